@@ -0,0 +1,386 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Headless benchmark, renders a set of XML scenes with a fixed number of samples and reports
+ * timings, memory usage and kernel profiling of every scene as JSON. The seed is part of the
+ * integrator settings of each scene, so repeated runs trace exactly the same paths. */
+
+#include <stdio.h>
+
+#include "render/buffers.h"
+#include "render/camera.h"
+#include "device/device.h"
+#include "render/integrator.h"
+#include "render/scene.h"
+#include "render/session.h"
+#include "render/stats.h"
+
+#include "util/util_args.h"
+#include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_path.h"
+#include "util/util_progress.h"
+#include "util/util_string.h"
+#include "util/util_time.h"
+#include "util/util_version.h"
+
+#include "app/cycles_xml.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Scenes bundled with the benchmark, rendered when no scene files are given. */
+static const char *benchmark_default_scenes[] = {
+    "interior_gi.xml",
+    "hair.xml",
+    "volumes.xml",
+    "sss.xml",
+    "many_lights.xml",
+    "instancing.xml",
+};
+
+struct Options {
+  vector<string> filepaths;
+  string scene_directory;
+  string output_path;
+  SceneParams scene_params;
+  SessionParams session_params;
+  bool quiet;
+} options;
+
+/* JSON */
+
+static string json_escape(const string &str)
+{
+  string result = "\"";
+  foreach (const char c, str) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          result += string_printf("\\u%04x", (int)c);
+        }
+        else {
+          result += c;
+        }
+        break;
+    }
+  }
+  return result + "\"";
+}
+
+/* The profiler samples the state of every render thread once per millisecond, so sample counts
+ * are in thread milliseconds. */
+static string json_kernel_stats(const NamedNestedSampleStats &stats, int indent_level)
+{
+  const string indent(indent_level * 2, ' ');
+  string result = "{\n";
+  result += indent + "  \"name\": " + json_escape(stats.name) + ",\n";
+  result += indent + string_printf("  \"self_samples\": %llu,\n",
+                                   (unsigned long long)stats.self_samples);
+  result += indent + string_printf("  \"total_samples\": %llu,\n",
+                                   (unsigned long long)stats.sum_samples);
+  result += indent + "  \"entries\": [";
+  for (size_t i = 0; i < stats.entries.size(); i++) {
+    result += (i == 0) ? "\n" : ",\n";
+    result += indent + "    " + json_kernel_stats(stats.entries[i], indent_level + 2);
+  }
+  result += stats.entries.empty() ? "]\n" : "\n" + indent + "  ]\n";
+  result += indent + "}";
+  return result;
+}
+
+/* Benchmark */
+
+static string benchmark_scene_name(const string &filepath)
+{
+  string name = path_filename(filepath);
+  if (string_endswith(name, ".xml")) {
+    name.resize(name.size() - 4);
+  }
+  return name;
+}
+
+static bool benchmark_scene(const string &filepath, string &json)
+{
+  const string name = benchmark_scene_name(filepath);
+  if (!path_exists(filepath)) {
+    fprintf(stderr, "Scene file not found: %s\n", filepath.c_str());
+    return false;
+  }
+
+  if (!options.quiet) {
+    fprintf(stderr, "Rendering %s\n", name.c_str());
+  }
+
+  Session *session = new Session(options.session_params);
+  Scene *scene = new Scene(options.scene_params, session->device);
+  xml_read_file(scene, filepath.c_str());
+  scene->camera->compute_auto_viewplane();
+  session->scene = scene;
+
+  const int width = scene->camera->width;
+  const int height = scene->camera->height;
+  const int samples = options.session_params.samples;
+  const int seed = scene->integrator->seed;
+
+  BufferParams buffer_params;
+  buffer_params.width = width;
+  buffer_params.height = height;
+  buffer_params.full_width = width;
+  buffer_params.full_height = height;
+
+  session->reset(buffer_params, samples);
+  session->start();
+  session->wait();
+
+  if (session->progress.get_error()) {
+    fprintf(stderr,
+            "Error rendering %s: %s\n",
+            name.c_str(),
+            session->progress.get_error_message().c_str());
+    delete session;
+    return false;
+  }
+
+  double total_time, render_time;
+  session->progress.get_time(total_time, render_time);
+
+  RenderStats stats;
+  session->collect_statistics(&stats);
+
+  const double pixel_samples = (double)width * (double)height * (double)samples;
+
+  json = "{\n";
+  json += "      \"name\": " + json_escape(name) + ",\n";
+  json += string_printf("      \"width\": %d,\n", width);
+  json += string_printf("      \"height\": %d,\n", height);
+  json += string_printf("      \"samples\": %d,\n", samples);
+  json += string_printf("      \"seed\": %d,\n", seed);
+  json += string_printf("      \"total_time\": %.3f,\n", total_time);
+  json += string_printf("      \"render_time\": %.3f,\n", render_time);
+  json += string_printf("      \"samples_per_second\": %.3f,\n",
+                        (render_time > 0.0) ? samples / render_time : 0.0);
+  json += string_printf("      \"pixel_samples_per_second\": %.1f,\n",
+                        (render_time > 0.0) ? pixel_samples / render_time : 0.0);
+  json += string_printf("      \"object_bvh_build_time\": %.3f,\n",
+                        stats.mesh.object_bvh_build_time);
+  json += string_printf("      \"scene_bvh_build_time\": %.3f,\n",
+                        stats.mesh.scene_bvh_build_time);
+  json += string_printf("      \"geometry_memory\": %llu,\n",
+                        (unsigned long long)stats.mesh.geometry.total_size);
+  json += string_printf("      \"triangle_memory\": %llu,\n",
+                        (unsigned long long)stats.mesh.triangle_memory);
+  json += string_printf("      \"memory_peak\": %llu,\n",
+                        (unsigned long long)session->stats.mem_peak);
+  json += "      \"kernel\": ";
+  json += (stats.has_profiling) ? json_kernel_stats(stats.kernel, 3) : "null";
+  json += "\n    }";
+
+  delete session;
+
+  if (!options.quiet) {
+    fprintf(stderr,
+            "  %.2fs render time, %.2f samples per second\n",
+            render_time,
+            (render_time > 0.0) ? samples / render_time : 0.0);
+  }
+
+  return true;
+}
+
+static int benchmark_run()
+{
+  string json = "{\n";
+  json += "  \"version\": " + json_escape(CYCLES_VERSION_STRING) + ",\n";
+  json += "  \"device\": " + json_escape(options.session_params.device.description) + ",\n";
+  json += string_printf("  \"threads\": %d,\n", options.session_params.threads);
+  json += string_printf("  \"compact_geometry\": %s,\n",
+                        options.scene_params.use_compact_geometry ? "true" : "false");
+  json += "  \"scenes\": [";
+
+  int num_failed = 0;
+  bool first = true;
+  foreach (const string &filepath, options.filepaths) {
+    string scene_json;
+    if (!benchmark_scene(filepath, scene_json)) {
+      num_failed++;
+      continue;
+    }
+    json += (first) ? "\n    " : ",\n    ";
+    json += scene_json;
+    first = false;
+  }
+
+  json += (first) ? "]\n}\n" : "\n  ]\n}\n";
+
+  if (options.output_path.empty()) {
+    printf("%s", json.c_str());
+  }
+  else if (!path_write_text(options.output_path, json)) {
+    fprintf(stderr, "Failed to write %s\n", options.output_path.c_str());
+    return EXIT_FAILURE;
+  }
+
+  return (num_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/* Options */
+
+static int files_parse(int argc, const char *argv[])
+{
+  for (int i = 0; i < argc; i++) {
+    options.filepaths.push_back(argv[i]);
+  }
+
+  return 0;
+}
+
+static void options_parse(int argc, const char **argv)
+{
+  options.quiet = false;
+#ifdef CYCLES_BENCHMARK_SCENE_DIR
+  options.scene_directory = CYCLES_BENCHMARK_SCENE_DIR;
+#else
+  options.scene_directory = path_get("benchmark");
+#endif
+
+  /* Fixed defaults so results are comparable between runs. */
+  options.session_params.samples = 64;
+  options.session_params.threads = 0;
+
+  /* device names */
+  string device_names = "";
+  string devicename = "CPU";
+
+  vector<DeviceType> types = Device::available_types();
+  foreach (DeviceType type, types) {
+    if (device_names != "")
+      device_names += ", ";
+
+    device_names += Device::string_from_type(type);
+  }
+
+  /* parse options */
+  ArgParse ap;
+  bool help = false, debug = false;
+  int verbosity = 1;
+
+  ap.options("Usage: cycles_benchmark [options] [file.xml ...]",
+             "%*",
+             files_parse,
+             "",
+             "--device %s",
+             &devicename,
+             ("Devices to use: " + device_names).c_str(),
+             "--samples %d",
+             &options.session_params.samples,
+             "Number of samples to render every scene with",
+             "--threads %d",
+             &options.session_params.threads,
+             "CPU Rendering Threads",
+             "--scene-directory %s",
+             &options.scene_directory,
+             "Directory with the bundled scenes, used when no files are given",
+             "--output %s",
+             &options.output_path,
+             "File path to write JSON results to, instead of standard output",
+             "--compact-geometry",
+             &options.scene_params.use_compact_geometry,
+             "Store triangle vertices and normals quantized",
+             "--quiet",
+             &options.quiet,
+             "Don't print progress messages",
+#ifdef WITH_CYCLES_LOGGING
+             "--debug",
+             &debug,
+             "Enable debug logging",
+             "--verbose %d",
+             &verbosity,
+             "Set verbosity of the logger",
+#endif
+             "--help",
+             &help,
+             "Print help message",
+             NULL);
+
+  if (ap.parse(argc, argv) < 0) {
+    fprintf(stderr, "%s\n", ap.geterror().c_str());
+    ap.usage();
+    exit(EXIT_FAILURE);
+  }
+
+  if (debug) {
+    util_logging_start();
+    util_logging_verbosity_set(verbosity);
+  }
+
+  if (help) {
+    ap.usage();
+    exit(EXIT_SUCCESS);
+  }
+
+  if (options.filepaths.empty()) {
+    const size_t num_scenes = sizeof(benchmark_default_scenes) / sizeof(*benchmark_default_scenes);
+    for (size_t i = 0; i < num_scenes; i++) {
+      options.filepaths.push_back(path_join(options.scene_directory, benchmark_default_scenes[i]));
+    }
+  }
+
+  /* Render tiles in the background, the same way final renders do. */
+  options.session_params.background = true;
+  options.session_params.progressive = false;
+  options.session_params.progressive_refine = false;
+  options.session_params.use_profiling = true;
+
+  /* find matching device */
+  DeviceType device_type = Device::type_from_string(devicename.c_str());
+  vector<DeviceInfo> devices = Device::available_devices(DEVICE_MASK(device_type));
+
+  if (devices.empty()) {
+    fprintf(stderr, "Unknown device: %s\n", devicename.c_str());
+    exit(EXIT_FAILURE);
+  }
+  options.session_params.device = devices.front();
+
+  if (options.session_params.samples <= 0) {
+    fprintf(stderr, "Invalid number of samples: %d\n", options.session_params.samples);
+    exit(EXIT_FAILURE);
+  }
+}
+
+CCL_NAMESPACE_END
+
+using namespace ccl;
+
+int main(int argc, const char **argv)
+{
+  util_logging_init(argv[0]);
+  path_init();
+  options_parse(argc, argv);
+
+  return benchmark_run();
+}
@@ -372,12 +372,18 @@ static void xml_read_background(XMLReadState &state, xml_node node)
 
 /* Mesh */
 
-static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
+static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm, xml_node node)
 {
   /* create mesh */
   Mesh *mesh = new Mesh();
   scene->meshes.push_back(mesh);
 
+  /* named meshes can be instanced */
+  string name;
+  if (xml_read_string(&name, node, "name")) {
+    mesh->name = ustring(name);
+  }
+
   /* create object*/
   Object *object = new Object();
   object->mesh = mesh;
@@ -390,7 +396,7 @@ static Mesh *xml_add_mesh(Scene *scene, const Transform &tfm)
 static void xml_read_mesh(const XMLReadState &state, xml_node node)
 {
   /* add mesh */
-  Mesh *mesh = xml_add_mesh(state.scene, state.tfm);
+  Mesh *mesh = xml_add_mesh(state.scene, state.tfm, node);
   mesh->used_shaders.push_back(state.shader);
 
   /* read state */
@@ -529,6 +535,71 @@ static void xml_read_mesh(const XMLReadState &state, xml_node node)
   }
 }
 
+/* Hair */
+
+static void xml_read_hair(const XMLReadState &state, xml_node node)
+{
+  /* add mesh */
+  Mesh *mesh = xml_add_mesh(state.scene, state.tfm, node);
+  mesh->used_shaders.push_back(state.shader);
+
+  /* read keys and curves, radius is either one value or one per key */
+  vector<float3> P;
+  vector<float> radius;
+  vector<int> nkeys;
+
+  xml_read_float3_array(P, node, "P");
+  xml_read_float_array(radius, node, "radius");
+  xml_read_int_array(nkeys, node, "nkeys");
+
+  if (radius.empty()) {
+    radius.push_back(0.01f);
+  }
+
+  mesh->reserve_curves(nkeys.size(), P.size());
+
+  /* create curves */
+  int key_offset = 0;
+
+  for (size_t i = 0; i < nkeys.size(); i++) {
+    if (nkeys[i] < 2 || key_offset + nkeys[i] > (int)P.size()) {
+      fprintf(stderr, "Invalid hair curve %d.\n", (int)i);
+      break;
+    }
+
+    for (int j = 0; j < nkeys[i]; j++) {
+      const int key = key_offset + j;
+      mesh->add_curve_key(P[key], (radius.size() == 1) ? radius[0] : radius[key]);
+    }
+    mesh->add_curve(key_offset, 0);
+
+    key_offset += nkeys[i];
+  }
+}
+
+/* Instance */
+
+static void xml_read_instance(const XMLReadState &state, xml_node node)
+{
+  string name;
+  if (!xml_read_string(&name, node, "mesh")) {
+    fprintf(stderr, "Instance without mesh.\n");
+    return;
+  }
+
+  foreach (Mesh *mesh, state.scene->meshes) {
+    if (mesh->name == name) {
+      Object *object = new Object();
+      object->mesh = mesh;
+      object->tfm = state.tfm;
+      state.scene->objects.push_back(object);
+      return;
+    }
+  }
+
+  fprintf(stderr, "Unknown mesh \"%s\".\n", name.c_str());
+}
+
 /* Light */
 
 static void xml_read_light(XMLReadState &state, xml_node node)
@@ -538,6 +609,12 @@ static void xml_read_light(XMLReadState &state, xml_node node)
   light->shader = state.shader;
   xml_read_node(state, light, node);
 
+  /* lights have no object, so apply the current transform directly */
+  light->co = transform_point(&state.tfm, light->co);
+  light->dir = transform_direction(&state.tfm, light->dir);
+  light->axisu = transform_direction(&state.tfm, light->axisu);
+  light->axisv = transform_direction(&state.tfm, light->axisv);
+
   state.scene->lights.push_back(light);
 }
 
@@ -628,6 +705,12 @@ static void xml_read_scene(XMLReadState &state, xml_node scene_node)
     else if (string_iequals(node.name(), "mesh")) {
       xml_read_mesh(state, node);
     }
+    else if (string_iequals(node.name(), "hair")) {
+      xml_read_hair(state, node);
+    }
+    else if (string_iequals(node.name(), "instance")) {
+      xml_read_instance(state, node);
+    }
     else if (string_iequals(node.name(), "light")) {
       xml_read_light(state, node);
     }
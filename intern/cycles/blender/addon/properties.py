@@ -316,6 +316,27 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default='SOBOL',
     )
 
+    use_adaptive_sampling: BoolProperty(
+        name="Use Adaptive Sampling",
+        description="Automatically stop sampling pixels which have converged, only used for final renders on CPU",
+        default=False,
+    )
+    adaptive_threshold: FloatProperty(
+        name="Adaptive Sampling Threshold",
+        description="Noise level at which pixels stop being sampled, "
+        "zero for an automatic setting based on the number of AA samples",
+        min=0.0, max=1.0,
+        default=0.0,
+        precision=4,
+    )
+    adaptive_min_samples: IntProperty(
+        name="Adaptive Min Samples",
+        description="Minimum number of AA samples taken before a pixel can be considered converged, "
+        "zero for an automatic setting based on the number of AA samples",
+        min=0, max=4096,
+        default=0,
+    )
+
     use_layer_samples: EnumProperty(
         name="Layer Samples",
         description="How to use per view layer sample settings",
@@ -341,6 +362,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Sample lights by their estimated contribution using a light tree, "
+        "reducing noise in scenes with many lights (not used when sampling all lights)",
+        default=False,
+    )
 
     min_light_bounces: IntProperty(
             name="Min Light Bounces",
@@ -609,6 +636,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0,
         min=0, max=16,
     )
+    use_compact_geometry: BoolProperty(
+        name="Compact Geometry",
+        description="Store triangle vertices and normals quantized to reduce memory usage, "
+        "at the cost of precision for large meshes (not used with Embree and OptiX)",
+        default=False,
+    )
     tile_order: EnumProperty(
         name="Tile Order",
         description="Tile order for rendering",
@@ -717,6 +750,29 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures from disk while rendering, only loading the tiles and resolutions that are used (CPU only)",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=1024,
+        min=16, max=1048576,
+    )
+    use_texture_memory_budget: BoolProperty(
+        name="Texture Memory Budget",
+        description="Compress image textures set to automatic compression once the images of the scene exceed the memory budget",
+        default=False,
+    )
+    texture_memory_budget: IntProperty(
+        name="Memory Budget",
+        description="Memory available for image textures before they get compressed, in megabytes",
+        default=16384,
+        min=16, max=1048576,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -1311,6 +1367,12 @@ class CyclesRenderLayerSettings(bpy.types.PropertyGroup):
         default=False,
         update=update_render_passes,
     )
+    use_oidn_denoising: BoolProperty(
+        name="Use OpenImageDenoise",
+        description="Denoise the rendered image with Intel OpenImageDenoise on the CPU, using the albedo and normal passes as input",
+        default=False,
+        update=update_render_passes,
+    )
     denoising_diffuse_direct: BoolProperty(
         name="Diffuse Direct",
         description="Denoise the direct diffuse lighting",
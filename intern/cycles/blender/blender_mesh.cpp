@@ -304,6 +304,7 @@ static void create_mesh_volume_attribute(
                                                EXTENSION_CLIP,
                                                IMAGE_ALPHA_AUTO,
                                                u_colorspace_raw,
+                                               IMAGE_COMPRESSION_AUTO,
                                                metadata);
 }
 
@@ -1046,12 +1047,11 @@ Mesh *BlenderSync::sync_mesh(BL::Depsgraph &b_depsgraph,
   oldsubd_faces.steal_data(mesh->subd_faces);
   oldsubd_face_corners.steal_data(mesh->subd_face_corners);
 
-  /* compares curve_keys rather than strands in order to handle quick hair
-   * adjustments in dynamic BVH - other methods could probably do this better*/
-  array<float3> oldcurve_keys;
-  array<float> oldcurve_radius;
-  oldcurve_keys.steal_data(mesh->curve_keys);
-  oldcurve_radius.steal_data(mesh->curve_radius);
+  /* Moving hair keys only needs a refit of the BVH, compare the layout of the curves
+   * to detect when it has to be rebuilt. */
+  const size_t oldnum_curve_keys = mesh->curve_keys.size();
+  array<int> oldcurve_first_key;
+  oldcurve_first_key.steal_data(mesh->curve_first_key);
 
   /* ensure bvh rebuild (instead of refit) if has_voxel_attributes() changed */
   bool oldhas_voxel_attributes = mesh->has_voxel_attributes();
@@ -1104,7 +1104,8 @@ Mesh *BlenderSync::sync_mesh(BL::Depsgraph &b_depsgraph,
   /* tag update */
   bool rebuild = (oldtriangles != mesh->triangles) || (oldsubd_faces != mesh->subd_faces) ||
                  (oldsubd_face_corners != mesh->subd_face_corners) ||
-                 (oldcurve_keys != mesh->curve_keys) || (oldcurve_radius != mesh->curve_radius) ||
+                 (oldnum_curve_keys != mesh->curve_keys.size()) ||
+                 (oldcurve_first_key != mesh->curve_first_key) ||
                  (oldhas_voxel_attributes != mesh->has_voxel_attributes());
 
   mesh->tag_update(scene, rebuild);
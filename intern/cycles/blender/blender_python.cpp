@@ -1085,5 +1085,13 @@ void *CCL_python_module_init()
   Py_INCREF(Py_False);
 #endif /* WITH_EMBREE */
 
+#ifdef WITH_OPENIMAGEDENOISE
+  PyModule_AddObject(mod, "with_openimagedenoise", Py_True);
+  Py_INCREF(Py_True);
+#else  /* WITH_OPENIMAGEDENOISE */
+  PyModule_AddObject(mod, "with_openimagedenoise", Py_False);
+  Py_INCREF(Py_False);
+#endif /* WITH_OPENIMAGEDENOISE */
+
   return (void *)mod;
 }
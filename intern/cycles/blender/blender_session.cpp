@@ -226,7 +226,6 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
   }
 
   session->progress.reset();
-  scene->reset();
 
   session->tile_manager.set_tile_order(session_params.tile_order);
 
@@ -235,13 +234,21 @@ void BlenderSession::reset_session(BL::BlendData &b_data, BL::Depsgraph &b_depsg
    */
   session->stats.mem_peak = session->stats.mem_used;
 
-  /* There is no single depsgraph to use for the entire render.
-   * See note on create_session().
-   */
-  /* sync object should be re-created */
-  sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
-
   BL::SpaceView3D b_null_space_view3d(PointerRNA_NULL);
+  if (b_engine.is_depsgraph_reused()) {
+    /* Persistent data: keep the scene and the sync maps from the previous render, so meshes,
+     * BVHs, images and shaders stay resident and only what the depsgraph reports as updated since
+     * then is synced again. */
+    sync->reset(this->b_data, this->b_scene);
+    sync->sync_recalc(b_depsgraph, b_null_space_view3d);
+  }
+  else {
+    /* The sync maps are keyed by evaluated data of the previous depsgraph, which is gone. */
+    scene->reset();
+    delete sync;
+    sync = new BlenderSync(b_engine, b_data, b_scene, scene, !background, session->progress);
+  }
+
   BL::RegionView3D b_null_region_view3d(PointerRNA_NULL);
   BufferParams buffer_params = BlenderSync::get_buffer_params(
       b_render, b_null_space_view3d, b_null_region_view3d, scene->camera, width, height);
@@ -474,22 +481,40 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
   b_rlay_name = b_view_layer.name();
 
   /* add passes */
-  vector<Pass> passes = sync->sync_render_passes(b_rlay, b_view_layer);
+  vector<Pass> passes = sync->sync_render_passes(b_rlay, b_view_layer, session->device->info);
+
+  /* Adaptive sampling needs every tile to be rendered with all of its samples at once, which is
+   * not the case with progressive refine. */
+  PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
+  session->params.adaptive_sampling = get_boolean(cscene, "use_adaptive_sampling") &&
+                                      !session->params.progressive_refine &&
+                                      session->device->info.has_adaptive_sampling;
+  if (session->params.adaptive_sampling) {
+    Pass::add(PASS_ADAPTIVE_AUX_BUFFER, passes);
+    Pass::add(PASS_SAMPLE_COUNT, passes);
+  }
+
   buffer_params.passes = passes;
 
   PointerRNA crl = RNA_pointer_get(&b_view_layer.ptr, "cycles");
   bool use_denoising = get_boolean(crl, "use_denoising");
   bool use_optix_denoising = get_boolean(crl, "use_optix_denoising");
+  /* OpenImageDenoise runs on the CPU only, other devices fall back to the regular denoiser. */
+  bool use_oidn_denoising = get_boolean(crl, "use_oidn_denoising") && !use_optix_denoising &&
+                            session->device->info.has_oidn_denoising;
   bool write_denoising_passes = get_boolean(crl, "denoising_store_passes");
+  bool use_ai_denoising = use_optix_denoising || use_oidn_denoising;
+  bool oidn_denoising = use_denoising && use_oidn_denoising;
 
   buffer_params.denoising_data_pass = use_denoising || write_denoising_passes;
   buffer_params.denoising_clean_pass = (scene->film->denoising_flags & DENOISING_CLEAN_ALL_PASSES);
-  buffer_params.denoising_prefiltered_pass = write_denoising_passes && !use_optix_denoising;
+  buffer_params.denoising_prefiltered_pass = write_denoising_passes && !use_ai_denoising;
 
   session->params.run_denoising = use_denoising || write_denoising_passes;
-  session->params.full_denoising = use_denoising && !use_optix_denoising;
+  session->params.full_denoising = use_denoising && !use_optix_denoising && !oidn_denoising;
   session->params.optix_denoising = use_denoising && use_optix_denoising;
-  session->params.write_denoising_passes = write_denoising_passes && !use_optix_denoising;
+  session->params.oidn_denoising = oidn_denoising;
+  session->params.write_denoising_passes = write_denoising_passes && !use_ai_denoising;
   session->params.denoising.radius = get_int(crl, "denoising_radius");
   session->params.denoising.strength = get_float(crl, "denoising_strength");
   session->params.denoising.feature_strength = get_float(crl, "denoising_feature_strength");
@@ -591,17 +616,8 @@ void BlenderSession::render(BL::Depsgraph &b_depsgraph_)
   session->write_render_tile_cb = function_null;
   session->update_render_tile_cb = function_null;
 
-  /* TODO: find a way to clear this data for persistent data render */
-#if 0
-  /* free all memory used (host and device), so we wouldn't leave render
-   * engine with extra memory allocated
-   */
-
-  session->device_free();
-
-  delete sync;
-  sync = NULL;
-#endif
+  /* Scene data is kept in the session until it is freed, so the next frame can reuse it when
+   * rendering with persistent data. */
 }
 
 static void populate_bake_data(BakeData *data,
@@ -1507,6 +1523,10 @@ void BlenderSession::free_blender_memory_if_possible()
      */
     return;
   }
+  if (scene->params.persistent_data) {
+    /* The depsgraph is reused for the next frame, its evaluated data must stay valid. */
+    return;
+  }
   b_engine.free_blender_memory();
 }
 
@@ -90,6 +90,13 @@ template<typename NodeType> static ExtensionType get_image_extension(NodeType &b
   return (ExtensionType)validate_enum_value(value, EXTENSION_NUM_TYPES, EXTENSION_REPEAT);
 }
 
+template<typename NodeType> static ImageCompression get_image_compression(NodeType &b_node)
+{
+  int value = b_node.compression();
+  return (ImageCompression)validate_enum_value(
+      value, IMAGE_COMPRESSION_NUM_TYPES, IMAGE_COMPRESSION_AUTO);
+}
+
 static ImageAlphaType get_image_alpha_type(BL::Image &b_image)
 {
   int value = b_image.alpha_mode();
@@ -688,6 +695,7 @@ static ShaderNode *add_node(Scene *scene,
     image->projection = (NodeImageProjection)b_image_node.projection();
     image->interpolation = get_image_interpolation(b_image_node);
     image->extension = get_image_extension(b_image_node);
+    image->compression = get_image_compression(b_image_node);
     image->projection_blend = b_image_node.projection_blend();
     BL::TexMapping b_texture_mapping(b_image_node.texture_mapping());
     get_tex_mapping(&image->tex_mapping, b_texture_mapping);
@@ -735,6 +743,7 @@ static ShaderNode *add_node(Scene *scene,
 #endif
     }
     env->interpolation = get_image_interpolation(b_env_node);
+    env->compression = get_image_compression(b_env_node);
     env->projection = (NodeEnvironmentProjection)b_env_node.projection();
     BL::TexMapping b_texture_mapping(b_env_node.texture_mapping());
     get_tex_mapping(&env->tex_mapping, b_texture_mapping);
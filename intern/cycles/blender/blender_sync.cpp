@@ -78,6 +78,14 @@ BlenderSync::~BlenderSync()
 {
 }
 
+void BlenderSync::reset(BL::BlendData &b_data, BL::Scene &b_scene)
+{
+  /* Update data and scene pointers in case they change in session reset,
+   * for example after undo or when rendering the next frame with persistent data. */
+  this->b_data = b_data;
+  this->b_scene = b_scene;
+}
+
 /* Sync */
 
 void BlenderSync::sync_recalc(BL::Depsgraph &b_depsgraph, BL::SpaceView3D &b_v3d)
@@ -273,6 +281,9 @@ void BlenderSync::sync_integrator()
   integrator->sampling_pattern = (SamplingPattern)get_enum(
       cscene, "sampling_pattern", SAMPLING_NUM_PATTERNS, SAMPLING_PATTERN_SOBOL);
 
+  integrator->adaptive_threshold = get_float(cscene, "adaptive_threshold");
+  integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
+
   integrator->sample_clamp_direct = get_float(cscene, "sample_clamp_direct");
   integrator->sample_clamp_indirect = get_float(cscene, "sample_clamp_indirect");
   if (!preview) {
@@ -291,6 +302,12 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
 
+  const bool use_light_tree = get_boolean(cscene, "use_light_tree");
+  if (integrator->use_light_tree != use_light_tree) {
+    scene->light_manager->tag_update(scene);
+  }
+  integrator->use_light_tree = use_light_tree;
+
   int diffuse_samples = get_int(cscene, "diffuse_samples");
   int glossy_samples = get_int(cscene, "glossy_samples");
   int transmission_samples = get_int(cscene, "transmission_samples");
@@ -517,7 +534,9 @@ int BlenderSync::get_denoising_pass(BL::RenderPass &b_pass)
   return -1;
 }
 
-vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay, BL::ViewLayer &b_view_layer)
+vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay,
+                                             BL::ViewLayer &b_view_layer,
+                                             const DeviceInfo &device_info)
 {
   vector<Pass> passes;
 
@@ -537,11 +556,14 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay, BL::ViewLa
   PointerRNA crp = RNA_pointer_get(&b_view_layer.ptr, "cycles");
   bool use_denoising = get_boolean(crp, "use_denoising");
   bool use_optix_denoising = get_boolean(crp, "use_optix_denoising");
+  /* Devices without OpenImageDenoise fall back to the regular denoiser, which needs its passes. */
+  bool use_oidn_denoising = get_boolean(crp, "use_oidn_denoising") && !use_optix_denoising &&
+                            device_info.has_oidn_denoising;
   bool write_denoising_passes = get_boolean(crp, "denoising_store_passes");
 
   scene->film->denoising_flags = 0;
   if (use_denoising || write_denoising_passes) {
-    if (!use_optix_denoising) {
+    if (!use_optix_denoising && !use_oidn_denoising) {
 #define MAP_OPTION(name, flag) \
   if (!get_boolean(crp, name)) \
     scene->film->denoising_flags |= flag;
@@ -562,7 +584,7 @@ vector<Pass> BlenderSync::sync_render_passes(BL::RenderLayer &b_rlay, BL::ViewLa
     b_engine.add_pass("Denoising Normal", 3, "XYZ", b_view_layer.name().c_str());
     b_engine.add_pass("Denoising Albedo", 3, "RGB", b_view_layer.name().c_str());
     b_engine.add_pass("Denoising Depth", 1, "Z", b_view_layer.name().c_str());
-    if (!use_optix_denoising) {
+    if (!use_optix_denoising && !use_oidn_denoising) {
       b_engine.add_pass("Denoising Shadowing", 1, "X", b_view_layer.name().c_str());
       b_engine.add_pass("Denoising Variance", 3, "RGB", b_view_layer.name().c_str());
       b_engine.add_pass("Denoising Intensity", 1, "X", b_view_layer.name().c_str());
@@ -701,6 +723,7 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
   params.use_bvh_spatial_split = RNA_boolean_get(&cscene, "debug_use_spatial_splits");
   params.use_bvh_unaligned_nodes = RNA_boolean_get(&cscene, "debug_use_hair_bvh");
   params.num_bvh_time_steps = RNA_int_get(&cscene, "debug_bvh_time_steps");
+  params.use_compact_geometry = RNA_boolean_get(&cscene, "use_compact_geometry");
 
   if (background && params.shadingsystem != SHADINGSYSTEM_OSL)
     params.persistent_data = r.use_persistent_data();
@@ -721,6 +744,20 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  if (get_boolean(cscene, "use_texture_cache")) {
+    params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  }
+  else {
+    params.texture_cache_size = 0;
+  }
+
+  if (get_boolean(cscene, "use_texture_memory_budget")) {
+    params.texture_memory_budget = get_int(cscene, "texture_memory_budget");
+  }
+  else {
+    params.texture_memory_budget = 0;
+  }
+
   /* TODO(sergey): Once OSL supports per-microarchitecture optimization get
    * rid of this.
    */
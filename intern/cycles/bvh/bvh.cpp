@@ -100,7 +100,12 @@ int BVHStackEntry::encodeIdx() const
 /* BVH */
 
 BVH::BVH(const BVHParams &params_, const vector<Mesh *> &meshes_, const vector<Object *> &objects_)
-    : params(params_), meshes(meshes_), objects(objects_)
+    : params(params_),
+      meshes(meshes_),
+      objects(objects_),
+      build_node_area_ratio(0.0f),
+      refit_node_area(0.0f),
+      refit_root_area(0.0f)
 {
 }
 
@@ -137,6 +142,19 @@ BVH *BVH::create(const BVHParams &params,
 
 /* Building */
 
+static float bvh_inner_node_area(const BVHNode *node)
+{
+  if (node->is_leaf()) {
+    return 0.0f;
+  }
+
+  float area = node->bounds.safe_area();
+  for (int i = 0; i < node->num_children(); i++) {
+    area += bvh_inner_node_area(node->get_child(i));
+  }
+  return area;
+}
+
 void BVH::build(Progress &progress, Stats *)
 {
   progress.set_substatus("Building BVH");
@@ -172,6 +190,18 @@ void BVH::build(Progress &progress, Stats *)
     return;
   }
 
+  /* Remember the quality of the tree, to decide when refitting it is no longer worth it.
+   * Unaligned node bounds are measured in their own (orthonormal) space, so refitting them
+   * into axis aligned nodes shows up as growth. The root is compared in world space, like
+   * refit_nodes() measures it. */
+  BoundBox root_bounds = root->bounds;
+  if (root->is_unaligned) {
+    const Transform world_space = transform_inverse(root->get_aligned_space());
+    root_bounds = root_bounds.transformed(&world_space);
+  }
+  const float root_area = root_bounds.safe_area();
+  build_node_area_ratio = (root_area > 0.0f) ? bvh_inner_node_area(root) / root_area : 0.0f;
+
   /* pack triangles */
   progress.set_substatus("Packing BVH triangles and strands");
   pack_primitives();
@@ -191,16 +221,33 @@ void BVH::build(Progress &progress, Stats *)
 
 /* Refitting */
 
-void BVH::refit(Progress &progress)
+bool BVH::refit(Progress &progress)
 {
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
   if (progress.get_cancel())
-    return;
+    return true;
 
   progress.set_substatus("Refitting BVH nodes");
+  refit_node_area = 0.0f;
+  refit_root_area = 0.0f;
   refit_nodes();
+
+  /* Primitives moving apart stretch the nodes and make them overlap, which the refit can not
+   * fix. Ask for a rebuild once traversal got noticeably more expensive. Only the packed BVH
+   * layouts measure this, Embree rebuilds committed geometry itself and leaves the areas zero. */
+  if (build_node_area_ratio == 0.0f || refit_root_area == 0.0f) {
+    return true;
+  }
+
+  const float node_area_ratio = refit_node_area / refit_root_area;
+  if (node_area_ratio > build_node_area_ratio * params.refit_max_area_growth) {
+    VLOG(1) << "Refitted BVH node area ratio " << node_area_ratio << " exceeds built "
+            << build_node_area_ratio << ", rebuild needed.";
+    return false;
+  }
+  return true;
 }
 
 void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
@@ -295,7 +342,7 @@ void BVH::pack_primitives()
   const size_t tidx_size = pack.prim_index.size();
   size_t num_prim_triangles = 0;
   /* Count number of triangles primitives in BVH. */
-  for (unsigned int i = 0; i < tidx_size; i++) {
+  for (unsigned int i = 0; i < tidx_size && !params.use_compact_geometry; i++) {
     if ((pack.prim_index[i] != -1)) {
       if ((pack.prim_type[i] & PRIMITIVE_ALL_TRIANGLE) != 0) {
         ++num_prim_triangles;
@@ -315,7 +362,7 @@ void BVH::pack_primitives()
     if (pack.prim_index[i] != -1) {
       int tob = pack.prim_object[i];
       Object *ob = objects[tob];
-      if ((pack.prim_type[i] & PRIMITIVE_ALL_TRIANGLE) != 0) {
+      if ((pack.prim_type[i] & PRIMITIVE_ALL_TRIANGLE) != 0 && !params.use_compact_geometry) {
         pack_triangle(i, (float4 *)&pack.prim_tri_verts[3 * prim_triangle_index]);
         pack.prim_tri_index[i] = 3 * prim_triangle_index;
         ++prim_triangle_index;
@@ -463,6 +510,10 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
           pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + mesh_curve_offset;
           pack_prim_tri_index[pack_prim_index_offset] = -1;
         }
+        else if (bvh_prim_tri_index[i] == (uint)-1) {
+          pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + mesh_tri_offset;
+          pack_prim_tri_index[pack_prim_index_offset] = -1;
+        }
         else {
           pack_prim_index[pack_prim_index_offset] = bvh_prim_index[i] + mesh_tri_offset;
           pack_prim_tri_index[pack_prim_index_offset] = bvh_prim_tri_index[i] +
@@ -99,11 +99,24 @@ class BVH {
   {
   }
 
-  void refit(Progress &progress);
+  /* Update node bounds for changed primitive positions, keeping the tree topology. Returns
+   * false when the refitted tree degraded too much compared to the built one, in which case
+   * it should be rebuilt. */
+  bool refit(Progress &progress);
 
  protected:
   BVH(const BVHParams &params, const vector<Mesh *> &meshes, const vector<Object *> &objects);
 
+  /* Summed surface area of inner nodes relative to the root, the node traversal term of the
+   * SAH cost. Recorded on build to measure how much refitting degrades the tree, zero when
+   * unknown. */
+  float build_node_area_ratio;
+
+  /* Summed surface area of inner nodes and area of the root, accumulated by refit_nodes() of
+   * the BVH2, BVH4 and BVH8 layouts. */
+  float refit_node_area;
+  float refit_root_area;
+
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
 
@@ -242,6 +242,7 @@ void BVH2::refit_nodes()
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  refit_root_area = bbox.safe_area();
 }
 
 void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
@@ -267,7 +268,6 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     assert(idx + BVH_NODE_SIZE <= pack.nodes.size());
 
     const int4 *data = &pack.nodes[idx];
-    const bool is_unaligned = (data[0].x & PATH_RAY_NODE_UNALIGNED) != 0;
     const int c0 = data[0].z;
     const int c1 = data[0].w;
     /* refit inner node, set bbox from children */
@@ -277,18 +277,15 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
     refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
 
-    if (is_unaligned) {
-      Transform aligned_space = transform_identity();
-      pack_unaligned_node(
-          idx, aligned_space, aligned_space, bbox0, bbox1, c0, c1, visibility0, visibility1);
-    }
-    else {
-      pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
-    }
+    /* The oriented spaces of unaligned nodes were fitted to the primitives on build and can't
+     * be refitted, store them as aligned nodes in the same (larger) slot instead. BVH::refit()
+     * asks for a rebuild when this makes the tree noticeably worse. */
+    pack_aligned_node(idx, bbox0, bbox1, c0, c1, visibility0, visibility1);
 
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    refit_node_area += bbox.safe_area();
   }
 }
 
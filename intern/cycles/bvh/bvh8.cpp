@@ -410,6 +410,7 @@ void BVH8::refit_nodes()
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  refit_root_area = bbox.safe_area();
 }
 
 void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
@@ -521,21 +522,10 @@ void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
       }
     }
 
-    if (is_unaligned) {
-      Transform aligned_space[8] = {transform_identity(),
-                                    transform_identity(),
-                                    transform_identity(),
-                                    transform_identity(),
-                                    transform_identity(),
-                                    transform_identity(),
-                                    transform_identity(),
-                                    transform_identity()};
-      pack_unaligned_node(
-          idx, aligned_space, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
-    }
-    else {
-      pack_aligned_node(idx, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
-    }
+    /* Unaligned nodes become aligned ones in the same slot, see BVH2::refit_node(). */
+    pack_aligned_node(idx, child_bbox, child, visibility, 0.0f, 1.0f, num_nodes);
+
+    refit_node_area += bbox.safe_area();
   }
 }
 
@@ -64,14 +64,11 @@ CCL_NAMESPACE_BEGIN
  * as well as filtering for volume objects happen here.
  * Cycles' own BVH does that directly inside the traversal calls.
  */
-static void rtc_filter_func(const RTCFilterFunctionNArguments *args)
+static void rtc_filter_func_single(CCLIntersectContext *ctx,
+                                   const RTCRay *ray,
+                                   const RTCHit *hit,
+                                   int *valid)
 {
-  /* Current implementation in Cycles assumes only single-ray intersection queries. */
-  assert(args->N == 1);
-
-  const RTCRay *ray = (RTCRay *)args->ray;
-  const RTCHit *hit = (RTCHit *)args->hit;
-  CCLIntersectContext *ctx = ((IntersectContext *)args->context)->userRayExt;
   KernelGlobals *kg = ctx->kg;
 
   /* Check if there is backfacing hair to ignore. */
@@ -80,19 +77,17 @@ static void rtc_filter_func(const RTCFilterFunctionNArguments *args)
       !(kernel_data.curve.curveflags & CURVE_KN_RIBBONS)) {
     if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
             make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-      *args->valid = 0;
+      *valid = 0;
       return;
     }
   }
 }
 
-static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
+static void rtc_filter_occluded_func_single(CCLIntersectContext *ctx,
+                                            const RTCRay *ray,
+                                            const RTCHit *hit,
+                                            int *valid)
 {
-  assert(args->N == 1);
-
-  const RTCRay *ray = (RTCRay *)args->ray;
-  RTCHit *hit = (RTCHit *)args->hit;
-  CCLIntersectContext *ctx = ((IntersectContext *)args->context)->userRayExt;
   KernelGlobals *kg = ctx->kg;
 
   /* For all ray types: Check if there is backfacing hair to ignore */
@@ -101,7 +96,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
       !(kernel_data.curve.curveflags & CURVE_KN_RIBBONS)) {
     if (dot(make_float3(ray->dir_x, ray->dir_y, ray->dir_z),
             make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z)) > 0.0f) {
-      *args->valid = 0;
+      *valid = 0;
       return;
     }
   }
@@ -116,7 +111,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
           if (current_isect.object == ctx->isect_s[i].object &&
               current_isect.prim == ctx->isect_s[i].prim && current_isect.t == ctx->isect_s[i].t) {
             /* This intersection was already recorded, skip it. */
-            *args->valid = 0;
+            *valid = 0;
             break;
           }
         }
@@ -136,7 +131,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
         /* If no transparent shadows, all light is blocked. */
         if (flag & (SD_HAS_TRANSPARENT_SHADOW)) {
           /* This tells Embree to continue tracing. */
-          *args->valid = 0;
+          *valid = 0;
         }
       }
       else {
@@ -157,7 +152,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
         kernel_embree_convert_hit(kg, ray, hit, &current_isect);
         if (ctx->local_object_id != current_isect.object) {
           /* This tells Embree to continue tracing. */
-          *args->valid = 0;
+          *valid = 0;
         }
       }
 
@@ -169,7 +164,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
       /* Ignore curves. */
       if (hit->geomID & 1) {
         /* This tells Embree to continue tracing. */
-        *args->valid = 0;
+        *valid = 0;
         break;
       }
 
@@ -177,7 +172,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
       for (int i = min(ctx->max_hits, ctx->local_isect->num_hits) - 1; i >= 0; --i) {
         if (ctx->local_isect->hits[i].t == ray->tfar) {
           /* This tells Embree to continue tracing. */
-          *args->valid = 0;
+          *valid = 0;
           break;
         }
       }
@@ -197,7 +192,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
 
           if (hit_idx >= ctx->max_hits) {
             /* This tells Embree to continue tracing. */
-            *args->valid = 0;
+            *valid = 0;
             break;
           }
         }
@@ -209,7 +204,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
       ctx->local_isect->hits[hit_idx] = current_isect;
       ctx->local_isect->Ng[hit_idx] = normalize(make_float3(hit->Ng_x, hit->Ng_y, hit->Ng_z));
       /* This tells Embree to continue tracing .*/
-      *args->valid = 0;
+      *valid = 0;
       break;
     }
     case CCLIntersectContext::RAY_VOLUME_ALL: {
@@ -221,7 +216,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
           if (current_isect.object == ctx->isect_s[i].object &&
               current_isect.prim == ctx->isect_s[i].prim && current_isect.t == ctx->isect_s[i].t) {
             /* This intersection was already recorded, skip it. */
-            *args->valid = 0;
+            *valid = 0;
             break;
           }
         }
@@ -237,7 +232,7 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
           --ctx->num_hits;
         }
         /* This tells Embree to continue tracing. */
-        *args->valid = 0;
+        *valid = 0;
         break;
       }
     }
@@ -248,6 +243,42 @@ static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
   }
 }
 
+/* Filter the hits of a query through a filter for single rays.
+ *
+ * Queries of multiple rays (the camera ray streams) are traced as packets by Embree, the filter
+ * then gets all lanes of the packet at once in SOA layout. Only lanes marked as valid hold a hit,
+ * each one of them is converted to a single ray and hit. */
+static void rtc_filter_n(const RTCFilterFunctionNArguments *args,
+                         void (*filter)(CCLIntersectContext *ctx,
+                                        const RTCRay *ray,
+                                        const RTCHit *hit,
+                                        int *valid))
+{
+  CCLIntersectContext *ctx = ((IntersectContext *)args->context)->userRayExt;
+  if (args->N == 1) {
+    filter(ctx, (const RTCRay *)args->ray, (const RTCHit *)args->hit, args->valid);
+    return;
+  }
+  for (unsigned int i = 0; i < args->N; i++) {
+    if (args->valid[i] == 0) {
+      continue;
+    }
+    const RTCRay ray = rtcGetRayFromRayN(args->ray, args->N, i);
+    const RTCHit hit = rtcGetHitFromHitN(args->hit, args->N, i);
+    filter(ctx, &ray, &hit, &args->valid[i]);
+  }
+}
+
+static void rtc_filter_func(const RTCFilterFunctionNArguments *args)
+{
+  rtc_filter_n(args, rtc_filter_func_single);
+}
+
+static void rtc_filter_occluded_func(const RTCFilterFunctionNArguments *args)
+{
+  rtc_filter_n(args, rtc_filter_occluded_func_single);
+}
+
 static size_t unaccounted_mem = 0;
 
 static bool rtc_memory_monitor_func(void *userPtr, const ssize_t bytes, const bool)
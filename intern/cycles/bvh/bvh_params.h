@@ -56,6 +56,10 @@ class BVHParams {
   float sah_node_cost;
   float sah_primitive_cost;
 
+  /* Refitted BVH is rebuilt once its inner nodes grew this much in surface area, relative to
+   * the root, compared to the freshly built tree. */
+  float refit_max_area_growth;
+
   /* number of primitives in leaf */
   int min_leaf_size;
   int max_triangle_leaf_size;
@@ -91,6 +95,10 @@ class BVHParams {
   /* Same as in SceneParams. */
   int bvh_type;
 
+  /* Triangles are intersected from the compact mesh storage, so no copy of their vertices is
+   * packed with the BVH. */
+  bool use_compact_geometry;
+
   /* These are needed for Embree. */
   int curve_flags;
   int curve_subdivisions;
@@ -110,6 +118,8 @@ class BVHParams {
     sah_node_cost = 1.0f;
     sah_primitive_cost = 1.0f;
 
+    refit_max_area_growth = 1.5f;
+
     min_leaf_size = 1;
     max_triangle_leaf_size = 8;
     max_motion_triangle_leaf_size = 8;
@@ -126,6 +136,7 @@ class BVHParams {
     num_motion_triangle_steps = 0;
 
     bvh_type = 0;
+    use_compact_geometry = false;
 
     curve_flags = 0;
     curve_subdivisions = 4;
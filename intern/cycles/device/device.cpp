@@ -592,9 +592,12 @@ DeviceInfo Device::get_multi_device(const vector<DeviceInfo> &subdevices,
   info.num = 0;
 
   info.has_half_images = true;
+  info.has_compressed_images = true;
   info.has_volume_decoupled = true;
   info.has_osl = true;
   info.has_profiling = true;
+  info.has_adaptive_sampling = true;
+  info.has_oidn_denoising = true;
 
   foreach (const DeviceInfo &device, subdevices) {
     /* Ensure CPU device does not slow down GPU. */
@@ -626,9 +629,12 @@ DeviceInfo Device::get_multi_device(const vector<DeviceInfo> &subdevices,
 
     /* Accumulate device info. */
     info.has_half_images &= device.has_half_images;
+    info.has_compressed_images &= device.has_compressed_images;
     info.has_volume_decoupled &= device.has_volume_decoupled;
     info.has_osl &= device.has_osl;
     info.has_profiling &= device.has_profiling;
+    info.has_adaptive_sampling &= device.has_adaptive_sampling;
+    info.has_oidn_denoising &= device.has_oidn_denoising;
   }
 
   return info;
@@ -75,12 +75,15 @@ class DeviceInfo {
   string description;
   string id; /* used for user preferences, should stay fixed with changing hardware config */
   int num;
-  bool display_device;       /* GPU is used as a display device. */
-  bool has_half_images;      /* Support half-float textures. */
-  bool has_volume_decoupled; /* Decoupled volume shading. */
-  bool has_osl;              /* Support Open Shading Language. */
-  bool use_split_kernel;     /* Use split or mega kernel. */
-  bool has_profiling;        /* Supports runtime collection of profiling info. */
+  bool display_device;        /* GPU is used as a display device. */
+  bool has_half_images;       /* Support half-float textures. */
+  bool has_compressed_images; /* Support block compressed textures. */
+  bool has_volume_decoupled;  /* Decoupled volume shading. */
+  bool has_osl;               /* Support Open Shading Language. */
+  bool use_split_kernel;      /* Use split or mega kernel. */
+  bool has_profiling;         /* Supports runtime collection of profiling info. */
+  bool has_adaptive_sampling; /* Supports stopping sampling of converged pixels. */
+  bool has_oidn_denoising;    /* Supports denoising with OpenImageDenoise. */
   int cpu_threads;
   vector<DeviceInfo> multi_devices;
 
@@ -92,10 +95,13 @@ class DeviceInfo {
     cpu_threads = 0;
     display_device = false;
     has_half_images = false;
+    has_compressed_images = false;
     has_volume_decoupled = false;
     has_osl = false;
     use_split_kernel = false;
     has_profiling = false;
+    has_adaptive_sampling = false;
+    has_oidn_denoising = false;
   }
 
   bool operator==(const DeviceInfo &info)
@@ -359,6 +365,12 @@ class Device {
     return NULL;
   }
 
+  /* texture cache for images read on demand, only for CPU device */
+  virtual void *texture_cache_memory()
+  {
+    return NULL;
+  }
+
   /* load/compile kernels, must be called before adding tasks */
   virtual bool load_kernels(const DeviceRequestedFeatures & /*requested_features*/)
   {
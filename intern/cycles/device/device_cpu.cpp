@@ -24,6 +24,10 @@
 #  include <OSL/oslexec.h>
 #endif
 
+#ifdef WITH_OPENIMAGEDENOISE
+#  include <OpenImageDenoise/oidn.hpp>
+#endif
+
 #include "device/device.h"
 #include "device/device_denoising.h"
 #include "device/device_intern.h"
@@ -34,6 +38,7 @@
 #include "kernel/kernel_types.h"
 #include "kernel/split/kernel_split_data.h"
 #include "kernel/kernel_globals.h"
+#include "kernel/kernel_adaptive_sampling.h"
 
 #include "kernel/filter/filter.h"
 
@@ -51,6 +56,8 @@
 #include "util/util_opengl.h"
 #include "util/util_optimization.h"
 #include "util/util_progress.h"
+#include "util/util_rect.h"
+#include "util/util_string.h"
 #include "util/util_system.h"
 #include "util/util_thread.h"
 
@@ -61,6 +68,20 @@ class CPUDevice;
 /* Has to be outside of the class to be shared across template instantiations. */
 static const char *logged_architecture = "";
 
+/* Pixels of the neighboring tiles which are passed to OpenImageDenoise along with the tile, so
+ * there are no visible seams between denoised tiles. */
+static const int OIDN_TILE_OVERLAP = 64;
+
+static bool oidn_denoising_supported()
+{
+#ifdef WITH_OPENIMAGEDENOISE
+  /* OpenImageDenoise needs at least SSE4.1. */
+  return system_cpu_support_sse41();
+#else
+  return false;
+#endif
+}
+
 template<typename F> class KernelFunctions {
  public:
   KernelFunctions()
@@ -174,11 +195,23 @@ class CPUDevice : public Device {
   OSLGlobals osl_globals;
 #endif
 
+  TextureCacheGlobals texture_cache_globals;
+
+#ifdef WITH_OPENIMAGEDENOISE
+  /* Created on first use. The filter is shared by all threads, OpenImageDenoise is multithreaded
+   * internally and memory intensive, so only one tile is denoised at a time. */
+  oidn::DeviceRef oidn_device;
+  oidn::FilterRef oidn_filter;
+  thread_mutex oidn_mutex;
+#endif
+
   bool use_split_kernel;
 
   DeviceRequestedFeatures requested_features;
 
   KernelFunctions<void (*)(KernelGlobals *, float *, int, int, int, int, int)> path_trace_kernel;
+  KernelFunctions<void (*)(KernelGlobals *, float *, int, const int2 *, int, int, int)>
+      path_trace_stream_kernel;
   KernelFunctions<void (*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)>
       convert_to_half_float_kernel;
   KernelFunctions<void (*)(KernelGlobals *, uchar4 *, float *, float, int, int, int, int)>
@@ -264,6 +297,7 @@ class CPUDevice : public Device {
         texture_info(this, "__texture_info", MEM_TEXTURE),
 #define REGISTER_KERNEL(name) name##_kernel(KERNEL_FUNCTIONS(name))
         REGISTER_KERNEL(path_trace),
+        REGISTER_KERNEL(path_trace_stream),
         REGISTER_KERNEL(convert_to_half_float),
         REGISTER_KERNEL(convert_to_byte),
         REGISTER_KERNEL(shader),
@@ -290,6 +324,8 @@ class CPUDevice : public Device {
 #ifdef WITH_OSL
     kernel_globals.osl = &osl_globals;
 #endif
+    kernel_globals.texture_cache = &texture_cache_globals;
+    kernel_globals.texture_cache_thread_info = NULL;
     use_split_kernel = DebugFlags().cpu.split_kernel;
     if (use_split_kernel) {
       VLOG(1) << "Will be using split kernel.";
@@ -506,6 +542,11 @@ class CPUDevice : public Device {
 #endif
   }
 
+  void *texture_cache_memory()
+  {
+    return &texture_cache_globals;
+  }
+
   void thread_run(DeviceTask *task)
   {
     if (task->type == DeviceTask::RENDER) {
@@ -819,9 +860,51 @@ class CPUDevice : public Device {
     return true;
   }
 
+  /* Returns true when all pixels of the tile have converged. */
+  bool adaptive_sampling_filter(KernelGlobals *kg, RenderTile &tile)
+  {
+    WorkTile wtile;
+    wtile.x = tile.x;
+    wtile.y = tile.y;
+    wtile.w = tile.w;
+    wtile.h = tile.h;
+    wtile.offset = tile.offset;
+    wtile.stride = tile.stride;
+    wtile.buffer = (float *)tile.buffer;
+
+    bool any = false;
+    for (int y = tile.y; y < tile.y + tile.h; y++) {
+      any |= kernel_do_adaptive_filter_x(kg, y, &wtile);
+    }
+    for (int x = tile.x; x < tile.x + tile.w; x++) {
+      any |= kernel_do_adaptive_filter_y(kg, x, &wtile);
+    }
+    return !any;
+  }
+
+  void adaptive_sampling_post(KernelGlobals *kg, RenderTile &tile)
+  {
+    float *render_buffer = (float *)tile.buffer;
+    const int num_samples = tile.sample - tile.start_sample;
+    for (int y = tile.y; y < tile.y + tile.h; y++) {
+      for (int x = tile.x; x < tile.x + tile.w; x++) {
+        int index = tile.offset + x + y * tile.stride;
+        float *buffer = render_buffer + index * kernel_data.film.pass_stride;
+        const float pixel_samples = buffer[kernel_data.film.pass_sample_count];
+        if (pixel_samples > 0.0f && pixel_samples < (float)num_samples) {
+          kernel_adaptive_post_adjust(kg, buffer, (float)num_samples / pixel_samples);
+        }
+      }
+    }
+  }
+
   void path_trace(DeviceTask &task, RenderTile &tile, KernelGlobals *kg)
   {
     const bool use_coverage = kernel_data.film.cryptomatte_passes & CRYPT_ACCURATE;
+    /* Coverage is accumulated outside of the render buffer and can not be scaled afterwards,
+     * so accurate cryptomatte renders all samples. */
+    const bool use_adaptive_sampling = kernel_data.film.pass_adaptive_aux_buffer &&
+                                       !use_coverage;
 
     scoped_timer timer(&tile.buffers->render_time);
 
@@ -843,30 +926,193 @@ class CPUDevice : public Device {
           break;
       }
 
-      for (int y = tile.y; y < tile.y + tile.h; y++) {
-        for (int x = tile.x; x < tile.x + tile.w; x++) {
-          if (use_coverage) {
+      if (use_coverage) {
+        /* Coverage is recorded per pixel, trace pixels one by one. */
+        for (int y = tile.y; y < tile.y + tile.h; y++) {
+          for (int x = tile.x; x < tile.x + tile.w; x++) {
             coverage.init_pixel(x, y);
+            path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
+          }
+        }
+      }
+      else {
+        /* Trace blocks of pixels together, so their camera rays can be intersected as a
+         * coherent stream. */
+        int2 pixels[PATH_STREAM_MAX_PIXELS];
+        for (int block_y = tile.y; block_y < tile.y + tile.h; block_y += PATH_STREAM_BLOCK_SIZE) {
+          const int y_end = min(block_y + PATH_STREAM_BLOCK_SIZE, tile.y + tile.h);
+          for (int block_x = tile.x; block_x < tile.x + tile.w;
+               block_x += PATH_STREAM_BLOCK_SIZE) {
+            const int x_end = min(block_x + PATH_STREAM_BLOCK_SIZE, tile.x + tile.w);
+            int num_pixels = 0;
+            for (int y = block_y; y < y_end; y++) {
+              for (int x = block_x; x < x_end; x++) {
+                if (use_adaptive_sampling) {
+                  int index = tile.offset + x + y * tile.stride;
+                  float *buffer = render_buffer + index * kernel_data.film.pass_stride;
+                  if (kernel_adaptive_pixel_is_converged(kg, buffer)) {
+                    tile.saved_samples++;
+                    continue;
+                  }
+                }
+                pixels[num_pixels++] = make_int2(x, y);
+              }
+            }
+            if (num_pixels > 0) {
+              path_trace_stream_kernel()(
+                  kg, render_buffer, sample, pixels, num_pixels, tile.offset, tile.stride);
+            }
           }
-          path_trace_kernel()(kg, render_buffer, sample, x, y, tile.offset, tile.stride);
         }
       }
 
       tile.sample = sample + 1;
 
+      if (use_adaptive_sampling && tile.sample % kernel_data.integrator.adaptive_step == 0 &&
+          tile.sample - start_sample >= kernel_data.integrator.adaptive_min_samples) {
+        for (int y = tile.y; y < tile.y + tile.h; y++) {
+          for (int x = tile.x; x < tile.x + tile.w; x++) {
+            int index = tile.offset + x + y * tile.stride;
+            kernel_do_adaptive_stopping(kg, render_buffer + index * kernel_data.film.pass_stride);
+          }
+        }
+        if (adaptive_sampling_filter(kg, tile)) {
+          /* All pixels of the tile converged, the remaining samples are skipped entirely and
+           * the tile is given back to the scheduler. */
+          const int num_pixels = tile.w * tile.h;
+          tile.saved_samples += (uint64_t)num_pixels * (end_sample - tile.sample);
+          tile.sample = end_sample;
+          task.update_progress(&tile, num_pixels * (end_sample - sample));
+          break;
+        }
+      }
+
       task.update_progress(&tile, tile.w * tile.h);
     }
+    if (use_adaptive_sampling) {
+      adaptive_sampling_post(kg, tile);
+    }
     if (use_coverage) {
       coverage.finalize();
     }
   }
 
-  void denoise(DenoisingTask &denoising, RenderTile &tile)
+  void denoise_oidn(DeviceTask &task, DenoisingTask &denoising, RenderTile &rtile)
+  {
+#ifdef WITH_OPENIMAGEDENOISE
+    ProfilingHelper profiling(denoising.profiler, PROFILING_DENOISING_OIDN);
+
+    /* Map neighboring tiles, indices are as following:
+     *   0 1 2
+     *   3 4 5
+     *   6 7 8  9
+     * Where index 4 is the center tile and index 9 is the target for the result. */
+    RenderTile rtiles[10];
+    rtiles[4] = rtile;
+    task.map_neighbor_tiles(rtiles, this);
+
+    /* Region to denoise, the tile and an overlap into its neighbors. */
+    int4 rect = make_int4(rtile.x, rtile.y, rtile.x + rtile.w, rtile.y + rtile.h);
+    rect = rect_expand(rect, OIDN_TILE_OVERLAP);
+    int4 clip_rect = make_int4(
+        rtiles[3].x, rtiles[1].y, rtiles[5].x + rtiles[5].w, rtiles[7].y + rtiles[7].h);
+    rect = rect_clip(rect, clip_rect);
+    const int2 rect_size = make_int2(rect.z - rect.x, rect.w - rect.y);
+    const size_t num_pixels = (size_t)rect_size.x * rect_size.y;
+
+    /* Render buffers store the sum of all samples, the denoiser expects the actual pixel
+     * values. */
+    const float num_samples = rtile.sample;
+    const float sample_scale = 1.0f / num_samples;
+
+    /* Gather color, albedo and normal of the region into contiguous images. */
+    vector<float> color(num_pixels * 3), albedo(num_pixels * 3), normal(num_pixels * 3);
+    vector<float> output(num_pixels * 3);
+
+    for (int i = 0; i < 9; i++) {
+      const RenderTile &ntile = rtiles[i];
+      if (!ntile.buffer) {
+        continue;
+      }
+
+      const int x0 = max(ntile.x, rect.x), x1 = min(ntile.x + ntile.w, rect.z);
+      const int y0 = max(ntile.y, rect.y), y1 = min(ntile.y + ntile.h, rect.w);
+      for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+          const float *in = (const float *)ntile.buffer +
+                            (size_t)(ntile.offset + x + y * ntile.stride) * task.pass_stride +
+                            task.pass_denoising_data;
+          const size_t index = 3 * ((size_t)(x - rect.x) + (size_t)(y - rect.y) * rect_size.x);
+          for (int c = 0; c < 3; c++) {
+            color[index + c] = ensure_finite(in[DENOISING_PASS_COLOR + c] * sample_scale);
+            albedo[index + c] = ensure_finite(in[DENOISING_PASS_ALBEDO + c] * sample_scale);
+            normal[index + c] = ensure_finite(in[DENOISING_PASS_NORMAL + c] * sample_scale);
+          }
+        }
+      }
+    }
+
+    bool denoised = true;
+    {
+      thread_scoped_lock lock(oidn_mutex);
+
+      if (!oidn_filter) {
+        oidn_device = oidn::newDevice();
+        oidn_device.commit();
+        oidn_filter = oidn_device.newFilter("RT");
+      }
+
+      oidn_filter.setImage("color", &color[0], oidn::Format::Float3, rect_size.x, rect_size.y);
+      oidn_filter.setImage("albedo", &albedo[0], oidn::Format::Float3, rect_size.x, rect_size.y);
+      oidn_filter.setImage("normal", &normal[0], oidn::Format::Float3, rect_size.x, rect_size.y);
+      oidn_filter.setImage("output", &output[0], oidn::Format::Float3, rect_size.x, rect_size.y);
+      oidn_filter.set("hdr", true);
+      oidn_filter.set("srgb", false);
+      oidn_filter.commit();
+      oidn_filter.execute();
+
+      const char *error_message;
+      if (oidn_device.getError(error_message) != oidn::Error::None) {
+        set_error(string_printf("OpenImageDenoise error: %s", error_message));
+        denoised = false;
+      }
+    }
+
+    /* Write the denoised tile into the combined pass, alpha is left untouched. On error the
+     * output is not valid, leave the noisy tile in place. */
+    if (denoised) {
+      const RenderTile &target = rtiles[9];
+      for (int y = rtile.y; y < rtile.y + rtile.h; y++) {
+        for (int x = rtile.x; x < rtile.x + rtile.w; x++) {
+          float *out = (float *)target.buffer +
+                       (size_t)(target.offset + x + y * target.stride) * task.pass_stride;
+          const size_t index = 3 * ((size_t)(x - rect.x) + (size_t)(y - rect.y) * rect_size.x);
+          for (int c = 0; c < 3; c++) {
+            out[c] = output[index + c] * num_samples;
+          }
+        }
+      }
+    }
+
+    task.unmap_neighbor_tiles(rtiles, this);
+#else
+    (void)task;
+    (void)denoising;
+    (void)rtile;
+#endif
+  }
+
+  void denoise(DeviceTask &task, DenoisingTask &denoising, RenderTile &tile)
   {
     ProfilingHelper profiling(denoising.profiler, PROFILING_DENOISING);
 
     tile.sample = tile.start_sample + tile.num_samples;
 
+    if (task.denoising_use_oidn && oidn_denoising_supported()) {
+      denoise_oidn(task, denoising, tile);
+      return;
+    }
+
     denoising.functions.construct_transform = function_bind(
         &CPUDevice::denoising_construct_transform, this, &denoising);
     denoising.functions.accumulate = function_bind(
@@ -934,7 +1180,7 @@ class CPUDevice : public Device {
         }
       }
       else if (tile.task == RenderTile::DENOISE) {
-        denoise(denoising, tile);
+        denoise(task, denoising, tile);
         task.update_progress(&tile, tile.w * tile.h);
       }
 
@@ -1055,10 +1301,14 @@ class CPUDevice : public Device {
       kg.decoupled_volume_steps[i] = NULL;
     }
     kg.decoupled_volume_steps_index = 0;
+    kg.shadow_stream = NULL;
     kg.coverage_asset = kg.coverage_object = kg.coverage_material = NULL;
 #ifdef WITH_OSL
     OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
+    if (texture_cache_globals.texture_system != NULL) {
+      kg.texture_cache_thread_info = texture_cache_globals.texture_system->create_thread_info();
+    }
     return kg;
   }
 
@@ -1081,6 +1331,10 @@ class CPUDevice : public Device {
 #ifdef WITH_OSL
     OSLShader::thread_free(kg);
 #endif
+    if (kg->texture_cache_thread_info != NULL) {
+      texture_cache_globals.texture_system->destroy_thread_info(kg->texture_cache_thread_info);
+      kg->texture_cache_thread_info = NULL;
+    }
   }
 
   virtual bool load_kernels(const DeviceRequestedFeatures &requested_features_)
@@ -1226,7 +1480,10 @@ void device_cpu_info(vector<DeviceInfo> &devices)
   info.has_volume_decoupled = true;
   info.has_osl = true;
   info.has_half_images = true;
+  info.has_compressed_images = true;
   info.has_profiling = true;
+  info.has_adaptive_sampling = true;
+  info.has_oidn_denoising = oidn_denoising_supported();
 
   devices.insert(devices.begin(), info);
 }
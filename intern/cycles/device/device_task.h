@@ -104,6 +104,7 @@ class DeviceTask : public Task {
 
   bool denoising_do_filter;
   bool denoising_use_optix;
+  bool denoising_use_oidn;
   bool denoising_write_passes;
 
   int pass_stride;
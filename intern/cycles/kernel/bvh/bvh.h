@@ -161,6 +161,27 @@ CCL_NAMESPACE_BEGIN
 #    endif
 #  endif /* __VOLUME_RECORD_ALL__ */
 
+/* Stream traversal of coherent rays, CPU only */
+
+#  if defined(__BVH_STREAM__)
+/* Stream traversal stack entry, holding the rays which still have to visit the node. */
+typedef struct BVHStreamStackItem {
+  int addr;
+  uint mask;
+  float dist;
+} BVHStreamStackItem;
+
+#    define BVH_FUNCTION_NAME bvh_intersect_stream
+#    define BVH_FUNCTION_FEATURES 0
+#    include "kernel/bvh/bvh_stream.h"
+
+#    if defined(__INSTANCING__)
+#      define BVH_FUNCTION_NAME bvh_intersect_stream_instancing
+#      define BVH_FUNCTION_FEATURES BVH_INSTANCING
+#      include "kernel/bvh/bvh_stream.h"
+#    endif
+#  endif /* __BVH_STREAM__ */
+
 #  undef BVH_FEATURE
 #  undef BVH_NAME_JOIN
 #  undef BVH_NAME_EVAL
@@ -281,6 +302,226 @@ ccl_device_intersect bool scene_intersect(KernelGlobals *kg,
 #endif     /* __KERNEL_OPTIX__ */
 }
 
+#ifdef __BVH_STREAM__
+/* Spread the lowest 8 bits of x to every second bit. */
+ccl_device_inline uint bvh_stream_morton_expand2(uint x)
+{
+  x = (x | (x << 4)) & 0x0F0F;
+  x = (x | (x << 2)) & 0x3333;
+  x = (x | (x << 1)) & 0x5555;
+  return x;
+}
+
+/* Spread the lowest 4 bits of x to every third bit. */
+ccl_device_inline uint bvh_stream_morton_expand3(uint x)
+{
+  x = (x | (x << 4)) & 0x0C3;
+  x = (x | (x << 2)) & 0x249;
+  return x;
+}
+
+/* Sort key of a ray, ordering rays by direction octant first, then by direction and then by
+ * origin, both as Morton codes. Rays with similar keys tend to visit the same BVH nodes. */
+ccl_device_inline uint bvh_stream_sort_key(const Ray *ray,
+                                           const float3 origin_min,
+                                           const float3 origin_scale)
+{
+  const float3 D = ray->D;
+  const uint octant = (D.x < 0.0f ? 1 : 0) | (D.y < 0.0f ? 2 : 0) | (D.z < 0.0f ? 4 : 0);
+
+  /* Direction within the octant, projected onto the octahedron. */
+  const float3 abs_D = fabs(D);
+  const float inv_l1 = 1.0f / (abs_D.x + abs_D.y + abs_D.z);
+  const uint dir_u = (uint)clamp((int)(abs_D.x * inv_l1 * 255.0f), 0, 255);
+  const uint dir_v = (uint)clamp((int)(abs_D.y * inv_l1 * 255.0f), 0, 255);
+  const uint dir_key = bvh_stream_morton_expand2(dir_u) | (bvh_stream_morton_expand2(dir_v) << 1);
+
+  /* Origin within the bounds of all origins, 4 bits per axis. */
+  const float3 o = (ray->P - origin_min) * origin_scale;
+  const uint o_x = (uint)clamp((int)o.x, 0, 15);
+  const uint o_y = (uint)clamp((int)o.y, 0, 15);
+  const uint o_z = (uint)clamp((int)o.z, 0, 15);
+  const uint origin_key = bvh_stream_morton_expand3(o_x) | (bvh_stream_morton_expand3(o_y) << 1) |
+                          (bvh_stream_morton_expand3(o_z) << 2);
+
+  return (octant << 28) | (dir_key << 12) | origin_key;
+}
+
+/* Intersect a batch of rays with the scene, like calling scene_intersect() for every ray. The
+ * rays are sorted by direction and origin and traversed together in streams, which is faster
+ * for coherent rays such as the camera rays of neighboring pixels.
+ *
+ * Rays which miss the scene have their primitive set to PRIM_NONE. */
+ccl_device void scene_intersect_stream(KernelGlobals *kg,
+                                       const Ray *rays,
+                                       const uint visibility,
+                                       Intersection *isects,
+                                       const int num_rays)
+{
+  kernel_assert(num_rays <= BVH_STREAM_MAX_RAYS);
+
+  int ray_index[BVH_STREAM_MAX_RAYS];
+  int num_valid_rays = 0;
+  float3 origin_min = make_float3(FLT_MAX, FLT_MAX, FLT_MAX);
+  float3 origin_max = make_float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+  for (int i = 0; i < num_rays; i++) {
+    if (!scene_intersect_valid(&rays[i])) {
+      isects[i].t = rays[i].t;
+      isects[i].prim = PRIM_NONE;
+      isects[i].object = OBJECT_NONE;
+      continue;
+    }
+    ray_index[num_valid_rays++] = i;
+    origin_min = min(origin_min, rays[i].P);
+    origin_max = max(origin_max, rays[i].P);
+  }
+
+  if (num_valid_rays == 0) {
+    return;
+  }
+
+#  ifdef __EMBREE__
+  if (kernel_data.bvh.scene) {
+    PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+    CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+    IntersectContext rtc_ctx(&ctx);
+    rtc_ctx.context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+    RTCRayHit ray_hits[BVH_STREAM_MAX_RAYS];
+    for (int i = 0; i < num_valid_rays; i++) {
+      kernel_embree_setup_rayhit(rays[ray_index[i]], ray_hits[i], visibility);
+    }
+    rtcIntersect1M(kernel_data.bvh.scene,
+                   &rtc_ctx.context,
+                   ray_hits,
+                   num_valid_rays,
+                   sizeof(RTCRayHit));
+
+    for (int i = 0; i < num_valid_rays; i++) {
+      Intersection *isect = &isects[ray_index[i]];
+      isect->t = rays[ray_index[i]].t;
+      isect->prim = PRIM_NONE;
+      isect->object = OBJECT_NONE;
+      if (ray_hits[i].hit.geomID != RTC_INVALID_GEOMETRY_ID &&
+          ray_hits[i].hit.primID != RTC_INVALID_GEOMETRY_ID) {
+        kernel_embree_convert_hit(kg, &ray_hits[i].ray, &ray_hits[i].hit, isect);
+      }
+    }
+    return;
+  }
+#  endif /* __EMBREE__ */
+
+  /* Stream traversal supports triangles on wide BVHs only, trace other scenes ray by ray. */
+  bool use_stream = (kernel_data.bvh.bvh_layout != BVH_LAYOUT_BVH2);
+#  ifdef __OBJECT_MOTION__
+  use_stream &= !kernel_data.bvh.have_motion;
+#  endif
+#  ifdef __HAIR__
+  use_stream &= !kernel_data.bvh.have_curves;
+#  endif
+
+  if (!use_stream) {
+    for (int i = 0; i < num_valid_rays; i++) {
+      Intersection *isect = &isects[ray_index[i]];
+      if (!scene_intersect(kg, &rays[ray_index[i]], visibility, isect)) {
+        isect->prim = PRIM_NONE;
+        isect->object = OBJECT_NONE;
+      }
+    }
+    return;
+  }
+
+  PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+  /* Sort rays, the count is small so insertion sort is fast enough. */
+  const float3 origin_extent = origin_max - origin_min;
+  const float3 origin_scale = make_float3(
+      (origin_extent.x > 0.0f) ? 16.0f / origin_extent.x : 0.0f,
+      (origin_extent.y > 0.0f) ? 16.0f / origin_extent.y : 0.0f,
+      (origin_extent.z > 0.0f) ? 16.0f / origin_extent.z : 0.0f);
+
+  uint sort_key[BVH_STREAM_MAX_RAYS];
+  for (int i = 0; i < num_valid_rays; i++) {
+    const int index = ray_index[i];
+    const uint key = bvh_stream_sort_key(&rays[index], origin_min, origin_scale);
+    int j = i;
+    for (; j > 0 && sort_key[j - 1] > key; j--) {
+      sort_key[j] = sort_key[j - 1];
+      ray_index[j] = ray_index[j - 1];
+    }
+    sort_key[j] = key;
+    ray_index[j] = index;
+  }
+
+  /* Traverse sorted rays in streams. */
+  for (int begin = 0; begin < num_valid_rays; begin += BVH_STREAM_SIZE) {
+    const int num_stream_rays = min(num_valid_rays - begin, BVH_STREAM_SIZE);
+#  ifdef __INSTANCING__
+    if (kernel_data.bvh.have_instancing) {
+      bvh_intersect_stream_instancing(
+          kg, rays, isects, ray_index + begin, num_stream_rays, visibility);
+      continue;
+    }
+#  endif /* __INSTANCING__ */
+    bvh_intersect_stream(kg, rays, isects, ray_index + begin, num_stream_rays, visibility);
+  }
+}
+
+/* Test a batch of shadow rays for occlusion by opaque geometry, like the opaque shadow test of
+ * shadow_blocked() for every ray. Traversal of a ray ends at its first hit. */
+ccl_device void scene_intersect_shadow_stream(KernelGlobals *kg,
+                                              const Ray *rays,
+                                              const uint visibility,
+                                              bool *blocked,
+                                              const int num_rays)
+{
+  kernel_assert(num_rays <= BVH_STREAM_MAX_RAYS);
+  kernel_assert((visibility & ~PATH_RAY_SHADOW_OPAQUE) == 0);
+
+#  ifdef __EMBREE__
+  if (kernel_data.bvh.scene) {
+    PROFILING_INIT(kg, PROFILING_INTERSECT);
+
+    CCLIntersectContext ctx(kg, CCLIntersectContext::RAY_REGULAR);
+    IntersectContext rtc_ctx(&ctx);
+    rtc_ctx.context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+    int ray_index[BVH_STREAM_MAX_RAYS];
+    RTCRay rtc_rays[BVH_STREAM_MAX_RAYS];
+    int num_valid_rays = 0;
+    for (int i = 0; i < num_rays; i++) {
+      blocked[i] = false;
+      if (scene_intersect_valid(&rays[i])) {
+        kernel_embree_setup_ray(rays[i], rtc_rays[num_valid_rays], visibility);
+        ray_index[num_valid_rays++] = i;
+      }
+    }
+    if (num_valid_rays == 0) {
+      return;
+    }
+
+    rtcOccluded1M(
+        kernel_data.bvh.scene, &rtc_ctx.context, rtc_rays, num_valid_rays, sizeof(RTCRay));
+
+    /* Embree sets the far distance of occluded rays to negative infinity. */
+    for (int i = 0; i < num_valid_rays; i++) {
+      blocked[ray_index[i]] = (rtc_rays[i].tfar < 0.0f);
+    }
+    return;
+  }
+#  endif /* __EMBREE__ */
+
+  /* The stream traversal ends rays at their first hit for opaque shadow visibility. */
+  Intersection isects[BVH_STREAM_MAX_RAYS];
+  scene_intersect_stream(kg, rays, visibility, isects, num_rays);
+  for (int i = 0; i < num_rays; i++) {
+    blocked[i] = (isects[i].prim != PRIM_NONE);
+  }
+}
+#endif /* __BVH_STREAM__ */
+
 #ifdef __BVH_LOCAL__
 ccl_device_intersect bool scene_intersect_local(KernelGlobals *kg,
                                                 const Ray *ray,
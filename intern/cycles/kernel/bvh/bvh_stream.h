@@ -0,0 +1,55 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Stream traversal of up to BVH_STREAM_SIZE rays at once. Rays visiting the same node are
+ * intersected with it together, so node data is fetched once for the whole stream. This only
+ * pays off for coherent rays, which callers are expected to sort by direction beforehand.
+ *
+ * Only wide BVH layouts are supported. */
+
+#ifdef __QBVH__
+#  include "kernel/bvh/qbvh_stream.h"
+#endif
+#ifdef __KERNEL_AVX2__
+#  include "kernel/bvh/obvh_stream.h"
+#endif
+
+ccl_device_inline void BVH_FUNCTION_NAME(KernelGlobals *kg,
+                                         const Ray *rays,
+                                         Intersection *isects,
+                                         const int *ray_index,
+                                         const int num_rays,
+                                         const uint visibility)
+{
+  kernel_assert(num_rays <= BVH_STREAM_SIZE);
+
+  switch (kernel_data.bvh.bvh_layout) {
+#ifdef __KERNEL_AVX2__
+    case BVH_LAYOUT_BVH8:
+      BVH_FUNCTION_FULL_NAME(OBVH)(kg, rays, isects, ray_index, num_rays, visibility);
+      return;
+#endif
+#ifdef __QBVH__
+    case BVH_LAYOUT_BVH4:
+      BVH_FUNCTION_FULL_NAME(QBVH)(kg, rays, isects, ray_index, num_rays, visibility);
+      return;
+#endif /* __QBVH__ */
+  }
+  kernel_assert(!"Should not happen");
+}
+
+#undef BVH_FUNCTION_NAME
+#undef BVH_FUNCTION_FEATURES
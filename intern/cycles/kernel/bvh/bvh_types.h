@@ -33,6 +33,11 @@ CCL_NAMESPACE_BEGIN
 #define BVH_STACK_SIZE 192
 #define BVH_QSTACK_SIZE 384
 #define BVH_OSTACK_SIZE 768
+
+/* Number of rays traversed together in a stream, one bit per ray in the traversal masks. */
+#define BVH_STREAM_SIZE 32
+/* Maximum number of rays sorted into streams by a single scene_intersect_stream() call. */
+#define BVH_STREAM_MAX_RAYS 64
 /* BVH intersection function variations */
 
 #define BVH_INSTANCING 1
@@ -72,6 +77,34 @@ CCL_NAMESPACE_BEGIN
 #  define BVH_DEBUG_NEXT_INSTANCE()
 #endif /* __KERNEL_DEBUG__ */
 
+#ifdef __BVH_STREAM__
+#  ifdef __KERNEL_DEBUG__
+#    define BVH_STREAM_DEBUG_INIT(isect) \
+      do { \
+        (isect)->num_traversed_nodes = 0; \
+        (isect)->num_traversed_instances = 0; \
+        (isect)->num_intersections = 0; \
+      } while (0)
+#    define BVH_STREAM_DEBUG_NEXT_NODE(isect) \
+      do { \
+        ++(isect)->num_traversed_nodes; \
+      } while (0)
+#    define BVH_STREAM_DEBUG_NEXT_INTERSECTION(isect) \
+      do { \
+        ++(isect)->num_intersections; \
+      } while (0)
+#    define BVH_STREAM_DEBUG_NEXT_INSTANCE(isect) \
+      do { \
+        ++(isect)->num_traversed_instances; \
+      } while (0)
+#  else /* __KERNEL_DEBUG__ */
+#    define BVH_STREAM_DEBUG_INIT(isect)
+#    define BVH_STREAM_DEBUG_NEXT_NODE(isect)
+#    define BVH_STREAM_DEBUG_NEXT_INTERSECTION(isect)
+#    define BVH_STREAM_DEBUG_NEXT_INSTANCE(isect)
+#  endif /* __KERNEL_DEBUG__ */
+#endif   /* __BVH_STREAM__ */
+
 CCL_NAMESPACE_END
 
 #endif /* __BVH_TYPES__ */
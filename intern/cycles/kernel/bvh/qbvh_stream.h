@@ -0,0 +1,311 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* This is a template BVH traversal function for ray streams, where various
+ * features can be enabled/disabled. This way we can compile optimized versions
+ * for each case without new features slowing things down.
+ *
+ * BVH_INSTANCING: object instancing
+ */
+
+ccl_device void BVH_FUNCTION_FULL_NAME(QBVH)(KernelGlobals *kg,
+                                             const Ray *rays,
+                                             Intersection *isects,
+                                             const int *ray_index,
+                                             const int num_rays,
+                                             const uint visibility)
+{
+  /* Traversal stack, every entry holds the rays which still have to visit the node. */
+  BVHStreamStackItem traversal_stack[BVH_QSTACK_SIZE];
+  traversal_stack[0].addr = ENTRYPOINT_SENTINEL;
+  traversal_stack[0].mask = 0;
+  traversal_stack[0].dist = -FLT_MAX;
+
+  int stack_ptr = 0;
+  int node_addr = kernel_data.bvh.root;
+  uint node_mask = 0;
+
+  /* Ray parameters of every lane of the stream. */
+  float3 P[BVH_STREAM_SIZE];
+  float3 dir[BVH_STREAM_SIZE];
+  float3 idir[BVH_STREAM_SIZE];
+#ifdef __KERNEL_AVX2__
+  sse3f P_idir4[BVH_STREAM_SIZE];
+#else
+  sse3f org4[BVH_STREAM_SIZE];
+#endif
+  sse3f idir4[BVH_STREAM_SIZE];
+  int near_far[BVH_STREAM_SIZE][6];
+  int object = OBJECT_NONE;
+
+  for (int lane = 0; lane < num_rays; lane++) {
+    const Ray *ray = &rays[ray_index[lane]];
+    Intersection *isect = &isects[ray_index[lane]];
+    isect->t = ray->t;
+    isect->u = 0.0f;
+    isect->v = 0.0f;
+    isect->prim = PRIM_NONE;
+    isect->object = OBJECT_NONE;
+    BVH_STREAM_DEBUG_INIT(isect);
+
+    P[lane] = ray->P;
+    dir[lane] = bvh_clamp_direction(ray->D);
+    idir[lane] = bvh_inverse_direction(dir[lane]);
+    node_mask |= (1u << lane);
+  }
+
+  /* Rays which found an opaque shadow hit and need no further traversal. */
+  uint terminated_mask = 0;
+
+#if BVH_FEATURE(BVH_INSTANCING)
+  /* Rays which are transformed into the space of the current instance. */
+  uint instance_mask = 0;
+#endif
+
+  /* Set up the per lane node intersection parameters. */
+#ifdef __KERNEL_AVX2__
+#  define QBVH_STREAM_LANE_SETUP(lane) \
+    { \
+      const float3 P_idir = P[lane] * idir[lane]; \
+      P_idir4[lane] = sse3f(P_idir.x, P_idir.y, P_idir.z); \
+      idir4[lane] = sse3f(ssef(idir[lane].x), ssef(idir[lane].y), ssef(idir[lane].z)); \
+      qbvh_near_far_idx_calc(idir[lane], \
+                             &near_far[lane][0], \
+                             &near_far[lane][1], \
+                             &near_far[lane][2], \
+                             &near_far[lane][3], \
+                             &near_far[lane][4], \
+                             &near_far[lane][5]); \
+    } \
+    (void)0
+#else
+#  define QBVH_STREAM_LANE_SETUP(lane) \
+    { \
+      org4[lane] = sse3f(ssef(P[lane].x), ssef(P[lane].y), ssef(P[lane].z)); \
+      idir4[lane] = sse3f(ssef(idir[lane].x), ssef(idir[lane].y), ssef(idir[lane].z)); \
+      qbvh_near_far_idx_calc(idir[lane], \
+                             &near_far[lane][0], \
+                             &near_far[lane][1], \
+                             &near_far[lane][2], \
+                             &near_far[lane][3], \
+                             &near_far[lane][4], \
+                             &near_far[lane][5]); \
+    } \
+    (void)0
+#endif
+
+  for (int lane = 0; lane < num_rays; lane++) {
+    QBVH_STREAM_LANE_SETUP(lane);
+  }
+
+  /* Traversal loop. */
+  do {
+    do {
+      node_mask &= ~terminated_mask;
+      if (node_mask == 0) {
+        /* Pop. */
+        node_addr = traversal_stack[stack_ptr].addr;
+        node_mask = traversal_stack[stack_ptr].mask;
+        --stack_ptr;
+        continue;
+      }
+
+      /* Traverse internal nodes. */
+      if (node_addr >= 0) {
+        float4 inodes = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+        (void)inodes;
+
+#ifdef __VISIBILITY_FLAG__
+        if ((__float_as_uint(inodes.x) & visibility) == 0) {
+          /* Pop. */
+          node_addr = traversal_stack[stack_ptr].addr;
+          node_mask = traversal_stack[stack_ptr].mask;
+          --stack_ptr;
+          continue;
+        }
+#endif
+
+        /* Intersect every ray with the children, gathering which rays hit each child. */
+        uint child_rays[4] = {0, 0, 0, 0};
+        float child_dist[4] = {FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX};
+
+        uint lanes = node_mask;
+        while (lanes) {
+          const int lane = __bscf(lanes);
+          Intersection *isect = &isects[ray_index[lane]];
+          const int *nf = near_far[lane];
+          ssef dist;
+          int child_mask = qbvh_aligned_node_intersect(kg,
+                                                       ssef(0.0f),
+                                                       ssef(isect->t),
+#ifdef __KERNEL_AVX2__
+                                                       P_idir4[lane],
+#else
+                                                       org4[lane],
+#endif
+                                                       idir4[lane],
+                                                       nf[0],
+                                                       nf[1],
+                                                       nf[2],
+                                                       nf[3],
+                                                       nf[4],
+                                                       nf[5],
+                                                       node_addr,
+                                                       &dist);
+          BVH_STREAM_DEBUG_NEXT_NODE(isect);
+
+          while (child_mask) {
+            const int child = __bscf(child_mask);
+            child_rays[child] |= (1u << lane);
+            child_dist[child] = min(child_dist[child], dist[child]);
+          }
+        }
+
+        /* Push hit children with the farthest first, continue with the closest. */
+        const float4 cnodes = kernel_tex_fetch(__bvh_nodes, node_addr + 7);
+        BVHStreamStackItem children[4];
+        int num_children = 0;
+        for (int child = 0; child < 4; child++) {
+          if (child_rays[child] == 0) {
+            continue;
+          }
+          BVHStreamStackItem item;
+          item.addr = __float_as_int(cnodes[child]);
+          item.mask = child_rays[child];
+          item.dist = child_dist[child];
+          int i = num_children++;
+          for (; i > 0 && children[i - 1].dist < item.dist; i--) {
+            children[i] = children[i - 1];
+          }
+          children[i] = item;
+        }
+
+        if (num_children == 0) {
+          /* Pop. */
+          node_addr = traversal_stack[stack_ptr].addr;
+          node_mask = traversal_stack[stack_ptr].mask;
+          --stack_ptr;
+          continue;
+        }
+
+        for (int i = 0; i < num_children - 1; i++) {
+          ++stack_ptr;
+          kernel_assert(stack_ptr < BVH_QSTACK_SIZE);
+          traversal_stack[stack_ptr] = children[i];
+        }
+        node_addr = children[num_children - 1].addr;
+        node_mask = children[num_children - 1].mask;
+        continue;
+      }
+
+      /* If node is leaf, fetch triangle list. */
+      float4 leaf = kernel_tex_fetch(__bvh_leaf_nodes, (-node_addr - 1));
+
+#ifdef __VISIBILITY_FLAG__
+      if ((__float_as_uint(leaf.z) & visibility) == 0) {
+        /* Pop. */
+        node_addr = traversal_stack[stack_ptr].addr;
+        node_mask = traversal_stack[stack_ptr].mask;
+        --stack_ptr;
+        continue;
+      }
+#endif
+
+      int prim_addr = __float_as_int(leaf.x);
+
+#if BVH_FEATURE(BVH_INSTANCING)
+      if (prim_addr >= 0) {
+#endif
+        const int prim_addr2 = __float_as_int(leaf.y);
+        const uint type = __float_as_int(leaf.w);
+        const uint leaf_mask = node_mask;
+
+        /* Pop. */
+        node_addr = traversal_stack[stack_ptr].addr;
+        node_mask = traversal_stack[stack_ptr].mask;
+        --stack_ptr;
+
+        /* Primitive intersection, triangles are the only primitives in streamed scenes. */
+        kernel_assert((type & PRIMITIVE_ALL) == PRIMITIVE_TRIANGLE);
+        (void)type;
+        for (; prim_addr < prim_addr2; prim_addr++) {
+          uint lanes = leaf_mask & ~terminated_mask;
+          while (lanes) {
+            const int lane = __bscf(lanes);
+            Intersection *isect = &isects[ray_index[lane]];
+            BVH_STREAM_DEBUG_NEXT_INTERSECTION(isect);
+            if (triangle_intersect(kg, isect, P[lane], dir[lane], visibility, object, prim_addr)) {
+              /* Shadow ray early termination. */
+              if (visibility & PATH_RAY_SHADOW_OPAQUE) {
+                terminated_mask |= (1u << lane);
+              }
+            }
+          }
+        }
+#if BVH_FEATURE(BVH_INSTANCING)
+      }
+      else {
+        /* Instance push. */
+        object = kernel_tex_fetch(__prim_object, -prim_addr - 1);
+        instance_mask = node_mask;
+
+        uint lanes = instance_mask;
+        while (lanes) {
+          const int lane = __bscf(lanes);
+          const Ray *ray = &rays[ray_index[lane]];
+          Intersection *isect = &isects[ray_index[lane]];
+          float t1 = -FLT_MAX;
+          qbvh_instance_push(kg, object, ray, &P[lane], &dir[lane], &idir[lane], &isect->t, &t1);
+          QBVH_STREAM_LANE_SETUP(lane);
+          BVH_STREAM_DEBUG_NEXT_INSTANCE(isect);
+        }
+
+        ++stack_ptr;
+        kernel_assert(stack_ptr < BVH_QSTACK_SIZE);
+        traversal_stack[stack_ptr].addr = ENTRYPOINT_SENTINEL;
+        traversal_stack[stack_ptr].mask = 0;
+        traversal_stack[stack_ptr].dist = -FLT_MAX;
+
+        node_addr = kernel_tex_fetch(__object_node, object);
+      }
+#endif /* FEATURE(BVH_INSTANCING) */
+    } while (node_addr != ENTRYPOINT_SENTINEL);
+
+#if BVH_FEATURE(BVH_INSTANCING)
+    if (stack_ptr >= 0) {
+      kernel_assert(object != OBJECT_NONE);
+
+      /* Instance pop. */
+      uint lanes = instance_mask;
+      while (lanes) {
+        const int lane = __bscf(lanes);
+        const Ray *ray = &rays[ray_index[lane]];
+        Intersection *isect = &isects[ray_index[lane]];
+        isect->t = bvh_instance_pop(kg, object, ray, &P[lane], &dir[lane], &idir[lane], isect->t);
+        QBVH_STREAM_LANE_SETUP(lane);
+      }
+
+      object = OBJECT_NONE;
+      instance_mask = 0;
+      node_addr = traversal_stack[stack_ptr].addr;
+      node_mask = traversal_stack[stack_ptr].mask;
+      --stack_ptr;
+    }
+#endif /* FEATURE(BVH_INSTANCING) */
+  } while (node_addr != ENTRYPOINT_SENTINEL);
+
+#undef QBVH_STREAM_LANE_SETUP
+}
@@ -31,7 +31,7 @@ ccl_device_inline void subd_triangle_patch_uv(KernelGlobals *kg,
                                               const ShaderData *sd,
                                               float2 uv[3])
 {
-  uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
+  uint4 tri_vindex = triangle_vertex_indices(kg, sd->prim);
 
   uv[0] = kernel_tex_fetch(__tri_patch_uv, tri_vindex.x);
   uv[1] = kernel_tex_fetch(__tri_patch_uv, tri_vindex.y);
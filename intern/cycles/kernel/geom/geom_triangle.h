@@ -22,21 +22,115 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Compact triangle storage
+ *
+ * With compact geometry vertex positions are quantized to 16 bits per axis on a grid over the
+ * bounds of their mesh, and vertex normals are octahedral encoded in 32 bits. Triangles have no
+ * copy of their vertices for intersection, the vertices are fetched through the vertex indices
+ * instead, and the last component of the vertex indices points to the quantization grid. The
+ * grid spacing is a power of two, so decoding is exact and matches the positions the BVH was
+ * built from. */
+
+ccl_device_inline float3 triangle_compact_vertex(KernelGlobals *kg, uint vert, float4 grid)
+{
+  const ushort4 q = kernel_tex_fetch(__tri_verts_compact, vert);
+  return make_float3(
+      grid.x + (float)q.x * grid.w, grid.y + (float)q.y * grid.w, grid.z + (float)q.z * grid.w);
+}
+
+/* Vertex indices of a triangle. The last component is the offset in the primitive triangle array,
+ * or the quantization grid of the mesh with compact geometry.
+ *
+ * Compact indices store the first index and the offsets of the other two from it in 16 bits
+ * each, the grid is then stored with the first vertex. */
+ccl_device_inline uint4 triangle_vertex_indices(KernelGlobals *kg, int prim)
+{
+  if (kernel_data.bvh.use_compact_indices) {
+    const uint2 packed = kernel_tex_fetch(__tri_vindex_compact, prim);
+    const uint v0 = packed.x;
+    const uint v1 = v0 + (uint)(int)(short)(packed.y & 0xFFFF);
+    const uint v2 = v0 + (uint)(int)(short)(packed.y >> 16);
+    return make_uint4(v0, v1, v2, kernel_tex_fetch(__tri_verts_compact, v0).w);
+  }
+  return kernel_tex_fetch(__tri_vindex, prim);
+}
+
+ccl_device_inline void triangle_compact_vertices(KernelGlobals *kg, int prim, float3 P[3])
+{
+  const uint4 tri_vindex = triangle_vertex_indices(kg, prim);
+  const float4 grid = kernel_tex_fetch(__tri_verts_compact_bounds, tri_vindex.w);
+  P[0] = triangle_compact_vertex(kg, tri_vindex.x, grid);
+  P[1] = triangle_compact_vertex(kg, tri_vindex.y, grid);
+  P[2] = triangle_compact_vertex(kg, tri_vindex.z, grid);
+}
+
+ccl_device_inline float3 triangle_compact_normal(KernelGlobals *kg, uint vert)
+{
+  const uint n = kernel_tex_fetch(__tri_vnormal_compact, vert);
+  const float x = (float)(n & 0xFFFF) * (2.0f / 65535.0f) - 1.0f;
+  const float y = (float)(n >> 16) * (2.0f / 65535.0f) - 1.0f;
+  const float z = 1.0f - fabsf(x) - fabsf(y);
+  if (z < 0.0f) {
+    /* Lower hemisphere is folded over the diagonals of the octahedron. */
+    return normalize(make_float3((1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f),
+                                 (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f),
+                                 z));
+  }
+  return normalize(make_float3(x, y, z));
+}
+
+/* Vertex locations of the triangle at a primitive address of the BVH. */
+ccl_device_inline void triangle_intersect_vertices(KernelGlobals *kg, int prim_addr, float3 P[3])
+{
+  if (kernel_data.bvh.use_compact_geometry) {
+    triangle_compact_vertices(kg, kernel_tex_fetch(__prim_index, prim_addr), P);
+    return;
+  }
+
+  const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
+  P[0] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0));
+  P[1] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1));
+  P[2] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2));
+}
+
+/* Triangle vertex locations */
+
+ccl_device_inline void triangle_vertices(KernelGlobals *kg, int prim, float3 P[3])
+{
+  if (kernel_data.bvh.use_compact_geometry) {
+    triangle_compact_vertices(kg, prim, P);
+    return;
+  }
+
+  const uint4 tri_vindex = triangle_vertex_indices(kg, prim);
+  P[0] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 0));
+  P[1] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 1));
+  P[2] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
+}
+
+/* Triangle vertex normal */
+
+ccl_device_inline float3 triangle_vertex_normal(KernelGlobals *kg, uint vert)
+{
+  if (kernel_data.bvh.use_compact_geometry) {
+    return triangle_compact_normal(kg, vert);
+  }
+  return float4_to_float3(kernel_tex_fetch(__tri_vnormal, vert));
+}
+
 /* normal on triangle  */
 ccl_device_inline float3 triangle_normal(KernelGlobals *kg, ShaderData *sd)
 {
   /* load triangle vertices */
-  const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
-  const float3 v0 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 0));
-  const float3 v1 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 1));
-  const float3 v2 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
+  float3 verts[3];
+  triangle_vertices(kg, sd->prim, verts);
 
   /* return normal */
   if (sd->object_flag & SD_OBJECT_NEGATIVE_SCALE_APPLIED) {
-    return normalize(cross(v2 - v0, v1 - v0));
+    return normalize(cross(verts[2] - verts[0], verts[1] - verts[0]));
   }
   else {
-    return normalize(cross(v1 - v0, v2 - v0));
+    return normalize(cross(verts[1] - verts[0], verts[2] - verts[0]));
   }
 }
 
@@ -45,10 +139,9 @@ ccl_device_inline void triangle_point_normal(
     KernelGlobals *kg, int object, int prim, float u, float v, float3 *P, float3 *Ng, int *shader)
 {
   /* load triangle vertices */
-  const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 v0 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 0));
-  float3 v1 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 1));
-  float3 v2 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
+  float3 verts[3];
+  triangle_vertices(kg, prim, verts);
+  const float3 v0 = verts[0], v1 = verts[1], v2 = verts[2];
   /* compute point */
   float t = 1.0f - u - v;
   *P = (u * v0 + v * v1 + t * v2);
@@ -65,26 +158,16 @@ ccl_device_inline void triangle_point_normal(
   *shader = kernel_tex_fetch(__tri_shader, prim);
 }
 
-/* Triangle vertex locations */
-
-ccl_device_inline void triangle_vertices(KernelGlobals *kg, int prim, float3 P[3])
-{
-  const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  P[0] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 0));
-  P[1] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 1));
-  P[2] = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
-}
-
 /* Interpolate smooth vertex normal from vertices */
 
 ccl_device_inline float3
 triangle_smooth_normal(KernelGlobals *kg, float3 Ng, int prim, float u, float v)
 {
   /* load triangle vertices */
-  const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  float3 n0 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.x));
-  float3 n1 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.y));
-  float3 n2 = float4_to_float3(kernel_tex_fetch(__tri_vnormal, tri_vindex.z));
+  const uint4 tri_vindex = triangle_vertex_indices(kg, prim);
+  float3 n0 = triangle_vertex_normal(kg, tri_vindex.x);
+  float3 n1 = triangle_vertex_normal(kg, tri_vindex.y);
+  float3 n2 = triangle_vertex_normal(kg, tri_vindex.z);
 
   float3 N = safe_normalize((1.0f - u - v) * n2 + u * n0 + v * n1);
 
@@ -99,14 +182,12 @@ ccl_device_inline void triangle_dPdudv(KernelGlobals *kg,
                                        ccl_addr_space float3 *dPdv)
 {
   /* fetch triangle vertex coordinates */
-  const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, prim);
-  const float3 p0 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 0));
-  const float3 p1 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 1));
-  const float3 p2 = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex.w + 2));
+  float3 verts[3];
+  triangle_vertices(kg, prim, verts);
 
   /* compute derivatives of P w.r.t. uv */
-  *dPdu = (p0 - p2);
-  *dPdv = (p1 - p2);
+  *dPdu = (verts[0] - verts[2]);
+  *dPdv = (verts[1] - verts[2]);
 }
 
 /* Reading attributes on various triangle elements */
@@ -123,7 +204,7 @@ ccl_device float triangle_attribute_float(
     return kernel_tex_fetch(__attributes_float, desc.offset + sd->prim);
   }
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
-    uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
+    uint4 tri_vindex = triangle_vertex_indices(kg, sd->prim);
 
     float f0 = kernel_tex_fetch(__attributes_float, desc.offset + tri_vindex.x);
     float f1 = kernel_tex_fetch(__attributes_float, desc.offset + tri_vindex.y);
@@ -178,7 +259,7 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
     return kernel_tex_fetch(__attributes_float2, desc.offset + sd->prim);
   }
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
-    uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
+    uint4 tri_vindex = triangle_vertex_indices(kg, sd->prim);
 
     float2 f0 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.x);
     float2 f1 = kernel_tex_fetch(__attributes_float2, desc.offset + tri_vindex.y);
@@ -237,7 +318,7 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
     return float4_to_float3(kernel_tex_fetch(__attributes_float3, desc.offset + sd->prim));
   }
   else if (desc.element == ATTR_ELEMENT_VERTEX || desc.element == ATTR_ELEMENT_VERTEX_MOTION) {
-    uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
+    uint4 tri_vindex = triangle_vertex_indices(kg, sd->prim);
 
     float3 f0 = float4_to_float3(
         kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.x));
@@ -30,13 +30,24 @@ ccl_device_inline bool triangle_intersect(KernelGlobals *kg,
                                           int object,
                                           int prim_addr)
 {
-  const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
 #if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
-  const ssef *ssef_verts = (ssef *)&kg->__prim_tri_verts.data[tri_vindex];
+  const ssef *ssef_verts;
+  ssef compact_verts[3];
+  if (kernel_data.bvh.use_compact_geometry) {
+    float3 verts[3];
+    triangle_compact_vertices(kg, kernel_tex_fetch(__prim_index, prim_addr), verts);
+    compact_verts[0] = ssef(verts[0]);
+    compact_verts[1] = ssef(verts[1]);
+    compact_verts[2] = ssef(verts[2]);
+    ssef_verts = compact_verts;
+  }
+  else {
+    const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
+    ssef_verts = (ssef *)&kg->__prim_tri_verts.data[tri_vindex];
+  }
 #else
-  const float4 tri_a = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0),
-               tri_b = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1),
-               tri_c = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2);
+  float3 verts[3];
+  triangle_intersect_vertices(kg, prim_addr, verts);
 #endif
   float t, u, v;
   if (ray_triangle_intersect(P,
@@ -45,9 +56,9 @@ ccl_device_inline bool triangle_intersect(KernelGlobals *kg,
 #if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
                              ssef_verts,
 #else
-                             float4_to_float3(tri_a),
-                             float4_to_float3(tri_b),
-                             float4_to_float3(tri_c),
+                             verts[0],
+                             verts[1],
+                             verts[2],
 #endif
                              &u,
                              &v,
@@ -378,11 +389,22 @@ ccl_device_inline int triangle_intersect8(KernelGlobals *kg,
 
   int i, r;
 
-  uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
-  for (i = 0; i < prim_num; i++) {
-    tri_a[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
-    tri_b[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
-    tri_c[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
+  if (kernel_data.bvh.use_compact_geometry) {
+    for (i = 0; i < prim_num; i++) {
+      float3 verts[3];
+      triangle_compact_vertices(kg, kernel_tex_fetch(__prim_index, prim_addr + i), verts);
+      tri_a[i] = verts[0].m128;
+      tri_b[i] = verts[1].m128;
+      tri_c[i] = verts[2].m128;
+    }
+  }
+  else {
+    uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
+    for (i = 0; i < prim_num; i++) {
+      tri_a[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
+      tri_b[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
+      tri_c[i] = *(__m128 *)&kg->__prim_tri_verts.data[tri_vindex++];
+    }
   }
   // create 9 or  12 placeholders
   tri[0] = _mm256_castps128_ps256(tri_a[0]);  //_mm256_zextps128_ps256
@@ -524,13 +546,10 @@ ccl_device_inline bool triangle_intersect_local(KernelGlobals *kg,
     }
   }
 
-  const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, prim_addr);
+  float3 verts[3];
+  triangle_intersect_vertices(kg, prim_addr, verts);
 #  if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
-  const ssef *ssef_verts = (ssef *)&kg->__prim_tri_verts.data[tri_vindex];
-#  else
-  const float3 tri_a = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0)),
-               tri_b = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1)),
-               tri_c = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2));
+  const ssef ssef_verts[3] = {ssef(verts[0]), ssef(verts[1]), ssef(verts[2])};
 #  endif
   float t, u, v;
   if (!ray_triangle_intersect(P,
@@ -539,9 +558,9 @@ ccl_device_inline bool triangle_intersect_local(KernelGlobals *kg,
 #  if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
                               ssef_verts,
 #  else
-                              tri_a,
-                              tri_b,
-                              tri_c,
+                              verts[0],
+                              verts[1],
+                              verts[2],
 #  endif
                               &u,
                               &v,
@@ -597,12 +616,7 @@ ccl_device_inline bool triangle_intersect_local(KernelGlobals *kg,
   isect->t = t;
 
   /* Record geometric normal. */
-#  if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
-  const float3 tri_a = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0)),
-               tri_b = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1)),
-               tri_c = float4_to_float3(kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2));
-#  endif
-  local_isect->Ng[hit] = normalize(cross(tri_b - tri_a, tri_c - tri_a));
+  local_isect->Ng[hit] = normalize(cross(verts[1] - verts[0], verts[2] - verts[0]));
 
   return false;
 }
@@ -646,10 +660,9 @@ ccl_device_inline float3 triangle_refine(KernelGlobals *kg,
 
   P = P + D * t;
 
-  const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, isect->prim);
-  const float4 tri_a = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0),
-               tri_b = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1),
-               tri_c = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2);
+  float3 verts[3];
+  triangle_intersect_vertices(kg, isect->prim, verts);
+  const float3 tri_a = verts[0], tri_b = verts[1], tri_c = verts[2];
   float3 edge1 = make_float3(tri_a.x - tri_c.x, tri_a.y - tri_c.y, tri_a.z - tri_c.z);
   float3 edge2 = make_float3(tri_b.x - tri_c.x, tri_b.y - tri_c.y, tri_b.z - tri_c.z);
   float3 tvec = make_float3(P.x - tri_c.x, P.y - tri_c.y, P.z - tri_c.z);
@@ -709,10 +722,9 @@ ccl_device_inline float3 triangle_refine_local(KernelGlobals *kg,
   P = P + D * t;
 
 #ifdef __INTERSECTION_REFINE__
-  const uint tri_vindex = kernel_tex_fetch(__prim_tri_index, isect->prim);
-  const float4 tri_a = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 0),
-               tri_b = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 1),
-               tri_c = kernel_tex_fetch(__prim_tri_verts, tri_vindex + 2);
+  float3 verts[3];
+  triangle_intersect_vertices(kg, isect->prim, verts);
+  const float3 tri_a = verts[0], tri_b = verts[1], tri_c = verts[2];
   float3 edge1 = make_float3(tri_a.x - tri_c.x, tri_a.y - tri_c.y, tri_a.z - tri_c.z);
   float3 edge2 = make_float3(tri_b.x - tri_c.x, tri_b.y - tri_c.y, tri_b.z - tri_c.z);
   float3 tvec = make_float3(P.x - tri_c.x, P.y - tri_c.y, P.z - tri_c.z);
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_ADAPTIVE_SAMPLING_H__
+#define __KERNEL_ADAPTIVE_SAMPLING_H__
+
+CCL_NAMESPACE_BEGIN
+
+/* Adaptive sampling
+ *
+ * Every pixel accumulates a second estimate of its color from odd samples only, stored in the
+ * XYZ components of the adaptive auxiliary buffer pass. The difference between this estimate and
+ * the combined pass gives a per-pixel error, once it is below the threshold the pixel is marked
+ * as converged in the W component and no longer sampled. The number of samples each pixel
+ * received is stored in the sample count pass, so the pixel can be scaled to the full number of
+ * samples once the tile is finished. */
+
+ccl_device_inline ccl_global float *kernel_adaptive_pixel_buffer(KernelGlobals *kg,
+                                                                 ccl_global WorkTile *tile,
+                                                                 int x,
+                                                                 int y)
+{
+  const int index = tile->offset + x + y * tile->stride;
+  return tile->buffer + index * kernel_data.film.pass_stride;
+}
+
+ccl_device_inline bool kernel_adaptive_pixel_is_converged(KernelGlobals *kg,
+                                                          ccl_global float *buffer)
+{
+  return buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] != 0.0f;
+}
+
+ccl_device_inline void kernel_adaptive_pixel_set_converged(KernelGlobals *kg,
+                                                           ccl_global float *buffer,
+                                                           bool converged)
+{
+  buffer[kernel_data.film.pass_adaptive_aux_buffer + 3] = converged ? 1.0f : 0.0f;
+}
+
+/* Determines whether to continue sampling a given pixel or if it has sufficiently converged. */
+ccl_device void kernel_do_adaptive_stopping(KernelGlobals *kg, ccl_global float *buffer)
+{
+  if (kernel_adaptive_pixel_is_converged(kg, buffer)) {
+    return;
+  }
+
+  const float sample = buffer[kernel_data.film.pass_sample_count];
+  if (sample < (float)kernel_data.integrator.adaptive_min_samples) {
+    return;
+  }
+
+  ccl_global float *I = buffer + kernel_data.film.pass_combined;
+  ccl_global float *A = buffer + kernel_data.film.pass_adaptive_aux_buffer;
+
+  /* The per pixel error as seen in section 2.1 of
+   * "A hierarchical automatic stopping condition for Monte Carlo global illumination",
+   * with both estimates not yet divided by the number of samples. A small epsilon is added to
+   * the divisor to prevent division by zero. */
+  const float error = (fabsf(I[0] - A[0]) + fabsf(I[1] - A[1]) + fabsf(I[2] - A[2])) /
+                      (sample * 0.0001f + sqrtf(max(I[0] + I[1] + I[2], 0.0f)));
+  if (error < kernel_data.integrator.adaptive_threshold * sample) {
+    kernel_adaptive_pixel_set_converged(kg, buffer, true);
+  }
+}
+
+/* A box filter in two passes: when a pixel demands more samples, its neighbors are sampled as
+ * well. This avoids visible seams between converged and unconverged regions.
+ * Returns true when any pixel of the row or column still needs samples. */
+ccl_device bool kernel_do_adaptive_filter_x(KernelGlobals *kg, int y, ccl_global WorkTile *tile)
+{
+  bool any = false;
+  bool prev = false;
+  const int x_begin = tile->x, x_end = tile->x + tile->w;
+  for (int x = x_begin; x < x_end; x++) {
+    ccl_global float *buffer = kernel_adaptive_pixel_buffer(kg, tile, x, y);
+    if (!kernel_adaptive_pixel_is_converged(kg, buffer)) {
+      any = true;
+      if (x > x_begin && !prev) {
+        kernel_adaptive_pixel_set_converged(
+            kg, kernel_adaptive_pixel_buffer(kg, tile, x - 1, y), false);
+      }
+      prev = true;
+    }
+    else {
+      if (prev) {
+        kernel_adaptive_pixel_set_converged(kg, buffer, false);
+      }
+      prev = false;
+    }
+  }
+  return any;
+}
+
+ccl_device bool kernel_do_adaptive_filter_y(KernelGlobals *kg, int x, ccl_global WorkTile *tile)
+{
+  bool any = false;
+  bool prev = false;
+  const int y_begin = tile->y, y_end = tile->y + tile->h;
+  for (int y = y_begin; y < y_end; y++) {
+    ccl_global float *buffer = kernel_adaptive_pixel_buffer(kg, tile, x, y);
+    if (!kernel_adaptive_pixel_is_converged(kg, buffer)) {
+      any = true;
+      if (y > y_begin && !prev) {
+        kernel_adaptive_pixel_set_converged(
+            kg, kernel_adaptive_pixel_buffer(kg, tile, x, y - 1), false);
+      }
+      prev = true;
+    }
+    else {
+      if (prev) {
+        kernel_adaptive_pixel_set_converged(kg, buffer, false);
+      }
+      prev = false;
+    }
+  }
+  return any;
+}
+
+/* Scale all accumulated passes of a pixel which stopped sampling early, so it looks as if it
+ * received all samples of the tile. Passes which are only written once or which store IDs are
+ * left untouched. */
+ccl_device void kernel_adaptive_post_adjust(KernelGlobals *kg,
+                                            ccl_global float *buffer,
+                                            float sample_multiplier)
+{
+  const int flag = kernel_data.film.pass_flag;
+  const int pass_stride = kernel_data.film.pass_stride;
+
+  int cryptomatte_begin = pass_stride, cryptomatte_end = pass_stride;
+  if (kernel_data.film.cryptomatte_passes) {
+    int num_cryptomatte_types = 0;
+    num_cryptomatte_types += (kernel_data.film.cryptomatte_passes & CRYPT_OBJECT) ? 1 : 0;
+    num_cryptomatte_types += (kernel_data.film.cryptomatte_passes & CRYPT_MATERIAL) ? 1 : 0;
+    num_cryptomatte_types += (kernel_data.film.cryptomatte_passes & CRYPT_ASSET) ? 1 : 0;
+    cryptomatte_begin = kernel_data.film.pass_cryptomatte;
+    cryptomatte_end = cryptomatte_begin +
+                      2 * kernel_data.film.cryptomatte_depth * num_cryptomatte_types;
+  }
+
+  for (int i = 0; i < pass_stride; i++) {
+    if ((flag & PASSMASK(DEPTH)) && i == kernel_data.film.pass_depth) {
+      continue;
+    }
+    if ((flag & PASSMASK(OBJECT_ID)) && i == kernel_data.film.pass_object_id) {
+      continue;
+    }
+    if ((flag & PASSMASK(MATERIAL_ID)) && i == kernel_data.film.pass_material_id) {
+      continue;
+    }
+    if (i == kernel_data.film.pass_sample_count ||
+        i == kernel_data.film.pass_adaptive_aux_buffer + 3) {
+      continue;
+    }
+    /* Cryptomatte slots are (ID, weight) pairs, only weights are accumulated. */
+    if (i >= cryptomatte_begin && i < cryptomatte_end && ((i - cryptomatte_begin) & 1) == 0) {
+      continue;
+    }
+    buffer[i] *= sample_multiplier;
+  }
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_ADAPTIVE_SAMPLING_H__ */
@@ -26,6 +26,10 @@
 #  include "util/util_map.h"
 #endif
 
+#ifdef __TEXTURE_CACHE__
+#  include "kernel/kernels/cpu/kernel_cpu_texture_cache.h"
+#endif
+
 #ifdef __KERNEL_OPENCL__
 #  include "util/util_atomic.h"
 #endif
@@ -49,6 +53,7 @@ typedef unordered_map<float, float> CoverageMap;
 
 struct Intersection;
 struct VolumeStep;
+struct ShadowStream;
 
 typedef struct KernelGlobals {
 #  define KERNEL_TEX(type, name) texture<type> name;
@@ -64,6 +69,12 @@ typedef struct KernelGlobals {
   OSLThreadData *osl_tdata;
 #  endif
 
+#  ifdef __TEXTURE_CACHE__
+  /* Images read on demand through the OpenImageIO texture system. */
+  TextureCacheGlobals *texture_cache;
+  OIIO::TextureSystem::Perthread *texture_cache_thread_info;
+#  endif
+
   /* **** Run-time data ****  */
 
   /* Heap-allocated storage for transparent shadows intersections. */
@@ -73,6 +84,9 @@ typedef struct KernelGlobals {
   VolumeStep *decoupled_volume_steps[2];
   int decoupled_volume_steps_index;
 
+  /* Shadow rays deferred by the stream path tracing kernel, NULL when traced right away. */
+  ShadowStream *shadow_stream;
+
   /* A buffer for storing per-pixel coverage for Cryptomatte. */
   CoverageMap *coverage_object;
   CoverageMap *coverage_material;
@@ -498,6 +498,9 @@ background_light_sample(KernelGlobals *kg, float3 P, float randu, float randv, f
 
 ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direction)
 {
+  const float select_pdf = light_tree_use(kg) ? light_tree_pdf(kg, P, LIGHT_TREE_NODE_NONE) :
+                                                kernel_data.integrator.pdf_lights;
+
   /* Probability of sampling portals instead of the map. */
   float portal_sampling_pdf = kernel_data.integrator.portal_pdf;
 
@@ -511,7 +514,7 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
        * If map sampling is possible, it would be used instead,
        * otherwise fallback sampling is used. */
       if (portal_sampling_pdf == 1.0f) {
-        return kernel_data.integrator.pdf_lights / M_4PI_F;
+        return select_pdf / M_4PI_F;
       }
       else {
         /* Force map sampling. */
@@ -523,12 +526,23 @@ ccl_device float background_light_pdf(KernelGlobals *kg, float3 P, float3 direct
     /* Evaluate PDF of sampling this direction by map sampling. */
     map_pdf = background_map_pdf(kg, direction) * (1.0f - portal_sampling_pdf);
   }
-  return (portal_pdf + map_pdf) * kernel_data.integrator.pdf_lights;
+  return (portal_pdf + map_pdf) * select_pdf;
 }
 #endif
 
 /* Regular Light */
 
+/* Probability of selecting the lamp from the light distribution. */
+ccl_device_inline float light_select_lamp_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+  if (light_tree_use(kg)) {
+    return light_tree_lamp_pdf(kg, P, lamp);
+  }
+  return kernel_data.integrator.pdf_lights;
+}
+
+/* Sample a point on the lamp, the returned pdf does not include the probability of selecting the
+ * lamp. */
 ccl_device_inline bool lamp_light_sample(
     KernelGlobals *kg, int lamp, float randu, float randv, float3 P, LightSample *ls)
 {
@@ -645,8 +659,6 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
-
   return (ls->pdf > 0.0f);
 }
 
@@ -783,7 +795,7 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= light_select_lamp_pdf(kg, lamp, P);
 
   return true;
 }
@@ -822,18 +834,30 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
-                                                const float3 Ng,
-                                                const float3 I,
-                                                float t)
+/* Conversion from area measure to solid angle measure. */
+ccl_device_inline float triangle_light_pdf_area(const float3 Ng, const float3 I, float t)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
     return 0.0f;
 
-  return t * t * pdf / cos_pi;
+  return t * t / cos_pi;
+}
+
+/* Probability of selecting the triangle from the flat light distribution.
+ * The distribution is built from the triangle area at the center frame, which differs from the
+ * area the sample is taken from when the triangle has motion. */
+ccl_device_inline float triangle_light_distribution_pdf(
+    KernelGlobals *kg, int object, int prim, bool has_motion, float area)
+{
+  float area_pre = area;
+  if (has_motion) {
+    float3 V[3];
+    triangle_world_space_vertices(kg, object, prim, -1.0f, V);
+    area_pre = triangle_area(V[0], V[1], V[2]);
+  }
+  return area_pre * kernel_data.integrator.pdf_triangles;
 }
 
 ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *sd, float t)
@@ -851,11 +875,18 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
   const float longest_edge_squared = max(len_squared(e0), max(len_squared(e1), len_squared(e2)));
   const float3 N = cross(e0, e1);
   const float distance_to_plane = fabsf(dot(N, sd->I * t)) / dot(N, N);
+  const float area = 0.5f * len(N);
+
+  /* sd contains the point on the light source
+   * calculate Px, the point that we're shading */
+  const float3 Px = sd->P + sd->I * t;
+
+  const float select_pdf = light_tree_use(kg) ?
+                               light_tree_triangle_pdf(kg, Px, sd->object, sd->prim) :
+                               triangle_light_distribution_pdf(
+                                   kg, sd->object, sd->prim, has_motion, area);
 
   if (longest_edge_squared > distance_to_plane * distance_to_plane) {
-    /* sd contains the point on the light source
-     * calculate Px, the point that we're shading */
-    const float3 Px = sd->P + sd->I * t;
     const float3 v0_p = V[0] - Px;
     const float3 v1_p = V[1] - Px;
     const float3 v2_p = V[2] - Px;
@@ -869,39 +900,20 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
     const float gamma = fast_acosf(dot(u02, u12));
     const float solid_angle = alpha + beta + gamma - M_PI_F;
 
-    /* pdf_triangles is calculated over triangle area, but we're not sampling over its area */
+    /* the selection pdf is over the triangle, but we're not sampling over its area */
     if (UNLIKELY(solid_angle == 0.0f)) {
       return 0.0f;
     }
     else {
-      float area = 1.0f;
-      if (has_motion) {
-        /* get the center frame vertices, this is what the PDF was calculated from */
-        triangle_world_space_vertices(kg, sd->object, sd->prim, -1.0f, V);
-        area = triangle_area(V[0], V[1], V[2]);
-      }
-      else {
-        area = 0.5f * len(N);
-      }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
-      return pdf / solid_angle;
+      return select_pdf / solid_angle;
     }
   }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
-    if (has_motion) {
-      const float area = 0.5f * len(N);
-      if (UNLIKELY(area == 0.0f)) {
-        return 0.0f;
-      }
-      /* scale the PDF.
-       * area = the area the sample was taken from
-       * area_pre = the are from which pdf_triangles was calculated from */
-      triangle_world_space_vertices(kg, sd->object, sd->prim, -1.0f, V);
-      const float area_pre = triangle_area(V[0], V[1], V[2]);
-      pdf = pdf * area_pre / area;
+    if (UNLIKELY(area == 0.0f)) {
+      return 0.0f;
     }
-    return pdf;
+    /* area = the area the sample was taken from */
+    return triangle_light_pdf_area(sd->Ng, sd->I, t) * select_pdf / area;
   }
 }
 
@@ -943,6 +955,12 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
   ls->shader |= SHADER_USE_MIS;
   ls->type = LIGHT_TRIANGLE;
 
+  /* Probability of having selected this triangle. With the light tree it is known from the
+   * traversal and applied by the caller. */
+  const float select_pdf = light_tree_use(kg) ?
+                               1.0f :
+                               triangle_light_distribution_pdf(kg, object, prim, has_motion, area);
+
   float distance_to_plane = fabsf(dot(N0, V[0] - P) / dot(N0, N0));
 
   if (longest_edge_squared > distance_to_plane * distance_to_plane) {
@@ -1025,19 +1043,13 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
 
     ls->P = P + ls->D * ls->t;
 
-    /* pdf_triangles is calculated over triangle area, but we're sampling over solid angle */
+    /* the selection pdf is over the triangle, but we're sampling over solid angle */
     if (UNLIKELY(solid_angle == 0.0f)) {
       ls->pdf = 0.0f;
       return;
     }
     else {
-      if (has_motion) {
-        /* get the center frame vertices, this is what the PDF was calculated from */
-        triangle_world_space_vertices(kg, object, prim, -1.0f, V);
-        area = triangle_area(V[0], V[1], V[2]);
-      }
-      const float pdf = area * kernel_data.integrator.pdf_triangles;
-      ls->pdf = pdf / solid_angle;
+      ls->pdf = select_pdf / solid_angle;
     }
   }
   else {
@@ -1050,15 +1062,9 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
-    if (has_motion && area != 0.0f) {
-      /* scale the PDF.
-       * area = the area the sample was taken from
-       * area_pre = the are from which pdf_triangles was calculated from */
-      triangle_world_space_vertices(kg, object, prim, -1.0f, V);
-      const float area_pre = triangle_area(V[0], V[1], V[2]);
-      ls->pdf = ls->pdf * area_pre / area;
-    }
+    /* area = the area the sample was taken from */
+    ls->pdf = (area != 0.0f) ? triangle_light_pdf_area(ls->Ng, -ls->D, ls->t) * select_pdf / area :
+                               0.0f;
     ls->u = u;
     ls->v = v;
   }
@@ -1118,9 +1124,20 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       int bounce,
                                       LightSample *ls)
 {
+  float select_pdf = kernel_data.integrator.pdf_lights;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (light_tree_use(kg)) {
+      index = light_tree_sample(kg, P, &randu, &select_pdf);
+      if (index < 0) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -1133,6 +1150,9 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
 
       triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
       ls->shader |= shader_flag;
+      if (light_tree_use(kg)) {
+        ls->pdf *= select_pdf;
+      }
       return (ls->pdf > 0.0f);
     }
 
@@ -1143,7 +1163,12 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+    return false;
+  }
+
+  ls->pdf *= select_pdf;
+  return (ls->pdf > 0.0f);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_LIGHT_TREE_H__
+#define __KERNEL_LIGHT_TREE_H__
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Emitters of the light distribution are stored in a binary tree, where every node bounds the
+ * positions and emission directions of the emitters below it. A light is selected by traversing
+ * the tree from the root, picking a child proportional to its estimated contribution to the
+ * shading point. Distant and background lights are not bounded in space, they are selected with
+ * a fixed probability instead.
+ *
+ * The importance estimate follows "Importance Sampling of Many Lights with Adaptive Tree
+ * Splitting" by Estevez and Kulla, but ignores the normal at the shading point. This way the
+ * probability of selecting a light only depends on the position it was selected from, and can
+ * be evaluated again from the ray origin for multiple importance sampling. */
+
+ccl_device_inline bool light_tree_use(KernelGlobals *kg)
+{
+  /* Sampling all lights relies on the flat light distribution. */
+  return kernel_data.integrator.use_light_tree && !kernel_data.integrator.sample_all_lights_direct &&
+         !kernel_data.integrator.sample_all_lights_indirect;
+}
+
+/* cos(max(a - b, 0)) and sin(max(a - b, 0)) for angles in [0, pi]. */
+ccl_device_inline float light_tree_cos_sub_clamped(float sin_a,
+                                                   float cos_a,
+                                                   float sin_b,
+                                                   float cos_b)
+{
+  if (cos_a > cos_b) {
+    return 1.0f;
+  }
+  return cos_a * cos_b + sin_a * sin_b;
+}
+
+ccl_device_inline float light_tree_sin_sub_clamped(float sin_a,
+                                                   float cos_a,
+                                                   float sin_b,
+                                                   float cos_b)
+{
+  if (cos_a > cos_b) {
+    return 0.0f;
+  }
+  return sin_a * cos_b - cos_a * sin_b;
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, const float3 P, int node_index)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(
+      knode->bounding_box_min[0], knode->bounding_box_min[1], knode->bounding_box_min[2]);
+  const float3 bbox_max = make_float3(
+      knode->bounding_box_max[0], knode->bounding_box_max[1], knode->bounding_box_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+
+  /* Squared distance to the node, clamped to its size, so nodes close to the shading point do
+   * not get an arbitrarily high importance. */
+  const float3 to_point = P - centroid;
+  const float distance_squared = len_squared(to_point);
+  const float radius_squared = 0.25f * len_squared(bbox_max - bbox_min);
+  const float d2 = max(max(distance_squared, radius_squared), 1e-8f);
+
+  /* Angle between the emission axis and the direction towards the shading point. */
+  const float3 omega = (distance_squared > 0.0f) ? to_point / sqrtf(distance_squared) :
+                                                   make_float3(0.0f, 0.0f, 0.0f);
+  float cos_theta_w = dot(axis, omega);
+  if (knode->two_sided) {
+    cos_theta_w = fabsf(cos_theta_w);
+  }
+  const float sin_theta_w = safe_sqrtf(1.0f - cos_theta_w * cos_theta_w);
+
+  /* Angle subtended by the bounding sphere of the node. */
+  float cos_theta_b = -1.0f, sin_theta_b = 0.0f;
+  if (distance_squared > radius_squared) {
+    const float sin_theta_b_squared = radius_squared / distance_squared;
+    sin_theta_b = sqrtf(sin_theta_b_squared);
+    cos_theta_b = safe_sqrtf(1.0f - sin_theta_b_squared);
+  }
+
+  /* Smallest angle between the emission cone and the directions towards the shading point. */
+  const float cos_theta_o = knode->cos_theta_o;
+  const float sin_theta_o = safe_sqrtf(1.0f - cos_theta_o * cos_theta_o);
+  const float cos_theta_x = light_tree_cos_sub_clamped(
+      sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+  const float sin_theta_x = light_tree_sin_sub_clamped(
+      sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o);
+  const float cos_theta_p = light_tree_cos_sub_clamped(
+      sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+
+  /* No emitter of the node can reach the shading point. */
+  if (cos_theta_p <= knode->cos_theta_e) {
+    return 0.0f;
+  }
+
+  return knode->energy * cos_theta_p / d2;
+}
+
+/* Select an emitter of the light distribution. Returns its index in the distribution, or -1 when
+ * no light contributes to the shading point. The random number is rescaled for reuse when
+ * sampling the emitter. */
+ccl_device int light_tree_sample(KernelGlobals *kg, const float3 P, float *randu, float *pdf)
+{
+  const int num_infinite = kernel_data.integrator.light_tree_num_infinite;
+  const float infinite_pdf = kernel_data.integrator.light_tree_infinite_pdf;
+  float r = *randu;
+
+  if (r < infinite_pdf) {
+    /* Infinite lights are selected uniformly. */
+    r = r / infinite_pdf * num_infinite;
+    const int index = min((int)r, num_infinite - 1);
+    *randu = r - index;
+    *pdf = infinite_pdf / num_infinite;
+    return (int)kernel_tex_fetch(__light_tree_infinite, index);
+  }
+
+  if (kernel_data.integrator.light_tree_num_nodes == 0) {
+    return -1;
+  }
+
+  r = (r - infinite_pdf) / (1.0f - infinite_pdf);
+  float node_pdf = 1.0f - infinite_pdf;
+  int node_index = 0;
+
+  while (true) {
+    const int child_index = kernel_tex_fetch(__light_tree_nodes, node_index).child_index;
+    if (child_index < 0) {
+      *randu = r;
+      *pdf = node_pdf;
+      return ~child_index;
+    }
+
+    const float importance_left = light_tree_node_importance(kg, P, node_index + 1);
+    const float importance_right = light_tree_node_importance(kg, P, child_index);
+    const float importance_total = importance_left + importance_right;
+    if (importance_total == 0.0f) {
+      return -1;
+    }
+
+    const float prob_left = importance_left / importance_total;
+    if (r < prob_left) {
+      r = r / prob_left;
+      node_pdf *= prob_left;
+      node_index = node_index + 1;
+    }
+    else {
+      r = (r - prob_left) / (1.0f - prob_left);
+      node_pdf *= 1.0f - prob_left;
+      node_index = child_index;
+    }
+    r = min(r, 1.0f);
+  }
+}
+
+/* Probability of selecting the emitter in the given leaf node from the shading point, found by
+ * walking up the tree to the root. Infinite lights have no leaf node. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, const float3 P, int leaf_index)
+{
+  const float infinite_pdf = kernel_data.integrator.light_tree_infinite_pdf;
+  if (leaf_index == LIGHT_TREE_NODE_NONE) {
+    const int num_infinite = kernel_data.integrator.light_tree_num_infinite;
+    return (num_infinite > 0) ? infinite_pdf / num_infinite : 0.0f;
+  }
+
+  float pdf = 1.0f - infinite_pdf;
+  int node_index = leaf_index;
+  while (node_index != 0) {
+    const int parent_index = kernel_tex_fetch(__light_tree_nodes, node_index).parent_index;
+    const int sibling_index = (node_index == parent_index + 1) ?
+                                  kernel_tex_fetch(__light_tree_nodes, parent_index).child_index :
+                                  parent_index + 1;
+
+    const float importance = light_tree_node_importance(kg, P, node_index);
+    const float importance_total = importance +
+                                   light_tree_node_importance(kg, P, sibling_index);
+    if (importance_total == 0.0f) {
+      return 0.0f;
+    }
+
+    pdf *= importance / importance_total;
+    node_index = parent_index;
+  }
+  return pdf;
+}
+
+ccl_device_inline float light_tree_lamp_pdf(KernelGlobals *kg, const float3 P, int lamp)
+{
+  return light_tree_pdf(kg, P, (int)kernel_tex_fetch(__light_tree_lamp_nodes, lamp));
+}
+
+ccl_device_inline float light_tree_triangle_pdf(KernelGlobals *kg,
+                                                const float3 P,
+                                                int object,
+                                                int prim)
+{
+  /* Triangles are looked up per object, relative to the first triangle of its mesh. */
+  const uint2 kobject = kernel_tex_fetch(__light_tree_objects, object);
+  if ((int)kobject.x == LIGHT_TREE_NODE_NONE) {
+    return 0.0f;
+  }
+
+  const int leaf_index = (int)kernel_tex_fetch(__light_tree_triangle_nodes,
+                                               kobject.x + prim - kobject.y);
+  if (leaf_index == LIGHT_TREE_NODE_NONE) {
+    return 0.0f;
+  }
+  return light_tree_pdf(kg, P, leaf_index);
+}
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_LIGHT_TREE_H__ */
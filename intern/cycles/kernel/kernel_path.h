@@ -30,6 +30,7 @@
 #include "kernel/kernel_write_passes.h"
 #include "kernel/kernel_accumulate.h"
 #include "kernel/kernel_shader.h"
+#include "kernel/kernel_light_tree.h"
 #include "kernel/kernel_light.h"
 #include "kernel/kernel_passes.h"
 
@@ -517,7 +518,8 @@ ccl_device_forceinline void kernel_path_integrate(KernelGlobals *kg,
                                                   Ray *ray,
                                                   PathRadiance *L,
                                                   ccl_global float *buffer,
-                                                  ShaderData *emission_sd)
+                                                  ShaderData *emission_sd,
+                                                  const Intersection *primary_isect)
 {
   PROFILING_INIT(kg, PROFILING_PATH_INTEGRATE);
 
@@ -535,7 +537,22 @@ ccl_device_forceinline void kernel_path_integrate(KernelGlobals *kg,
     for (;;) {
       /* Find intersection with objects in scene. */
       Intersection isect;
-      bool hit = kernel_path_scene_intersect(kg, state, ray, &isect, L);
+      bool hit;
+      if (primary_isect) {
+        /* Camera ray was already intersected together with the rays of neighboring pixels. */
+        isect = *primary_isect;
+        hit = (isect.prim != PRIM_NONE);
+        primary_isect = NULL;
+#  ifdef __KERNEL_DEBUG__
+        L->debug_data.num_bvh_traversed_nodes += isect.num_traversed_nodes;
+        L->debug_data.num_bvh_traversed_instances += isect.num_traversed_instances;
+        L->debug_data.num_bvh_intersections += isect.num_intersections;
+        L->debug_data.num_ray_bounces++;
+#  endif /* __KERNEL_DEBUG__ */
+      }
+      else {
+        hit = kernel_path_scene_intersect(kg, state, ray, &isect, L);
+      }
 
       /* Find intersection with lamps and compute emission for MIS. */
       kernel_path_lamp_emission(kg, state, ray, throughput, &isect, &sd, L);
@@ -688,11 +705,90 @@ ccl_device void kernel_path_trace(
 #  endif
 
   /* Integrate. */
-  kernel_path_integrate(kg, &state, throughput, &ray, &L, buffer, emission_sd);
+  kernel_path_integrate(kg, &state, throughput, &ray, &L, buffer, emission_sd, NULL);
 
   kernel_write_result(kg, buffer, sample, &L);
 }
 
+#  ifdef __BVH_STREAM__
+/* Path trace a block of pixels. Their camera rays are intersected together as a coherent ray
+ * stream, after which every path is integrated on its own. The opaque shadow rays of the direct
+ * light at the first bounce are deferred and intersected together as well. */
+ccl_device void kernel_path_trace_stream(KernelGlobals *kg,
+                                         ccl_global float *buffer,
+                                         int sample,
+                                         const int2 *pixels,
+                                         int num_pixels,
+                                         int offset,
+                                         int stride)
+{
+  PROFILING_INIT(kg, PROFILING_RAY_SETUP);
+
+  kernel_assert(num_pixels <= PATH_STREAM_MAX_PIXELS);
+  kernel_assert(PATH_STREAM_MAX_PIXELS <= BVH_STREAM_MAX_RAYS);
+
+  int pass_stride = kernel_data.film.pass_stride;
+
+  ShaderDataTinyStorage emission_sd_storage;
+  ShaderData *emission_sd = AS_SHADER_DATA(&emission_sd_storage);
+
+  /* Initialize random numbers, sample camera rays and initialize states. */
+  Ray rays[PATH_STREAM_MAX_PIXELS];
+  PathState states[PATH_STREAM_MAX_PIXELS];
+  uint visibility = 0;
+
+  for (int i = 0; i < num_pixels; i++) {
+    uint rng_hash;
+    kernel_path_trace_setup(kg, sample, pixels[i].x, pixels[i].y, &rng_hash, &rays[i]);
+
+    if (rays[i].t == 0.0f) {
+      continue;
+    }
+
+    path_state_init(kg, emission_sd, &states[i], rng_hash, sample, &rays[i]);
+    visibility = path_state_ray_visibility(kg, &states[i]);
+  }
+
+  /* Intersect camera rays. */
+  Intersection isects[PATH_STREAM_MAX_PIXELS];
+  scene_intersect_stream(kg, rays, visibility, isects, num_pixels);
+
+  /* Integrate, the radiance of all paths is kept until the deferred shadow rays are traced. */
+  PathRadiance L[PATH_STREAM_MAX_PIXELS];
+  ShadowStream shadow_stream;
+  shadow_stream.num_rays = 0;
+  kg->shadow_stream = &shadow_stream;
+
+  for (int i = 0; i < num_pixels; i++) {
+    if (rays[i].t == 0.0f) {
+      continue;
+    }
+
+    ccl_global float *pixel_buffer = buffer + (offset + pixels[i].x + pixels[i].y * stride) *
+                                                  pass_stride;
+
+    path_radiance_init(kg, &L[i]);
+
+    float3 throughput = make_float3(1.0f, 1.0f, 1.0f);
+    kernel_path_integrate(
+        kg, &states[i], throughput, &rays[i], &L[i], pixel_buffer, emission_sd, &isects[i]);
+  }
+
+  shadow_stream_flush(kg, &shadow_stream);
+  kg->shadow_stream = NULL;
+
+  for (int i = 0; i < num_pixels; i++) {
+    if (rays[i].t == 0.0f) {
+      continue;
+    }
+
+    ccl_global float *pixel_buffer = buffer + (offset + pixels[i].x + pixels[i].y * stride) *
+                                                  pass_stride;
+    kernel_write_result(kg, pixel_buffer, sample, &L[i]);
+  }
+}
+#  endif /* __BVH_STREAM__ */
+
 #endif /* __SPLIT_KERNEL__ */
 
 CCL_NAMESPACE_END
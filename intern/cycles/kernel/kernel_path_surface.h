@@ -101,7 +101,7 @@ ccl_device_noinline_cpu void kernel_branched_path_surface_connect_light(
         LightSample ls ccl_optional_struct_init;
         const int lamp = is_lamp ? i : -1;
         if (light_sample(kg, lamp, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
-          /* The sampling probability returned by lamp_light_sample assumes that all lights were
+          /* The sampling probability returned by light_sample assumes that all lights were
            * sampled. However, this code only samples lamps, so if the scene also had mesh lights,
            * the real probability is twice as high. */
           if (double_pdf) {
@@ -113,6 +113,19 @@ ccl_device_noinline_cpu void kernel_branched_path_surface_connect_light(
         }
       }
 
+#    ifdef __BVH_STREAM__
+      if (has_emission && shadow_stream_defer(kg,
+                                              state,
+                                              &light_ray,
+                                              &L_light,
+                                              L,
+                                              throughput * num_samples_inv,
+                                              num_samples_inv,
+                                              is_lamp)) {
+        continue;
+      }
+#    endif
+
       /* trace shadow ray */
       float3 shadow;
 
@@ -248,6 +261,13 @@ ccl_device_inline void kernel_path_surface_connect_light(KernelGlobals *kg,
     }
   }
 
+#    ifdef __BVH_STREAM__
+  if (has_emission &&
+      shadow_stream_defer(kg, state, &light_ray, &L_light, L, throughput, 1.0f, is_lamp)) {
+    return;
+  }
+#    endif
+
   /* trace shadow ray */
   float3 shadow;
 
@@ -461,6 +461,107 @@ ccl_device_inline bool shadow_blocked(KernelGlobals *kg,
 #endif   /* __TRANSPARENT_SHADOWS__ */
 }
 
+#ifdef __BVH_STREAM__
+/* Shadow rays of neighboring pixels, deferred so their occlusion can be tested together as a
+ * coherent ray stream. Only opaque shadows are deferred, their light contribution is added to
+ * the radiance of the path once the ray is known not to be blocked. */
+#  define SHADOW_STREAM_MAX_RAYS BVH_STREAM_MAX_RAYS
+
+typedef struct ShadowStream {
+  Ray rays[SHADOW_STREAM_MAX_RAYS];
+  BsdfEval L_light[SHADOW_STREAM_MAX_RAYS];
+  float3 throughput[SHADOW_STREAM_MAX_RAYS];
+  float shadow_fac[SHADOW_STREAM_MAX_RAYS];
+  int state_flag[SHADOW_STREAM_MAX_RAYS];
+  bool is_lamp[SHADOW_STREAM_MAX_RAYS];
+  PathRadiance *L[SHADOW_STREAM_MAX_RAYS];
+  int num_rays;
+} ShadowStream;
+
+ccl_device void shadow_stream_flush(KernelGlobals *kg, ShadowStream *stream)
+{
+  if (stream->num_rays == 0) {
+    return;
+  }
+
+  bool blocked[SHADOW_STREAM_MAX_RAYS];
+  scene_intersect_shadow_stream(
+      kg, stream->rays, PATH_RAY_SHADOW_OPAQUE, blocked, stream->num_rays);
+
+  for (int i = 0; i < stream->num_rays; i++) {
+    /* Only rays of the first bounce are deferred, accumulating the light reads no other
+     * path state than this. */
+    PathState state;
+    state.flag = stream->state_flag[i];
+    state.bounce = 0;
+
+    if (!blocked[i]) {
+      path_radiance_accum_light(kg,
+                                stream->L[i],
+                                &state,
+                                stream->throughput[i],
+                                &stream->L_light[i],
+                                make_float3(1.0f, 1.0f, 1.0f),
+                                stream->shadow_fac[i],
+                                stream->is_lamp[i]);
+    }
+    else {
+      path_radiance_accum_total_light(
+          stream->L[i], &state, stream->throughput[i], &stream->L_light[i]);
+    }
+  }
+
+  stream->num_rays = 0;
+}
+
+/* Defer the shadow ray of a light sample to the shadow stream of the kernel, instead of calling
+ * shadow_blocked() and accumulating the light. Returns false when the ray has to be traced right
+ * away, because there is no stream or the shadow is not simply opaque. */
+ccl_device_inline bool shadow_stream_defer(KernelGlobals *kg,
+                                           ccl_addr_space PathState *state,
+                                           const Ray *ray,
+                                           const BsdfEval *L_light,
+                                           PathRadiance *L,
+                                           float3 throughput,
+                                           float shadow_fac,
+                                           bool is_lamp)
+{
+  ShadowStream *stream = kg->shadow_stream;
+  if (stream == NULL || state->bounce != 0 || ray->t == 0.0f) {
+    return false;
+  }
+#  ifdef __SHADOW_TRICKS__
+  if (state->flag & PATH_RAY_SHADOW_CATCHER) {
+    return false;
+  }
+#  endif
+#  ifdef __TRANSPARENT_SHADOWS__
+  if (kernel_data.integrator.transparent_shadows) {
+    return false;
+  }
+#  endif
+#  ifdef __VOLUME__
+  if (state->volume_stack[0].shader != SHADER_NONE) {
+    return false;
+  }
+#  endif
+
+  if (stream->num_rays == SHADOW_STREAM_MAX_RAYS) {
+    shadow_stream_flush(kg, stream);
+  }
+
+  const int i = stream->num_rays++;
+  stream->rays[i] = *ray;
+  stream->L_light[i] = *L_light;
+  stream->throughput[i] = throughput;
+  stream->shadow_fac[i] = shadow_fac;
+  stream->state_flag[i] = state->flag;
+  stream->is_lamp[i] = is_lamp;
+  stream->L[i] = L;
+  return true;
+}
+#endif /* __BVH_STREAM__ */
+
 #undef SHADOW_STACK_MAX_HITS
 
 CCL_NAMESPACE_END
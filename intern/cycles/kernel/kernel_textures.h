@@ -46,6 +46,12 @@ KERNEL_TEX(uint4, __tri_vindex)
 KERNEL_TEX(uint, __tri_patch)
 KERNEL_TEX(float2, __tri_patch_uv)
 
+/* compact triangles */
+KERNEL_TEX(ushort4, __tri_verts_compact)
+KERNEL_TEX(float4, __tri_verts_compact_bounds)
+KERNEL_TEX(uint, __tri_vnormal_compact)
+KERNEL_TEX(uint2, __tri_vindex_compact)
+
 /* curves */
 KERNEL_TEX(float4, __curves)
 KERNEL_TEX(float4, __curve_keys)
@@ -65,6 +71,11 @@ KERNEL_TEX(KernelLightDistribution, __light_distribution)
 KERNEL_TEX(KernelLight, __lights)
 KERNEL_TEX(float2, __light_background_marginal_cdf)
 KERNEL_TEX(float2, __light_background_conditional_cdf)
+KERNEL_TEX(KernelLightTreeNode, __light_tree_nodes)
+KERNEL_TEX(uint, __light_tree_lamp_nodes)
+KERNEL_TEX(uint, __light_tree_infinite)
+KERNEL_TEX(uint2, __light_tree_objects)
+KERNEL_TEX(uint, __light_tree_triangle_nodes)
 
 /* particles */
 KERNEL_TEX(KernelParticle, __particles)
@@ -59,10 +59,15 @@ CCL_NAMESPACE_BEGIN
 #define OBJECT_NONE (~0)
 #define PRIM_NONE (~0)
 #define LAMP_NONE (~0)
+#define LIGHT_TREE_NODE_NONE (~0)
 #define ID_NONE (0.0f)
 
 #define VOLUME_STACK_SIZE 32
 
+/* CPU stream kernel constants, pixels are path traced together in square blocks */
+#define PATH_STREAM_BLOCK_SIZE 8
+#define PATH_STREAM_MAX_PIXELS (PATH_STREAM_BLOCK_SIZE * PATH_STREAM_BLOCK_SIZE)
+
 /* Split kernel constants */
 #define WORK_POOL_SIZE_GPU 64
 #define WORK_POOL_SIZE_CPU 1
@@ -129,10 +134,12 @@ CCL_NAMESPACE_BEGIN
 #ifdef __KERNEL_CPU__
 #  ifdef __KERNEL_SSE2__
 #    define __QBVH__
+#    define __BVH_STREAM__
 #  endif
 #  ifdef WITH_OSL
 #    define __OSL__
 #  endif
+#  define __TEXTURE_CACHE__
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
 #endif /* __KERNEL_CPU__ */
@@ -375,6 +382,8 @@ typedef enum PassType {
   PASS_CRYPTOMATTE,
   PASS_AOV_COLOR,
   PASS_AOV_VALUE,
+  PASS_ADAPTIVE_AUX_BUFFER,
+  PASS_SAMPLE_COUNT,
   PASS_CATEGORY_MAIN_END = 31,
 
   PASS_MIST = 32,
@@ -1250,8 +1259,8 @@ typedef struct KernelFilm {
 
   int pass_aov_color;
   int pass_aov_value;
-  int pad1;
-  int pad2;
+  int pass_adaptive_aux_buffer;
+  int pass_sample_count;
 
   /* XYZ to rendering color space transform. float4 instead of float3 to
    * ensure consistent padding/alignment across devices. */
@@ -1303,6 +1312,12 @@ typedef struct KernelIntegrator {
   int pdf_background_res_y;
   float light_inv_rr_threshold;
 
+  /* light tree */
+  int use_light_tree;
+  int light_tree_num_nodes;
+  int light_tree_num_infinite;
+  float light_tree_infinite_pdf;
+
   /* light portals */
   float portal_pdf;
   int num_portals;
@@ -1365,7 +1380,12 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1;
+  /* adaptive sampling */
+  int adaptive_min_samples;
+  int adaptive_step;
+  float adaptive_threshold;
+
+  int pad1, pad2;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1392,6 +1412,12 @@ typedef struct KernelBVH {
   int bvh_layout;
   int use_bvh_steps;
 
+  /* Triangle vertices and normals are stored quantized, and with compact indices the triangle
+   * vertex indices are delta encoded, see geom_triangle.h. */
+  int use_compact_geometry;
+  int use_compact_indices;
+  int pad3, pad4;
+
   /* Custom BVH */
 #ifdef __KERNEL_OPTIX__
   OptixTraversableHandle scene;
@@ -1534,6 +1560,24 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Node of the light tree, bounds the position and emission direction of all emitters below it.
+ * The first child of an inner node directly follows it in the array. */
+typedef struct KernelLightTreeNode {
+  float bounding_box_min[3];
+  float energy;
+  float bounding_box_max[3];
+  float cos_theta_o;
+  float axis[3];
+  float cos_theta_e;
+  /* Inner node: index of the second child.
+   * Leaf node: bitwise negated index of the emitter in the light distribution. */
+  int child_index;
+  int parent_index;
+  int two_sided;
+  int pad;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -80,12 +80,97 @@ template<typename T> struct TextureInterpolator {
     return make_float4(r.x * f, r.y * f, r.z * f, r.w * f);
   }
 
+  /* Block compression, see util_texture.h for the layout of the blocks. */
+  static ccl_always_inline float4 read_bc_color(uint colors, uint indices, int i)
+  {
+    const float weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    const float t = weights[(indices >> (2 * i)) & 0x3];
+    const uint c0 = colors & 0xFFFF;
+    const uint c1 = colors >> 16;
+    const float4 e0 = make_float4((c0 >> 11) * (1.0f / 31.0f),
+                                  ((c0 >> 5) & 0x3F) * (1.0f / 63.0f),
+                                  (c0 & 0x1F) * (1.0f / 31.0f),
+                                  1.0f);
+    const float4 e1 = make_float4((c1 >> 11) * (1.0f / 31.0f),
+                                  ((c1 >> 5) & 0x3F) * (1.0f / 63.0f),
+                                  (c1 & 0x1F) * (1.0f / 31.0f),
+                                  1.0f);
+    return e0 + (e1 - e0) * t;
+  }
+
+  static ccl_always_inline float read_bc_alpha(uint4 block, int i)
+  {
+    const float weights[8] = {
+        0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f};
+    const uint64_t indices = (uint64_t)(block.x >> 16) | ((uint64_t)block.y << 16);
+    const float t = weights[(indices >> (3 * i)) & 0x7];
+    const float a0 = (block.x & 0xFF) * (1.0f / 255.0f);
+    const float a1 = ((block.x >> 8) & 0xFF) * (1.0f / 255.0f);
+    return a0 + (a1 - a0) * t;
+  }
+
+  /* Width of the image in pixels, for 2D images. */
+  template<typename U> static ccl_always_inline int width_2d(const U *, const TextureInfo &info)
+  {
+    return info.width;
+  }
+
+  static ccl_always_inline int width_2d(const uint2 *, const TextureInfo &info)
+  {
+    return info.width * IMAGE_BLOCK_SIZE;
+  }
+
+  static ccl_always_inline int width_2d(const uint4 *, const TextureInfo &info)
+  {
+    return info.width * IMAGE_BLOCK_SIZE;
+  }
+
+  template<typename U> static ccl_always_inline int height_2d(const U *, const TextureInfo &info)
+  {
+    return info.height;
+  }
+
+  static ccl_always_inline int height_2d(const uint2 *, const TextureInfo &info)
+  {
+    return info.height * IMAGE_BLOCK_SIZE;
+  }
+
+  static ccl_always_inline int height_2d(const uint4 *, const TextureInfo &info)
+  {
+    return info.height * IMAGE_BLOCK_SIZE;
+  }
+
+  /* Pixel of a 2D image. */
+  template<typename U>
+  static ccl_always_inline float4 fetch(const U *data, int x, int y, int width)
+  {
+    return read(data[y * width + x]);
+  }
+
+  static ccl_always_inline float4 fetch(const uint2 *data, int x, int y, int width)
+  {
+    const uint2 block = data[(y / IMAGE_BLOCK_SIZE) * (width / IMAGE_BLOCK_SIZE) +
+                             x / IMAGE_BLOCK_SIZE];
+    const int i = (y % IMAGE_BLOCK_SIZE) * IMAGE_BLOCK_SIZE + x % IMAGE_BLOCK_SIZE;
+    return read_bc_color(block.x, block.y, i);
+  }
+
+  static ccl_always_inline float4 fetch(const uint4 *data, int x, int y, int width)
+  {
+    const uint4 block = data[(y / IMAGE_BLOCK_SIZE) * (width / IMAGE_BLOCK_SIZE) +
+                             x / IMAGE_BLOCK_SIZE];
+    const int i = (y % IMAGE_BLOCK_SIZE) * IMAGE_BLOCK_SIZE + x % IMAGE_BLOCK_SIZE;
+    float4 r = read_bc_color(block.z, block.w, i);
+    r.w = read_bc_alpha(block, i);
+    return r;
+  }
+
   static ccl_always_inline float4 read(const T *data, int x, int y, int width, int height)
   {
     if (x < 0 || y < 0 || x >= width || y >= height) {
       return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
-    return read(data[y * width + x]);
+    return fetch(data, x, y, width);
   }
 
   static ccl_always_inline int wrap_periodic(int x, int width)
@@ -113,8 +198,8 @@ template<typename T> struct TextureInterpolator {
   static ccl_always_inline float4 interp_closest(const TextureInfo &info, float x, float y)
   {
     const T *data = (const T *)info.data;
-    const int width = info.width;
-    const int height = info.height;
+    const int width = width_2d(data, info);
+    const int height = height_2d(data, info);
     int ix, iy;
     frac(x * (float)width, &ix);
     frac(y * (float)height, &iy);
@@ -136,14 +221,14 @@ template<typename T> struct TextureInterpolator {
         kernel_assert(0);
         return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
     }
-    return read(data[ix + iy * width]);
+    return fetch(data, ix, iy, width);
   }
 
   static ccl_always_inline float4 interp_linear(const TextureInfo &info, float x, float y)
   {
     const T *data = (const T *)info.data;
-    const int width = info.width;
-    const int height = info.height;
+    const int width = width_2d(data, info);
+    const int height = height_2d(data, info);
     int ix, iy, nix, niy;
     const float tx = frac(x * (float)width - 0.5f, &ix);
     const float ty = frac(y * (float)height - 0.5f, &iy);
@@ -177,8 +262,8 @@ template<typename T> struct TextureInterpolator {
   static ccl_always_inline float4 interp_cubic(const TextureInfo &info, float x, float y)
   {
     const T *data = (const T *)info.data;
-    const int width = info.width;
-    const int height = info.height;
+    const int width = width_2d(data, info);
+    const int height = height_2d(data, info);
     int ix, iy, nix, niy;
     const float tx = frac(x * (float)width - 0.5f, &ix);
     const float ty = frac(y * (float)height - 0.5f, &iy);
@@ -491,6 +576,10 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
       return TextureInterpolator<ushort4>::interp(info, x, y);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_BC1:
+      return TextureInterpolator<uint2>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_BC3:
+      return TextureInterpolator<uint4>::interp(info, x, y);
     default:
       assert(0);
       return make_float4(
@@ -527,6 +616,47 @@ ccl_device float4 kernel_tex_image_interp_3d(
   }
 }
 
+#ifdef __TEXTURE_CACHE__
+ccl_device_inline bool kernel_tex_image_is_cached(KernelGlobals *kg, int id)
+{
+  const TextureCacheGlobals *texture_cache = kg->texture_cache;
+  return texture_cache != NULL && id < (int)texture_cache->images.size() &&
+         texture_cache->images[id].handle != NULL;
+}
+
+/* Lookup in an image which is read on demand. The derivatives of the texture coordinates select
+ * the mipmap level, so only the tiles of the resolution that is needed get loaded. */
+ccl_device float4 kernel_tex_image_interp_cache(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureCacheImage &image = kg->texture_cache->images[id];
+  OIIO::TextureOpt options = image.options;
+  float result[4];
+
+  /* OpenImageIO has its origin at the top of the image. */
+  const bool ok = kg->texture_cache->texture_system->texture(image.handle,
+                                                             kg->texture_cache_thread_info,
+                                                             options,
+                                                             x,
+                                                             1.0f - y,
+                                                             dx.x,
+                                                             -dx.y,
+                                                             dy.x,
+                                                             -dy.y,
+                                                             image.num_channels,
+                                                             result);
+  if (!ok) {
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  if (image.num_channels == 1) {
+    return make_float4(result[0], result[0], result[0], 1.0f);
+  }
+  return make_float4(result[0], result[1], result[2], result[3]);
+}
+#endif /* __TEXTURE_CACHE__ */
+
 } /* Namespace. */
 
 CCL_NAMESPACE_END
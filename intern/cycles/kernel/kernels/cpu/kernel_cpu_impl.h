@@ -92,6 +92,37 @@ void KERNEL_FUNCTION_FULL_NAME(path_trace)(
 #  endif /* KERNEL_STUB */
 }
 
+void KERNEL_FUNCTION_FULL_NAME(path_trace_stream)(KernelGlobals *kg,
+                                                  float *buffer,
+                                                  int sample,
+                                                  const int2 *pixels,
+                                                  int num_pixels,
+                                                  int offset,
+                                                  int stride)
+{
+#  ifdef KERNEL_STUB
+  STUB_ASSERT(KERNEL_ARCH, path_trace_stream);
+#  else
+#    ifdef __BRANCHED_PATH__
+  if (kernel_data.integrator.branched) {
+    for (int i = 0; i < num_pixels; i++) {
+      kernel_branched_path_trace(kg, buffer, sample, pixels[i].x, pixels[i].y, offset, stride);
+    }
+  }
+  else
+#    endif
+  {
+#    ifdef __BVH_STREAM__
+    kernel_path_trace_stream(kg, buffer, sample, pixels, num_pixels, offset, stride);
+#    else
+    for (int i = 0; i < num_pixels; i++) {
+      kernel_path_trace(kg, buffer, sample, pixels[i].x, pixels[i].y, offset, stride);
+    }
+#    endif /* __BVH_STREAM__ */
+  }
+#  endif /* KERNEL_STUB */
+}
+
 /* Film */
 
 void KERNEL_FUNCTION_FULL_NAME(convert_to_byte)(KernelGlobals *kg,
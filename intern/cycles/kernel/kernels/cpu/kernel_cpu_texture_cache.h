@@ -0,0 +1,52 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __KERNEL_CPU_TEXTURE_CACHE_H__
+#define __KERNEL_CPU_TEXTURE_CACHE_H__
+
+#include <OpenImageIO/texture.h>
+
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Image which is not loaded into device memory, but read tile by tile through the OpenImageIO
+ * texture system while rendering. */
+struct TextureCacheImage {
+  TextureCacheImage() : handle(NULL), num_channels(0)
+  {
+  }
+
+  OIIO::TextureSystem::TextureHandle *handle;
+  /* Interpolation, wrap and fill options matching the image node. */
+  OIIO::TextureOpt options;
+  int num_channels;
+};
+
+/* Texture cache of a CPU device, shared between all render threads. Filled in by the image
+ * manager, images are indexed by their flattened slot. */
+struct TextureCacheGlobals {
+  TextureCacheGlobals() : texture_system(NULL)
+  {
+  }
+
+  OIIO::TextureSystem *texture_system;
+  vector<TextureCacheImage> images;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __KERNEL_CPU_TEXTURE_CACHE_H__ */
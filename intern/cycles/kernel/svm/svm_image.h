@@ -18,21 +18,33 @@ CCL_NAMESPACE_BEGIN
 
 #ifdef __TEXTURES__
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+ccl_device float4 svm_image_texture(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
+#ifdef __TEXTURE_CACHE__
+  const bool is_cached = kernel_tex_image_is_cached(kg, id);
+  float4 r = is_cached ? kernel_tex_image_interp_cache(kg, id, x, y, dx, dy) :
+                         kernel_tex_image_interp(kg, id, x, y);
+#else
+  const bool is_cached = false;
   float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
     r /= alpha;
-    const int texture_type = kernel_tex_type(id);
-    if (texture_type == IMAGE_DATA_TYPE_BYTE4 || texture_type == IMAGE_DATA_TYPE_BYTE) {
-      r = min(r, make_float4(1.0f, 1.0f, 1.0f, 1.0f));
+    /* Cached images have no texture info to look up their type. */
+    if (!is_cached) {
+      const int texture_type = kernel_tex_type(id);
+      if (texture_type == IMAGE_DATA_TYPE_BYTE4 || texture_type == IMAGE_DATA_TYPE_BYTE ||
+          texture_type == IMAGE_DATA_TYPE_BC1 || texture_type == IMAGE_DATA_TYPE_BC3) {
+        r = min(r, make_float4(1.0f, 1.0f, 1.0f, 1.0f));
+      }
     }
     r.w = alpha;
   }
@@ -44,6 +56,36 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+/* Differentials of the UV map used as texture coordinate, which select the mipmap level of
+ * images read through the texture cache. */
+ccl_device void svm_image_uv_differentials(
+    KernelGlobals *kg, ShaderData *sd, uint attr_id, float2 *dx, float2 *dy)
+{
+  *dx = make_float2(0.0f, 0.0f);
+  *dy = make_float2(0.0f, 0.0f);
+
+#ifdef __RAY_DIFFERENTIALS__
+  if (sd->object == OBJECT_NONE) {
+    return;
+  }
+
+  const AttributeDescriptor desc = find_attribute(kg, sd, attr_id);
+  if (desc.offset == ATTR_STD_NOT_FOUND) {
+    return;
+  }
+
+  if (desc.type == NODE_ATTR_FLOAT2) {
+    primitive_surface_attribute_float2(kg, sd, desc, dx, dy);
+  }
+  else {
+    float3 uv_dx, uv_dy;
+    primitive_surface_attribute_float3(kg, sd, desc, &uv_dx, &uv_dy);
+    *dx = make_float2(uv_dx.x, uv_dx.y);
+    *dy = make_float2(uv_dy.x, uv_dy.y);
+  }
+#endif
+}
+
 /* Remap coordnate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -71,6 +113,12 @@ ccl_device void svm_node_tex_image(
     tex_co = make_float2(co.x, co.y);
   }
 
+  float2 tex_dx = make_float2(0.0f, 0.0f), tex_dy = make_float2(0.0f, 0.0f);
+  if (flags & NODE_IMAGE_UV_DIFFERENTIALS) {
+    uint4 uv_node = read_node(kg, offset);
+    svm_image_uv_differentials(kg, sd, uv_node.x, &tex_dx, &tex_dy);
+  }
+
   /* TODO(lukas): Consider moving tile information out of the SVM node.
    * TextureInfo seems a reasonable candidate. */
   int id = -1;
@@ -114,7 +162,7 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, tex_dx, tex_dy, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -200,19 +248,20 @@ ccl_device void svm_node_tex_image_box(KernelGlobals *kg, ShaderData *sd, float
   uint id = node.y;
 
   float4 f = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+  const float2 zero = make_float2(0.0f, 0.0f);
 
   /* Map so that no textures are flipped, rotation is somewhat arbitrary. */
   if (weight.x > 0.0f) {
     float2 uv = make_float2((signed_N.x < 0.0f) ? 1.0f - co.y : co.y, co.z);
-    f += weight.x * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.x * svm_image_texture(kg, id, uv.x, uv.y, zero, zero, flags);
   }
   if (weight.y > 0.0f) {
     float2 uv = make_float2((signed_N.y > 0.0f) ? 1.0f - co.x : co.x, co.z);
-    f += weight.y * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.y * svm_image_texture(kg, id, uv.x, uv.y, zero, zero, flags);
   }
   if (weight.z > 0.0f) {
     float2 uv = make_float2((signed_N.z > 0.0f) ? 1.0f - co.y : co.y, co.x);
-    f += weight.z * svm_image_texture(kg, id, uv.x, uv.y, flags);
+    f += weight.z * svm_image_texture(kg, id, uv.x, uv.y, zero, zero, flags);
   }
 
   if (stack_valid(out_offset))
@@ -242,7 +291,8 @@ ccl_device void svm_node_tex_environment(KernelGlobals *kg,
   else
     uv = direction_to_mirrorball(co);
 
-  float4 f = svm_image_texture(kg, id, uv.x, uv.y, flags);
+  const float2 zero = make_float2(0.0f, 0.0f);
+  float4 f = svm_image_texture(kg, id, uv.x, uv.y, zero, zero, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
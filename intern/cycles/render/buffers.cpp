@@ -120,6 +120,8 @@ RenderTile::RenderTile()
   offset = 0;
   stride = 0;
 
+  saved_samples = 0;
+
   buffer = 0;
 
   buffers = NULL;
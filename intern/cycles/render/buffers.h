@@ -142,6 +142,9 @@ class RenderTile {
   int stride;
   int tile_index;
 
+  /* Pixel samples which were not taken because pixels converged early with adaptive sampling. */
+  uint64_t saved_samples;
+
   device_ptr buffer;
   int device_size;
 
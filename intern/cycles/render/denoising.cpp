@@ -378,6 +378,8 @@ void DenoiseTask::create_task(DeviceTask &task)
   /* Denoising parameters. */
   task.denoising = denoiser->params;
   task.denoising_do_filter = true;
+  task.denoising_use_optix = false;
+  task.denoising_use_oidn = false;
   task.denoising_write_passes = false;
   task.denoising_from_render = false;
 
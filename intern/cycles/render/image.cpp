@@ -28,6 +28,8 @@
 #include "util/util_texture.h"
 #include "util/util_unique_ptr.h"
 
+#include "kernel/kernels/cpu/kernel_cpu_texture_cache.h"
+
 #ifdef WITH_OSL
 #  include <OSL/oslexec.h>
 #endif
@@ -50,7 +52,7 @@ bool isfinite(uint16_t /*value*/)
   return true;
 }
 
-/* The lower three bits of a device texture slot number indicate its type.
+/* The lower four bits of a device texture slot number indicate its type.
  * These functions convert the slot ids from ImageManager "images" ones
  * to device ones and vice verse.
  */
@@ -84,6 +86,10 @@ const char *name_from_type(ImageDataType type)
       return "ushort4";
     case IMAGE_DATA_TYPE_USHORT:
       return "ushort";
+    case IMAGE_DATA_TYPE_BC1:
+      return "bc1";
+    case IMAGE_DATA_TYPE_BC3:
+      return "bc3";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -92,17 +98,251 @@ const char *name_from_type(ImageDataType type)
   return "";
 }
 
+/* Convert float pixels, with non-finite values set to zero. */
+template<typename StorageType>
+void image_cast_from_float(const float *floatpixels, StorageType *pixels, size_t num_values)
+{
+  for (size_t i = 0; i < num_values; i++) {
+    const float value = floatpixels[i];
+    pixels[i] = util_image_cast_from_float<StorageType>(std::isfinite(value) ? value : 0.0f);
+  }
+}
+
+/* Dimensions of the image after scaling it down to the texture limit, matching the scaling done
+ * when loading the image. */
+void image_scaled_size(
+    const ImageMetaData &metadata, int texture_limit, size_t *width, size_t *height, size_t *depth)
+{
+  *width = metadata.width;
+  *height = metadata.height;
+  *depth = metadata.depth;
+
+  const size_t max_size = max(max(metadata.width, metadata.height), metadata.depth);
+  if (texture_limit > 0 && max_size > texture_limit) {
+    float scale_factor = 1.0f;
+    while (max_size * scale_factor > texture_limit) {
+      scale_factor *= 0.5f;
+    }
+    *width = max((size_t)((float)metadata.width * scale_factor), (size_t)1);
+    *height = max((size_t)((float)metadata.height * scale_factor), (size_t)1);
+    *depth = max((size_t)((float)metadata.depth * scale_factor), (size_t)1);
+  }
+}
+
+size_t image_memory_size(ImageDataType type, size_t width, size_t height, size_t depth)
+{
+  const size_t num_pixels = width * height * max(depth, (size_t)1);
+  const size_t num_blocks = divide_up(width, IMAGE_BLOCK_SIZE) *
+                            divide_up(height, IMAGE_BLOCK_SIZE);
+
+  switch (type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return num_pixels * sizeof(float4);
+    case IMAGE_DATA_TYPE_BYTE4:
+      return num_pixels * sizeof(uchar4);
+    case IMAGE_DATA_TYPE_HALF4:
+      return num_pixels * sizeof(half4);
+    case IMAGE_DATA_TYPE_FLOAT:
+      return num_pixels * sizeof(float);
+    case IMAGE_DATA_TYPE_BYTE:
+      return num_pixels * sizeof(uchar);
+    case IMAGE_DATA_TYPE_HALF:
+      return num_pixels * sizeof(half);
+    case IMAGE_DATA_TYPE_USHORT4:
+      return num_pixels * sizeof(ushort4);
+    case IMAGE_DATA_TYPE_USHORT:
+      return num_pixels * sizeof(uint16_t);
+    case IMAGE_DATA_TYPE_BC1:
+      return num_blocks * sizeof(uint2);
+    case IMAGE_DATA_TYPE_BC3:
+      return num_blocks * sizeof(uint4);
+    case IMAGE_DATA_NUM_TYPES:
+      assert(!"System enumerator type, should never be used");
+      return 0;
+  }
+  assert(!"Unhandled image data type");
+  return 0;
+}
+
+/* Block compression of 8 bit images, see util_texture.h for the layout of the blocks.
+ *
+ * Color endpoints are the corners of the bounding box of the block colors, along the diagonal
+ * that best follows the colors, and every pixel picks the closest color of the palette. */
+
+const int IMAGE_BLOCK_NUM_PIXELS = IMAGE_BLOCK_SIZE * IMAGE_BLOCK_SIZE;
+
+uint image_bc_pack_565(const int color[3])
+{
+  const uint r = (color[0] * 31 + 127) / 255;
+  const uint g = (color[1] * 63 + 127) / 255;
+  const uint b = (color[2] * 31 + 127) / 255;
+  return (r << 11) | (g << 5) | b;
+}
+
+void image_bc_unpack_565(uint packed, float color[3])
+{
+  color[0] = (packed >> 11) * (255.0f / 31.0f);
+  color[1] = ((packed >> 5) & 0x3F) * (255.0f / 63.0f);
+  color[2] = (packed & 0x1F) * (255.0f / 31.0f);
+}
+
+void image_bc_encode_color(const uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS],
+                           uint *colors,
+                           uint *indices)
+{
+  int color_min[3] = {255, 255, 255}, color_max[3] = {0, 0, 0};
+  float mean[3] = {0.0f, 0.0f, 0.0f};
+  for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+    const int color[3] = {pixels[i].x, pixels[i].y, pixels[i].z};
+    for (int c = 0; c < 3; c++) {
+      color_min[c] = min(color_min[c], color[c]);
+      color_max[c] = max(color_max[c], color[c]);
+      mean[c] += color[c] * (1.0f / IMAGE_BLOCK_NUM_PIXELS);
+    }
+  }
+
+  /* Flip the diagonal for red and blue when they are anti-correlated with green. */
+  float covariance_rg = 0.0f, covariance_bg = 0.0f;
+  for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+    const float g = pixels[i].y - mean[1];
+    covariance_rg += (pixels[i].x - mean[0]) * g;
+    covariance_bg += (pixels[i].z - mean[2]) * g;
+  }
+  if (covariance_rg < 0.0f) {
+    swap(color_min[0], color_max[0]);
+  }
+  if (covariance_bg < 0.0f) {
+    swap(color_min[2], color_max[2]);
+  }
+
+  /* Inset the box a little, which lowers the error for the colors inside of it. */
+  for (int c = 0; c < 3; c++) {
+    const int inset = (color_max[c] - color_min[c]) / 16;
+    color_max[c] -= inset;
+    color_min[c] += inset;
+  }
+
+  uint c0 = image_bc_pack_565(color_max);
+  uint c1 = image_bc_pack_565(color_min);
+  *indices = 0;
+
+  if (c0 != c1) {
+    float palette[4][3];
+    image_bc_unpack_565(c0, palette[0]);
+    image_bc_unpack_565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+      palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) * (1.0f / 3.0f);
+      palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) * (1.0f / 3.0f);
+    }
+
+    for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+      const float color[3] = {(float)pixels[i].x, (float)pixels[i].y, (float)pixels[i].z};
+      uint best_index = 0;
+      float best_distance = FLT_MAX;
+      for (uint index = 0; index < 4; index++) {
+        float distance = 0.0f;
+        for (int c = 0; c < 3; c++) {
+          distance += (color[c] - palette[index][c]) * (color[c] - palette[index][c]);
+        }
+        if (distance < best_distance) {
+          best_distance = distance;
+          best_index = index;
+        }
+      }
+      *indices |= best_index << (2 * i);
+    }
+
+    /* The first endpoint must be the larger one for a palette of four colors, swapping the
+     * endpoints swaps the palette colors pairwise. */
+    if (c0 < c1) {
+      swap(c0, c1);
+      *indices ^= 0x55555555;
+    }
+  }
+
+  *colors = c0 | (c1 << 16);
+}
+
+void image_bc_encode_alpha(const uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS], uint *x, uint *y)
+{
+  int alpha_min = 255, alpha_max = 0;
+  for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+    alpha_min = min(alpha_min, (int)pixels[i].w);
+    alpha_max = max(alpha_max, (int)pixels[i].w);
+  }
+
+  /* With the first endpoint the larger one, the palette has the endpoints followed by six
+   * evenly spaced values in between. Opaque blocks keep exactly opaque alpha. */
+  uint64_t indices = 0;
+  if (alpha_max != alpha_min) {
+    const float scale = 7.0f / (alpha_min - alpha_max);
+    for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+      const int step = clamp((int)((pixels[i].w - alpha_max) * scale + 0.5f), 0, 7);
+      const uint64_t index = (step == 0) ? 0 : (step == 7) ? 1 : step + 1;
+      indices |= index << (3 * i);
+    }
+  }
+
+  *x = (uint)alpha_max | ((uint)alpha_min << 8) | ((uint)(indices & 0xFFFF) << 16);
+  *y = (uint)(indices >> 16);
+}
+
+void image_compress_block(const uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS], uint2 *block)
+{
+  image_bc_encode_color(pixels, &block->x, &block->y);
+}
+
+void image_compress_block(const uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS], uint4 *block)
+{
+  image_bc_encode_alpha(pixels, &block->x, &block->y);
+  image_bc_encode_color(pixels, &block->z, &block->w);
+}
+
+void image_missing_block(uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS])
+{
+  for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+    pixels[i] = make_uchar4(TEX_IMAGE_MISSING_R * 255,
+                            TEX_IMAGE_MISSING_G * 255,
+                            TEX_IMAGE_MISSING_B * 255,
+                            TEX_IMAGE_MISSING_A * 255);
+  }
+}
+
+template<typename BlockType>
+void image_compress_blocks(const uchar4 *pixels, size_t width, size_t height, BlockType *blocks)
+{
+  const size_t num_blocks_x = divide_up(width, IMAGE_BLOCK_SIZE);
+  const size_t num_blocks_y = divide_up(height, IMAGE_BLOCK_SIZE);
+
+  for (size_t block_y = 0; block_y < num_blocks_y; block_y++) {
+    for (size_t block_x = 0; block_x < num_blocks_x; block_x++) {
+      /* Pixels past the edge of the image repeat the last row and column. */
+      uchar4 block_pixels[IMAGE_BLOCK_NUM_PIXELS];
+      for (int i = 0; i < IMAGE_BLOCK_NUM_PIXELS; i++) {
+        const size_t x = min(block_x * IMAGE_BLOCK_SIZE + i % IMAGE_BLOCK_SIZE, width - 1);
+        const size_t y = min(block_y * IMAGE_BLOCK_SIZE + i / IMAGE_BLOCK_SIZE, height - 1);
+        block_pixels[i] = pixels[y * width + x];
+      }
+      image_compress_block(block_pixels, &blocks[block_y * num_blocks_x + block_x]);
+    }
+  }
+}
+
 }  // namespace
 
 ImageManager::ImageManager(const DeviceInfo &info)
 {
   need_update = true;
   osl_texture_system = NULL;
+  texture_cache = NULL;
   animation_frame = 0;
 
   /* Set image limits */
   max_num_images = TEX_NUM_MAX;
   has_half_images = info.has_half_images;
+  has_compressed_images = info.has_compressed_images;
+  texture_limit = 0;
+  texture_memory_budget = 0;
 
   for (size_t type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     tex_num_images[type] = 0;
@@ -122,6 +362,12 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+void ImageManager::set_texture_memory_params(int texture_limit_, size_t texture_memory_budget_)
+{
+  texture_limit = texture_limit_;
+  texture_memory_budget = texture_memory_budget_;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -294,6 +540,65 @@ bool ImageManager::get_image_metadata(const string &filename,
   return true;
 }
 
+/* Compression
+ *
+ * Float images are compressed to half float, and 8 bit color images to blocks of 4x4 pixels.
+ * Images which can't be compressed on the device keep their type. With automatic compression,
+ * 8 bit non-color images are not block compressed, see #add_image. */
+
+ImageDataType ImageManager::compressed_type(const ImageMetaData &metadata,
+                                            ImageDataType type,
+                                            ImageAlphaType alpha_type)
+{
+  switch (type) {
+    case IMAGE_DATA_TYPE_FLOAT4:
+      return (has_half_images) ? IMAGE_DATA_TYPE_HALF4 : type;
+    case IMAGE_DATA_TYPE_FLOAT:
+      return (has_half_images) ? IMAGE_DATA_TYPE_HALF : type;
+    case IMAGE_DATA_TYPE_BYTE4: {
+      /* Blocks only cover 2D images with dimensions that are multiples of the block size. */
+      if (!has_compressed_images || metadata.depth > 1) {
+        return type;
+      }
+      size_t width, height, depth;
+      image_scaled_size(metadata, texture_limit, &width, &height, &depth);
+      if (width % IMAGE_BLOCK_SIZE != 0 || height % IMAGE_BLOCK_SIZE != 0) {
+        return type;
+      }
+      const bool has_alpha = metadata.channels != 3 && alpha_type != IMAGE_ALPHA_IGNORE;
+      return (has_alpha) ? IMAGE_DATA_TYPE_BC3 : IMAGE_DATA_TYPE_BC1;
+    }
+    default:
+      return type;
+  }
+}
+
+/* Check if adding an uncompressed image exceeds the memory budget. Images are counted in the
+ * order they are added, so with automatic compression the images added last are compressed
+ * first. */
+bool ImageManager::over_texture_memory_budget(const ImageMetaData &metadata, ImageDataType type)
+{
+  if (texture_memory_budget == 0) {
+    return false;
+  }
+
+  size_t width, height, depth;
+  image_scaled_size(metadata, texture_limit, &width, &height, &depth);
+  size_t memory = image_memory_size(type, width, height, depth);
+
+  for (int image_type = 0; image_type < IMAGE_DATA_NUM_TYPES; image_type++) {
+    foreach (const Image *img, images[image_type]) {
+      if (img == NULL || img->users == 0) {
+        continue;
+      }
+      image_scaled_size(img->metadata, texture_limit, &width, &height, &depth);
+      memory += image_memory_size((ImageDataType)image_type, width, height, depth);
+    }
+  }
+
+  return memory > texture_memory_budget;
+}
+
 static bool image_equals(ImageManager::Image *image,
                          const string &filename,
                          void *builtin_data,
@@ -315,6 +620,7 @@ int ImageManager::add_image(const string &filename,
                             ExtensionType extension,
                             ImageAlphaType alpha_type,
                             ustring colorspace,
+                            ImageCompression compression,
                             ImageMetaData &metadata)
 {
   Image *img;
@@ -335,33 +641,55 @@ int ImageManager::add_image(const string &filename,
     }
   }
 
-  /* Fnd existing image. */
-  for (slot = 0; slot < images[type].size(); slot++) {
-    img = images[type][slot];
-    if (img &&
-        image_equals(
-            img, filename, builtin_data, interpolation, extension, alpha_type, colorspace)) {
-      if (img->frame != frame) {
-        img->frame = frame;
-        img->need_load = true;
-      }
-      if (img->alpha_type != alpha_type) {
-        img->alpha_type = alpha_type;
-        img->need_load = true;
-      }
-      if (img->colorspace != colorspace) {
-        img->colorspace = colorspace;
-        img->need_load = true;
-      }
-      if (!(img->metadata == metadata)) {
-        img->metadata = metadata;
-        img->need_load = true;
+  ImageDataType type_compressed = compressed_type(metadata, type, alpha_type);
+
+  /* Block compression visibly corrupts non-color data like normal or roughness maps,
+   * only do it automatically for color images. */
+  if (compression == IMAGE_COMPRESSION_AUTO && metadata.colorspace == u_colorspace_raw &&
+      (type_compressed == IMAGE_DATA_TYPE_BC1 || type_compressed == IMAGE_DATA_TYPE_BC3)) {
+    type_compressed = type;
+  }
+
+  /* Find existing image, stored with any of the types the compression allows. */
+  const ImageDataType find_types[2] = {
+      (compression == IMAGE_COMPRESSION_COMPRESSED) ? type_compressed : type,
+      (compression == IMAGE_COMPRESSION_NONE) ? type : type_compressed};
+  for (int i = 0; i < 2; i++) {
+    const ImageDataType find_type = find_types[i];
+    for (slot = 0; slot < images[find_type].size(); slot++) {
+      img = images[find_type][slot];
+      if (img &&
+          image_equals(
+              img, filename, builtin_data, interpolation, extension, alpha_type, colorspace)) {
+        if (img->frame != frame) {
+          img->frame = frame;
+          img->need_load = true;
+        }
+        if (img->alpha_type != alpha_type) {
+          img->alpha_type = alpha_type;
+          img->need_load = true;
+        }
+        if (img->colorspace != colorspace) {
+          img->colorspace = colorspace;
+          img->need_load = true;
+        }
+        if (!(img->metadata == metadata)) {
+          img->metadata = metadata;
+          img->need_load = true;
+        }
+        img->users++;
+        return type_index_to_flattened_slot(slot, find_type);
       }
-      img->users++;
-      return type_index_to_flattened_slot(slot, type);
     }
   }
 
+  /* Compress new image as requested, or automatically when it does not fit in memory. */
+  if (compression == IMAGE_COMPRESSION_COMPRESSED ||
+      (compression == IMAGE_COMPRESSION_AUTO && type_compressed != type &&
+       over_texture_memory_budget(metadata, type))) {
+    type = type_compressed;
+  }
+
   /* Find free slot. */
   for (slot = 0; slot < images[type].size(); slot++) {
     if (!images[type][slot])
@@ -403,6 +731,7 @@ int ImageManager::add_image(const string &filename,
   img->alpha_type = alpha_type;
   img->colorspace = colorspace;
   img->mem = NULL;
+  img->is_cached = false;
 
   images[type][slot] = img;
 
@@ -494,7 +823,7 @@ void ImageManager::tag_reload_image(const string &filename,
   }
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -590,6 +919,16 @@ bool ImageManager::file_load_image(Image *img,
 
   bool cmyk = false;
   const size_t num_pixels = ((size_t)width) * height * depth;
+
+  /* Compressed float images are read as float and converted to half, so values out of the half
+   * range are clamped instead of becoming infinite. */
+  const bool half_from_float = (FileFormat == TypeDesc::HALF && img->metadata.is_float &&
+                                !img->metadata.is_half);
+  vector<float> floatpixels;
+  if (half_from_float) {
+    floatpixels.resize(num_pixels * components);
+  }
+
   if (in) {
     /* Read pixels through OpenImageIO. */
     StorageType *readpixels = pixels;
@@ -599,16 +938,23 @@ bool ImageManager::file_load_image(Image *img,
       readpixels = &tmppixels[0];
     }
 
+    const TypeDesc::BASETYPE read_format = (half_from_float) ? TypeDesc::FLOAT : FileFormat;
+    uchar *read_buffer = (half_from_float) ? (uchar *)&floatpixels[0] : (uchar *)readpixels;
     if (depth <= 1) {
-      size_t scanlinesize = ((size_t)width) * components * sizeof(StorageType);
-      in->read_image(FileFormat,
-                     (uchar *)readpixels + (height - 1) * scanlinesize,
+      size_t scanlinesize = ((size_t)width) * components *
+                            ((half_from_float) ? sizeof(float) : sizeof(StorageType));
+      in->read_image(read_format,
+                     read_buffer + (height - 1) * scanlinesize,
                      AutoStride,
                      -scanlinesize,
                      AutoStride);
     }
     else {
-      in->read_image(FileFormat, (uchar *)readpixels);
+      in->read_image(read_format, read_buffer);
+    }
+
+    if (half_from_float) {
+      image_cast_from_float(&floatpixels[0], readpixels, num_pixels * components);
     }
 
     if (components > 4) {
@@ -645,6 +991,16 @@ bool ImageManager::file_load_image(Image *img,
                               image_associate_alpha(img),
                               img->metadata.builtin_free_cache);
     }
+    else if (half_from_float) {
+      builtin_image_float_pixels_cb(img->filename,
+                                    img->builtin_data,
+                                    0,
+                                    &floatpixels[0],
+                                    num_pixels * components,
+                                    image_associate_alpha(img),
+                                    img->metadata.builtin_free_cache);
+      image_cast_from_float(&floatpixels[0], pixels, num_pixels * components);
+    }
     else {
       /* TODO(dingto): Support half for ImBuf. */
     }
@@ -774,6 +1130,153 @@ bool ImageManager::file_load_image(Image *img,
   return true;
 }
 
+template<typename BlockType>
+bool ImageManager::file_load_image_compressed(Device *device,
+                                              Image *img,
+                                              int texture_limit,
+                                              device_vector<BlockType> &tex_img)
+{
+  /* Load the 8 bit pixels on the host only, and compress them into blocks. */
+  device_vector<uchar4> tex_pixels(device, "__tex_image_uncompressed", MEM_READ_ONLY);
+  if (!file_load_image<TypeDesc::UINT8, uchar>(
+          img, IMAGE_DATA_TYPE_BYTE4, texture_limit, tex_pixels)) {
+    return false;
+  }
+
+  const size_t width = tex_pixels.data_width;
+  const size_t height = max(tex_pixels.data_height, (size_t)1);
+
+  BlockType *blocks;
+  {
+    thread_scoped_lock device_lock(device_mutex);
+    blocks = tex_img.alloc(divide_up(width, IMAGE_BLOCK_SIZE),
+                           divide_up(height, IMAGE_BLOCK_SIZE));
+  }
+
+  image_compress_blocks(tex_pixels.data(), width, height, blocks);
+
+  return true;
+}
+
+/* Texture Cache
+ *
+ * On the CPU, file images can be read on demand through the OpenImageIO texture system instead
+ * of being loaded into memory up front. Tiles are loaded as they get accessed, at the mipmap
+ * level matching the texture coordinate differentials, and the least recently used ones are
+ * evicted once the memory budget is exceeded. */
+
+bool ImageManager::texture_cache_supported(Scene *scene)
+{
+  /* OSL reads file images through its own texture system already. */
+  return osl_texture_system == NULL && scene->params.texture_cache_size > 0 &&
+         scene->device->texture_cache_memory() != NULL;
+}
+
+void ImageManager::texture_cache_init(Device *device, Scene *scene)
+{
+  if (!texture_cache_supported(scene)) {
+    texture_cache = NULL;
+    return;
+  }
+
+  const int cache_size = scene->params.texture_cache_size;
+  texture_cache = (TextureCacheGlobals *)device->texture_cache_memory();
+
+  if (texture_cache->texture_system == NULL) {
+    OIIO::TextureSystem *texture_system = OIIO::TextureSystem::create(false);
+    /* Tile and mipmap images which are not stored that way on disk. */
+    texture_system->attribute("autotile", 64);
+    texture_system->attribute("automip", 1);
+    texture_cache->texture_system = texture_system;
+  }
+  texture_cache->texture_system->attribute("max_memory_MB", (float)cache_size);
+}
+
+bool ImageManager::texture_cache_use(const Image *img)
+{
+  if (texture_cache == NULL || img->builtin_data) {
+    return false;
+  }
+
+  /* Pixels are used as stored in the file, so no color space conversion may be needed. sRGB is
+   * converted in the kernel, same as for compressed images. */
+  const ImageMetaData &metadata = img->metadata;
+  if (!(metadata.colorspace == u_colorspace_raw || metadata.colorspace == u_colorspace_srgb)) {
+    return false;
+  }
+
+  switch (metadata.channels) {
+    case 1:
+    case 3:
+      return true;
+    case 4:
+      /* The texture system always associates alpha. */
+      return image_associate_alpha(img);
+    default:
+      return false;
+  }
+}
+
+void ImageManager::texture_cache_load_image(Image *img, int flat_slot)
+{
+  OIIO::TextureSystem *texture_system = texture_cache->texture_system;
+  ustring filename(img->filename);
+
+  /* Make sure a reloaded image is read from disk again. */
+  texture_system->invalidate(filename);
+
+  TextureCacheImage image;
+  image.handle = texture_system->get_texture_handle(filename);
+  image.num_channels = (img->metadata.channels == 1) ? 1 : 4;
+
+  OIIO::TextureOpt &options = image.options;
+  switch (img->interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = OIIO::TextureOpt::InterpClosest;
+      options.mipmode = OIIO::TextureOpt::MipModeOneLevel;
+      break;
+    case INTERPOLATION_CUBIC:
+    case INTERPOLATION_SMART:
+      options.interpmode = OIIO::TextureOpt::InterpBicubic;
+      break;
+    default:
+      options.interpmode = OIIO::TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (img->extension) {
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapClamp;
+      break;
+    case EXTENSION_CLIP:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapBlack;
+      break;
+    default:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapPeriodic;
+      break;
+  }
+
+  /* Opaque alpha for RGB images. */
+  options.fill = 1.0f;
+
+  thread_scoped_lock device_lock(device_mutex);
+  if ((size_t)flat_slot >= texture_cache->images.size()) {
+    texture_cache->images.resize(flat_slot + 1);
+  }
+  texture_cache->images[flat_slot] = image;
+  img->is_cached = true;
+}
+
+void ImageManager::texture_cache_free_image(Image *img, int flat_slot)
+{
+  thread_scoped_lock device_lock(device_mutex);
+  if ((size_t)flat_slot < texture_cache->images.size()) {
+    texture_cache->images[flat_slot] = TextureCacheImage();
+  }
+  texture_cache->texture_system->invalidate(ustring(img->filename));
+  img->is_cached = false;
+}
+
 void ImageManager::device_load_image(
     Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress)
 {
@@ -800,6 +1303,15 @@ void ImageManager::device_load_image(
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->is_cached) {
+    texture_cache_free_image(img, flat_slot);
+  }
+
+  if (texture_cache_use(img)) {
+    texture_cache_load_image(img, flat_slot);
+    img->need_load = false;
+    return;
+  }
 
   /* Create new texture. */
   if (type == IMAGE_DATA_TYPE_FLOAT4) {
@@ -966,6 +1478,46 @@ void ImageManager::device_load_image(
     thread_scoped_lock device_lock(device_mutex);
     tex_img->copy_to_device();
   }
+  else if (type == IMAGE_DATA_TYPE_BC1) {
+    device_vector<uint2> *tex_img = new device_vector<uint2>(
+        device, img->mem_name.c_str(), MEM_TEXTURE);
+
+    if (!file_load_image_compressed(device, img, texture_limit, *tex_img)) {
+      /* on failure to load, we set a 4x4 pixels pink image */
+      uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS];
+      image_missing_block(pixels);
+
+      thread_scoped_lock device_lock(device_mutex);
+      image_compress_block(pixels, tex_img->alloc(1, 1));
+    }
+
+    img->mem = tex_img;
+    img->mem->interpolation = img->interpolation;
+    img->mem->extension = img->extension;
+
+    thread_scoped_lock device_lock(device_mutex);
+    tex_img->copy_to_device();
+  }
+  else if (type == IMAGE_DATA_TYPE_BC3) {
+    device_vector<uint4> *tex_img = new device_vector<uint4>(
+        device, img->mem_name.c_str(), MEM_TEXTURE);
+
+    if (!file_load_image_compressed(device, img, texture_limit, *tex_img)) {
+      /* on failure to load, we set a 4x4 pixels pink image */
+      uchar4 pixels[IMAGE_BLOCK_NUM_PIXELS];
+      image_missing_block(pixels);
+
+      thread_scoped_lock device_lock(device_mutex);
+      image_compress_block(pixels, tex_img->alloc(1, 1));
+    }
+
+    img->mem = tex_img;
+    img->mem->interpolation = img->interpolation;
+    img->mem->extension = img->extension;
+
+    thread_scoped_lock device_lock(device_mutex);
+    tex_img->copy_to_device();
+  }
   img->need_load = false;
 }
 
@@ -974,6 +1526,10 @@ void ImageManager::device_free_image(Device *, ImageDataType type, int slot)
   Image *img = images[type][slot];
 
   if (img) {
+    if (img->is_cached) {
+      texture_cache_free_image(img, type_index_to_flattened_slot(slot, type));
+    }
+
     if (osl_texture_system && !img->builtin_data) {
 #ifdef WITH_OSL
       ustring filename(images[type][slot]->filename);
@@ -998,6 +1554,8 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     return;
   }
 
+  texture_cache_init(device, scene);
+
   TaskPool pool;
   for (int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     for (size_t slot = 0; slot < images[type].size(); slot++) {
@@ -1094,16 +1652,44 @@ void ImageManager::device_free(Device *device)
     }
     images[type].clear();
   }
+
+  if (texture_cache) {
+    OIIO::TextureSystem::destroy(texture_cache->texture_system);
+    texture_cache->texture_system = NULL;
+    texture_cache->images.clear();
+    texture_cache = NULL;
+  }
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
 {
   for (int type = 0; type < IMAGE_DATA_NUM_TYPES; type++) {
     foreach (const Image *image, images[type]) {
+      if (image == NULL || image->mem == NULL) {
+        continue;
+      }
       stats->image.textures.add_entry(
           NamedSizeEntry(path_filename(image->filename), image->mem->memory_size()));
     }
   }
+
+  if (texture_cache) {
+    OIIO::TextureSystem *texture_system = texture_cache->texture_system;
+    TextureCacheStats &cache_stats = stats->texture_cache;
+    long long memory_used = 0, tile_lookups = 0, bytes_read = 0;
+    int tile_misses = 0, tiles_created = 0;
+    texture_system->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+    texture_system->getattribute("stat:find_tile_calls", TypeDesc::INT64, &tile_lookups);
+    texture_system->getattribute("stat:find_tile_cache_misses", TypeDesc::INT, &tile_misses);
+    texture_system->getattribute("stat:tiles_created", TypeDesc::INT, &tiles_created);
+    texture_system->getattribute("stat:bytes_read", TypeDesc::INT64, &bytes_read);
+    cache_stats.memory_used = memory_used;
+    cache_stats.tile_lookups = tile_lookups;
+    cache_stats.tile_misses = tile_misses;
+    cache_stats.tiles_created = tiles_created;
+    cache_stats.bytes_read = bytes_read;
+    stats->has_texture_cache = true;
+  }
 }
 
 CCL_NAMESPACE_END
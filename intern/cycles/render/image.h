@@ -35,6 +35,7 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+struct TextureCacheGlobals;
 
 class ImageMetaData {
  public:
@@ -85,6 +86,7 @@ class ImageManager {
                 ExtensionType extension,
                 ImageAlphaType alpha_type,
                 ustring colorspace,
+                ImageCompression compression,
                 ImageMetaData &metadata);
   void add_image_user(int flat_slot);
   void remove_image(int flat_slot);
@@ -114,6 +116,9 @@ class ImageManager {
   void device_free_builtin(Device *device);
 
   void set_osl_texture_system(void *texture_system);
+  /* Resolution limit and memory budget in bytes, used to decide which images to compress. */
+  void set_texture_memory_params(int texture_limit, size_t texture_memory_budget);
+  bool texture_cache_supported(Scene *scene);
   bool set_animation_frame_update(int frame);
 
   device_memory *image_memory(int flat_slot);
@@ -160,6 +165,8 @@ class ImageManager {
 
     string mem_name;
     device_memory *mem;
+    /* Read on demand through the texture cache, without device memory. */
+    bool is_cached;
 
     int users;
   };
@@ -168,12 +175,16 @@ class ImageManager {
   int tex_num_images[IMAGE_DATA_NUM_TYPES];
   int max_num_images;
   bool has_half_images;
+  bool has_compressed_images;
+  int texture_limit;
+  size_t texture_memory_budget;
 
   thread_mutex device_mutex;
   int animation_frame;
 
   vector<Image *> images[IMAGE_DATA_NUM_TYPES];
   void *osl_texture_system;
+  TextureCacheGlobals *texture_cache;
 
   bool file_load_image_generic(Image *img, unique_ptr<ImageInput> *in);
 
@@ -183,8 +194,24 @@ class ImageManager {
                        int texture_limit,
                        device_vector<DeviceType> &tex_img);
 
+  template<typename BlockType>
+  bool file_load_image_compressed(Device *device,
+                                  Image *img,
+                                  int texture_limit,
+                                  device_vector<BlockType> &tex_img);
+
   void metadata_detect_colorspace(ImageMetaData &metadata, const char *file_format);
 
+  ImageDataType compressed_type(const ImageMetaData &metadata,
+                                ImageDataType type,
+                                ImageAlphaType alpha_type);
+  bool over_texture_memory_budget(const ImageMetaData &metadata, ImageDataType type);
+
+  void texture_cache_init(Device *device, Scene *scene);
+  bool texture_cache_use(const Image *img);
+  void texture_cache_load_image(Image *img, int flat_slot);
+  void texture_cache_free_image(Image *img, int flat_slot);
+
   void device_load_image(
       Device *device, Scene *scene, ImageDataType type, int slot, Progress *progress);
   void device_free_image(Device *device, ImageDataType type, int slot);
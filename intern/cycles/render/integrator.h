@@ -71,9 +71,15 @@ class Integrator : public Node {
   int volume_samples;
   int start_sample;
 
+  /* Adaptive sampling, zero values mean automatic settings derived from aa_samples. */
+  float adaptive_threshold;
+  int adaptive_min_samples;
+
   bool sample_all_lights_direct;
   bool sample_all_lights_indirect;
   float light_sampling_threshold;
+  /* Importance sample lights with a light tree, built by the light manager. */
+  bool use_light_tree;
 
   enum Method {
     BRANCHED_PATH = 0,
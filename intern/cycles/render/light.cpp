@@ -20,12 +20,14 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/light.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
 #include "render/scene.h"
 #include "render/shader.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_path.h"
@@ -230,6 +232,91 @@ void LightManager::disable_ineffective_light(Scene *scene)
   }
 }
 
+static LightTreeEmitter light_tree_lamp_emitter(const Light *light, int distribution_index)
+{
+  LightTreeEmitter emitter;
+  emitter.distribution_index = distribution_index;
+  /* Energy is the emitted power up to a constant factor shared by all emitters. */
+  emitter.energy = average(fabs(light->strength));
+
+  const float3 dir = safe_normalize(light->dir);
+  if (light->type == LIGHT_AREA) {
+    const float3 axisu = light->axisu * (light->sizeu * light->size * 0.5f);
+    const float3 axisv = light->axisv * (light->sizev * light->size * 0.5f);
+    emitter.bbox.grow(light->co - axisu - axisv);
+    emitter.bbox.grow(light->co - axisu + axisv);
+    emitter.bbox.grow(light->co + axisu - axisv);
+    emitter.bbox.grow(light->co + axisu + axisv);
+    emitter.orientation = LightTreeOrientation(dir, 0.0f, M_PI_2_F);
+    emitter.energy *= M_PI_4_F;
+  }
+  else {
+    emitter.bbox.grow(light->co, light->size);
+    if (light->type == LIGHT_SPOT) {
+      emitter.orientation = LightTreeOrientation(
+          dir, 0.0f, min(light->spot_angle * 0.5f, M_PI_2_F));
+    }
+    else {
+      emitter.orientation = LightTreeOrientation::sphere();
+    }
+  }
+
+  if (dir == make_float3(0.0f, 0.0f, 0.0f)) {
+    emitter.orientation = LightTreeOrientation::sphere();
+  }
+
+  return emitter;
+}
+
+static LightTreeEmitter light_tree_triangle_emitter(const Object *object,
+                                                    const Mesh *mesh,
+                                                    const Mesh::Triangle &t,
+                                                    const float3 p[3],
+                                                    float area,
+                                                    float strength,
+                                                    int distribution_index)
+{
+  LightTreeEmitter emitter;
+  emitter.distribution_index = distribution_index;
+  /* Emission is on both sides of the triangle. */
+  emitter.energy = 2.0f * area * strength;
+  emitter.two_sided = true;
+
+  emitter.bbox.grow(p[0]);
+  emitter.bbox.grow(p[1]);
+  emitter.bbox.grow(p[2]);
+  const float3 N = safe_normalize(cross(p[1] - p[0], p[2] - p[0]));
+  emitter.orientation = LightTreeOrientation(N, 0.0f, M_PI_2_F);
+
+  /* With motion blur the triangle is sampled at the time of the ray, so it has to be bounded
+   * over the whole shutter, in any orientation. */
+  const Attribute *attr_mP = mesh->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+  const bool has_vertex_motion = mesh->use_motion_blur && attr_mP;
+  if (object->use_motion()) {
+    emitter.bbox = object->bounds;
+    emitter.orientation = LightTreeOrientation::sphere();
+  }
+  else if (has_vertex_motion) {
+    const float3 *vert_steps = attr_mP->data_float3();
+    const size_t num_verts = mesh->verts.size();
+    for (size_t step = 0; step < mesh->motion_steps - 1; step++) {
+      for (int i = 0; i < 3; i++) {
+        float3 P = vert_steps[step * num_verts + t.v[i]];
+        if (!mesh->transform_applied) {
+          P = transform_point(&object->tfm, P);
+        }
+        emitter.bbox.grow(P);
+      }
+    }
+    emitter.orientation = LightTreeOrientation::sphere();
+  }
+  else if (N == make_float3(0.0f, 0.0f, 0.0f)) {
+    emitter.orientation = LightTreeOrientation::sphere();
+  }
+
+  return emitter;
+}
+
 bool LightManager::object_usable_as_light(Object *object)
 {
   Mesh *mesh = object->mesh;
@@ -269,6 +356,17 @@ void LightManager::device_update_distribution(Device *,
 
   bool background_mis = false;
 
+  /* Light tree, built from the same emitters as the distribution. */
+  const bool use_light_tree = scene->integrator->use_light_tree;
+  vector<LightTreeEmitter> tree_emitters;
+  vector<int> tree_lamp_emitters;
+  vector<int> tree_infinite;
+  vector<uint2> tree_objects;
+  vector<int> tree_triangle_emitters;
+  if (use_light_tree) {
+    tree_objects.resize(scene->objects.size(), make_uint2(LIGHT_TREE_NODE_NONE, 0));
+  }
+
   foreach (Light *light, scene->lights) {
     if (light->is_enabled) {
       num_lights++;
@@ -344,6 +442,22 @@ void LightManager::device_update_distribution(Device *,
     }
 
     size_t mesh_num_triangles = mesh->num_triangles();
+
+    /* Triangles are looked up by the kernel relative to the first triangle of the mesh. */
+    vector<float> shader_strength;
+    if (use_light_tree) {
+      tree_objects[object_id] = make_uint2(tree_triangle_emitters.size(), mesh->tri_offset);
+      tree_triangle_emitters.resize(tree_triangle_emitters.size() + mesh_num_triangles,
+                                    LIGHT_TREE_NODE_NONE);
+
+      /* Emission of shaders which are not constant is unknown, assume unit strength. */
+      foreach (Shader *shader, mesh->used_shaders) {
+        float3 emission;
+        shader_strength.push_back(
+            shader->is_constant_emission(&emission) ? average(fabs(emission)) : 1.0f);
+      }
+    }
+
     for (size_t i = 0; i < mesh_num_triangles; i++) {
       int shader_index = mesh->shader[i];
       Shader *shader = (shader_index < mesh->used_shaders.size()) ?
@@ -351,6 +465,10 @@ void LightManager::device_update_distribution(Device *,
                            scene->default_surface;
 
       if (shader->use_mis && shader->has_surface_emission) {
+        if (use_light_tree) {
+          tree_triangle_emitters[tree_objects[object_id].x + i] = tree_emitters.size();
+        }
+
         distribution[offset].totarea = totarea;
         distribution[offset].prim = i + mesh->tri_offset;
         distribution[offset].mesh_light.shader_flag = shader_flag;
@@ -359,6 +477,13 @@ void LightManager::device_update_distribution(Device *,
 
         Mesh::Triangle t = mesh->get_triangle(i);
         if (!t.valid(&mesh->verts[0])) {
+          if (use_light_tree) {
+            /* Never selected, but every emitter of the distribution needs a leaf. */
+            LightTreeEmitter emitter;
+            emitter.bbox = object->bounds;
+            emitter.distribution_index = offset - 1;
+            tree_emitters.push_back(emitter);
+          }
           continue;
         }
         float3 p1 = mesh->verts[t.v[0]];
@@ -371,7 +496,14 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_light_tree) {
+          const float3 p[3] = {p1, p2, p3};
+          tree_emitters.push_back(light_tree_triangle_emitter(
+              object, mesh, t, p, area, shader_strength[shader_index], offset - 1));
+        }
       }
     }
 
@@ -395,6 +527,17 @@ void LightManager::device_update_distribution(Device *,
     distribution[offset].lamp.size = light->size;
     totarea += lightarea;
 
+    if (use_light_tree) {
+      if (light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+        tree_lamp_emitters.push_back(LIGHT_TREE_NODE_NONE);
+        tree_infinite.push_back(offset);
+      }
+      else {
+        tree_lamp_emitters.push_back(tree_emitters.size());
+        tree_emitters.push_back(light_tree_lamp_emitter(light, offset));
+      }
+    }
+
     if (light->type == LIGHT_DISTANT) {
       use_lamp_mis |= (light->angle > 0.0f && light->use_mis);
     }
@@ -471,6 +614,22 @@ void LightManager::device_update_distribution(Device *,
     /* CDF */
     dscene->light_distribution.copy_to_device();
 
+    /* Light tree */
+    if (use_light_tree) {
+      progress.set_status("Updating Lights", "Building light tree");
+
+      LightTree light_tree(tree_emitters);
+      device_update_light_tree(dscene,
+                               light_tree,
+                               tree_lamp_emitters,
+                               tree_infinite,
+                               tree_objects,
+                               tree_triangle_emitters);
+    }
+    else {
+      device_free_light_tree(dscene);
+    }
+
     /* Portals */
     if (num_portals > 0) {
       kintegrator->portal_offset = light_index;
@@ -485,6 +644,7 @@ void LightManager::device_update_distribution(Device *,
   }
   else {
     dscene->light_distribution.free();
+    device_free_light_tree(dscene);
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
@@ -927,9 +1087,103 @@ void LightManager::device_update(Device *device,
   need_update = false;
 }
 
+void LightManager::device_update_light_tree(DeviceScene *dscene,
+                                            const LightTree &light_tree,
+                                            const vector<int> &lamp_emitters,
+                                            const vector<int> &infinite_lights,
+                                            const vector<uint2> &objects,
+                                            const vector<int> &triangle_emitters)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  const vector<KernelLightTreeNode> &nodes = light_tree.get_nodes();
+  const vector<int> &emitter_nodes = light_tree.get_emitter_nodes();
+
+  VLOG(1) << "Light tree with " << nodes.size() << " nodes and " << infinite_lights.size()
+          << " infinite lights.";
+
+  /* Infinite lights are selected with a fixed probability, as if the tree was one more of them. */
+  const int num_infinite = infinite_lights.size();
+  kintegrator->use_light_tree = true;
+  kintegrator->light_tree_num_nodes = nodes.size();
+  kintegrator->light_tree_num_infinite = num_infinite;
+  kintegrator->light_tree_infinite_pdf = (num_infinite > 0) ?
+                                             (float)num_infinite /
+                                                 (num_infinite + (nodes.empty() ? 0 : 1)) :
+                                             0.0f;
+
+  if (!nodes.empty()) {
+    KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+    std::copy(nodes.begin(), nodes.end(), knodes);
+    dscene->light_tree_nodes.copy_to_device();
+  }
+  else {
+    dscene->light_tree_nodes.free();
+  }
+
+  if (!lamp_emitters.empty()) {
+    uint *klamp_nodes = dscene->light_tree_lamp_nodes.alloc(lamp_emitters.size());
+    for (size_t i = 0; i < lamp_emitters.size(); i++) {
+      const int emitter = lamp_emitters[i];
+      klamp_nodes[i] = (emitter == LIGHT_TREE_NODE_NONE) ? LIGHT_TREE_NODE_NONE :
+                                                           emitter_nodes[emitter];
+    }
+    dscene->light_tree_lamp_nodes.copy_to_device();
+  }
+  else {
+    dscene->light_tree_lamp_nodes.free();
+  }
+
+  if (!infinite_lights.empty()) {
+    uint *kinfinite = dscene->light_tree_infinite.alloc(infinite_lights.size());
+    std::copy(infinite_lights.begin(), infinite_lights.end(), kinfinite);
+    dscene->light_tree_infinite.copy_to_device();
+  }
+  else {
+    dscene->light_tree_infinite.free();
+  }
+
+  if (!objects.empty()) {
+    uint2 *kobjects = dscene->light_tree_objects.alloc(objects.size());
+    std::copy(objects.begin(), objects.end(), kobjects);
+    dscene->light_tree_objects.copy_to_device();
+  }
+  else {
+    dscene->light_tree_objects.free();
+  }
+
+  if (!triangle_emitters.empty()) {
+    uint *ktriangle_nodes = dscene->light_tree_triangle_nodes.alloc(triangle_emitters.size());
+    for (size_t i = 0; i < triangle_emitters.size(); i++) {
+      const int emitter = triangle_emitters[i];
+      ktriangle_nodes[i] = (emitter == LIGHT_TREE_NODE_NONE) ? LIGHT_TREE_NODE_NONE :
+                                                               emitter_nodes[emitter];
+    }
+    dscene->light_tree_triangle_nodes.copy_to_device();
+  }
+  else {
+    dscene->light_tree_triangle_nodes.free();
+  }
+}
+
+void LightManager::device_free_light_tree(DeviceScene *dscene)
+{
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = false;
+  kintegrator->light_tree_num_nodes = 0;
+  kintegrator->light_tree_num_infinite = 0;
+  kintegrator->light_tree_infinite_pdf = 0.0f;
+
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_lamp_nodes.free();
+  dscene->light_tree_infinite.free();
+  dscene->light_tree_objects.free();
+  dscene->light_tree_triangle_nodes.free();
+}
+
 void LightManager::device_free(Device *, DeviceScene *dscene)
 {
   dscene->light_distribution.free();
+  device_free_light_tree(dscene);
   dscene->lights.free();
   dscene->light_background_marginal_cdf.free();
   dscene->light_background_conditional_cdf.free();
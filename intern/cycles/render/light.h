@@ -30,6 +30,7 @@ CCL_NAMESPACE_BEGIN
 
 class Device;
 class DeviceScene;
+class LightTree;
 class Object;
 class Progress;
 class Scene;
@@ -121,6 +122,13 @@ class LightManager {
                                 Scene *scene,
                                 Progress &progress);
   void device_update_ies(DeviceScene *dscene);
+  void device_update_light_tree(DeviceScene *dscene,
+                                const LightTree &light_tree,
+                                const vector<int> &lamp_emitters,
+                                const vector<int> &infinite_lights,
+                                const vector<uint2> &objects,
+                                const vector<int> &triangle_emitters);
+  void device_free_light_tree(DeviceScene *dscene);
 
   /* Check whether light manager can use the object as a light-emissive. */
   bool object_usable_as_light(Object *object);
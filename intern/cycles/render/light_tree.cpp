@@ -0,0 +1,242 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Number of buckets the centroids are binned into when looking for a split. */
+static const int LIGHT_TREE_NUM_BUCKETS = 12;
+
+/* Light Tree Orientation */
+
+LightTreeOrientation LightTreeOrientation::merge(const LightTreeOrientation &a,
+                                                 const LightTreeOrientation &b)
+{
+  /* Make a the wider cone. */
+  if (b.theta_o > a.theta_o) {
+    return merge(b, a);
+  }
+
+  const float theta_e = max(a.theta_e, b.theta_e);
+
+  /* Cone b is already inside of cone a. */
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    return LightTreeOrientation(a.axis, a.theta_o, theta_e);
+  }
+
+  /* Cone spanning both cones, with its axis rotated from a towards b. */
+  const float theta_o = 0.5f * (a.theta_o + theta_d + b.theta_o);
+  if (theta_o >= M_PI_F) {
+    return LightTreeOrientation(a.axis, M_PI_F, theta_e);
+  }
+
+  const float3 rotation_axis = cross(a.axis, b.axis);
+  if (len_squared(rotation_axis) < 1e-12f) {
+    return LightTreeOrientation(a.axis, M_PI_F, theta_e);
+  }
+
+  const float3 axis = rotate_around_axis(a.axis, normalize(rotation_axis), theta_o - a.theta_o);
+  return LightTreeOrientation(normalize(axis), theta_o, theta_e);
+}
+
+float LightTreeOrientation::measure() const
+{
+  /* Integral of the cosine weighted emission over the cone, see "Importance Sampling of Many
+   * Lights with Adaptive Tree Splitting". */
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_theta_o = cosf(theta_o);
+  const float sin_theta_o = sinf(theta_o);
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) -
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+/* Light Tree Bounds */
+
+void LightTree::Bounds::add(const LightTreeEmitter &emitter)
+{
+  bbox.grow(emitter.bbox);
+  orientation = (num_emitters == 0) ?
+                    emitter.orientation :
+                    LightTreeOrientation::merge(orientation, emitter.orientation);
+  two_sided |= emitter.two_sided;
+  energy += emitter.energy;
+  num_emitters++;
+}
+
+void LightTree::Bounds::add(const Bounds &other)
+{
+  if (other.num_emitters == 0) {
+    return;
+  }
+  bbox.grow(other.bbox);
+  orientation = (num_emitters == 0) ? other.orientation :
+                                      LightTreeOrientation::merge(orientation, other.orientation);
+  two_sided |= other.two_sided;
+  energy += other.energy;
+  num_emitters += other.num_emitters;
+}
+
+float LightTree::Bounds::cost(float regularization) const
+{
+  return energy * orientation.measure() * bbox.safe_area() * regularization;
+}
+
+/* Light Tree */
+
+LightTree::LightTree(const vector<LightTreeEmitter> &emitters) : emitters_(emitters)
+{
+  const int num_emitters = emitters_.size();
+  emitter_nodes_.resize(num_emitters, LIGHT_TREE_NODE_NONE);
+  if (num_emitters == 0) {
+    return;
+  }
+
+  order_.resize(num_emitters);
+  for (int i = 0; i < num_emitters; i++) {
+    order_[i] = i;
+  }
+
+  nodes_.reserve(2 * num_emitters - 1);
+  recursive_build(0, num_emitters, -1);
+  order_.clear();
+}
+
+int LightTree::recursive_build(int begin, int end, int parent_index)
+{
+  Bounds bounds;
+  for (int i = begin; i < end; i++) {
+    bounds.add(emitters_[order_[i]]);
+  }
+
+  const int node_index = nodes_.size();
+  nodes_.push_back(KernelLightTreeNode());
+
+  KernelLightTreeNode &knode = nodes_[node_index];
+  knode.bounding_box_min[0] = bounds.bbox.min.x;
+  knode.bounding_box_min[1] = bounds.bbox.min.y;
+  knode.bounding_box_min[2] = bounds.bbox.min.z;
+  knode.bounding_box_max[0] = bounds.bbox.max.x;
+  knode.bounding_box_max[1] = bounds.bbox.max.y;
+  knode.bounding_box_max[2] = bounds.bbox.max.z;
+  knode.energy = bounds.energy;
+  knode.axis[0] = bounds.orientation.axis.x;
+  knode.axis[1] = bounds.orientation.axis.y;
+  knode.axis[2] = bounds.orientation.axis.z;
+  knode.cos_theta_o = cosf(bounds.orientation.theta_o);
+  knode.cos_theta_e = cosf(bounds.orientation.theta_e);
+  knode.parent_index = parent_index;
+  knode.two_sided = bounds.two_sided;
+  knode.pad = 0;
+
+  if (end - begin == 1) {
+    const int emitter_index = order_[begin];
+    knode.child_index = ~emitters_[emitter_index].distribution_index;
+    emitter_nodes_[emitter_index] = node_index;
+    return node_index;
+  }
+
+  const int middle = find_split(begin, end, bounds);
+
+  /* First child directly follows its parent. The node reference is invalidated by the build of
+   * the children, so look it up again. */
+  recursive_build(begin, middle, node_index);
+  const int second_child_index = recursive_build(middle, end, node_index);
+  nodes_[node_index].child_index = second_child_index;
+
+  return node_index;
+}
+
+int LightTree::find_split(int begin, int end, const Bounds &bounds)
+{
+  BoundBox centroid_bbox = BoundBox::empty;
+  for (int i = begin; i < end; i++) {
+    centroid_bbox.grow(emitters_[order_[i]].bbox.center());
+  }
+
+  const float3 centroid_extent = centroid_bbox.size();
+  const float3 extent = bounds.bbox.size();
+  const float max_extent = max3(extent);
+
+  float min_cost = FLT_MAX;
+  int min_dim = -1, min_bucket = 0;
+
+  for (int dim = 0; dim < 3; dim++) {
+    if (centroid_extent[dim] == 0.0f) {
+      continue;
+    }
+
+    Bounds buckets[LIGHT_TREE_NUM_BUCKETS];
+    for (int i = begin; i < end; i++) {
+      const LightTreeEmitter &emitter = emitters_[order_[i]];
+      const float offset = (emitter.bbox.center()[dim] - centroid_bbox.min[dim]) /
+                           centroid_extent[dim];
+      const int bucket = clamp(
+          (int)(offset * LIGHT_TREE_NUM_BUCKETS), 0, LIGHT_TREE_NUM_BUCKETS - 1);
+      buckets[bucket].add(emitter);
+    }
+
+    /* Bounds of all buckets right of every split. */
+    Bounds right[LIGHT_TREE_NUM_BUCKETS];
+    for (int bucket = LIGHT_TREE_NUM_BUCKETS - 1; bucket > 0; bucket--) {
+      right[bucket] = buckets[bucket];
+      if (bucket < LIGHT_TREE_NUM_BUCKETS - 1) {
+        right[bucket].add(right[bucket + 1]);
+      }
+    }
+
+    /* Penalize thin slabs, which are poorly bounded by a cone. */
+    const float regularization = (extent[dim] > 0.0f) ? max_extent / extent[dim] : 1.0f;
+
+    Bounds left;
+    for (int split = 1; split < LIGHT_TREE_NUM_BUCKETS; split++) {
+      left.add(buckets[split - 1]);
+      if (left.num_emitters == 0 || right[split].num_emitters == 0) {
+        continue;
+      }
+      const float cost = left.cost(regularization) + right[split].cost(regularization);
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_dim = dim;
+        min_bucket = split;
+      }
+    }
+  }
+
+  if (min_dim == -1) {
+    /* All centroids coincide, split in the middle. */
+    return (begin + end) / 2;
+  }
+
+  int *middle = std::partition(
+      &order_[0] + begin, &order_[0] + end, [&](const int emitter_index) {
+        const float offset = (emitters_[emitter_index].bbox.center()[min_dim] -
+                              centroid_bbox.min[min_dim]) /
+                             centroid_extent[min_dim];
+        const int bucket = clamp(
+            (int)(offset * LIGHT_TREE_NUM_BUCKETS), 0, LIGHT_TREE_NUM_BUCKETS - 1);
+        return bucket < min_bucket;
+      });
+
+  return middle - &order_[0];
+}
+
+CCL_NAMESPACE_END
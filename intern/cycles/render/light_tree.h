@@ -0,0 +1,119 @@
+/*
+ * Copyright 2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone of emission directions: all emitted light leaves within theta_e of a direction which is at
+ * most theta_o away from the axis. */
+struct LightTreeOrientation {
+  float3 axis;
+  float theta_o;
+  float theta_e;
+
+  LightTreeOrientation() : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(0.0f)
+  {
+  }
+
+  LightTreeOrientation(const float3 &axis, float theta_o, float theta_e)
+      : axis(axis), theta_o(theta_o), theta_e(theta_e)
+  {
+  }
+
+  /* Emission in all directions. */
+  static LightTreeOrientation sphere()
+  {
+    return LightTreeOrientation(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+  }
+
+  /* Smallest cone containing both cones. */
+  static LightTreeOrientation merge(const LightTreeOrientation &a, const LightTreeOrientation &b);
+
+  /* Solid angle measure of the cone, used by the split heuristic. */
+  float measure() const;
+};
+
+/* Emitter of the light distribution as seen by the light tree. */
+struct LightTreeEmitter {
+  BoundBox bbox;
+  LightTreeOrientation orientation;
+  bool two_sided;
+  float energy;
+  /* Index of the emitter in the light distribution. */
+  int distribution_index;
+
+  LightTreeEmitter()
+      : bbox(BoundBox::empty), two_sided(false), energy(0.0f), distribution_index(-1)
+  {
+  }
+};
+
+/* Binary tree over the emitters of the light distribution, with one emitter per leaf.
+ * Nodes are stored in depth first order, which is the layout the kernel traverses. */
+class LightTree {
+ public:
+  explicit LightTree(const vector<LightTreeEmitter> &emitters);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes_;
+  }
+
+  /* Leaf node index of every emitter, in the order the emitters were given. */
+  const vector<int> &get_emitter_nodes() const
+  {
+    return emitter_nodes_;
+  }
+
+ protected:
+  struct Bounds {
+    BoundBox bbox;
+    LightTreeOrientation orientation;
+    bool two_sided;
+    float energy;
+    int num_emitters;
+
+    Bounds() : bbox(BoundBox::empty), two_sided(false), energy(0.0f), num_emitters(0)
+    {
+    }
+
+    void add(const LightTreeEmitter &emitter);
+    void add(const Bounds &other);
+
+    float cost(float regularization) const;
+  };
+
+  int recursive_build(int begin, int end, int parent_index);
+  int find_split(int begin, int end, const Bounds &bounds);
+
+  const vector<LightTreeEmitter> &emitters_;
+  /* Emitter indices, reordered by the build. */
+  vector<int> order_;
+  vector<KernelLightTreeNode> nodes_;
+  vector<int> emitter_nodes_;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
@@ -38,6 +38,7 @@
 #include "util/util_logging.h"
 #include "util/util_progress.h"
 #include "util/util_set.h"
+#include "util/util_time.h"
 
 #ifdef WITH_EMBREE
 #  include "bvh/bvh_embree.h"
@@ -437,6 +438,8 @@ Mesh::Mesh() : Node(node_type)
 
   num_subd_verts = 0;
 
+  compact_bounds = make_float4(0.0f, 0.0f, 0.0f, 1.0f);
+
   attributes.triangle_mesh = this;
   curve_attributes.curve_mesh = this;
   subd_attributes.subd_mesh = this;
@@ -748,6 +751,59 @@ void Mesh::compute_bounds()
   bounds = bnds;
 }
 
+/* Number of steps of the quantization grid along every axis. */
+static const int MESH_COMPACT_GRID_SIZE = 65535;
+
+/* Compact geometry is only intersected by the Cycles BVH traversal, Embree and OptiX read the
+ * uncompressed triangle vertices. */
+static bool mesh_use_compact_geometry(const SceneParams &params, BVHLayout bvh_layout)
+{
+  return params.use_compact_geometry &&
+         (bvh_layout == BVH_LAYOUT_BVH2 || bvh_layout == BVH_LAYOUT_BVH4 ||
+          bvh_layout == BVH_LAYOUT_BVH8);
+}
+
+void Mesh::quantize_verts()
+{
+  BoundBox bnds = BoundBox::empty;
+  size_t verts_size = verts.size();
+
+  for (size_t i = 0; i < verts_size; i++)
+    bnds.grow_safe(verts[i]);
+
+  if (!bnds.valid()) {
+    compact_bounds = make_float4(0.0f, 0.0f, 0.0f, 1.0f);
+    return;
+  }
+
+  /* The grid spacing is a power of two no finer than the float precision at the bounds, so every
+   * grid point is exactly representable and decoding in the kernel gives the same locations the
+   * BVH is built from. */
+  const float max_abs = max3(max(fabs(bnds.min), fabs(bnds.max)));
+  int exponent;
+  frexpf(max_abs, &exponent);
+  float scale = ldexpf(1.0f, exponent - 24);
+
+  const float extent = max3(bnds.size());
+  if (extent > 0.0f) {
+    frexpf(extent / (MESH_COMPACT_GRID_SIZE - 1), &exponent);
+    scale = max(scale, ldexpf(1.0f, exponent));
+  }
+
+  const float3 offset = floor(bnds.min / scale) * scale;
+  compact_bounds = make_float4(offset.x, offset.y, offset.z, scale);
+
+  /* Snap vertices to the grid, so shading and BVH agree with the intersected triangles. */
+  const float3 grid_max = make_float3(
+      MESH_COMPACT_GRID_SIZE, MESH_COMPACT_GRID_SIZE, MESH_COMPACT_GRID_SIZE);
+  for (size_t i = 0; i < verts_size; i++) {
+    const float3 q = clamp(floor((verts[i] - offset) / scale + make_float3(0.5f, 0.5f, 0.5f)),
+                           make_float3(0.0f, 0.0f, 0.0f),
+                           grid_max);
+    verts[i] = offset + q * scale;
+  }
+}
+
 void Mesh::add_face_normals()
 {
   /* don't compute if already there */
@@ -965,16 +1021,121 @@ void Mesh::pack_verts(const vector<uint> &tri_prim_index,
   size_t triangles_size = num_triangles();
 
   for (size_t i = 0; i < triangles_size; i++) {
-    Triangle t = get_triangle(i);
-    tri_vindex[i] = make_uint4(t.v[0] + vert_offset,
-                               t.v[1] + vert_offset,
-                               t.v[2] + vert_offset,
-                               tri_prim_index[i + tri_offset]);
+    /* Vertex indices may be stored compact instead, see pack_vindex_compact(). */
+    if (tri_vindex) {
+      Triangle t = get_triangle(i);
+      tri_vindex[i] = make_uint4(t.v[0] + vert_offset,
+                                 t.v[1] + vert_offset,
+                                 t.v[2] + vert_offset,
+                                 tri_prim_index[i + tri_offset]);
+    }
 
     tri_patch[i] = (!subd_faces.size()) ? -1 : (triangle_patch[i] * 8 + patch_offset);
   }
 }
 
+void Mesh::pack_verts_compact(ushort4 *verts_compact, uint grid_index)
+{
+  const float3 offset = float4_to_float3(compact_bounds);
+  const float inv_scale = 1.0f / compact_bounds.w;
+  const float3 grid_max = make_float3(
+      MESH_COMPACT_GRID_SIZE, MESH_COMPACT_GRID_SIZE, MESH_COMPACT_GRID_SIZE);
+  size_t verts_size = verts.size();
+
+  for (size_t i = 0; i < verts_size; i++) {
+    const float3 q = clamp((verts[i] - offset) * inv_scale + make_float3(0.5f, 0.5f, 0.5f),
+                           make_float3(0.0f, 0.0f, 0.0f),
+                           grid_max);
+    verts_compact[i].x = (uint16_t)q.x;
+    verts_compact[i].y = (uint16_t)q.y;
+    verts_compact[i].z = (uint16_t)q.z;
+    /* Compact vertex indices find the grid through the first vertex of a triangle. */
+    verts_compact[i].w = (uint16_t)grid_index;
+  }
+}
+
+/* Compact vertex indices store the first vertex index of a triangle, and the offsets of the
+ * other two from it as signed 16 bit numbers. Vertices of a triangle are usually close to each
+ * other in the vertex array, so this fits for most meshes. */
+static bool mesh_vindex_offset_fits(int offset)
+{
+  return offset >= -32768 && offset <= 32767;
+}
+
+bool Mesh::can_pack_vindex_compact() const
+{
+  size_t triangles_size = num_triangles();
+
+  for (size_t i = 0; i < triangles_size; i++) {
+    Triangle t = get_triangle(i);
+    if (!mesh_vindex_offset_fits((int)t.v[1] - (int)t.v[0]) ||
+        !mesh_vindex_offset_fits((int)t.v[2] - (int)t.v[0])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Mesh::pack_vindex_compact(uint2 *tri_vindex_compact, size_t vert_offset)
+{
+  size_t triangles_size = num_triangles();
+
+  for (size_t i = 0; i < triangles_size; i++) {
+    Triangle t = get_triangle(i);
+    const uint offset1 = (uint16_t)(int16_t)((int)t.v[1] - (int)t.v[0]);
+    const uint offset2 = (uint16_t)(int16_t)((int)t.v[2] - (int)t.v[0]);
+    tri_vindex_compact[i] = make_uint2(t.v[0] + vert_offset, offset1 | (offset2 << 16));
+  }
+}
+
+/* Octahedral encoding of a unit vector with 16 bits per component, see "A Survey of Efficient
+ * Representations for Independent Unit Vectors". */
+static uint mesh_encode_normal(const float3 N)
+{
+  const float len = fabsf(N.x) + fabsf(N.y) + fabsf(N.z);
+  float x = 0.0f, y = 0.0f;
+
+  if (len > 0.0f) {
+    x = N.x / len;
+    y = N.y / len;
+
+    if (N.z < 0.0f) {
+      const float fold_x = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+      const float fold_y = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+      x = fold_x;
+      y = fold_y;
+    }
+  }
+
+  const uint ex = (uint)clamp((x * 0.5f + 0.5f) * 65535.0f + 0.5f, 0.0f, 65535.0f);
+  const uint ey = (uint)clamp((y * 0.5f + 0.5f) * 65535.0f + 0.5f, 0.0f, 65535.0f);
+  return ex | (ey << 16);
+}
+
+void Mesh::pack_normals_compact(uint *vnormal_compact)
+{
+  Attribute *attr_vN = attributes.find(ATTR_STD_VERTEX_NORMAL);
+  if (attr_vN == NULL) {
+    /* Happens on objects with just hair. */
+    return;
+  }
+
+  bool do_transform = transform_applied;
+  Transform ntfm = transform_normal;
+
+  float3 *vN = attr_vN->data_float3();
+  size_t verts_size = verts.size();
+
+  for (size_t i = 0; i < verts_size; i++) {
+    float3 vNi = vN[i];
+
+    if (do_transform)
+      vNi = safe_normalize(transform_direction(&ntfm, vNi));
+
+    vnormal_compact[i] = mesh_encode_normal(vNi);
+  }
+}
+
 void Mesh::pack_curves(Scene *scene,
                        float4 *curve_key_co,
                        float4 *curve_data,
@@ -1060,10 +1221,15 @@ void Mesh::compute_bvh(
   if (progress->get_cancel())
     return;
 
-  compute_bounds();
-
   const BVHLayout bvh_layout = BVHParams::best_bvh_layout(params->bvh_layout,
                                                           device->get_bvh_layout_mask());
+  const bool use_compact_geometry = mesh_use_compact_geometry(*params, bvh_layout);
+  if (use_compact_geometry) {
+    quantize_verts();
+  }
+
+  compute_bounds();
+
   if (need_build_bvh(bvh_layout)) {
     string msg = "Updating Mesh BVH ";
     if (name.empty())
@@ -1079,15 +1245,20 @@ void Mesh::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
-    if (bvh && !need_update_rebuild) {
+    bool need_build = (bvh == NULL) || need_update_rebuild;
+
+    if (!need_build) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->meshes = meshes;
       bvh->objects = objects;
 
-      bvh->refit(*progress);
+      /* Refitting keeps the topology of the previous build, rebuild once it degraded too much
+       * for the deformed mesh. */
+      need_build = !bvh->refit(*progress);
     }
-    else {
+
+    if (need_build) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
@@ -1098,6 +1269,7 @@ void Mesh::compute_bvh(
       bparams.num_motion_triangle_steps = params->num_bvh_time_steps;
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
+      bparams.use_compact_geometry = use_compact_geometry;
       bparams.curve_flags = dscene->data.curve.curveflags;
       bparams.curve_subdivisions = dscene->data.curve.subdivisions;
 
@@ -1204,6 +1376,10 @@ MeshManager::MeshManager()
 {
   need_update = true;
   need_flags_update = true;
+  object_bvh_build_time = 0.0;
+  scene_bvh_build_time = 0.0;
+  use_compact_geometry = false;
+  triangle_memory = 0;
 }
 
 MeshManager::~MeshManager()
@@ -1855,9 +2031,39 @@ void MeshManager::device_update_mesh(
     }
   }
 
+  /* Compact geometry needs the BVH of the final render. */
+  const bool use_compact_geometry = !for_displacement &&
+                                    mesh_use_compact_geometry(
+                                        scene->params, (BVHLayout)dscene->data.bvh.bvh_layout);
+  dscene->data.bvh.use_compact_geometry = use_compact_geometry;
+
+  /* Compact vertex indices need the grid index to fit in the 16 bits left in the compact
+   * vertices, and the vertex offsets of all triangles to fit in 16 bits. */
+  bool use_compact_indices = use_compact_geometry && scene->meshes.size() <= 65536;
+  if (use_compact_indices) {
+    foreach (Mesh *mesh, scene->meshes) {
+      if (!mesh->can_pack_vindex_compact()) {
+        use_compact_indices = false;
+        break;
+      }
+    }
+  }
+  dscene->data.bvh.use_compact_indices = use_compact_indices;
+
   /* Create mapping from triangle to primitive triangle array. */
   vector<uint> tri_prim_index(tri_size);
-  if (for_displacement) {
+  if (use_compact_geometry) {
+    /* Compact triangles have no primitive triangle array, refer to the quantization grid of
+     * their mesh instead. */
+    size_t mesh_index = 0;
+    foreach (Mesh *mesh, scene->meshes) {
+      for (size_t i = 0; i < mesh->num_triangles(); ++i) {
+        tri_prim_index[i + mesh->tri_offset] = mesh_index;
+      }
+      mesh_index++;
+    }
+  }
+  else if (for_displacement) {
     /* For displacement kernels we do some trickery to make them believe
      * we've got all required data ready. However, that data is different
      * from final render kernels since we don't have BVH yet, so can't
@@ -1883,16 +2089,46 @@ void MeshManager::device_update_mesh(
     progress.set_status("Updating Mesh", "Computing normals");
 
     uint *tri_shader = dscene->tri_shader.alloc(tri_size);
-    float4 *vnormal = dscene->tri_vnormal.alloc(vert_size);
-    uint4 *tri_vindex = dscene->tri_vindex.alloc(tri_size);
+    uint4 *tri_vindex = NULL;
+    uint2 *tri_vindex_compact = NULL;
+    if (use_compact_indices) {
+      tri_vindex_compact = dscene->tri_vindex_compact.alloc(tri_size);
+    }
+    else {
+      tri_vindex = dscene->tri_vindex.alloc(tri_size);
+    }
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
+    float4 *vnormal = NULL;
+    ushort4 *verts_compact = NULL;
+    float4 *verts_compact_bounds = NULL;
+    uint *vnormal_compact = NULL;
+    if (use_compact_geometry) {
+      verts_compact = dscene->tri_verts_compact.alloc(vert_size);
+      verts_compact_bounds = dscene->tri_verts_compact_bounds.alloc(scene->meshes.size());
+      vnormal_compact = dscene->tri_vnormal_compact.alloc(vert_size);
+    }
+    else {
+      vnormal = dscene->tri_vnormal.alloc(vert_size);
+    }
+
+    size_t mesh_index = 0;
     foreach (Mesh *mesh, scene->meshes) {
       mesh->pack_shaders(scene, &tri_shader[mesh->tri_offset]);
-      mesh->pack_normals(&vnormal[mesh->vert_offset]);
+      if (use_compact_geometry) {
+        mesh->pack_verts_compact(&verts_compact[mesh->vert_offset], mesh_index);
+        mesh->pack_normals_compact(&vnormal_compact[mesh->vert_offset]);
+        verts_compact_bounds[mesh_index++] = mesh->compact_bounds;
+      }
+      else {
+        mesh->pack_normals(&vnormal[mesh->vert_offset]);
+      }
+      if (use_compact_indices) {
+        mesh->pack_vindex_compact(&tri_vindex_compact[mesh->tri_offset], mesh->vert_offset);
+      }
       mesh->pack_verts(tri_prim_index,
-                       &tri_vindex[mesh->tri_offset],
+                       (tri_vindex) ? &tri_vindex[mesh->tri_offset] : NULL,
                        &tri_patch[mesh->tri_offset],
                        &tri_patch_uv[mesh->vert_offset],
                        mesh->vert_offset,
@@ -1905,8 +2141,20 @@ void MeshManager::device_update_mesh(
     progress.set_status("Updating Mesh", "Copying Mesh to device");
 
     dscene->tri_shader.copy_to_device();
-    dscene->tri_vnormal.copy_to_device();
-    dscene->tri_vindex.copy_to_device();
+    if (use_compact_geometry) {
+      dscene->tri_verts_compact.copy_to_device();
+      dscene->tri_verts_compact_bounds.copy_to_device();
+      dscene->tri_vnormal_compact.copy_to_device();
+    }
+    else {
+      dscene->tri_vnormal.copy_to_device();
+    }
+    if (use_compact_indices) {
+      dscene->tri_vindex_compact.copy_to_device();
+    }
+    else {
+      dscene->tri_vindex.copy_to_device();
+    }
     dscene->tri_patch.copy_to_device();
     dscene->tri_patch_uv.copy_to_device();
   }
@@ -1986,6 +2234,7 @@ void MeshManager::device_update_bvh(Device *device,
   bparams.num_motion_triangle_steps = scene->params.num_bvh_time_steps;
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
+  bparams.use_compact_geometry = mesh_use_compact_geometry(scene->params, bparams.bvh_layout);
   bparams.curve_flags = dscene->data.curve.curveflags;
   bparams.curve_subdivisions = dscene->data.curve.subdivisions;
 
@@ -2031,7 +2280,7 @@ void MeshManager::device_update_bvh(Device *device,
     dscene->object_node.steal_data(pack.object_node);
     dscene->object_node.copy_to_device();
   }
-  if (pack.prim_tri_index.size()) {
+  if (pack.prim_tri_index.size() && !bparams.use_compact_geometry) {
     dscene->prim_tri_index.steal_data(pack.prim_tri_index);
     dscene->prim_tri_index.copy_to_device();
   }
@@ -2306,6 +2555,7 @@ void MeshManager::device_update(Device *device,
 
   TaskPool pool;
 
+  double bvh_start_time = time_dt();
   size_t i = 0;
   foreach (Mesh *mesh, scene->meshes) {
     if (mesh->need_update) {
@@ -2319,6 +2569,7 @@ void MeshManager::device_update(Device *device,
 
   TaskPool::Summary summary;
   pool.wait_work(&summary);
+  object_bvh_build_time = time_dt() - bvh_start_time;
   VLOG(2) << "Objects BVH build pool statistics:\n" << summary.full_report();
 
   foreach (Shader *shader, scene->shaders) {
@@ -2337,7 +2588,9 @@ void MeshManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
+  bvh_start_time = time_dt();
   device_update_bvh(device, dscene, scene, progress);
+  scene_bvh_build_time = time_dt() - bvh_start_time;
   if (progress.get_cancel())
     return;
 
@@ -2345,6 +2598,14 @@ void MeshManager::device_update(Device *device,
   if (progress.get_cancel())
     return;
 
+  use_compact_geometry = dscene->data.bvh.use_compact_geometry;
+  triangle_memory = dscene->prim_tri_verts.memory_size() +
+                    dscene->prim_tri_index.memory_size() + dscene->tri_vnormal.memory_size() +
+                    dscene->tri_verts_compact.memory_size() +
+                    dscene->tri_verts_compact_bounds.memory_size() +
+                    dscene->tri_vnormal_compact.memory_size() + dscene->tri_vindex.memory_size() +
+                    dscene->tri_vindex_compact.memory_size();
+
   need_update = false;
 
   if (true_displacement_used) {
@@ -2375,6 +2636,10 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
   dscene->tri_vindex.free();
   dscene->tri_patch.free();
   dscene->tri_patch_uv.free();
+  dscene->tri_verts_compact.free();
+  dscene->tri_verts_compact_bounds.free();
+  dscene->tri_vnormal_compact.free();
+  dscene->tri_vindex_compact.free();
   dscene->curves.free();
   dscene->curve_keys.free();
   dscene->patches.free();
@@ -2386,6 +2651,8 @@ void MeshManager::device_free(Device *device, DeviceScene *dscene)
 
   /* Signal for shaders like displacement not to do ray tracing. */
   dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
+  dscene->data.bvh.use_compact_geometry = false;
+  dscene->data.bvh.use_compact_indices = false;
 
 #ifdef WITH_OSL
   OSLGlobals *og = (OSLGlobals *)device->osl_memory();
@@ -2412,6 +2679,10 @@ void MeshManager::collect_statistics(const Scene *scene, RenderStats *stats)
     stats->mesh.geometry.add_entry(
         NamedSizeEntry(string(mesh->name.c_str()), mesh->get_total_size_in_bytes()));
   }
+  stats->mesh.object_bvh_build_time = object_bvh_build_time;
+  stats->mesh.scene_bvh_build_time = scene_bvh_build_time;
+  stats->mesh.use_compact_geometry = use_compact_geometry;
+  stats->mesh.triangle_memory = triangle_memory;
 }
 
 bool Mesh::need_attribute(Scene *scene, AttributeStandard std)
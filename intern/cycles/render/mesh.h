@@ -284,6 +284,10 @@ class Mesh : public Node {
 
   size_t num_subd_verts;
 
+  /* Quantization grid of the vertices for compact geometry, offset in xyz and the grid spacing
+   * in w. */
+  float4 compact_bounds;
+
  private:
   unordered_map<int, int> vert_to_stitching_key_map; /* real vert index -> stitching index */
   unordered_multimap<int, int>
@@ -311,6 +315,7 @@ class Mesh : public Node {
   void add_subd_face(int *corners, int num_corners, int shader_, bool smooth_);
 
   void compute_bounds();
+  void quantize_verts();
   void add_face_normals();
   void add_vertex_normals();
   void add_undisplaced();
@@ -325,6 +330,10 @@ class Mesh : public Node {
                   float2 *tri_patch_uv,
                   size_t vert_offset,
                   size_t tri_offset);
+  void pack_verts_compact(ushort4 *verts_compact, uint grid_index);
+  void pack_normals_compact(uint *vnormal_compact);
+  bool can_pack_vindex_compact() const;
+  void pack_vindex_compact(uint2 *tri_vindex_compact, size_t vert_offset);
   void pack_curves(Scene *scene, float4 *curve_key_co, float4 *curve_data, size_t curvekey_offset);
   void pack_patches(uint *patch_data, uint vert_offset, uint face_offset, uint corner_offset);
 
@@ -373,6 +382,14 @@ class MeshManager {
   bool need_update;
   bool need_flags_update;
 
+  /* Time in seconds spent building the object and scene BVHs in the last update. */
+  double object_bvh_build_time;
+  double scene_bvh_build_time;
+
+  /* Device memory used by triangle vertices, normals and vertex indices, for statistics. */
+  bool use_compact_geometry;
+  size_t triangle_memory;
+
   MeshManager();
   ~MeshManager();
 
@@ -256,6 +256,12 @@ NODE_DEFINE(ImageTextureNode)
   extension_enum.insert("black", EXTENSION_CLIP);
   SOCKET_ENUM(extension, "Extension", extension_enum, EXTENSION_REPEAT);
 
+  static NodeEnum compression_enum;
+  compression_enum.insert("auto", IMAGE_COMPRESSION_AUTO);
+  compression_enum.insert("none", IMAGE_COMPRESSION_NONE);
+  compression_enum.insert("compressed", IMAGE_COMPRESSION_COMPRESSED);
+  SOCKET_ENUM(compression, "Compression", compression_enum, IMAGE_COMPRESSION_AUTO);
+
   static NodeEnum projection_enum;
   projection_enum.insert("flat", NODE_IMAGE_PROJ_FLAT);
   projection_enum.insert("box", NODE_IMAGE_PROJ_BOX);
@@ -365,6 +371,27 @@ void ImageTextureNode::attributes(Shader *shader, AttributeRequestSet *attribute
   ShaderNode::attributes(shader, attributes);
 }
 
+/* UV map which is directly used as texture coordinate. Its differentials select the mipmap
+ * level of images read through the texture cache. */
+static bool image_texture_uv_map(ShaderInput *vector_in, ustring *attribute)
+{
+  if (!vector_in->link) {
+    return false;
+  }
+
+  ShaderNode *node = vector_in->link->parent;
+  if (node->type == UVMapNode::node_type) {
+    UVMapNode *uvmap = (UVMapNode *)node;
+    *attribute = uvmap->attribute;
+    return !uvmap->from_dupli;
+  }
+  else if (node->type == TextureCoordinateNode::node_type) {
+    TextureCoordinateNode *texco = (TextureCoordinateNode *)node;
+    return vector_in->link == node->output("UV") && !texco->from_dupli;
+  }
+  return false;
+}
+
 void ImageTextureNode::compile(SVMCompiler &compiler)
 {
   ShaderInput *vector_in = input("Vector");
@@ -390,6 +417,7 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                           extension,
                                           alpha_type,
                                           colorspace,
+                                          compression,
                                           metadata);
       slots.push_back(slot);
 
@@ -428,6 +456,16 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       }
     }
 
+    /* Texture coordinate differentials, only known for an untransformed UV map. */
+    int uv_attr = ATTR_STD_NOT_FOUND;
+    ustring uv_map;
+    if (projection == NODE_IMAGE_PROJ_FLAT && tex_mapping.skip() &&
+        image_texture_uv_map(vector_in, &uv_map) &&
+        image_manager->texture_cache_supported(compiler.scene)) {
+      uv_attr = (uv_map != "") ? compiler.attribute(uv_map) : compiler.attribute(ATTR_STD_UV);
+      flags |= NODE_IMAGE_UV_DIFFERENTIALS;
+    }
+
     if (projection != NODE_IMAGE_PROJ_BOX) {
       /* If there only is one image (a very common case), we encode it as a negative value. */
       int num_nodes;
@@ -446,6 +484,10 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
                                                flags),
                         projection);
 
+      if (flags & NODE_IMAGE_UV_DIFFERENTIALS) {
+        compiler.add_node(uv_attr, 0, 0, 0);
+      }
+
       if (num_nodes > 0) {
         for (int i = 0; i < num_nodes; i++) {
           int4 node;
@@ -514,6 +556,7 @@ void ImageTextureNode::compile(OSLCompiler &compiler)
                                           extension,
                                           alpha_type,
                                           colorspace,
+                                          compression,
                                           metadata);
       slots.push_back(slot);
     }
@@ -574,6 +617,12 @@ NODE_DEFINE(EnvironmentTextureNode)
   interpolation_enum.insert("smart", INTERPOLATION_SMART);
   SOCKET_ENUM(interpolation, "Interpolation", interpolation_enum, INTERPOLATION_LINEAR);
 
+  static NodeEnum compression_enum;
+  compression_enum.insert("auto", IMAGE_COMPRESSION_AUTO);
+  compression_enum.insert("none", IMAGE_COMPRESSION_NONE);
+  compression_enum.insert("compressed", IMAGE_COMPRESSION_COMPRESSED);
+  SOCKET_ENUM(compression, "Compression", compression_enum, IMAGE_COMPRESSION_AUTO);
+
   static NodeEnum projection_enum;
   projection_enum.insert("equirectangular", NODE_ENVIRONMENT_EQUIRECTANGULAR);
   projection_enum.insert("mirror_ball", NODE_ENVIRONMENT_MIRROR_BALL);
@@ -632,6 +681,7 @@ void EnvironmentTextureNode::compile(SVMCompiler &compiler)
                                         EXTENSION_REPEAT,
                                         alpha_type,
                                         colorspace,
+                                        compression,
                                         metadata);
     slots.push_back(slot);
     is_float = metadata.is_float;
@@ -694,6 +744,7 @@ void EnvironmentTextureNode::compile(OSLCompiler &compiler)
                                           EXTENSION_REPEAT,
                                           alpha_type,
                                           colorspace,
+                                          compression,
                                           metadata);
       slots.push_back(slot);
     }
@@ -1770,6 +1821,7 @@ void PointDensityTextureNode::add_image()
                                     EXTENSION_CLIP,
                                     IMAGE_ALPHA_AUTO,
                                     u_colorspace_raw,
+                                    IMAGE_COMPRESSION_AUTO,
                                     metadata);
   }
 }
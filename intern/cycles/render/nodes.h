@@ -110,6 +110,7 @@ class ImageTextureNode : public ImageSlotTextureNode {
   NodeImageProjection projection;
   InterpolationType interpolation;
   ExtensionType extension;
+  ImageCompression compression;
   float projection_blend;
   bool animated;
   float3 vector;
@@ -152,6 +153,7 @@ class EnvironmentTextureNode : public ImageSlotTextureNode {
   ImageAlphaType alpha_type;
   NodeEnvironmentProjection projection;
   InterpolationType interpolation;
+  ImageCompression compression;
   bool animated;
   float3 vector;
 
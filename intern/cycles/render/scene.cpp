@@ -56,6 +56,10 @@ DeviceScene::DeviceScene(Device *device)
       tri_vindex(device, "__tri_vindex", MEM_TEXTURE),
       tri_patch(device, "__tri_patch", MEM_TEXTURE),
       tri_patch_uv(device, "__tri_patch_uv", MEM_TEXTURE),
+      tri_verts_compact(device, "__tri_verts_compact", MEM_TEXTURE),
+      tri_verts_compact_bounds(device, "__tri_verts_compact_bounds", MEM_TEXTURE),
+      tri_vnormal_compact(device, "__tri_vnormal_compact", MEM_TEXTURE),
+      tri_vindex_compact(device, "__tri_vindex_compact", MEM_TEXTURE),
       curves(device, "__curves", MEM_TEXTURE),
       curve_keys(device, "__curve_keys", MEM_TEXTURE),
       patches(device, "__patches", MEM_TEXTURE),
@@ -73,6 +77,11 @@ DeviceScene::DeviceScene(Device *device)
       lights(device, "__lights", MEM_TEXTURE),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_TEXTURE),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_TEXTURE),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_TEXTURE),
+      light_tree_lamp_nodes(device, "__light_tree_lamp_nodes", MEM_TEXTURE),
+      light_tree_infinite(device, "__light_tree_infinite", MEM_TEXTURE),
+      light_tree_objects(device, "__light_tree_objects", MEM_TEXTURE),
+      light_tree_triangle_nodes(device, "__light_tree_triangle_nodes", MEM_TEXTURE),
       particles(device, "__particles", MEM_TEXTURE),
       svm_nodes(device, "__svm_nodes", MEM_TEXTURE),
       shaders(device, "__shaders", MEM_TEXTURE),
@@ -98,6 +107,8 @@ Scene::Scene(const SceneParams &params_, Device *device)
   object_manager = new ObjectManager();
   integrator = new Integrator();
   image_manager = new ImageManager(device->info);
+  image_manager->set_texture_memory_params(params.texture_limit,
+                                           (size_t)params.texture_memory_budget * 1024 * 1024);
   particle_system_manager = new ParticleSystemManager();
   curve_system_manager = new CurveSystemManager();
   bake_manager = new BakeManager();
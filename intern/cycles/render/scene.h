@@ -80,6 +80,10 @@ class DeviceScene {
   device_vector<uint4> tri_vindex;
   device_vector<uint> tri_patch;
   device_vector<float2> tri_patch_uv;
+  device_vector<ushort4> tri_verts_compact;
+  device_vector<float4> tri_verts_compact_bounds;
+  device_vector<uint> tri_vnormal_compact;
+  device_vector<uint2> tri_vindex_compact;
 
   device_vector<float4> curves;
   device_vector<float4> curve_keys;
@@ -107,6 +111,11 @@ class DeviceScene {
   device_vector<KernelLight> lights;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<uint> light_tree_lamp_nodes;
+  device_vector<uint> light_tree_infinite;
+  device_vector<uint2> light_tree_objects;
+  device_vector<uint> light_tree_triangle_nodes;
 
   /* particles */
   device_vector<KernelParticle> particles;
@@ -167,8 +176,15 @@ class SceneParams {
   bool use_bvh_spatial_split;
   bool use_bvh_unaligned_nodes;
   int num_bvh_time_steps;
+  /* Store triangle vertices and normals quantized, trading precision for memory. */
+  bool use_compact_geometry;
   bool persistent_data;
   int texture_limit;
+  /* Memory budget of the texture cache in megabytes, zero loads all images into memory. */
+  int texture_cache_size;
+  /* Memory budget of image textures in megabytes, images over it are compressed. Zero only
+   * compresses images that request it. */
+  int texture_memory_budget;
 
   bool background;
 
@@ -180,8 +196,11 @@ class SceneParams {
     use_bvh_spatial_split = false;
     use_bvh_unaligned_nodes = true;
     num_bvh_time_steps = 0;
+    use_compact_geometry = false;
     persistent_data = false;
     texture_limit = 0;
+    texture_cache_size = 0;
+    texture_memory_budget = 0;
     background = true;
   }
 
@@ -192,7 +211,10 @@ class SceneParams {
              use_bvh_spatial_split == params.use_bvh_spatial_split &&
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             use_compact_geometry == params.use_compact_geometry &&
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size &&
+             texture_memory_budget == params.texture_memory_budget);
   }
 };
 
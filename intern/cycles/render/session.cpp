@@ -400,6 +400,7 @@ bool Session::acquire_tile(Device *tile_device, RenderTile &rtile)
   rtile.resolution = tile_manager.state.resolution_divider;
   rtile.tile_index = tile->index;
   rtile.task = (tile->state == Tile::DENOISE) ? RenderTile::DENOISE : RenderTile::PATH_TRACE;
+  rtile.saved_samples = 0;
 
   tile_lock.unlock();
 
@@ -465,6 +466,11 @@ void Session::release_tile(RenderTile &rtile)
 
   progress.add_finished_tile(rtile.task == RenderTile::DENOISE);
 
+  if (params.adaptive_sampling && rtile.task == RenderTile::PATH_TRACE) {
+    sampling_stats.total_samples += (uint64_t)rtile.w * rtile.h * rtile.num_samples;
+    sampling_stats.saved_samples += rtile.saved_samples;
+  }
+
   bool delete_tile;
 
   if (tile_manager.finish_tile(rtile.tile_index, delete_tile)) {
@@ -819,6 +825,7 @@ void Session::reset_(BufferParams &buffer_params, int samples)
 
   tile_manager.reset(buffer_params, samples);
   progress.reset_sample();
+  sampling_stats = SamplingStats();
 
   bool show_progress = params.background || tile_manager.get_num_effective_samples() != INT_MAX;
   progress.set_total_pixel_samples(show_progress ? tile_manager.state.total_pixel_samples : 0);
@@ -976,7 +983,7 @@ void Session::update_status_time(bool show_pause, bool show_done)
        */
       substatus += string_printf(", Sample %d/%d", progress.get_current_sample(), num_samples);
     }
-    if (params.full_denoising || params.optix_denoising) {
+    if (params.full_denoising || params.optix_denoising || params.oidn_denoising) {
       substatus += string_printf(", Denoised %d tiles", progress.get_denoised_tiles());
     }
     else if (params.run_denoising) {
@@ -1037,6 +1044,7 @@ void Session::render()
     task.denoising_from_render = true;
     task.denoising_do_filter = params.full_denoising;
     task.denoising_use_optix = params.optix_denoising;
+    task.denoising_use_oidn = params.oidn_denoising;
     task.denoising_write_passes = params.write_denoising_passes;
   }
 
@@ -1126,6 +1134,11 @@ void Session::device_free()
 void Session::collect_statistics(RenderStats *render_stats)
 {
   scene->collect_statistics(render_stats);
+  if (params.adaptive_sampling) {
+    thread_scoped_lock tile_lock(tile_mutex);
+    render_stats->has_adaptive_sampling = true;
+    render_stats->sampling = sampling_stats;
+  }
   if (params.use_profiling && (params.device.type == DEVICE_CPU)) {
     render_stats->collect_profiling(scene, profiler);
   }
@@ -64,8 +64,11 @@ class SessionParams {
   bool write_denoising_passes;
   bool full_denoising;
   bool optix_denoising;
+  bool oidn_denoising;
   DenoiseParams denoising;
 
+  bool adaptive_sampling;
+
   double cancel_timeout;
   double reset_timeout;
   double text_timeout;
@@ -94,6 +97,9 @@ class SessionParams {
     write_denoising_passes = false;
     full_denoising = false;
     optix_denoising = false;
+    oidn_denoising = false;
+
+    adaptive_sampling = false;
 
     display_buffer_linear = false;
 
@@ -214,6 +220,9 @@ class Session {
   thread_mutex buffers_mutex;
   thread_mutex display_mutex;
 
+  /* Accumulated from released tiles, protected by tile_mutex. */
+  SamplingStats sampling_stats;
+
   bool kernels_loaded;
   DeviceRequestedFeatures loaded_kernel_features;
 
@@ -199,14 +199,29 @@ string NamedSampleCountStats::full_report(int indent_level)
 /* Mesh statistics. */
 
 MeshStats::MeshStats()
+    : object_bvh_build_time(0.0),
+      scene_bvh_build_time(0.0),
+      use_compact_geometry(false),
+      triangle_memory(0)
 {
 }
 
 string MeshStats::full_report(int indent_level)
 {
   const string indent(indent_level * kIndentNumSpaces, ' ');
+  const string next_indent((indent_level + 1) * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Geometry:\n" + geometry.full_report(indent_level + 1);
+  result += indent + "BVH build time:\n";
+  result += next_indent + string_printf("%-32s: %.3fs\n", "Objects", object_bvh_build_time);
+  result += next_indent + string_printf("%-32s: %.3fs\n", "Scene", scene_bvh_build_time);
+  result += indent + "Triangle storage:\n";
+  result += next_indent + string_printf("%-32s: %s\n",
+                                        "Compact geometry",
+                                        use_compact_geometry ? "yes" : "no");
+  result += next_indent + string_printf("%-32s: %s\n",
+                                        "Vertices and normals",
+                                        string_human_readable_size(triangle_memory).c_str());
   return result;
 }
 
@@ -224,11 +239,76 @@ string ImageStats::full_report(int indent_level)
   return result;
 }
 
+/* Texture cache statistics. */
+
+TextureCacheStats::TextureCacheStats()
+    : memory_used(0), tile_lookups(0), tile_misses(0), tiles_created(0), bytes_read(0)
+{
+}
+
+string TextureCacheStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const double hit_percent = (tile_lookups != 0) ?
+                                 100.0 * (double)(tile_lookups - tile_misses) /
+                                     (double)tile_lookups :
+                                 0.0;
+  string result = "";
+  result += indent + string_printf("%-32s: %s\n",
+                                   "Memory used",
+                                   string_human_readable_size(memory_used).c_str());
+  result += indent + string_printf("%-32s: %llu\n",
+                                   "Tile lookups",
+                                   (unsigned long long)tile_lookups);
+  result += indent + string_printf("%-32s: %llu (%.2f%%)\n",
+                                   "Tile hits",
+                                   (unsigned long long)(tile_lookups - tile_misses),
+                                   hit_percent);
+  result += indent + string_printf("%-32s: %llu\n",
+                                   "Tile misses",
+                                   (unsigned long long)tile_misses);
+  result += indent + string_printf("%-32s: %llu\n",
+                                   "Tiles loaded",
+                                   (unsigned long long)tiles_created);
+  result += indent + string_printf("%-32s: %s\n",
+                                   "Bytes read",
+                                   string_human_readable_size(bytes_read).c_str());
+  return result;
+}
+
+/* Sampling statistics. */
+
+SamplingStats::SamplingStats() : total_samples(0), saved_samples(0)
+{
+}
+
+string SamplingStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const double saved_percent = (total_samples != 0) ?
+                                   100.0 * (double)saved_samples / (double)total_samples :
+                                   0.0;
+  string result = "";
+  result += indent + string_printf("%-32s: %llu\n",
+                                   "Total pixel samples",
+                                   (unsigned long long)total_samples);
+  result += indent + string_printf("%-32s: %llu\n",
+                                   "Rendered pixel samples",
+                                   (unsigned long long)(total_samples - saved_samples));
+  result += indent + string_printf("%-32s: %llu (%.2f%%)\n",
+                                   "Saved pixel samples",
+                                   (unsigned long long)saved_samples,
+                                   saved_percent);
+  return result;
+}
+
 /* Overall statistics. */
 
 RenderStats::RenderStats()
 {
   has_profiling = false;
+  has_adaptive_sampling = false;
+  has_texture_cache = false;
 }
 
 void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
@@ -284,6 +364,8 @@ void RenderStats::collect_profiling(Scene *scene, Profiler &prof)
   prefilter.add_entry("Detect Outliers", prof.get_event(PROFILING_DENOISING_DETECT_OUTLIERS));
   prefilter.add_entry("Combine Halves", prof.get_event(PROFILING_DENOISING_COMBINE_HALVES));
 
+  denoising.add_entry("OpenImageDenoise", prof.get_event(PROFILING_DENOISING_OIDN));
+
   shaders.entries.clear();
   foreach (Shader *shader, scene->shaders) {
     uint64_t samples, hits;
@@ -306,6 +388,12 @@ string RenderStats::full_report()
   string result = "";
   result += "Mesh statistics:\n" + mesh.full_report(1);
   result += "Image statistics:\n" + image.full_report(1);
+  if (has_texture_cache) {
+    result += "Texture cache statistics:\n" + texture_cache.full_report(1);
+  }
+  if (has_adaptive_sampling) {
+    result += "Sampling statistics:\n" + sampling.full_report(1);
+  }
   if (has_profiling) {
     result += "Kernel statistics:\n" + kernel.full_report(1);
     result += "Shader statistics:\n" + shaders.full_report(1);
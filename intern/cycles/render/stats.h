@@ -122,6 +122,14 @@ class MeshStats {
    * memory like BVH.
    */
   NamedSizeStats geometry;
+
+  /* Time in seconds spent building the BVHs of individual objects and of the scene. */
+  double object_bvh_build_time;
+  double scene_bvh_build_time;
+
+  /* Device memory used by triangle vertices and normals, and whether they are quantized. */
+  bool use_compact_geometry;
+  size_t triangle_memory;
 };
 
 /* Statistics about images held in memory. */
@@ -135,6 +143,37 @@ class ImageStats {
   NamedSizeStats textures;
 };
 
+/* Statistics of the texture cache, for images which are read on demand. */
+class TextureCacheStats {
+ public:
+  TextureCacheStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Memory used by tiles held in the cache. */
+  uint64_t memory_used;
+  /* Number of tile lookups, and how many of them had to read the tile from disk. */
+  uint64_t tile_lookups;
+  uint64_t tile_misses;
+  uint64_t tiles_created;
+  uint64_t bytes_read;
+};
+
+/* Statistics of adaptive sampling. */
+class SamplingStats {
+ public:
+  SamplingStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Number of pixel samples which were requested for all rendered tiles. */
+  uint64_t total_samples;
+  /* Number of pixel samples which were skipped by adaptive sampling. */
+  uint64_t saved_samples;
+};
+
 /* Render process statistics. */
 class RenderStats {
  public:
@@ -147,9 +186,13 @@ class RenderStats {
   void collect_profiling(Scene *scene, Profiler &prof);
 
   bool has_profiling;
+  bool has_adaptive_sampling;
+  bool has_texture_cache;
 
   MeshStats mesh;
   ImageStats image;
+  TextureCacheStats texture_cache;
+  SamplingStats sampling;
   NamedNestedSampleStats kernel;
   NamedSampleCountStats shaders;
   NamedSampleCountStats objects;
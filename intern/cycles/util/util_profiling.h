@@ -61,6 +61,7 @@ enum ProfilingEvent : uint32_t {
   PROFILING_DENOISING_COMBINE_HALVES,
   PROFILING_DENOISING_GET_FEATURE,
   PROFILING_DENOISING_DETECT_OUTLIERS,
+  PROFILING_DENOISING_OIDN,
 
   PROFILING_NUM_EVENTS,
 };
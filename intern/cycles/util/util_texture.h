@@ -55,10 +55,26 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_HALF = 5,
   IMAGE_DATA_TYPE_USHORT4 = 6,
   IMAGE_DATA_TYPE_USHORT = 7,
+  IMAGE_DATA_TYPE_BC1 = 8,
+  IMAGE_DATA_TYPE_BC3 = 9,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
 
+/* Block compressed images store 4x4 pixel blocks, with the image dimensions in blocks.
+ *
+ * BC1 blocks are stored as uint2, for opaque 8 bit RGB images:
+ *   x: two RGB565 color endpoints, the first one in the lower 16 bits.
+ *   y: 2 bit palette index of every pixel, the first pixel in the lowest bits.
+ * Endpoints are always ordered so the palette has four colors.
+ *
+ * BC3 blocks are stored as uint4, for 8 bit RGBA images:
+ *   x: two 8 bit alpha endpoints in the lower 16 bits, then the first 16 bits of the alpha
+ *      indices.
+ *   y: remaining 32 bits of the 3 bit alpha index of every pixel.
+ *   z, w: color block, same as BC1. */
+#define IMAGE_BLOCK_SIZE 4
+
 /* Alpha types
  * How to treat alpha in images. */
 typedef enum ImageAlphaType {
@@ -71,8 +87,22 @@ typedef enum ImageAlphaType {
   IMAGE_ALPHA_NUM_TYPES,
 } ImageAlphaType;
 
-#define IMAGE_DATA_TYPE_SHIFT 3
-#define IMAGE_DATA_TYPE_MASK 0x7
+/* Compression types
+ * How to store images in memory. */
+typedef enum ImageCompression {
+  /* Compress when the scene is over the texture memory budget,
+   * except 8 bit non-color images which are never block compressed. */
+  IMAGE_COMPRESSION_AUTO = 0,
+  /* Store with the precision of the image file. */
+  IMAGE_COMPRESSION_NONE = 1,
+  /* Store float images as half float, and 8 bit color images block compressed. */
+  IMAGE_COMPRESSION_COMPRESSED = 2,
+
+  IMAGE_COMPRESSION_NUM_TYPES,
+} ImageCompression;
+
+#define IMAGE_DATA_TYPE_SHIFT 4
+#define IMAGE_DATA_TYPE_MASK 0xF
 
 /* Extension types for textures.
  *
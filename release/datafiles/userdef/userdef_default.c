@@ -131,6 +131,8 @@ const UserDef U_default = {
 
     .prefetchframes = 0,
     .pad_rot_angle = 15,
+    /** Clamped by half the systems memory. */
+    .compositor_cache_limit = 1024,
     .rvisize = 25,
     .rvibright = 8,
     .recent_files = 10,
@@ -193,6 +195,9 @@ const UserDef U_default = {
     .render_display_type = USER_RENDER_DISPLAY_WINDOW,
     .filebrowser_display_type = USER_TEMP_SPACE_DISPLAY_WINDOW,
     .viewport_aa = 8,
+    .sequencer_disk_cache_dir = "",
+    .sequencer_disk_cache_size_limit = 100,
+    .sequencer_disk_cache_compression = USER_SEQ_DISK_CACHE_COMPRESSION_LOW,
 
     .walk_navigation =
         {
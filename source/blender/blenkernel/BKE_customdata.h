@@ -73,6 +73,10 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /** Share data of all layers with the source, freed with its last user (copy and merge only).
+   * Shared data is not to be modified, use #CustomData_duplicate_referenced_layer() to get an
+   * own copy of a layer before writing to it. */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -217,7 +221,8 @@ bool CustomData_has_layer(const struct CustomData *data, int type);
 int CustomData_number_of_layers(const struct CustomData *data, int type);
 int CustomData_number_of_layers_typemask(const struct CustomData *data, CustomDataMask mask);
 
-/* duplicate data of a layer with flag NOFREE, and remove that flag.
+/* duplicate data of a layer with flag NOFREE, and remove that flag,
+ * or of a layer sharing its data with other layers (see CD_SHARE), so it can be modified.
  * returns the layer data */
 void *CustomData_duplicate_referenced_layer(struct CustomData *data,
                                             const int type,
@@ -111,6 +111,12 @@ enum {
   /** Support simulating events (for testing). */
   G_FLAG_EVENT_SIMULATE = (1 << 3),
   G_FLAG_USERPREF_NO_SAVE_ON_EXIT = (1 << 4),
+  /** Defer reading linked data-blocks until the depsgraph needs them. */
+  G_FLAG_LIB_DEFERRED_LOAD = (1 << 5),
+  /** Evaluate depsgraph operations on the longest estimated chain first. */
+  G_FLAG_DEPSGRAPH_PRIORITY_SCHEDULING = (1 << 6),
+  /** Only rebuild relations of data-blocks tagged for relations update. */
+  G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS = (1 << 7),
 
   G_FLAG_SCRIPT_AUTOEXEC = (1 << 13),
   /** When this flag is set ignore the prefs #USER_SCRIPT_AUTOEXEC_DISABLE. */
@@ -122,7 +128,8 @@ enum {
 /** Don't overwrite these flags when reading a file. */
 #define G_FLAG_ALL_RUNTIME \
   (G_FLAG_SCRIPT_AUTOEXEC | G_FLAG_SCRIPT_OVERRIDE_PREF | G_FLAG_EVENT_SIMULATE | \
-   G_FLAG_USERPREF_NO_SAVE_ON_EXIT)
+   G_FLAG_USERPREF_NO_SAVE_ON_EXIT | G_FLAG_LIB_DEFERRED_LOAD | \
+   G_FLAG_DEPSGRAPH_PRIORITY_SCHEDULING | G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS)
 
 /** Flags to read from blend file. */
 #define G_FLAG_ALL_READFILE 0
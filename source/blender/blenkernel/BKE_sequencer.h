@@ -283,6 +283,7 @@ void BKE_sequence_reload_new_file(struct Main *bmain,
                                   const bool lock_range);
 int BKE_sequencer_evaluate_frame(struct Scene *scene, int cfra);
 
+float BKE_sequencer_give_stripelem_index(struct Sequence *seq, float cfra);
 struct StripElem *BKE_sequencer_give_stripelem(struct Sequence *seq, int cfra);
 
 /* intern */
@@ -345,6 +346,8 @@ void BKE_sequencer_cache_iterate(
     void *userdata,
     bool callback(void *userdata, struct Sequence *seq, int cfra, int cache_type, float cost));
 bool BKE_sequencer_cache_is_full(struct Scene *scene);
+void BKE_sequencer_cache_disk_free(void);
+void BKE_sequencer_cache_disk_size_limit_set(size_t size_limit);
 
 /* **********************************************************************
  * seqprefetch.c
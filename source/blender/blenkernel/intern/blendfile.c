@@ -364,6 +364,10 @@ static void setup_app_data(bContext *C,
     /* TODO(sergey): Can this be also move above? */
     RE_FreeAllPersistentData();
   }
+  else {
+    /* Render engines are kept on undo, but not the evaluated data they reference. */
+    RE_FreeAllPersistentDepsgraphs();
+  }
 
   if (mode == LOAD_UNDO) {
     /* In undo/redo case, we do a whole lot of magic tricks to avoid having to re-read linked
@@ -604,6 +608,8 @@ UserDef *BKE_blendfile_userdef_from_defaults(void)
 
   userdef->memcachelimit = min_ii(BLI_system_memory_max_in_megabytes_int() / 2,
                                   userdef->memcachelimit);
+  userdef->compositor_cache_limit = min_ii(BLI_system_memory_max_in_megabytes_int() / 2,
+                                           userdef->compositor_cache_limit);
 
   /* Init weight paint range. */
   BKE_colorband_init(&userdef->coba_weight, true);
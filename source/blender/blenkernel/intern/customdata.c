@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -1811,6 +1813,90 @@ void customData_mask_layers__print(const CustomData_MeshMasks *mask)
   }
 }
 
+/********************* Shared layer data *********************/
+
+/**
+ * Layer data shared between layers of several custom data (like a mesh and its evaluated copy),
+ * see #CD_SHARE. The data is owned by all its users, and freed with the last one.
+ */
+typedef struct CustomDataSharing {
+  int users;
+} CustomDataSharing;
+
+static void *customData_duplicate_layer_data(int type, const void *data, const int totelem)
+{
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->copy) {
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(data, dst_data, totelem);
+    return dst_data;
+  }
+  return MEM_dupallocN(data);
+}
+
+static void customData_free_layer_data(int type, void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+  MEM_freeN(data);
+}
+
+/* Add a user to the data of the layer, the layer itself becomes a user when it's not shared yet.
+ * Several dependency graphs can copy the same layer at the same time. */
+static CustomDataSharing *customData_layer_share(CustomDataLayer *layer)
+{
+  CustomDataSharing *sharing = layer->sharing;
+  if (sharing == NULL) {
+    CustomDataSharing *sharing_new = MEM_mallocN(sizeof(*sharing_new), __func__);
+    sharing_new->users = 1;
+    sharing = atomic_cas_ptr((void **)&layer->sharing, NULL, sharing_new);
+    if (sharing == NULL) {
+      sharing = sharing_new;
+    }
+    else {
+      MEM_freeN(sharing_new);
+    }
+  }
+  atomic_add_and_fetch_int32(&sharing->users, 1);
+  return sharing;
+}
+
+/* Remove the layer from the users of its data, returns true when it was the last user, the data
+ * is to be freed then. */
+static bool customData_layer_unshare(CustomDataLayer *layer)
+{
+  CustomDataSharing *sharing = layer->sharing;
+  layer->sharing = NULL;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) != 0) {
+    return false;
+  }
+  MEM_freeN(sharing);
+  return true;
+}
+
+/* Make the data of a shared layer owned by the layer only, so it can be modified. */
+static void customData_layer_unshare_for_write(CustomDataLayer *layer, const int totelem)
+{
+  void *data = layer->data;
+  if (atomic_add_and_fetch_int32(&layer->sharing->users, 0) == 1) {
+    customData_layer_unshare(layer);
+    return;
+  }
+  layer->data = customData_duplicate_layer_data(layer->type, data, totelem);
+  if (customData_layer_unshare(layer)) {
+    /* Other users were freed in the meantime. */
+    customData_free_layer_data(layer->type, data, totelem);
+  }
+}
+
 /********************* CustomData functions *********************/
 static void customData_update_offsets(CustomData *data);
 
@@ -1899,6 +1985,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -1910,8 +1997,26 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      /* Data not owned by the source, or read from an external file, is copied. */
+      if (data == NULL || (flag & (CD_FLAG_NOFREE | CD_FLAG_EXTERNAL))) {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_DUPLICATE, data, totelem, layer->name);
+      }
+      else {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_ASSIGN, data, totelem, layer->name);
+        if (newlayer && newlayer->data == data) {
+          newlayer->sharing = customData_layer_share((CustomDataLayer *)layer);
+        }
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      if (newlayer && alloctype == CD_ASSIGN && newlayer->data == data) {
+        /* The data keeps its users, the source layer is not freed. */
+        newlayer->sharing = layer->sharing;
+      }
     }
 
     if (newlayer) {
@@ -1941,6 +2046,10 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing) {
+      customData_layer_unshare_for_write(layer,
+                                         (int)(MEM_allocN_len(layer->data) / typeInfo->size));
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -1962,18 +2071,12 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
+    if (layer->sharing && !customData_layer_unshare(layer)) {
+      /* Still in use by other layers. */
+      return;
     }
+    customData_free_layer_data(layer->type, layer->data, totelem);
   }
 }
 
@@ -2362,6 +2465,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2548,24 +2652,12 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
   layer = &data->layers[layer_index];
 
   if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
+    layer->data = customData_duplicate_layer_data(layer->type, layer->data, totelem);
     layer->flag &= ~CD_FLAG_NOFREE;
   }
+  else if (layer->sharing) {
+    customData_layer_unshare_for_write(layer, totelem);
+  }
 
   return layer->data;
 }
@@ -2619,7 +2711,7 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return (layer->flag & CD_FLAG_NOFREE) != 0 || layer->sharing != NULL;
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -4054,7 +4146,9 @@ void CustomData_file_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      /* Sharing is runtime only. */
+      write_layers[j++].sharing = NULL;
     }
   }
   BLI_assert(j == data->totlayer);
@@ -21,21 +21,35 @@
  */
 
 #include <stddef.h>
+#include <stdlib.h>
 #include <memory.h>
 
+#include "zlib.h"
+
 #include "MEM_guardedalloc.h"
 
+#include "DNA_color_types.h"
 #include "DNA_sequence_types.h"
 #include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+#include "DNA_vfont_types.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
 #include "BLI_mempool.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_listbase.h"
 #include "BLI_ghash.h"
+#include "BLI_utildefines.h"
 
+#include "BKE_appdir.h"
 #include "BKE_sequencer.h"
 #include "BKE_scene.h"
 #include "BKE_main.h"
@@ -63,6 +77,21 @@
  * entries one by one in reverse order to their creation.
  *
  * User can exclude caching of some images. Such entries will have is_temp_cache set.
+ *
+ * Disk cache:
+ * When enabled with #SEQ_CACHE_DISK_CACHE_ENABLE, permanent entries are also written to
+ * compressed files in the disk cache directory, which is shared by all files and sessions.
+ * Files are named after a hash of the content of the image: the render settings and the strips
+ * it has been rendered from, including the modification times of their source files. So files
+ * are found again after reloading the blend-file and editing a strip simply creates new files.
+ *
+ * Images are written by a background task pool, without blocking rendering. Images not found
+ * in memory are read from disk by the thread rendering them, so the prefetch job loads them
+ * ahead of playback. Images read from disk are put into the memory cache like rendered ones.
+ *
+ * Strips rendering other data-blocks (scenes, movie clips, masks) are not disk cached, their
+ * content can't be hashed. The size of the directory is limited by the preferences, least
+ * recently used files are removed first.
  */
 
 typedef struct SeqCache {
@@ -72,6 +101,10 @@ typedef struct SeqCache {
   struct BLI_mempool *items_pool;
   struct SeqCacheKey *last_key;
   size_t memory_used;
+  /* Disk cache keys of the images looked up or stored, see #seq_disk_cache_key_get. */
+  struct GSet *disk_keys;
+  /* Incremented when the keys are forgotten. */
+  int disk_keys_generation;
 } SeqCache;
 
 typedef struct SeqCacheItem {
@@ -440,6 +473,7 @@ static void BKE_sequencer_cache_create(Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
+    cache->disk_keys = BLI_gset_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache disk keys");
     cache->last_key = NULL;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -447,6 +481,1027 @@ static void BKE_sequencer_cache_create(Scene *scene)
   BLI_mutex_unlock(&cache_create_lock);
 }
 
+/* ************************** Disk cache ************************** */
+
+/* Bump when the file format or the content hash change, so old files are not used anymore. */
+#define DCACHE_VERSION 2
+#define DCACHE_MAGIC "BSDC"
+#define DCACHE_FNAME_EXT ".dcf"
+/* Length of the hexadecimal key in file names. */
+#define DCACHE_FNAME_KEY_LEN 16
+/* Used in the temporary directory when no directory is set in the preferences. */
+#define DCACHE_DIRNAME "blender_sequencer_cache"
+/* Fraction of the memory cache limit images waiting to be written can take, more images are not
+ * written until these are done. */
+#define DCACHE_PENDING_WRITES_FRACTION 4
+/* Nesting of meta strips, effect inputs and masks followed by the content hash. */
+#define DCACHE_MAX_HASH_DEPTH 32
+/* Size of the blocks images are compressed and decompressed in. */
+#define DCACHE_IO_CHUNK_SIZE (64 * 1024 * 1024)
+
+/* SeqDiskCacheHeader.image_flag */
+#define DCACHE_IMAGE_RECT (1 << 0)
+#define DCACHE_IMAGE_FLOAT (1 << 1)
+
+/* Hash of the content of an image, see #seq_disk_cache_key. */
+typedef uint64_t SeqDiskCacheKey;
+/* Key of images which can't be disk cached. */
+#define DCACHE_KEY_NONE 0
+/* Number of remembered keys and source file stats, they are forgotten all at once beyond it. */
+#define DCACHE_MAX_MEMOS 65536
+
+/* Disk cache key of an image, looked up like the memory cache items. */
+typedef struct SeqDiskCacheKeyMemo {
+  /* Only the sequence, render data, frame and type are set. */
+  SeqCacheKey key;
+  SeqDiskCacheKey disk_key;
+} SeqDiskCacheKeyMemo;
+
+typedef struct SeqDiskCacheFileStat {
+  bool exists;
+  int64_t mtime;
+  int64_t size;
+} SeqDiskCacheFileStat;
+
+typedef struct SeqDiskCacheFile {
+  struct SeqDiskCacheFile *next, *prev;
+  SeqDiskCacheKey key;
+  uint64_t size;
+  int64_t mtime;
+  /* File is being written, it can't be read or removed yet. */
+  bool is_writing;
+} SeqDiskCacheFile;
+
+typedef struct SeqDiskCache {
+  /* Absolute path of the directory the files are in. */
+  char dir[FILE_MAX];
+  /* Files in the directory, least recently used first. */
+  ListBase files;
+  struct GHash *files_by_key;
+  uint64_t size_total;
+  struct TaskPool *write_pool;
+  /* Memory used by the images waiting to be written. */
+  size_t pending_size;
+} SeqDiskCache;
+
+typedef struct SeqDiskCacheHeader {
+  char magic[4];
+  int version;
+  SeqDiskCacheKey key;
+  int x, y;
+  int planes;
+  int image_flag;
+  /* Alpha mode of the image. */
+  int ibuf_flags;
+  float cost;
+  char rect_colorspace[64];
+  char float_colorspace[64];
+} SeqDiskCacheHeader;
+
+typedef struct SeqDiskCacheWriteTask {
+  char dir[FILE_MAX];
+  SeqDiskCacheKey key;
+  ImBuf *ibuf;
+  size_t ibuf_size;
+  float cost;
+  int compression_level;
+} SeqDiskCacheWriteTask;
+
+static SeqDiskCache *disk_cache = NULL;
+static ThreadMutex disk_cache_lock = BLI_MUTEX_INITIALIZER;
+/* Stats of the source files by path, see #seq_disk_cache_hash_path.
+ * Uses disk_cache_lock, it's independent from the cache directory. */
+static struct GHash *disk_cache_file_stats = NULL;
+/* Size limit in bytes overriding the preferences when not 0. */
+static size_t disk_cache_size_limit_override = 0;
+
+/* Content hash, 64 bit FNV-1a. */
+
+static void seq_disk_cache_hash_add(SeqDiskCacheKey *hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = data;
+  for (size_t i = 0; i < size; i++) {
+    *hash = (*hash ^ bytes[i]) * 1099511628211ULL;
+  }
+}
+
+static void seq_disk_cache_hash_int(SeqDiskCacheKey *hash, int value)
+{
+  seq_disk_cache_hash_add(hash, &value, sizeof(value));
+}
+
+static void seq_disk_cache_hash_float(SeqDiskCacheKey *hash, float value)
+{
+  seq_disk_cache_hash_add(hash, &value, sizeof(value));
+}
+
+static void seq_disk_cache_hash_str(SeqDiskCacheKey *hash, const char *str)
+{
+  seq_disk_cache_hash_add(hash, str, strlen(str) + 1);
+}
+
+/* Stat of a source file, remembered until the sequencer cache is invalidated like the images
+ * read from the file, so the same movie file is not checked on every frame. */
+static SeqDiskCacheFileStat seq_disk_cache_file_stat(const char *path)
+{
+  SeqDiskCacheFileStat file_stat = {false};
+
+  BLI_mutex_lock(&disk_cache_lock);
+  const SeqDiskCacheFileStat *stored = (disk_cache_file_stats != NULL) ?
+                                           BLI_ghash_lookup(disk_cache_file_stats, path) :
+                                           NULL;
+  if (stored != NULL) {
+    file_stat = *stored;
+  }
+  BLI_mutex_unlock(&disk_cache_lock);
+
+  if (stored != NULL) {
+    return file_stat;
+  }
+
+  BLI_stat_t st;
+  if (BLI_stat(path, &st) == 0) {
+    file_stat.exists = true;
+    file_stat.mtime = (int64_t)st.st_mtime;
+    file_stat.size = (int64_t)st.st_size;
+  }
+
+  BLI_mutex_lock(&disk_cache_lock);
+  if (disk_cache_file_stats == NULL) {
+    disk_cache_file_stats = BLI_ghash_str_new("SeqDiskCache file stats");
+  }
+  else if (BLI_ghash_len(disk_cache_file_stats) >= DCACHE_MAX_MEMOS) {
+    BLI_ghash_clear(disk_cache_file_stats, MEM_freeN, MEM_freeN);
+  }
+  if (!BLI_ghash_haskey(disk_cache_file_stats, path)) {
+    SeqDiskCacheFileStat *stored_new = MEM_mallocN(sizeof(*stored_new), __func__);
+    *stored_new = file_stat;
+    BLI_ghash_insert(disk_cache_file_stats, BLI_strdup(path), stored_new);
+  }
+  BLI_mutex_unlock(&disk_cache_lock);
+
+  return file_stat;
+}
+
+static void seq_disk_cache_file_stats_clear(void)
+{
+  BLI_mutex_lock(&disk_cache_lock);
+  if (disk_cache_file_stats != NULL) {
+    BLI_ghash_clear(disk_cache_file_stats, MEM_freeN, MEM_freeN);
+  }
+  BLI_mutex_unlock(&disk_cache_lock);
+}
+
+/* Source files are identified by their absolute path, modification time and size. */
+static void seq_disk_cache_hash_path(SeqDiskCacheKey *hash, const char *path)
+{
+  const SeqDiskCacheFileStat file_stat = seq_disk_cache_file_stat(path);
+
+  seq_disk_cache_hash_str(hash, path);
+
+  if (file_stat.exists) {
+    seq_disk_cache_hash_add(hash, &file_stat.mtime, sizeof(file_stat.mtime));
+    seq_disk_cache_hash_add(hash, &file_stat.size, sizeof(file_stat.size));
+  }
+}
+
+static void seq_disk_cache_hash_file(SeqDiskCacheKey *hash, const char *dir, const char *name)
+{
+  char path[FILE_MAX];
+
+  BLI_join_dirfile(path, sizeof(path), dir, name);
+  BLI_path_abs(path, BKE_main_blendfile_path_from_global());
+  seq_disk_cache_hash_path(hash, path);
+}
+
+/* Fonts are hashed by their file, the data-block and the loaded font only exist at runtime. */
+static void seq_disk_cache_hash_text(SeqDiskCacheKey *hash, const TextVars *data)
+{
+  seq_disk_cache_hash_str(hash, data->text);
+
+  if (data->text_font) {
+    char path[FILE_MAX];
+    STRNCPY(path, data->text_font->name);
+    BLI_path_abs(path, ID_BLEND_PATH_FROM_GLOBAL(&data->text_font->id));
+    seq_disk_cache_hash_path(hash, path);
+  }
+  else {
+    seq_disk_cache_hash_str(hash, "");
+  }
+
+  seq_disk_cache_hash_int(hash, data->text_size);
+  seq_disk_cache_hash_add(hash, data->color, sizeof(data->color));
+  seq_disk_cache_hash_add(hash, data->shadow_color, sizeof(data->shadow_color));
+  seq_disk_cache_hash_add(hash, data->loc, sizeof(data->loc));
+  seq_disk_cache_hash_float(hash, data->wrap_width);
+  seq_disk_cache_hash_int(hash, data->flag);
+  seq_disk_cache_hash_int(hash, data->align);
+  seq_disk_cache_hash_int(hash, data->align_y);
+}
+
+static void seq_disk_cache_hash_curve_mapping(SeqDiskCacheKey *hash, const CurveMapping *cumap)
+{
+  seq_disk_cache_hash_int(hash, cumap->flag);
+  seq_disk_cache_hash_add(hash, &cumap->clipr, sizeof(cumap->clipr));
+  seq_disk_cache_hash_add(hash, cumap->black, sizeof(cumap->black));
+  seq_disk_cache_hash_add(hash, cumap->white, sizeof(cumap->white));
+  seq_disk_cache_hash_int(hash, cumap->tone);
+
+  for (int i = 0; i < CM_TOT; i++) {
+    const CurveMap *cuma = &cumap->cm[i];
+    seq_disk_cache_hash_int(hash, cuma->totpoint);
+    seq_disk_cache_hash_add(hash, cuma->ext_in, sizeof(cuma->ext_in));
+    seq_disk_cache_hash_add(hash, cuma->ext_out, sizeof(cuma->ext_out));
+
+    for (int a = 0; a < cuma->totpoint; a++) {
+      const CurveMapPoint *cmp = &cuma->curve[a];
+      seq_disk_cache_hash_float(hash, cmp->x);
+      seq_disk_cache_hash_float(hash, cmp->y);
+      /* Selection doesn't change the curve. */
+      seq_disk_cache_hash_int(hash, cmp->flag & ~CUMA_SELECT);
+    }
+  }
+}
+
+static bool seq_disk_cache_hash_strip(SeqDiskCacheKey *hash,
+                                      ListBase *seqbase_top,
+                                      ListBase *seqbase,
+                                      Sequence *seq,
+                                      float cfra,
+                                      int depth);
+
+/* Strips up to a channel at a frame, which are blended with the strips above them. */
+static bool seq_disk_cache_hash_stack(SeqDiskCacheKey *hash,
+                                      ListBase *seqbase_top,
+                                      ListBase *seqbase,
+                                      int machine,
+                                      float cfra,
+                                      int depth)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbase) {
+    if (seq->machine <= machine && seq->startdisp <= cfra && seq->enddisp > cfra) {
+      seq_disk_cache_hash_int(hash, seq->machine);
+      if (!seq_disk_cache_hash_strip(hash, seqbase_top, seqbase, seq, cfra, depth)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static bool seq_disk_cache_hash_modifiers(SeqDiskCacheKey *hash,
+                                          ListBase *seqbase_top,
+                                          ListBase *seqbase,
+                                          Sequence *seq,
+                                          float cfra,
+                                          int depth)
+{
+  LISTBASE_FOREACH (SequenceModifierData *, smd, &seq->modifiers) {
+    const SequenceModifierTypeInfo *smti = BKE_sequence_modifier_type_info_get(smd->type);
+
+    seq_disk_cache_hash_int(hash, smd->type);
+    seq_disk_cache_hash_int(hash, smd->flag);
+    seq_disk_cache_hash_int(hash, smd->mask_input_type);
+    seq_disk_cache_hash_int(hash, smd->mask_time);
+
+    if (smd->mask_input_type == SEQUENCE_MASK_INPUT_ID) {
+      if (smd->mask_id) {
+        return false;
+      }
+    }
+    else if (!seq_disk_cache_hash_strip(
+                 hash, seqbase_top, seqbase, smd->mask_sequence, cfra, depth + 1)) {
+      return false;
+    }
+
+    if (smd->type == seqModifierType_Curves) {
+      seq_disk_cache_hash_curve_mapping(hash, &((CurvesModifierData *)smd)->curve_mapping);
+    }
+    else if (smd->type == seqModifierType_HueCorrect) {
+      seq_disk_cache_hash_curve_mapping(hash, &((HueCorrectModifierData *)smd)->curve_mapping);
+    }
+    else if (smti) {
+      /* Settings of the other modifiers don't contain pointers. */
+      seq_disk_cache_hash_add(hash, smd + 1, smti->struct_size - sizeof(SequenceModifierData));
+    }
+  }
+  return true;
+}
+
+/* Hash everything a strip is rendered from at a frame. Returns false for strips which can't be
+ * hashed, because they render data-blocks which can change without the strip changing or read
+ * their inputs at other frames. The top level seqbase is used to find parent meta strips. */
+static bool seq_disk_cache_hash_strip(SeqDiskCacheKey *hash,
+                                      ListBase *seqbase_top,
+                                      ListBase *seqbase,
+                                      Sequence *seq,
+                                      float cfra,
+                                      int depth)
+{
+  if (seq == NULL) {
+    seq_disk_cache_hash_int(hash, -1);
+    return true;
+  }
+
+  if (depth > DCACHE_MAX_HASH_DEPTH ||
+      ELEM(seq->type, SEQ_TYPE_SCENE, SEQ_TYPE_MOVIECLIP, SEQ_TYPE_MASK, SEQ_TYPE_SPEED)) {
+    return false;
+  }
+
+  /* Selection and locking don't change the image. */
+  const int flag = seq->flag & ~(SELECT | SEQ_LEFTSEL | SEQ_RIGHTSEL | SEQ_OVERLAP | SEQ_LOCK |
+                                 SEQ_FLAG_DELETE);
+  const float frame_index = BKE_sequencer_give_stripelem_index(seq, cfra);
+  Strip *strip = seq->strip;
+
+  seq_disk_cache_hash_int(hash, seq->type);
+  seq_disk_cache_hash_int(hash, flag);
+  seq_disk_cache_hash_float(hash, cfra - seq->start);
+  seq_disk_cache_hash_float(hash, frame_index);
+  seq_disk_cache_hash_int(hash, seq->len);
+  seq_disk_cache_hash_int(hash, seq->startofs);
+  seq_disk_cache_hash_int(hash, seq->endofs);
+  seq_disk_cache_hash_int(hash, seq->startstill);
+  seq_disk_cache_hash_int(hash, seq->endstill);
+  seq_disk_cache_hash_int(hash, seq->anim_startofs);
+  seq_disk_cache_hash_int(hash, seq->anim_endofs);
+  seq_disk_cache_hash_int(hash, seq->streamindex);
+  seq_disk_cache_hash_int(hash, seq->multicam_source);
+  seq_disk_cache_hash_int(hash, seq->blend_mode);
+  seq_disk_cache_hash_float(hash, seq->blend_opacity);
+  seq_disk_cache_hash_float(hash, seq->sat);
+  seq_disk_cache_hash_float(hash, seq->mul);
+  seq_disk_cache_hash_float(hash, seq->effect_fader);
+  seq_disk_cache_hash_float(hash, seq->speed_fader);
+  seq_disk_cache_hash_float(hash, seq->strobe);
+  seq_disk_cache_hash_int(hash, seq->alpha_mode);
+  seq_disk_cache_hash_int(hash, seq->views_format);
+
+  if (seq->stereo3d_format) {
+    seq_disk_cache_hash_add(hash, seq->stereo3d_format, sizeof(*seq->stereo3d_format));
+  }
+
+  if (strip) {
+    seq_disk_cache_hash_str(hash, strip->colorspace_settings.name);
+
+    if (strip->crop) {
+      seq_disk_cache_hash_add(hash, strip->crop, sizeof(*strip->crop));
+    }
+    if (strip->transform) {
+      seq_disk_cache_hash_add(hash, strip->transform, sizeof(*strip->transform));
+    }
+    if ((seq->flag & SEQ_USE_PROXY) && strip->proxy) {
+      seq_disk_cache_hash_str(hash, strip->proxy->dir);
+      seq_disk_cache_hash_str(hash, strip->proxy->file);
+      seq_disk_cache_hash_int(hash, strip->proxy->tc);
+      seq_disk_cache_hash_int(hash, strip->proxy->build_size_flags);
+      seq_disk_cache_hash_int(hash, strip->proxy->storage);
+    }
+
+    if (seq->type == SEQ_TYPE_IMAGE) {
+      StripElem *se = BKE_sequencer_give_stripelem(seq, (int)cfra);
+      if (se) {
+        seq_disk_cache_hash_file(hash, strip->dir, se->name);
+      }
+    }
+    else if (seq->type == SEQ_TYPE_MOVIE && strip->stripdata) {
+      seq_disk_cache_hash_file(hash, strip->dir, strip->stripdata->name);
+    }
+  }
+
+  if (seq->type & SEQ_TYPE_EFFECT) {
+    if (seq->effectdata == NULL) {
+      seq_disk_cache_hash_int(hash, -1);
+    }
+    else if (seq->type == SEQ_TYPE_TEXT) {
+      seq_disk_cache_hash_text(hash, seq->effectdata);
+    }
+    else {
+      /* Settings of the other effects don't contain pointers, speed effects are not hashed. */
+      seq_disk_cache_hash_add(hash, seq->effectdata, MEM_allocN_len(seq->effectdata));
+    }
+
+    /* These effects render the strips below them. */
+    if (ELEM(seq->type, SEQ_TYPE_MULTICAM, SEQ_TYPE_ADJUSTMENT) &&
+        !seq_disk_cache_hash_stack(
+            hash, seqbase_top, seqbase, seq->machine - 1, cfra, depth + 1)) {
+      return false;
+    }
+
+    /* Adjustment strips with nothing below them in a meta strip render the strips below the meta
+     * strip, up to the top level (see #do_adjustment_impl). Whether the strips below render
+     * anything isn't known here, so the stacks below all parent meta strips are hashed. */
+    if (seq->type == SEQ_TYPE_ADJUSTMENT) {
+      for (Sequence *meta = BKE_sequence_metastrip(seqbase_top, NULL, seq); meta != NULL;
+           meta = BKE_sequence_metastrip(seqbase_top, NULL, meta)) {
+        ListBase *meta_seqbase = BKE_sequence_seqbase(seqbase_top, meta);
+        if (meta_seqbase == NULL ||
+            !seq_disk_cache_hash_stack(
+                hash, seqbase_top, meta_seqbase, meta->machine - 1, cfra, depth + 1)) {
+          return false;
+        }
+      }
+    }
+
+    if (!seq_disk_cache_hash_strip(hash, seqbase_top, seqbase, seq->seq1, cfra, depth + 1) ||
+        !seq_disk_cache_hash_strip(hash, seqbase_top, seqbase, seq->seq2, cfra, depth + 1) ||
+        !seq_disk_cache_hash_strip(hash, seqbase_top, seqbase, seq->seq3, cfra, depth + 1)) {
+      return false;
+    }
+  }
+  else if (seq->type == SEQ_TYPE_META) {
+    if (!seq_disk_cache_hash_stack(
+            hash, seqbase_top, &seq->seqbase, MAXSEQ, frame_index + seq->start, depth + 1)) {
+      return false;
+    }
+  }
+
+  return seq_disk_cache_hash_modifiers(hash, seqbase_top, seqbase, seq, cfra, depth);
+}
+
+/* Key of an image in the disk cache, from the render data and sequence it is rendered with
+ * (not the originals of prefetch render data), so animated properties have been evaluated. */
+static SeqDiskCacheKey seq_disk_cache_key(const SeqRenderData *context,
+                                          Sequence *seq,
+                                          float cfra,
+                                          int type)
+{
+  Scene *scene = context->scene;
+  ListBase *seqbase = BKE_sequence_seqbase(&scene->ed->seqbase, seq);
+  SeqDiskCacheKey hash = 14695981039346656037ULL;
+  bool is_hashed;
+
+  if (seqbase == NULL) {
+    return DCACHE_KEY_NONE;
+  }
+
+  seq_disk_cache_hash_int(&hash, DCACHE_VERSION);
+  seq_disk_cache_hash_int(&hash, type);
+  seq_disk_cache_hash_int(&hash, context->rectx);
+  seq_disk_cache_hash_int(&hash, context->recty);
+  seq_disk_cache_hash_int(&hash, context->preview_render_size);
+  seq_disk_cache_hash_int(&hash, context->for_render);
+  seq_disk_cache_hash_int(&hash, context->motion_blur_samples);
+  seq_disk_cache_hash_float(&hash, context->motion_blur_shutter);
+  seq_disk_cache_hash_int(&hash, context->view_id);
+  seq_disk_cache_hash_int(&hash, scene->r.views_format);
+  seq_disk_cache_hash_str(&hash, scene->sequencer_colorspace_settings.name);
+  seq_disk_cache_hash_int(&hash, scene->ed->proxy_storage);
+  seq_disk_cache_hash_str(&hash, scene->ed->proxy_dir);
+
+  if (ELEM(type, SEQ_CACHE_STORE_COMPOSITE, SEQ_CACHE_STORE_FINAL_OUT)) {
+    is_hashed = seq_disk_cache_hash_stack(
+        &hash, &scene->ed->seqbase, seqbase, seq->machine, cfra, 0);
+  }
+  else {
+    is_hashed = seq_disk_cache_hash_strip(&hash, &scene->ed->seqbase, seqbase, seq, cfra, 0);
+  }
+
+  if (!is_hashed) {
+    return DCACHE_KEY_NONE;
+  }
+  return (hash == DCACHE_KEY_NONE) ? 1 : hash;
+}
+
+/* Key of an image in the disk cache, created from the render data and sequence like
+ * #seq_disk_cache_key, but remembered for the original ones until the memory cache is
+ * invalidated. A frame is looked up and stored for every channel of its stack, the stacks below
+ * and their source files are then only hashed once. */
+static SeqDiskCacheKey seq_disk_cache_key_get(const SeqRenderData *context,
+                                              Sequence *seq,
+                                              const SeqRenderData *render_context,
+                                              Sequence *render_seq,
+                                              float cfra,
+                                              int type)
+{
+  Scene *scene = context->scene;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  SeqDiskCacheKeyMemo lookup = {{NULL}};
+
+  lookup.key.seq = seq;
+  lookup.key.context = *context;
+  lookup.key.nfra = cfra - seq->start;
+  lookup.key.type = type;
+
+  seq_cache_lock(scene);
+  const SeqDiskCacheKeyMemo *memo = BLI_gset_lookup(cache->disk_keys, &lookup);
+  const int generation = cache->disk_keys_generation;
+  if (memo) {
+    lookup.disk_key = memo->disk_key;
+  }
+  seq_cache_unlock(scene);
+
+  if (memo) {
+    return lookup.disk_key;
+  }
+
+  lookup.disk_key = seq_disk_cache_key(render_context, render_seq, cfra, type);
+
+  seq_cache_lock(scene);
+  /* Don't remember a key of data which changed while it was created. */
+  if (generation == cache->disk_keys_generation) {
+    if (BLI_gset_len(cache->disk_keys) >= DCACHE_MAX_MEMOS) {
+      BLI_gset_clear(cache->disk_keys, MEM_freeN);
+    }
+    if (!BLI_gset_haskey(cache->disk_keys, &lookup)) {
+      SeqDiskCacheKeyMemo *memo_new = MEM_mallocN(sizeof(*memo_new), __func__);
+      *memo_new = lookup;
+      BLI_gset_insert(cache->disk_keys, memo_new);
+    }
+  }
+  seq_cache_unlock(scene);
+
+  return lookup.disk_key;
+}
+
+/* Forget the disk cache keys and source file stats, when the memory cache is invalidated.
+ * Must be called with the memory cache locked. */
+static void seq_disk_cache_keys_clear(SeqCache *cache)
+{
+  BLI_gset_clear(cache->disk_keys, MEM_freeN);
+  cache->disk_keys_generation++;
+  seq_disk_cache_file_stats_clear();
+}
+
+static bool seq_disk_cache_is_enabled(Scene *scene)
+{
+  return (scene->ed->cache_flag & SEQ_CACHE_DISK_CACHE_ENABLE) &&
+         U.sequencer_disk_cache_size_limit > 0;
+}
+
+static uint64_t seq_disk_cache_size_limit(void)
+{
+  if (disk_cache_size_limit_override != 0) {
+    return (uint64_t)disk_cache_size_limit_override;
+  }
+  return ((uint64_t)U.sequencer_disk_cache_size_limit) * 1024 * 1024 * 1024;
+}
+
+static int seq_disk_cache_compression_level(void)
+{
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      return 0;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_HIGH:
+      return 9;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
+    default:
+      return 1;
+  }
+}
+
+static void seq_disk_cache_dir_get(char *r_dir)
+{
+  if (U.sequencer_disk_cache_dir[0] != '\0') {
+    BLI_strncpy(r_dir, U.sequencer_disk_cache_dir, FILE_MAX);
+    BLI_path_abs(r_dir, BKE_main_blendfile_path_from_global());
+  }
+  else {
+    BLI_join_dirfile(r_dir, FILE_MAX, BKE_tempdir_base(), DCACHE_DIRNAME);
+  }
+}
+
+static void seq_disk_cache_file_path(char *r_path, const char *dir, SeqDiskCacheKey key)
+{
+  char filename[FILE_MAXFILE];
+
+  BLI_snprintf(
+      filename, sizeof(filename), "%016llx%s", (unsigned long long)key, DCACHE_FNAME_EXT);
+  BLI_join_dirfile(r_path, FILE_MAX, dir, filename);
+}
+
+static unsigned int seq_disk_cache_key_hash(const void *key)
+{
+  const SeqDiskCacheKey value = *(const SeqDiskCacheKey *)key;
+  return (unsigned int)(value ^ (value >> 32));
+}
+
+static bool seq_disk_cache_key_cmp(const void *a, const void *b)
+{
+  return *(const SeqDiskCacheKey *)a != *(const SeqDiskCacheKey *)b;
+}
+
+static int seq_disk_cache_file_cmp_mtime(const void *a_, const void *b_)
+{
+  const SeqDiskCacheFile *a = a_;
+  const SeqDiskCacheFile *b = b_;
+
+  if (a->mtime < b->mtime) {
+    return -1;
+  }
+  return (a->mtime > b->mtime) ? 1 : 0;
+}
+
+static SeqDiskCacheFile *seq_disk_cache_file_add(SeqDiskCache *dcache, SeqDiskCacheKey key)
+{
+  SeqDiskCacheFile *file = MEM_callocN(sizeof(SeqDiskCacheFile), "SeqDiskCacheFile");
+  file->key = key;
+  BLI_addtail(&dcache->files, file);
+  BLI_ghash_insert(dcache->files_by_key, &file->key, file);
+  return file;
+}
+
+static void seq_disk_cache_file_remove(SeqDiskCache *dcache, SeqDiskCacheFile *file)
+{
+  BLI_ghash_remove(dcache->files_by_key, &file->key, NULL, NULL);
+  BLI_remlink(&dcache->files, file);
+  dcache->size_total -= file->size;
+  MEM_freeN(file);
+}
+
+static void seq_disk_cache_file_delete(SeqDiskCache *dcache, SeqDiskCacheFile *file)
+{
+  char path[FILE_MAX];
+
+  seq_disk_cache_file_path(path, dcache->dir, file->key);
+  BLI_delete(path, false, false);
+  seq_disk_cache_file_remove(dcache, file);
+}
+
+static void seq_disk_cache_files_free(SeqDiskCache *dcache)
+{
+  BLI_ghash_clear(dcache->files_by_key, NULL, NULL);
+  BLI_freelistN(&dcache->files);
+  dcache->size_total = 0;
+}
+
+/* Add the files written in previous sessions, in the order they have last been used in. */
+static void seq_disk_cache_scan(SeqDiskCache *dcache)
+{
+  struct direntry *filelist;
+  const unsigned int totfile = BLI_filelist_dir_contents(dcache->dir, &filelist);
+
+  for (unsigned int i = 0; i < totfile; i++) {
+    const char *name = filelist[i].relname;
+    char *name_end;
+
+    if (S_ISDIR(filelist[i].type) ||
+        strlen(name) != DCACHE_FNAME_KEY_LEN + strlen(DCACHE_FNAME_EXT) ||
+        !BLI_path_extension_check(name, DCACHE_FNAME_EXT)) {
+      continue;
+    }
+
+    const SeqDiskCacheKey key = strtoull(name, &name_end, 16);
+    if (name_end != name + DCACHE_FNAME_KEY_LEN || key == DCACHE_KEY_NONE ||
+        BLI_ghash_haskey(dcache->files_by_key, &key)) {
+      continue;
+    }
+
+    SeqDiskCacheFile *file = seq_disk_cache_file_add(dcache, key);
+    file->size = (uint64_t)filelist[i].s.st_size;
+    file->mtime = (int64_t)filelist[i].s.st_mtime;
+    dcache->size_total += file->size;
+  }
+
+  BLI_filelist_free(filelist, totfile);
+  BLI_listbase_sort(&dcache->files, seq_disk_cache_file_cmp_mtime);
+}
+
+/* Remove least recently used files until the cache fits in the size limit. */
+static void seq_disk_cache_limit(SeqDiskCache *dcache)
+{
+  const uint64_t limit = seq_disk_cache_size_limit();
+  SeqDiskCacheFile *file = dcache->files.first;
+
+  while (file && dcache->size_total > limit) {
+    SeqDiskCacheFile *next = file->next;
+    if (!file->is_writing) {
+      seq_disk_cache_file_delete(dcache, file);
+    }
+    file = next;
+  }
+}
+
+/* Get the disk cache, creating it or following a change of its directory in the preferences.
+ * Must be called with disk_cache_lock locked. */
+static SeqDiskCache *seq_disk_cache_ensure(void)
+{
+  char dir[FILE_MAX];
+
+  seq_disk_cache_dir_get(dir);
+
+  if (disk_cache == NULL) {
+    disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+    disk_cache->files_by_key = BLI_ghash_new(
+        seq_disk_cache_key_hash, seq_disk_cache_key_cmp, "SeqDiskCache files");
+    disk_cache->write_pool = BLI_task_pool_create_background(BLI_task_scheduler_get(), NULL);
+  }
+
+  if (!STREQ(disk_cache->dir, dir)) {
+    seq_disk_cache_files_free(disk_cache);
+    BLI_strncpy(disk_cache->dir, dir, sizeof(disk_cache->dir));
+
+    if (BLI_dir_create_recursive(dir)) {
+      seq_disk_cache_scan(disk_cache);
+      seq_disk_cache_limit(disk_cache);
+    }
+  }
+
+  return disk_cache;
+}
+
+static bool seq_disk_cache_gzwrite(gzFile gzfile, const void *data, size_t size)
+{
+  const char *bytes = data;
+
+  while (size > 0) {
+    const unsigned int len = (unsigned int)MIN2(size, DCACHE_IO_CHUNK_SIZE);
+    if (gzwrite(gzfile, bytes, len) != (int)len) {
+      return false;
+    }
+    bytes += len;
+    size -= len;
+  }
+  return true;
+}
+
+static bool seq_disk_cache_gzread(gzFile gzfile, void *data, size_t size)
+{
+  char *bytes = data;
+
+  while (size > 0) {
+    const unsigned int len = (unsigned int)MIN2(size, DCACHE_IO_CHUNK_SIZE);
+    if (gzread(gzfile, bytes, len) != (int)len) {
+      return false;
+    }
+    bytes += len;
+    size -= len;
+  }
+  return true;
+}
+
+/* Write to a temporary file renamed when complete, so readers never see partial files. */
+static bool seq_disk_cache_write_file(const char *path, SeqDiskCacheWriteTask *task)
+{
+  ImBuf *ibuf = task->ibuf;
+  /* Buffers could be added while writing, only write the ones in the header. */
+  const unsigned int *rect = ibuf->rect;
+  const float *rect_float = ibuf->rect_float;
+  const size_t num_pixels = ((size_t)ibuf->x) * ibuf->y;
+  SeqDiskCacheHeader header = {{0}};
+  char path_tmp[FILE_MAX + 4];
+  char mode[4];
+  bool ok;
+
+  BLI_snprintf(path_tmp, sizeof(path_tmp), "%s.tmp", path);
+  BLI_snprintf(mode, sizeof(mode), "wb%d", task->compression_level);
+
+  gzFile gzfile = BLI_gzopen(path_tmp, mode);
+  if (gzfile == NULL) {
+    return false;
+  }
+
+  memcpy(header.magic, DCACHE_MAGIC, sizeof(header.magic));
+  header.version = DCACHE_VERSION;
+  header.key = task->key;
+  header.x = ibuf->x;
+  header.y = ibuf->y;
+  header.planes = ibuf->planes;
+  header.ibuf_flags = ibuf->flags & (IB_alphamode_premul | IB_alphamode_ignore);
+  header.cost = task->cost;
+
+  if (rect) {
+    header.image_flag |= DCACHE_IMAGE_RECT;
+    BLI_strncpy(header.rect_colorspace,
+                IMB_colormanagement_get_rect_colorspace(ibuf),
+                sizeof(header.rect_colorspace));
+  }
+  if (rect_float) {
+    header.image_flag |= DCACHE_IMAGE_FLOAT;
+    BLI_strncpy(header.float_colorspace,
+                IMB_colormanagement_get_float_colorspace(ibuf),
+                sizeof(header.float_colorspace));
+  }
+
+  ok = seq_disk_cache_gzwrite(gzfile, &header, sizeof(header));
+  if (ok && rect) {
+    ok = seq_disk_cache_gzwrite(gzfile, rect, sizeof(unsigned int) * num_pixels);
+  }
+  if (ok && rect_float) {
+    ok = seq_disk_cache_gzwrite(gzfile, rect_float, sizeof(float) * 4 * num_pixels);
+  }
+  ok = (gzclose(gzfile) == Z_OK) && ok;
+
+  if (ok) {
+    ok = (BLI_rename(path_tmp, path) == 0);
+  }
+  if (!ok) {
+    BLI_delete(path_tmp, false, false);
+  }
+  return ok;
+}
+
+static ImBuf *seq_disk_cache_read_file(const char *path, SeqDiskCacheKey key, float *r_cost)
+{
+  SeqDiskCacheHeader header;
+  ImBuf *ibuf = NULL;
+
+  gzFile gzfile = BLI_gzopen(path, "rb");
+  if (gzfile == NULL) {
+    return NULL;
+  }
+
+  if (seq_disk_cache_gzread(gzfile, &header, sizeof(header)) &&
+      memcmp(header.magic, DCACHE_MAGIC, sizeof(header.magic)) == 0 &&
+      header.version == DCACHE_VERSION && header.key == key && header.x > 0 && header.y > 0 &&
+      (header.image_flag & (DCACHE_IMAGE_RECT | DCACHE_IMAGE_FLOAT))) {
+    const size_t num_pixels = ((size_t)header.x) * header.y;
+    const int flags = ((header.image_flag & DCACHE_IMAGE_RECT) ? IB_rect : 0) |
+                      ((header.image_flag & DCACHE_IMAGE_FLOAT) ? IB_rectfloat : 0);
+    bool ok;
+
+    ibuf = IMB_allocImBuf(header.x, header.y, header.planes, flags);
+
+    ok = (ibuf != NULL);
+    if (ok && ibuf->rect) {
+      ok = seq_disk_cache_gzread(gzfile, ibuf->rect, sizeof(unsigned int) * num_pixels);
+    }
+    if (ok && ibuf->rect_float) {
+      ok = seq_disk_cache_gzread(gzfile, ibuf->rect_float, sizeof(float) * 4 * num_pixels);
+    }
+
+    if (ok) {
+      header.rect_colorspace[sizeof(header.rect_colorspace) - 1] = '\0';
+      header.float_colorspace[sizeof(header.float_colorspace) - 1] = '\0';
+
+      ibuf->flags |= header.ibuf_flags & (IB_alphamode_premul | IB_alphamode_ignore);
+      if (ibuf->rect) {
+        IMB_colormanagement_assign_rect_colorspace(ibuf, header.rect_colorspace);
+      }
+      if (ibuf->rect_float) {
+        IMB_colormanagement_assign_float_colorspace(ibuf, header.float_colorspace);
+      }
+      *r_cost = header.cost;
+    }
+    else if (ibuf) {
+      IMB_freeImBuf(ibuf);
+      ibuf = NULL;
+    }
+  }
+
+  gzclose(gzfile);
+  return ibuf;
+}
+
+static void seq_disk_cache_write_task(TaskPool *__restrict UNUSED(pool),
+                                      void *taskdata,
+                                      int UNUSED(threadid))
+{
+  SeqDiskCacheWriteTask *task = taskdata;
+  char path[FILE_MAX];
+
+  seq_disk_cache_file_path(path, task->dir, task->key);
+  const bool ok = seq_disk_cache_write_file(path, task);
+  const uint64_t size = ok ? (uint64_t)BLI_file_size(path) : 0;
+
+  IMB_freeImBuf(task->ibuf);
+
+  BLI_mutex_lock(&disk_cache_lock);
+
+  /* The file is not used when the directory changed in the meantime. */
+  SeqDiskCacheFile *file = STREQ(disk_cache->dir, task->dir) ?
+                               BLI_ghash_lookup(disk_cache->files_by_key, &task->key) :
+                               NULL;
+  if (file && file->is_writing) {
+    if (ok) {
+      file->is_writing = false;
+      file->size = size;
+      disk_cache->size_total += size;
+      seq_disk_cache_limit(disk_cache);
+    }
+    else {
+      seq_disk_cache_file_remove(disk_cache, file);
+    }
+  }
+  disk_cache->pending_size -= task->ibuf_size;
+
+  BLI_mutex_unlock(&disk_cache_lock);
+}
+
+/* Write an image in the background, the image must not be modified anymore. */
+static void seq_disk_cache_put(SeqDiskCacheKey key, ImBuf *ibuf, float cost)
+{
+  if ((ibuf->rect == NULL && ibuf->rect_float == NULL) ||
+      (ibuf->rect_float && ibuf->channels != 4) || key == DCACHE_KEY_NONE) {
+    return;
+  }
+
+  const size_t num_pixels = ((size_t)ibuf->x) * ibuf->y;
+  const size_t ibuf_size = (ibuf->rect ? sizeof(unsigned int) * num_pixels : 0) +
+                           (ibuf->rect_float ? sizeof(float) * 4 * num_pixels : 0);
+
+  BLI_mutex_lock(&disk_cache_lock);
+
+  SeqDiskCache *dcache = seq_disk_cache_ensure();
+
+  /* A single image is always written, even if it exceeds the limit on its own. */
+  if ((dcache->pending_size == 0 ||
+       dcache->pending_size + ibuf_size <=
+           seq_cache_get_mem_total() / DCACHE_PENDING_WRITES_FRACTION) &&
+      !BLI_ghash_haskey(dcache->files_by_key, &key)) {
+    SeqDiskCacheWriteTask *task = MEM_callocN(sizeof(SeqDiskCacheWriteTask), __func__);
+    BLI_strncpy(task->dir, dcache->dir, sizeof(task->dir));
+    task->key = key;
+    task->ibuf = ibuf;
+    task->ibuf_size = ibuf_size;
+    task->cost = cost;
+    task->compression_level = seq_disk_cache_compression_level();
+    IMB_refImBuf(ibuf);
+
+    SeqDiskCacheFile *file = seq_disk_cache_file_add(dcache, key);
+    file->is_writing = true;
+    dcache->pending_size += ibuf_size;
+
+    BLI_task_pool_push(
+        dcache->write_pool, seq_disk_cache_write_task, task, true, TASK_PRIORITY_LOW);
+  }
+
+  BLI_mutex_unlock(&disk_cache_lock);
+}
+
+static ImBuf *seq_disk_cache_get(SeqDiskCacheKey key, float *r_cost)
+{
+  char path[FILE_MAX];
+
+  if (key == DCACHE_KEY_NONE) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(&disk_cache_lock);
+
+  SeqDiskCache *dcache = seq_disk_cache_ensure();
+  SeqDiskCacheFile *file = BLI_ghash_lookup(dcache->files_by_key, &key);
+
+  if (file == NULL || file->is_writing) {
+    BLI_mutex_unlock(&disk_cache_lock);
+    return NULL;
+  }
+
+  /* Most recently used. */
+  BLI_remlink(&dcache->files, file);
+  BLI_addtail(&dcache->files, file);
+  seq_disk_cache_file_path(path, dcache->dir, key);
+
+  BLI_mutex_unlock(&disk_cache_lock);
+
+  /* Read without locking, other threads keep rendering and reading. */
+  ImBuf *ibuf = seq_disk_cache_read_file(path, key, r_cost);
+
+  /* The file could have been removed or written again in the meantime, only touch or forget it
+   * while it is still the same file in the cache. */
+  BLI_mutex_lock(&disk_cache_lock);
+  file = BLI_ghash_lookup(dcache->files_by_key, &key);
+  if (file && !file->is_writing) {
+    char path_current[FILE_MAX];
+    seq_disk_cache_file_path(path_current, dcache->dir, key);
+    if (BLI_path_cmp(path_current, path) == 0) {
+      if (ibuf) {
+        /* Keep the order of use for the next sessions. */
+        BLI_file_touch(path);
+      }
+      else {
+        /* The file has been removed or is corrupt. */
+        seq_disk_cache_file_delete(dcache, file);
+      }
+    }
+  }
+  BLI_mutex_unlock(&disk_cache_lock);
+
+  return ibuf;
+}
+
+void BKE_sequencer_cache_disk_free(void)
+{
+  if (disk_cache_file_stats != NULL) {
+    BLI_ghash_free(disk_cache_file_stats, MEM_freeN, MEM_freeN);
+    disk_cache_file_stats = NULL;
+  }
+
+  if (disk_cache == NULL) {
+    return;
+  }
+
+  /* Finish writing the pending images. */
+  BLI_task_pool_work_and_wait(disk_cache->write_pool);
+  BLI_task_pool_free(disk_cache->write_pool);
+
+  seq_disk_cache_files_free(disk_cache);
+  BLI_ghash_free(disk_cache->files_by_key, NULL, NULL);
+  MEM_freeN(disk_cache);
+  disk_cache = NULL;
+}
+
+/**
+ * Limit the size of the disk cache to \a size_limit bytes instead of the preferences, 0 uses the
+ * preferences again. Used by tests, the preferences only have a granularity of gigabytes.
+ */
+void BKE_sequencer_cache_disk_size_limit_set(size_t size_limit)
+{
+  BLI_mutex_lock(&disk_cache_lock);
+  disk_cache_size_limit_override = size_limit;
+  BLI_mutex_unlock(&disk_cache_lock);
+}
+
 /* ***************************** API ****************************** */
 
 void BKE_sequencer_cache_free_temp_cache(Scene *scene, short id, int cfra)
@@ -479,6 +1534,7 @@ void BKE_sequencer_cache_destruct(Scene *scene)
   }
 
   BLI_ghash_free(cache->hash, seq_cache_keyfree, seq_cache_valfree);
+  BLI_gset_free(cache->disk_keys, MEM_freeN);
   BLI_mempool_destroy(cache->keys_pool);
   BLI_mempool_destroy(cache->items_pool);
   BLI_mutex_end(&cache->iterator_mutex);
@@ -512,6 +1568,7 @@ void BKE_sequencer_cache_cleanup(Scene *scene)
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
   cache->last_key = NULL;
+  seq_disk_cache_keys_clear(cache);
   seq_cache_unlock(scene);
 }
 
@@ -569,14 +1626,51 @@ void BKE_sequencer_cache_cleanup_sequence(Scene *scene,
     }
   }
   cache->last_key = NULL;
+  /* Keys of images of other strips which use this one can change too. */
+  seq_disk_cache_keys_clear(cache);
+  seq_cache_unlock(scene);
+}
+
+/* Find an image in memory, context and seq must be the originals. */
+static ImBuf *seq_cache_lookup(const SeqRenderData *context, Sequence *seq, float cfra, int type)
+{
+  Scene *scene = context->scene;
+
+  seq_cache_lock(scene);
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  ImBuf *ibuf = NULL;
+
+  if (cache && seq) {
+    SeqCacheKey key;
+
+    key.seq = seq;
+    key.context = *context;
+    key.nfra = cfra - seq->start;
+    key.type = type;
+
+    ibuf = seq_cache_get(cache, &key);
+  }
   seq_cache_unlock(scene);
+
+  return ibuf;
 }
 
+static void seq_cache_put_ex(const SeqRenderData *context,
+                             Sequence *seq,
+                             float cfra,
+                             int type,
+                             ImBuf *i,
+                             float cost,
+                             bool use_disk_cache);
+
 struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
                                       Sequence *seq,
                                       float cfra,
                                       int type)
 {
+  /* Disk cache keys are created from the data as rendered. */
+  const SeqRenderData *render_context = context;
+  Sequence *render_seq = seq;
   Scene *scene = context->scene;
 
   if (context->is_prefetch_render) {
@@ -587,24 +1681,23 @@ struct ImBuf *BKE_sequencer_cache_get(const SeqRenderData *context,
 
   if (!scene->ed->cache) {
     BKE_sequencer_cache_create(scene);
-    return NULL;
   }
 
-  seq_cache_lock(scene);
-  SeqCache *cache = seq_cache_get_from_scene(scene);
-  ImBuf *ibuf = NULL;
-
-  if (cache && seq) {
-    SeqCacheKey key;
+  ImBuf *ibuf = seq_cache_lookup(context, seq, cfra, type);
 
-    key.seq = seq;
-    key.context = *context;
-    key.nfra = cfra - seq->start;
-    key.type = type;
+  if (ibuf == NULL && seq && seq_disk_cache_is_enabled(scene)) {
+    const SeqDiskCacheKey key = seq_disk_cache_key_get(
+        context, seq, render_context, render_seq, cfra, type);
+    float cost = 0.0f;
+    ibuf = seq_disk_cache_get(key, &cost);
 
-    ibuf = seq_cache_get(cache, &key);
+    /* Keep the image in memory like a rendered one. Final images of the main render must fit
+     * in the memory cache, like in #BKE_sequencer_cache_put_if_possible. */
+    if (ibuf && (type != SEQ_CACHE_STORE_FINAL_OUT || render_context->is_prefetch_render ||
+                 BKE_sequencer_cache_recycle_item(scene))) {
+      seq_cache_put_ex(context, seq, cfra, type, ibuf, cost, false);
+    }
   }
-  seq_cache_unlock(scene);
 
   return ibuf;
 }
@@ -631,9 +1724,16 @@ bool BKE_sequencer_cache_put_if_possible(
   }
 }
 
-void BKE_sequencer_cache_put(
-    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *i, float cost)
+static void seq_cache_put_ex(const SeqRenderData *context,
+                             Sequence *seq,
+                             float cfra,
+                             int type,
+                             ImBuf *i,
+                             float cost,
+                             bool use_disk_cache)
 {
+  const SeqRenderData *render_context = context;
+  Sequence *render_seq = seq;
   Scene *scene = context->scene;
 
   if (context->is_prefetch_render) {
@@ -647,7 +1747,7 @@ void BKE_sequencer_cache_put(
   }
 
   /* Prevent reinserting, it breaks cache key linking */
-  ImBuf *test = BKE_sequencer_cache_get(context, seq, cfra, type);
+  ImBuf *test = seq_cache_lookup(context, seq, cfra, type);
   if (test) {
     IMB_freeImBuf(test);
     return;
@@ -714,7 +1814,21 @@ void BKE_sequencer_cache_put(
     cache->last_key = NULL;
   }
 
+  const bool is_stored = !key->is_temp_cache;
+
   seq_cache_unlock(scene);
+
+  if (use_disk_cache && is_stored && seq_disk_cache_is_enabled(scene)) {
+    const SeqDiskCacheKey key = seq_disk_cache_key_get(
+        context, seq, render_context, render_seq, cfra, type);
+    seq_disk_cache_put(key, i, cost);
+  }
+}
+
+void BKE_sequencer_cache_put(
+    const SeqRenderData *context, Sequence *seq, float cfra, int type, ImBuf *i, float cost)
+{
+  seq_cache_put_ex(context, seq, cfra, type, i, cost, true);
 }
 
 void BKE_sequencer_cache_iterate(
@@ -36,8 +36,14 @@ struct BLI_mempool;
 
 /* Task Scheduler
  *
- * Central scheduler that holds running threads ready to execute tasks. A single
- * queue holds the task from all pools.
+ * Central scheduler that holds running threads ready to execute tasks. Each
+ * thread has its own work-stealing deque for the tasks it pushes itself, idle
+ * threads steal from the other deques. A global queue holds tasks pushed from
+ * outside of the scheduler threads.
+ *
+ * In NUMA mode, worker threads are pinned to the nodes of the system, steal
+ * from threads of their own node first, and parallel ranges are split so each
+ * node processes its own part of the range.
  *
  * Init/exit must be called before/after any task pools are created/freed, and
  * must be called from the main threads. All other scheduler and pool functions
@@ -46,6 +52,7 @@ struct BLI_mempool;
 typedef struct TaskScheduler TaskScheduler;
 
 TaskScheduler *BLI_task_scheduler_create(int num_threads);
+TaskScheduler *BLI_task_scheduler_create_ex(int num_threads, bool use_numa);
 void BLI_task_scheduler_free(TaskScheduler *scheduler);
 
 int BLI_task_scheduler_num_threads(TaskScheduler *scheduler);
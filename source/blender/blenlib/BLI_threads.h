@@ -65,6 +65,9 @@ void BLI_threaded_malloc_end(void);
 int BLI_system_thread_count(void); /* gets the number of threads the system can make use of */
 void BLI_system_num_threads_override_set(int num);
 int BLI_system_num_threads_override_get(void);
+/* Use a NUMA-aware global task scheduler, must be set before it is first used. */
+void BLI_system_numa_scheduler_set(bool use_numa);
+bool BLI_system_numa_scheduler_get(void);
 
 /* Global Mutex Locks
  *
@@ -200,6 +203,13 @@ void BLI_thread_queue_nowait(ThreadQueue *queue);
 void BLI_thread_put_process_on_fast_node(void);
 void BLI_thread_put_thread_on_fast_node(void);
 
+/* NUMA topology, nodes are numbered in [0, num_nodes[ and only those with processors
+ * are counted. A single node is reported when NUMA is not available. */
+int BLI_thread_numa_num_nodes(void);
+int BLI_thread_numa_node_num_processors(int node);
+/* Restrict the calling thread to the processors of the given node. */
+bool BLI_thread_numa_run_thread_on_node(int node);
+
 #ifdef __cplusplus
 }
 #endif
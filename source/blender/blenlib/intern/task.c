@@ -45,18 +45,13 @@
  */
 #define MEMPOOL_SIZE 256
 
-/* Number of tasks which are pushed directly to local thread queue.
+/* Number of tasks which can be held by a per-thread work-stealing deque.
  *
- * This allows thread to fetch next task without locking the whole queue.
+ * Must be a power of two. Tasks which do not fit are pushed to the global
+ * scheduler queue instead.
  */
-#define LOCAL_QUEUE_SIZE 1
-
-/* Number of tasks which are allowed to be scheduled in a delayed manner.
- *
- * This allows to use less locks per graph node children schedule. More details
- * could be found at TaskThreadLocalStorage::do_delayed_push.
- */
-#define DELAYED_QUEUE_SIZE 4096
+#define DEQUE_SIZE 4096
+#define DEQUE_MASK (DEQUE_SIZE - 1)
 
 #ifndef NDEBUG
 #  define ASSERT_THREAD_ID(scheduler, thread_id) \
@@ -138,31 +133,57 @@ typedef struct TaskThreadLocalStorage {
    */
   TaskMemPool task_mempool;
 
-  /* Local queue keeps thread alive by keeping small amount of tasks ready
-   * to be picked up without causing global thread locks for synchronization.
-   */
-  int num_local_queue;
-  Task *local_queue[LOCAL_QUEUE_SIZE];
-
   /* Thread can be marked for delayed tasks push. This is helpful when it's
    * know that lots of subsequent task pushed will happen from the same thread
    * without "interrupting" for task execution.
    *
-   * We try to accumulate as much tasks as possible in a local queue without
-   * any locks first, and then we push all of them into a scheduler's queue
-   * from within a single mutex lock.
+   * Tasks still go to the thread's deque right away, but sleeping worker threads
+   * are only woken up once, when the delayed push ends.
    */
   bool do_delayed_push;
-  int num_delayed_queue;
-  Task *delayed_queue[DELAYED_QUEUE_SIZE];
 } TaskThreadLocalStorage;
 
+/* Work-stealing deque of a scheduler thread.
+ *
+ * This is a fixed size Chase-Lev deque: the owner thread pushes and pops tasks
+ * at the bottom end without any lock, other threads steal the oldest tasks from
+ * the top end with a single compare-and-swap.
+ *
+ * Each slot also stores the pool of its task, so threads which are only allowed
+ * to run tasks of a given pool (see BLI_task_pool_work_and_wait()) can check it
+ * before taking the task, without touching task memory which might have been
+ * freed already.
+ */
+typedef struct TaskDequeSlot {
+  Task *task;
+  TaskPool *pool;
+} TaskDequeSlot;
+
+typedef struct TaskDeque {
+  /* Index of the oldest task, advanced by stealing threads. */
+  int64_t top;
+  /* Keep indices written by different threads on separate cache lines. */
+  char _pad[64 - sizeof(int64_t)];
+  /* Index past the newest task, only modified by the owner thread. */
+  int64_t bottom;
+  TaskDequeSlot slots[DEQUE_SIZE];
+} TaskDeque;
+
+/* Unordered accesses, only for values whose ordering is ensured by a neighbor atomic operation,
+ * or which are used as hints. */
+#define DEQUE_LOAD(v) (*(volatile int64_t *)&(v))
+#define DEQUE_STORE(v, value) (*(volatile int64_t *)&(v) = (value))
+
 struct TaskPool {
   TaskScheduler *scheduler;
 
-  volatile size_t num;
+  /* Number of tasks pushed and not finished yet. Only decreases to zero while
+   * holding num_mutex, waiting threads can then safely free the pool. */
+  size_t num;
   ThreadMutex num_mutex;
   ThreadCondition num_cond;
+  /* Number of threads waiting on num_cond for new tasks or for the pool to be done. */
+  int num_waiting;
 
   void *userdata;
   ThreadMutex user_mutex;
@@ -206,10 +227,16 @@ struct TaskScheduler {
   struct TaskThread *task_threads;
   int num_threads;
   bool background_thread_only;
+  /* Number of NUMA nodes worker threads are pinned to, 1 when not NUMA-aware. */
+  int num_nodes;
 
+  /* Global queue, for tasks pushed from outside of scheduler threads, from
+   * suspended pools and for background pools. */
   ListBase queue;
   ThreadMutex queue_mutex;
   ThreadCondition queue_cond;
+  /* Number of worker threads waiting on queue_cond for new tasks. */
+  int num_sleeping;
 
   ThreadMutex startup_mutex;
   ThreadCondition startup_cond;
@@ -224,7 +251,10 @@ struct TaskScheduler {
 typedef struct TaskThread {
   TaskScheduler *scheduler;
   int id;
+  /* NUMA node the thread is pinned to, -1 if it is not (main thread or not NUMA-aware). */
+  int node;
   TaskThreadLocalStorage tls;
+  TaskDeque deque;
 } TaskThread;
 
 /* Helper */
@@ -326,17 +356,132 @@ static void task_free(TaskPool *pool, Task *task, const int thread_id)
   }
 }
 
+/* Work-stealing deque */
+
+BLI_INLINE void task_deque_init(TaskDeque *deque)
+{
+  deque->top = 0;
+  deque->bottom = 0;
+}
+
+/* Push a task at the bottom of the deque, only called from the owner thread.
+ * Returns false when the deque is full, or holds tasks of another pool.
+ *
+ * Keeping the tasks of a single pool per deque guarantees that a thread waiting for its pool
+ * finds all of them at the ends of the deques, where it pops and steals filtered by pool. With
+ * mixed pools, tasks of the waited pool could be stuck below tasks of other pools (nested pools
+ * pushing from the same thread), starving or deadlocking the waiting thread. Tasks of other
+ * pools go to the global queue instead, which can be searched by pool. */
+BLI_INLINE bool task_deque_push(TaskDeque *deque, Task *task)
+{
+  const int64_t bottom = deque->bottom;
+  const int64_t num_tasks = bottom - DEQUE_LOAD(deque->top);
+  if (num_tasks >= DEQUE_SIZE) {
+    return false;
+  }
+  /* A stale top can only make the deque look non-empty, the task then goes to the global queue
+   * which is correct, just slower. */
+  if (num_tasks > 0 && deque->slots[(bottom - 1) & DEQUE_MASK].pool != task->pool) {
+    return false;
+  }
+
+  TaskDequeSlot *slot = &deque->slots[bottom & DEQUE_MASK];
+  slot->task = task;
+  slot->pool = task->pool;
+
+  /* Full barrier: the slot must be visible to stealing threads before the new bottom, and the
+   * new bottom before the caller checks for sleeping threads to wake up. */
+  atomic_add_and_fetch_int64(&deque->bottom, 1);
+  return true;
+}
+
+/* Pop the newest task from the bottom of the deque, only called from the owner thread.
+ * When pool is not NULL, only a task from that pool is returned. */
+static Task *task_deque_pop(TaskDeque *deque, TaskPool *pool)
+{
+  /* Top only grows, so this can only be wrong by seeing a task which was stolen already. */
+  if (deque->bottom - DEQUE_LOAD(deque->top) <= 0) {
+    return NULL;
+  }
+
+  /* Full barrier, stealing threads must see the reserved slot before we read top. */
+  const int64_t bottom = atomic_sub_and_fetch_int64(&deque->bottom, 1);
+  const int64_t top = DEQUE_LOAD(deque->top);
+  Task *task = NULL;
+
+  if (top <= bottom) {
+    const TaskDequeSlot *slot = &deque->slots[bottom & DEQUE_MASK];
+    if (pool == NULL || slot->pool == pool) {
+      task = slot->task;
+      if (top != bottom) {
+        /* There are other tasks left, stealing threads cannot reach this one. */
+        return task;
+      }
+      /* Last task of the deque, race against stealing threads for it. */
+      if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+        task = NULL;
+      }
+    }
+  }
+
+  /* Deque is empty now, or the task was left in place. */
+  DEQUE_STORE(deque->bottom, bottom + 1);
+  return task;
+}
+
+/* Steal the oldest task from the top of the deque, called from any thread.
+ * When pool is not NULL, only a task from that pool is returned. */
+static Task *task_deque_steal(TaskDeque *deque, TaskPool *pool)
+{
+  /* Cheap test first, to avoid bouncing cache lines of empty deques around. */
+  if (DEQUE_LOAD(deque->bottom) - DEQUE_LOAD(deque->top) <= 0) {
+    return NULL;
+  }
+
+  /* Full barriers: top has to be read before bottom, and both before the slot. A plain volatile
+   * load gives no ordering on weakly ordered CPUs, the slot contents could then be stale. */
+  const int64_t top = atomic_fetch_and_add_int64(&deque->top, 0);
+  const int64_t bottom = atomic_fetch_and_add_int64(&deque->bottom, 0);
+  if (top >= bottom) {
+    return NULL;
+  }
+
+  /* The slot may be overwritten concurrently, but only after top has been advanced,
+   * in which case the CAS below fails and the values read here are not used. */
+  volatile TaskDequeSlot *slot = &deque->slots[top & DEQUE_MASK];
+  Task *task = slot->task;
+  if (pool != NULL && slot->pool != pool) {
+    return NULL;
+  }
+
+  if (atomic_cas_int64(&deque->top, top, top + 1) != top) {
+    /* Lost the race against the owner or another stealing thread. */
+    return NULL;
+  }
+  return task;
+}
+
 /* Task Scheduler */
 
 static void task_pool_num_decrease(TaskPool *pool, size_t done)
 {
+  /* Fast path, as long as this is not the last task no lock is needed. */
+  size_t num = atomic_add_and_fetch_z(&pool->num, 0);
+  while (num > done) {
+    const size_t num_prev = atomic_cas_z(&pool->num, num, num - done);
+    if (num_prev == num) {
+      return;
+    }
+    num = num_prev;
+  }
+
+  /* The pool may be freed as soon as it's done, so the last decrease happens while holding
+   * the lock waiting threads check it with. */
   BLI_mutex_lock(&pool->num_mutex);
 
   BLI_assert(pool->num >= done);
 
-  pool->num -= done;
-
-  if (pool->num == 0) {
+  if (atomic_sub_and_fetch_z(&pool->num, done) == 0) {
     BLI_condition_notify_all(&pool->num_cond);
   }
 
@@ -345,82 +490,155 @@ static void task_pool_num_decrease(TaskPool *pool, size_t done)
 
 static void task_pool_num_increase(TaskPool *pool, size_t new)
 {
-  BLI_mutex_lock(&pool->num_mutex);
-
-  pool->num += new;
-  BLI_condition_notify_all(&pool->num_cond);
-
-  BLI_mutex_unlock(&pool->num_mutex);
+  atomic_add_and_fetch_z(&pool->num, new);
 }
 
-static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
+/* Wake up threads waiting for tasks of this pool, once new tasks have been pushed. */
+BLI_INLINE void task_pool_notify_waiting(TaskPool *pool)
 {
-  bool found_task = false;
-  BLI_mutex_lock(&scheduler->queue_mutex);
-
-  while (!scheduler->queue.first && !scheduler->do_exit) {
-    BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+  /* Full barrier, pairs with the one in task_pool_wait(). */
+  if (atomic_add_and_fetch_int32(&pool->num_waiting, 0) != 0) {
+    BLI_mutex_lock(&pool->num_mutex);
+    BLI_condition_notify_all(&pool->num_cond);
+    BLI_mutex_unlock(&pool->num_mutex);
   }
+}
 
-  do {
-    Task *current_task;
+/* Wake up sleeping worker threads, once new tasks have been pushed to a deque. */
+BLI_INLINE void task_scheduler_notify_sleeping(TaskScheduler *scheduler, const bool notify_all)
+{
+  /* Full barrier, pairs with the one in task_scheduler_thread_wait_pop(). */
+  if (atomic_add_and_fetch_int32(&scheduler->num_sleeping, 0) != 0) {
+    BLI_mutex_lock(&scheduler->queue_mutex);
+    if (notify_all) {
+      BLI_condition_notify_all(&scheduler->queue_cond);
+    }
+    else {
+      BLI_condition_notify_one(&scheduler->queue_cond);
+    }
+    BLI_mutex_unlock(&scheduler->queue_mutex);
+  }
+}
 
-    /* Assuming we can only have a void queue in 'exit' case here seems logical
-     * (we should only be here after our worker thread has been woken up from a
-     * condition_wait(), which only happens after a new task was added to the queue),
-     * but it is wrong.
-     * Waiting on condition may wake up the thread even if condition is not signaled
-     * (spurious wake-ups), and some race condition may also empty the queue **after**
-     * condition has been signaled, but **before** awoken thread reaches this point...
-     * See http://stackoverflow.com/questions/8594591
-     *
-     * So we only abort here if do_exit is set.
-     */
-    if (scheduler->do_exit) {
-      BLI_mutex_unlock(&scheduler->queue_mutex);
-      return false;
+/* Pop a task from the global queue, queue_mutex must be locked.
+ * When pool is not NULL, only a task from that pool is returned. */
+static Task *task_scheduler_queue_pop(TaskScheduler *scheduler, TaskPool *pool)
+{
+  for (Task *task = scheduler->queue.first; task != NULL; task = task->next) {
+    if (pool != NULL) {
+      if (task->pool != pool) {
+        continue;
+      }
+    }
+    else if (scheduler->background_thread_only && !task->pool->run_in_background) {
+      continue;
     }
 
-    for (current_task = scheduler->queue.first; current_task != NULL;
-         current_task = current_task->next) {
-      TaskPool *pool = current_task->pool;
+    BLI_remlink(&scheduler->queue, task);
+    return task;
+  }
+  return NULL;
+}
 
-      if (scheduler->background_thread_only && !pool->run_in_background) {
+/* Steal a task from the deque of any other thread than own_thread_id (-1 for none).
+ * With NUMA, threads of the same node are tried first, their tasks are more likely to use
+ * memory local to that node. */
+static Task *task_scheduler_steal(TaskScheduler *scheduler, const int own_thread_id, TaskPool *pool)
+{
+  const int num_deques = scheduler->num_threads + 1;
+  const int start = own_thread_id + 1;
+  const int own_node = (own_thread_id != -1) ? scheduler->task_threads[own_thread_id].node : -1;
+  const int num_passes = (own_node != -1) ? 2 : 1;
+
+  for (int pass = 0; pass < num_passes; pass++) {
+    for (int i = 0; i < num_deques; i++) {
+      const int victim_id = (start + i) % num_deques;
+      if (victim_id == own_thread_id) {
         continue;
       }
+      TaskThread *victim = &scheduler->task_threads[victim_id];
+      if (num_passes == 2 && (victim->node == own_node) != (pass == 0)) {
+        continue;
+      }
+      Task *task = task_deque_steal(&victim->deque, pool);
+      if (task != NULL) {
+        return task;
+      }
+    }
+  }
+  return NULL;
+}
 
-      *task = current_task;
-      found_task = true;
-      BLI_remlink(&scheduler->queue, *task);
-      break;
+static Task *task_scheduler_thread_find_task(TaskScheduler *scheduler, TaskThread *thread)
+{
+  /* Own newest task first, it is likely to still be in the cache. */
+  Task *task = task_deque_pop(&thread->deque, NULL);
+  if (task != NULL) {
+    return task;
+  }
+
+  BLI_mutex_lock(&scheduler->queue_mutex);
+  task = task_scheduler_queue_pop(scheduler, NULL);
+  BLI_mutex_unlock(&scheduler->queue_mutex);
+  if (task != NULL) {
+    return task;
+  }
+
+  return task_scheduler_steal(scheduler, thread->id, NULL);
+}
+
+static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler,
+                                           TaskThread *thread,
+                                           Task **task)
+{
+  *task = task_scheduler_thread_find_task(scheduler, thread);
+  if (*task != NULL) {
+    return true;
+  }
+
+  BLI_mutex_lock(&scheduler->queue_mutex);
+
+  /* Full barrier: either threads pushing to a deque see us sleeping and wake us up, or the
+   * search below sees their task. */
+  atomic_add_and_fetch_int32(&scheduler->num_sleeping, 1);
+
+  /* Waiting on condition may wake up the thread even if condition is not signaled
+   * (spurious wake-ups), and some race condition may also empty the queues **after**
+   * condition has been signaled, but **before** awoken thread reaches this point...
+   * See http://stackoverflow.com/questions/8594591
+   *
+   * So we only abort here if do_exit is set.
+   */
+  while (!scheduler->do_exit) {
+    *task = task_scheduler_queue_pop(scheduler, NULL);
+    if (*task == NULL) {
+      *task = task_scheduler_steal(scheduler, thread->id, NULL);
     }
-    if (!found_task) {
-      BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+    if (*task != NULL) {
+      break;
     }
-  } while (!found_task);
+    BLI_condition_wait(&scheduler->queue_cond, &scheduler->queue_mutex);
+  }
+
+  atomic_sub_and_fetch_int32(&scheduler->num_sleeping, 1);
 
   BLI_mutex_unlock(&scheduler->queue_mutex);
 
-  return true;
+  return (*task != NULL);
 }
 
-BLI_INLINE void handle_local_queue(TaskThreadLocalStorage *tls, const int thread_id)
+/* Run the task (unless its pool got canceled), then free it and notify its pool. */
+static void task_run_and_free(Task *task, const int thread_id)
 {
-  BLI_assert(!tls->do_delayed_push);
-  while (tls->num_local_queue > 0) {
-    /* We pop task from queue before handling it so handler of the task can
-     * push next job to the local queue.
-     */
-    tls->num_local_queue--;
-    Task *local_task = tls->local_queue[tls->num_local_queue];
-    /* TODO(sergey): Double-check work_and_wait() doesn't handle other's
-     * pool tasks.
-     */
-    TaskPool *local_pool = local_task->pool;
-    local_task->run(local_pool, local_task->taskdata, thread_id);
-    task_free(local_pool, local_task, thread_id);
+  TaskPool *pool = task->pool;
+
+  if (!pool->do_cancel) {
+    task->run(pool, task->taskdata, thread_id);
   }
-  BLI_assert(!tls->do_delayed_push);
+
+  task_free(pool, task, thread_id);
+
+  task_pool_num_decrease(pool, 1);
 }
 
 static void *task_scheduler_thread_run(void *thread_p)
@@ -433,6 +651,13 @@ static void *task_scheduler_thread_run(void *thread_p)
 
   pthread_setspecific(scheduler->tls_id_key, thread);
 
+  if (thread->node != -1) {
+    BLI_thread_numa_run_thread_on_node(thread->node);
+    /* Initialize thread data from the thread itself once it runs on its node, so pages which
+     * are only used by this thread get allocated on that node (first touch policy). */
+    memset(thread->deque.slots, 0, sizeof(thread->deque.slots));
+  }
+
   /* signal the main thread when all threads have started */
   BLI_mutex_lock(&scheduler->startup_mutex);
   scheduler->num_thread_started++;
@@ -442,28 +667,55 @@ static void *task_scheduler_thread_run(void *thread_p)
   BLI_mutex_unlock(&scheduler->startup_mutex);
 
   /* keep popping off tasks */
-  while (task_scheduler_thread_wait_pop(scheduler, &task)) {
-    TaskPool *pool = task->pool;
-
-    /* run task */
+  while (task_scheduler_thread_wait_pop(scheduler, thread, &task)) {
     BLI_assert(!tls->do_delayed_push);
-    task->run(pool, task->taskdata, thread_id);
+    task_run_and_free(task, thread_id);
     BLI_assert(!tls->do_delayed_push);
+  }
 
-    /* delete task */
-    task_free(pool, task, thread_id);
+  UNUSED_VARS_NDEBUG(tls);
 
-    /* Handle all tasks from local queue. */
-    handle_local_queue(tls, thread_id);
+  return NULL;
+}
 
-    /* notify pool task was done */
-    task_pool_num_decrease(pool, 1);
+/* Pin worker threads to NUMA nodes, in contiguous blocks proportional to the number of
+ * processors of each node. Main thread is left alone. */
+static void task_scheduler_numa_assign_nodes(TaskScheduler *scheduler)
+{
+  const int num_nodes = BLI_thread_numa_num_nodes();
+  const int num_threads = scheduler->num_threads;
+
+  int num_processors = 0;
+  for (int node = 0; node < num_nodes; node++) {
+    num_processors += BLI_thread_numa_node_num_processors(node);
+  }
+
+  int thread_index = 0;
+  int num_processors_done = 0;
+  for (int node = 0; node < num_nodes; node++) {
+    num_processors_done += BLI_thread_numa_node_num_processors(node);
+    const int thread_index_end = (node == num_nodes - 1) ?
+                                     num_threads :
+                                     (int)(((int64_t)num_threads * num_processors_done) /
+                                           num_processors);
+    for (; thread_index < thread_index_end; thread_index++) {
+      scheduler->task_threads[thread_index + 1].node = node;
+    }
   }
 
-  return NULL;
+  scheduler->num_nodes = num_nodes;
 }
 
 TaskScheduler *BLI_task_scheduler_create(int num_threads)
+{
+  return BLI_task_scheduler_create_ex(num_threads, false);
+}
+
+/**
+ * Create a scheduler, \a use_numa pins worker threads to the NUMA nodes of the system.
+ * This is ignored when there is a single node.
+ */
+TaskScheduler *BLI_task_scheduler_create_ex(int num_threads, bool use_numa)
 {
   TaskScheduler *scheduler = MEM_callocN(sizeof(TaskScheduler), "TaskScheduler");
 
@@ -474,6 +726,7 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
   BLI_listbase_clear(&scheduler->queue);
   BLI_mutex_init(&scheduler->queue_mutex);
   BLI_condition_init(&scheduler->queue_cond);
+  scheduler->num_sleeping = 0;
 
   BLI_mutex_init(&scheduler->startup_mutex);
   BLI_condition_init(&scheduler->startup_cond);
@@ -496,8 +749,13 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
   scheduler->task_threads = MEM_mallocN(sizeof(TaskThread) * (num_threads + 1),
                                         "TaskScheduler task threads");
 
-  /* Initialize TLS for main thread. */
+  /* Initialize TLS and deque for main thread. */
   initialize_task_tls(&scheduler->task_threads[0].tls);
+  task_deque_init(&scheduler->task_threads[0].deque);
+  for (int i = 0; i < num_threads + 1; i++) {
+    scheduler->task_threads[i].node = -1;
+  }
+  scheduler->num_nodes = 1;
 
   pthread_key_create(&scheduler->tls_id_key, NULL);
 
@@ -508,11 +766,16 @@ TaskScheduler *BLI_task_scheduler_create(int num_threads)
     scheduler->num_threads = num_threads;
     scheduler->threads = MEM_callocN(sizeof(pthread_t) * num_threads, "TaskScheduler threads");
 
+    if (use_numa && !scheduler->background_thread_only && BLI_thread_numa_num_nodes() > 1) {
+      task_scheduler_numa_assign_nodes(scheduler);
+    }
+
     for (i = 0; i < num_threads; i++) {
       TaskThread *thread = &scheduler->task_threads[i + 1];
       thread->scheduler = scheduler;
       thread->id = i + 1;
       initialize_task_tls(&thread->tls);
+      task_deque_init(&thread->deque);
 
       if (pthread_create(&scheduler->threads[i], NULL, task_scheduler_thread_run, thread) != 0) {
         fprintf(stderr, "TaskScheduler failed to launch thread %d/%d\n", i, num_threads);
@@ -564,6 +827,8 @@ void BLI_task_scheduler_free(TaskScheduler *scheduler)
     for (int i = 0; i < scheduler->num_threads + 1; i++) {
       TaskThreadLocalStorage *tls = &scheduler->task_threads[i].tls;
       free_task_tls(tls);
+      /* All pools are expected to be freed, which leaves no tasks in the deques. */
+      BLI_assert(scheduler->task_threads[i].deque.top == scheduler->task_threads[i].deque.bottom);
     }
 
     MEM_freeN(scheduler->task_threads);
@@ -591,7 +856,9 @@ int BLI_task_scheduler_num_threads(TaskScheduler *scheduler)
 
 static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriority priority)
 {
-  task_pool_num_increase(task->pool, 1);
+  TaskPool *pool = task->pool;
+
+  task_pool_num_increase(pool, 1);
 
   /* add task to queue */
   BLI_mutex_lock(&scheduler->queue_mutex);
@@ -605,27 +872,8 @@ static void task_scheduler_push(TaskScheduler *scheduler, Task *task, TaskPriori
 
   BLI_condition_notify_one(&scheduler->queue_cond);
   BLI_mutex_unlock(&scheduler->queue_mutex);
-}
-
-static void task_scheduler_push_all(TaskScheduler *scheduler,
-                                    TaskPool *pool,
-                                    Task **tasks,
-                                    int num_tasks)
-{
-  if (num_tasks == 0) {
-    return;
-  }
-
-  task_pool_num_increase(pool, num_tasks);
 
-  BLI_mutex_lock(&scheduler->queue_mutex);
-
-  for (int i = 0; i < num_tasks; i++) {
-    BLI_addhead(&scheduler->queue, tasks[i]);
-  }
-
-  BLI_condition_notify_all(&scheduler->queue_cond);
-  BLI_mutex_unlock(&scheduler->queue_mutex);
+  task_pool_notify_waiting(pool);
 }
 
 static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
@@ -650,7 +898,9 @@ static void task_scheduler_clear(TaskScheduler *scheduler, TaskPool *pool)
   BLI_mutex_unlock(&scheduler->queue_mutex);
 
   /* notify done */
-  task_pool_num_decrease(pool, done);
+  if (done != 0) {
+    task_pool_num_decrease(pool, done);
+  }
 }
 
 /* Task Pool */
@@ -677,6 +927,7 @@ static TaskPool *task_pool_create_ex(TaskScheduler *scheduler,
 
   pool->scheduler = scheduler;
   pool->num = 0;
+  pool->num_waiting = 0;
   pool->do_cancel = false;
   pool->do_work = false;
   pool->is_suspended = is_suspended;
@@ -796,9 +1047,15 @@ void BLI_task_pool_free(TaskPool *pool)
   BLI_threaded_malloc_end();
 }
 
+/* Whether the calling thread can push tasks of the pool to its own deque. */
 BLI_INLINE bool task_can_use_local_queues(TaskPool *pool, int thread_id)
 {
-  return (thread_id != -1 && (thread_id != pool->thread_id || pool->do_work));
+  /* The single worker thread of a background-only scheduler must not get any task of
+   * regular pools, keep everything in the global queue then. Thread ID 0 is used by both the
+   * main thread and threads unknown to the scheduler, only the former owns deque 0. */
+  return (thread_id != -1 && !pool->scheduler->background_thread_only &&
+          (thread_id != 0 || BLI_thread_is_main()) &&
+          (thread_id != pool->thread_id || pool->do_work));
 }
 
 static void task_pool_push(TaskPool *pool,
@@ -827,27 +1084,22 @@ static void task_pool_push(TaskPool *pool,
     atomic_fetch_and_add_z(&pool->num_suspended, 1);
     return;
   }
-  /* Populate to any local queue first, this is cheapest push ever. */
+  /* Push to the thread's own deque, this is cheapest push ever: no lock, and the
+   * task will be picked up next by this thread unless another one steals it first. */
   if (task_can_use_local_queues(pool, thread_id)) {
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
-    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-    /* Try to push to a local execution queue.
-     * These tasks will be picked up next.
-     */
-    if (tls->num_local_queue < LOCAL_QUEUE_SIZE) {
-      tls->local_queue[tls->num_local_queue] = task;
-      tls->num_local_queue++;
-      return;
-    }
-    /* If we are in the delayed tasks push mode, we push tasks to a
-     * temporary local queue first without any locks, and then move them
-     * to global execution queue with a single lock.
-     */
-    if (tls->do_delayed_push && tls->num_delayed_queue < DELAYED_QUEUE_SIZE) {
-      tls->delayed_queue[tls->num_delayed_queue] = task;
-      tls->num_delayed_queue++;
+    TaskThread *thread = &pool->scheduler->task_threads[thread_id];
+    task_pool_num_increase(pool, 1);
+    if (task_deque_push(&thread->deque, task)) {
+      /* In the delayed tasks push mode, other threads are woken up once at the end. */
+      if (!thread->tls.do_delayed_push) {
+        task_scheduler_notify_sleeping(pool->scheduler, false);
+        task_pool_notify_waiting(pool);
+      }
       return;
     }
+    /* Deque is full or used by another pool, fall back to the global queue. */
+    atomic_sub_and_fetch_z(&pool->num, 1);
   }
   /* Do push to a global execution pool, slowest possible method,
    * causes quite reasonable amount of threading overhead.
@@ -881,85 +1133,91 @@ void BLI_task_pool_push_from_thread(TaskPool *pool,
   task_pool_push(pool, run, taskdata, free_taskdata, NULL, priority, thread_id);
 }
 
-void BLI_task_pool_work_and_wait(TaskPool *pool)
+/* Find a task of the given pool, for the thread which created it. Tasks from other pools are
+ * never picked up here, that could lead to a deadlock. */
+static Task *task_pool_find_task(TaskPool *pool)
 {
-  TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
   TaskScheduler *scheduler = pool->scheduler;
-
-  if (atomic_fetch_and_and_uint8((uint8_t *)&pool->is_suspended, 0)) {
-    if (pool->num_suspended) {
-      task_pool_num_increase(pool, pool->num_suspended);
-      BLI_mutex_lock(&scheduler->queue_mutex);
-
-      BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
-
-      BLI_condition_notify_all(&scheduler->queue_cond);
-      BLI_mutex_unlock(&scheduler->queue_mutex);
-
-      pool->num_suspended = 0;
+  /* Threads unknown to the scheduler do not own a deque. */
+  const int own_thread_id = pool->use_local_tls ? -1 : pool->thread_id;
+  Task *task = NULL;
+
+  if (own_thread_id != -1) {
+    task = task_deque_pop(&scheduler->task_threads[own_thread_id].deque, pool);
+    if (task != NULL) {
+      return task;
     }
   }
 
-  pool->do_work = true;
+  BLI_mutex_lock(&scheduler->queue_mutex);
+  task = task_scheduler_queue_pop(scheduler, pool);
+  BLI_mutex_unlock(&scheduler->queue_mutex);
+  if (task != NULL) {
+    return task;
+  }
 
-  ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
+  return task_scheduler_steal(scheduler, own_thread_id, pool);
+}
 
-  handle_local_queue(tls, pool->thread_id);
+/* Run tasks of the pool from the calling thread, until all of them are done. */
+static void task_pool_wait(TaskPool *pool)
+{
+  while (true) {
+    Task *task = task_pool_find_task(pool);
 
-  BLI_mutex_lock(&pool->num_mutex);
+    if (task == NULL) {
+      BLI_mutex_lock(&pool->num_mutex);
 
-  while (pool->num != 0) {
-    Task *task, *work_task = NULL;
-    bool found_task = false;
+      /* Full barrier: either threads pushing new tasks see us waiting and wake us up, or the
+       * search below sees their task. */
+      atomic_add_and_fetch_int32(&pool->num_waiting, 1);
 
-    BLI_mutex_unlock(&pool->num_mutex);
+      while (pool->num != 0 && (task = task_pool_find_task(pool)) == NULL) {
+        BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+      }
 
-    BLI_mutex_lock(&scheduler->queue_mutex);
+      atomic_sub_and_fetch_int32(&pool->num_waiting, 1);
 
-    /* find task from this pool. if we get a task from another pool,
-     * we can get into deadlock */
+      BLI_mutex_unlock(&pool->num_mutex);
 
-    for (task = scheduler->queue.first; task; task = task->next) {
-      if (task->pool == pool) {
-        work_task = task;
-        found_task = true;
-        BLI_remlink(&scheduler->queue, task);
+      if (task == NULL) {
+        /* All tasks are done. */
         break;
       }
     }
 
-    BLI_mutex_unlock(&scheduler->queue_mutex);
-
-    /* if found task, do it, otherwise wait until other tasks are done */
-    if (found_task) {
-      /* run task */
-      BLI_assert(!tls->do_delayed_push);
-      work_task->run(pool, work_task->taskdata, pool->thread_id);
-      BLI_assert(!tls->do_delayed_push);
+    task_run_and_free(task, pool->thread_id);
+  }
+}
 
-      /* delete task */
-      task_free(pool, task, pool->thread_id);
+void BLI_task_pool_work_and_wait(TaskPool *pool)
+{
+  TaskThreadLocalStorage *tls = get_task_tls(pool, pool->thread_id);
+  TaskScheduler *scheduler = pool->scheduler;
 
-      /* Handle all tasks from local queue. */
-      handle_local_queue(tls, pool->thread_id);
+  if (atomic_fetch_and_and_uint8((uint8_t *)&pool->is_suspended, 0)) {
+    if (pool->num_suspended) {
+      task_pool_num_increase(pool, pool->num_suspended);
+      BLI_mutex_lock(&scheduler->queue_mutex);
 
-      /* notify pool task was done */
-      task_pool_num_decrease(pool, 1);
-    }
+      BLI_movelisttolist(&scheduler->queue, &pool->suspended_queue);
 
-    BLI_mutex_lock(&pool->num_mutex);
-    if (pool->num == 0) {
-      break;
-    }
+      BLI_condition_notify_all(&scheduler->queue_cond);
+      BLI_mutex_unlock(&scheduler->queue_mutex);
 
-    if (!found_task) {
-      BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
+      pool->num_suspended = 0;
     }
   }
 
-  BLI_mutex_unlock(&pool->num_mutex);
+  pool->do_work = true;
+
+  ASSERT_THREAD_ID(pool->scheduler, pool->thread_id);
 
-  BLI_assert(tls->num_local_queue == 0);
+  BLI_assert(!tls->do_delayed_push);
+  task_pool_wait(pool);
+  BLI_assert(!tls->do_delayed_push);
+
+  UNUSED_VARS_NDEBUG(tls);
 }
 
 void BLI_task_pool_work_wait_and_reset(TaskPool *pool)
@@ -976,12 +1234,9 @@ void BLI_task_pool_cancel(TaskPool *pool)
 
   task_scheduler_clear(pool->scheduler, pool);
 
-  /* wait until all entries are cleared */
-  BLI_mutex_lock(&pool->num_mutex);
-  while (pool->num) {
-    BLI_condition_wait(&pool->num_cond, &pool->num_mutex);
-  }
-  BLI_mutex_unlock(&pool->num_mutex);
+  /* Tasks can't be removed from the deques of other threads, those are discarded without
+   * running when popped. Wait until all entries are cleared, helping with that. */
+  task_pool_wait(pool);
 
   pool->do_cancel = false;
 }
@@ -1005,8 +1260,8 @@ void BLI_task_pool_delayed_push_begin(TaskPool *pool, int thread_id)
 {
   if (task_can_use_local_queues(pool, thread_id)) {
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
-    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-    tls->do_delayed_push = true;
+    TaskThread *thread = &pool->scheduler->task_threads[thread_id];
+    thread->tls.do_delayed_push = true;
   }
 }
 
@@ -1014,11 +1269,12 @@ void BLI_task_pool_delayed_push_end(TaskPool *pool, int thread_id)
 {
   if (task_can_use_local_queues(pool, thread_id)) {
     ASSERT_THREAD_ID(pool->scheduler, thread_id);
-    TaskThreadLocalStorage *tls = get_task_tls(pool, thread_id);
-    BLI_assert(tls->do_delayed_push);
-    task_scheduler_push_all(pool->scheduler, pool, tls->delayed_queue, tls->num_delayed_queue);
-    tls->do_delayed_push = false;
-    tls->num_delayed_queue = 0;
+    TaskThread *thread = &pool->scheduler->task_threads[thread_id];
+    BLI_assert(thread->tls.do_delayed_push);
+    thread->tls.do_delayed_push = false;
+    /* Wake up everyone who could help with the tasks pushed in the meantime. */
+    task_scheduler_notify_sleeping(pool->scheduler, true);
+    task_pool_notify_waiting(pool);
   }
 }
 
@@ -1091,6 +1347,11 @@ typedef struct TaskParallelRangePool {
   TaskParallelRangeState *current_state;
   /* Scheduling settings common to all tasks. */
   TaskParallelSettings *settings;
+
+  /* With a NUMA-aware scheduler, single range split in one part per node, threads process the
+   * part of their own node first and only then help with the other ones. */
+  TaskParallelRangeState *node_states;
+  int num_node_states;
 } TaskParallelRangePool;
 
 BLI_INLINE void task_parallel_calc_chunk_size(const TaskParallelSettings *settings,
@@ -1215,6 +1476,29 @@ BLI_INLINE bool parallel_range_next_iter_get(TaskParallelRangePool *__restrict r
   return (current_state != NULL && previter < current_state->stop);
 }
 
+BLI_INLINE bool parallel_range_node_next_iter_get(TaskParallelRangePool *__restrict range_pool,
+                                                  const int node,
+                                                  int *__restrict r_iter,
+                                                  int *__restrict r_count,
+                                                  TaskParallelRangeState **__restrict r_state)
+{
+  for (int i = 0; i < range_pool->num_node_states; i++) {
+    TaskParallelRangeState *state = &range_pool->node_states[(node + i) %
+                                                             range_pool->num_node_states];
+    if (atomic_fetch_and_add_int32(&state->iter_value, 0) >= state->stop) {
+      continue;
+    }
+    const int previter = atomic_fetch_and_add_int32(&state->iter_value, range_pool->chunk_size);
+    if (previter < state->stop) {
+      *r_iter = previter;
+      *r_count = min_ii(range_pool->chunk_size, state->stop - previter);
+      *r_state = state;
+      return true;
+    }
+  }
+  return false;
+}
+
 static void parallel_range_func(TaskPool *__restrict pool, void *tls_data_idx, int thread_id)
 {
   TaskParallelRangePool *__restrict range_pool = BLI_task_pool_userdata(pool);
@@ -1222,8 +1506,22 @@ static void parallel_range_func(TaskPool *__restrict pool, void *tls_data_idx, i
       .thread_id = thread_id,
       .userdata_chunk = NULL,
   };
-  TaskParallelRangeState *state;
-  int iter, count;
+  TaskParallelRangeState *state = NULL;
+  int iter = 0, count = 0;
+
+  if (range_pool->node_states != NULL) {
+    /* Main thread is not pinned, let it start with first node. */
+    const int node = max_ii(0, pool->scheduler->task_threads[thread_id].node);
+    while (parallel_range_node_next_iter_get(range_pool, node, &iter, &count, &state)) {
+      tls.userdata_chunk = (char *)state->flatten_tls_storage +
+                           (((size_t)POINTER_AS_INT(tls_data_idx)) * state->tls_data_size);
+      for (int i = 0; i < count; i++) {
+        state->func(state->userdata_shared, iter + i, &tls);
+      }
+    }
+    return;
+  }
+
   while (parallel_range_next_iter_get(range_pool, &iter, &count, &state)) {
     tls.userdata_chunk = (char *)state->flatten_tls_storage +
                          (((size_t)POINTER_AS_INT(tls_data_idx)) * state->tls_data_size);
@@ -1264,6 +1562,45 @@ static void parallel_range_single_thread(TaskParallelRangePool *range_pool)
   }
 }
 
+/* Split the range of the given state in one part per NUMA node, sized after the number of
+ * threads running on each node, so that memory first touched by a node keeps being processed by
+ * the same node in following loops over the same range. */
+static void task_parallel_range_numa_split(TaskScheduler *scheduler,
+                                           TaskParallelRangePool *range_pool,
+                                           const TaskParallelRangeState *state)
+{
+  const int num_nodes = scheduler->num_nodes;
+  TaskParallelRangeState *node_states = MEM_mallocN(sizeof(*node_states) * (size_t)num_nodes,
+                                                    __func__);
+
+  /* Main thread counts for first node. */
+  int num_threads_done = 1;
+  const int num_threads = scheduler->num_threads + 1;
+  int start = state->start;
+  const int64_t num_iters = state->stop - state->start;
+
+  for (int node = 0; node < num_nodes; node++) {
+    for (int i = 1; i < num_threads; i++) {
+      if (scheduler->task_threads[i].node == node) {
+        num_threads_done++;
+      }
+    }
+    const int stop = (node == num_nodes - 1) ?
+                         state->stop :
+                         state->start + (int)((num_iters * num_threads_done) / num_threads);
+
+    node_states[node] = *state;
+    node_states[node].next = NULL;
+    node_states[node].start = start;
+    node_states[node].stop = stop;
+    node_states[node].iter_value = start;
+    start = stop;
+  }
+
+  range_pool->node_states = node_states;
+  range_pool->num_node_states = num_nodes;
+}
+
 /**
  * This function allows to parallelized for loops in a similar way to OpenMP's
  * 'parallel for' statement.
@@ -1341,6 +1678,10 @@ void BLI_task_parallel_range(const int start,
     state.tls_data_size = tls_data_size;
   }
 
+  if (task_scheduler->num_nodes > 1) {
+    task_parallel_range_numa_split(task_scheduler, &range_pool, &state);
+  }
+
   for (i = 0; i < num_tasks; i++) {
     if (use_tls_data) {
       void *userdata_chunk_local = (char *)flatten_tls_storage + (tls_data_size * (size_t)i);
@@ -1358,6 +1699,10 @@ void BLI_task_parallel_range(const int start,
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
+  if (range_pool.node_states != NULL) {
+    MEM_freeN(range_pool.node_states);
+  }
+
   if (use_tls_data) {
     if (settings->func_finalize != NULL) {
       for (i = 0; i < num_tasks; i++) {
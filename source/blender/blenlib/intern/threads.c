@@ -125,6 +125,7 @@ static pthread_t mainid;
 static bool is_numa_available = false;
 static unsigned int thread_levels = 0; /* threads can be invoked inside threads */
 static int num_threads_override = 0;
+static bool use_numa_scheduler = false;
 
 /* just a max for security reasons */
 #define RE_MAX_THREAD BLENDER_MAX_THREADS
@@ -174,7 +175,7 @@ TaskScheduler *BLI_task_scheduler_get(void)
     /* Do a lazy initialization, so it happens after
      * command line arguments parsing
      */
-    task_scheduler = BLI_task_scheduler_create(tot_thread);
+    task_scheduler = BLI_task_scheduler_create_ex(tot_thread, use_numa_scheduler);
   }
 
   return task_scheduler;
@@ -392,6 +393,16 @@ int BLI_system_num_threads_override_get(void)
   return num_threads_override;
 }
 
+void BLI_system_numa_scheduler_set(bool use_numa)
+{
+  use_numa_scheduler = use_numa;
+}
+
+bool BLI_system_numa_scheduler_get(void)
+{
+  return use_numa_scheduler;
+}
+
 /* Global Mutex Locks */
 
 static ThreadMutex *global_mutex_from_type(const int type)
@@ -966,3 +977,53 @@ void BLI_thread_put_thread_on_fast_node(void)
   }
 #endif
 }
+
+/* Map from our node index to the NUMA API one, skipping nodes without processors. */
+static int numa_nodes[RE_MAX_THREAD];
+static int numa_num_nodes = -1;
+
+static void numa_nodes_ensure(void)
+{
+  if (numa_num_nodes != -1) {
+    return;
+  }
+  int num_nodes = 0;
+  if (is_numa_available) {
+    const int num_api_nodes = numaAPI_GetNumNodes();
+    for (int node = 0; node < num_api_nodes && num_nodes < RE_MAX_THREAD; node++) {
+      if (numaAPI_IsNodeAvailable(node) && numaAPI_GetNumNodeProcessors(node) > 0) {
+        numa_nodes[num_nodes++] = node;
+      }
+    }
+  }
+  numa_num_nodes = MAX2(num_nodes, 1);
+  if (num_nodes == 0) {
+    numa_nodes[0] = -1;
+  }
+}
+
+int BLI_thread_numa_num_nodes(void)
+{
+  numa_nodes_ensure();
+  return numa_num_nodes;
+}
+
+int BLI_thread_numa_node_num_processors(int node)
+{
+  numa_nodes_ensure();
+  BLI_assert(node >= 0 && node < numa_num_nodes);
+  if (numa_nodes[node] == -1) {
+    return BLI_system_thread_count();
+  }
+  return numaAPI_GetNumNodeProcessors(numa_nodes[node]);
+}
+
+bool BLI_thread_numa_run_thread_on_node(int node)
+{
+  numa_nodes_ensure();
+  BLI_assert(node >= 0 && node < numa_num_nodes);
+  if (numa_nodes[node] == -1) {
+    return false;
+  }
+  return numaAPI_RunThreadOnNode(numa_nodes[node]);
+}
@@ -34,6 +34,7 @@
 #include "BLI_utildefines.h"
 #ifndef WIN32
 #  include <unistd.h>  // for read close
+#  include <sys/mman.h>  // for mmap
 #else
 #  include <io.h>  // for open close read
 #  include "winsock2.h"
@@ -100,6 +101,7 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_ghash.h"
 
 #include "BLT_translation.h"
@@ -222,6 +224,31 @@
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Map uncompressed files into memory instead of reading them,
+ * blocks which don't need endian switching are accessed in place from the mapping,
+ * only copied into their final allocation (or reconstructed directly from the mapping).
+ *
+ * This saves the intermediate block allocation and the `read()` calls, it's not zero-copy:
+ * the data read ends up owned by #Main, where it's edited, reallocated and freed with
+ * guarded-alloc, so even blocks with the same DNA and no pointers to fix up (like mesh
+ * element arrays) are copied once out of the read-only mapping.
+ *
+ * \note Not used on WIN32, where the `mmap` emulation isn't thread-safe.
+ */
+#if defined(USE_BHEAD_READ_ON_DEMAND) && !defined(WIN32)
+#  define USE_BHEAD_MMAP
+#endif
+
+/**
+ * When the file's DNA differs from the current one, reconstruct the structs of each data-block
+ * in parallel before it's read, see #read_libblock_reconstruct_parallel.
+ * Only blocks which data is already in memory (or mapped) are handled this way.
+ */
+#ifdef USE_BHEAD_READ_ON_DEMAND
+#  define USE_BHEAD_RECONSTRUCT_PARALLEL
+#endif
+
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
@@ -238,6 +265,7 @@
 #endif
 
 /* local prototypes */
+static int fd_read_from_memory(FileData *filedata, void *buffer, uint size);
 static void read_libraries(FileData *basefd, ListBase *mainlist);
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
 static void direct_link_modifiers(FileData *fd, ListBase *lb, Object *ob);
@@ -257,6 +285,10 @@ typedef struct BHeadN {
   off64_t file_offset;
   /** When set, the remainder of this allocation is the data, otherwise it needs to be read. */
   bool has_data;
+#endif
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  /** Result of #DNA_struct_reconstruct computed ahead of time, taken by #read_struct. */
+  void *data_reconstructed;
 #endif
   struct BHead bhead;
 } BHeadN;
@@ -852,6 +884,9 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->next = new_bhead->prev = NULL;
           new_bhead->file_offset = fd->file_offset;
           new_bhead->has_data = false;
+#  ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+          new_bhead->data_reconstructed = NULL;
+#  endif
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->seek(fd, bhead.len, SEEK_CUR);
           if (seek_new == -1) {
@@ -873,6 +908,9 @@ static BHeadN *get_bhead(FileData *fd)
 #ifdef USE_BHEAD_READ_ON_DEMAND
           new_bhead->file_offset = 0; /* don't seek. */
           new_bhead->has_data = true;
+#endif
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+          new_bhead->data_reconstructed = NULL;
 #endif
           new_bhead->bhead = bhead;
 
@@ -956,11 +994,31 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
 }
 
 #ifdef USE_BHEAD_READ_ON_DEMAND
+/**
+ * Access the data of a block which hasn't been read, in place.
+ *
+ * \return The read-only data from the file buffer or NULL when it's not available.
+ */
+static const void *blo_bhead_data_in_place(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  /* Mapped files and decompressed block files, see #fd_read_zlib_blocks_from_file. */
+  if ((fd->read == fd_read_from_memory) && (fd->seek != NULL) && (new_bhead->has_data == false)) {
+    return fd->buffer + new_bhead->file_offset;
+  }
+  return NULL;
+}
+
 static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
 {
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  const void *data = blo_bhead_data_in_place(fd, thisblock);
+  if (data != NULL) {
+    memcpy(buf, data, new_bhead->bhead.len);
+    return true;
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -983,6 +1041,9 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   new_bhead_data->bhead = new_bhead->bhead;
   new_bhead_data->file_offset = new_bhead->file_offset;
   new_bhead_data->has_data = true;
+#  ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  new_bhead_data->data_reconstructed = NULL;
+#  endif
   if (!blo_bhead_read_data(fd, thisblock, new_bhead_data + 1)) {
     MEM_freeN(new_bhead_data);
     return NULL;
@@ -1171,12 +1232,243 @@ static int fd_read_gzip_from_file(FileData *filedata, void *buffer, uint size)
   return (readsize);
 }
 
+/* Memory mapped file reading. */
+
+#ifdef USE_BHEAD_MMAP
+/**
+ * Map the whole file read-only, reading is then done with #fd_read_from_memory.
+ *
+ * \return The mapping or NULL on failure, in which case the file is read regularly.
+ */
+static char *fd_mmap_file(int file, int64_t *r_buffersize)
+{
+  const size_t size = BLI_file_descriptor_size(file);
+  if (size == (size_t)-1 || size == 0) {
+    return NULL;
+  }
+
+  void *mem = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (mem == MAP_FAILED) {
+    return NULL;
+  }
+  /* Blocks are mostly accessed in file order. */
+  madvise(mem, size, MADV_SEQUENTIAL);
+
+  *r_buffersize = (int64_t)size;
+  return mem;
+}
+#endif
+
+/* Block compressed file reading, see #BLO_ZLIB_BLOCK_SIZE. */
+
+typedef struct ZlibBlockRead {
+  /** Offset of the member in the compressed data. */
+  size_t member_offset;
+  uint member_len;
+  /** Offset of the uncompressed data in the output buffer. */
+  size_t data_offset;
+  uint data_len;
+} ZlibBlockRead;
+
+typedef struct ZlibBlockReadData {
+  const uchar *mem;
+  uchar *buffer;
+  const ZlibBlockRead *blocks;
+  bool error;
+} ZlibBlockReadData;
+
+static uint zlib_block_read_uint16(const uchar *src)
+{
+  return (uint)src[0] | ((uint)src[1] << 8);
+}
+
+static uint zlib_block_read_uint32(const uchar *src)
+{
+  return zlib_block_read_uint16(src) | (zlib_block_read_uint16(src + 2) << 16);
+}
+
+/**
+ * Check whether \a header starts a member written by the block compressed writer,
+ * \a header_len is the number of bytes available from \a header.
+ *
+ * \note Only the header is checked, callers check the member length against the size of the
+ * data they have.
+ */
+static bool zlib_block_header_parse(const uchar *header,
+                                    const size_t header_len,
+                                    uint *r_member_len,
+                                    uint *r_data_len)
+{
+  if (header_len < BLO_ZLIB_BLOCK_HEADER_SIZE) {
+    return false;
+  }
+  if (!(header[0] == 0x1f && header[1] == 0x8b && header[2] == Z_DEFLATED &&
+        header[3] == 0x04 && zlib_block_read_uint16(&header[10]) == BLO_ZLIB_BLOCK_XLEN &&
+        header[12] == 'B' && header[13] == 'L' &&
+        zlib_block_read_uint16(&header[14]) == BLO_ZLIB_BLOCK_SLEN)) {
+    return false;
+  }
+
+  const uint member_len = zlib_block_read_uint32(&header[16]);
+  if (member_len < BLO_ZLIB_BLOCK_HEADER_SIZE + BLO_ZLIB_BLOCK_TRAILER_SIZE) {
+    return false;
+  }
+
+  *r_member_len = member_len;
+  *r_data_len = zlib_block_read_uint32(&header[20]);
+  return true;
+}
+
+static void zlib_block_inflate_cb(void *__restrict userdata,
+                                  const int index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZlibBlockReadData *data = userdata;
+  const ZlibBlockRead *block = &data->blocks[index];
+  const uchar *member = data->mem + block->member_offset;
+  const uchar *trailer = member + block->member_len - BLO_ZLIB_BLOCK_TRAILER_SIZE;
+  uchar *buffer = data->buffer + block->data_offset;
+  z_stream strm = {NULL};
+
+  if (inflateInit2(&strm, -MAX_WBITS) != Z_OK) {
+    data->error = true;
+    return;
+  }
+
+  strm.next_in = (Bytef *)member + BLO_ZLIB_BLOCK_HEADER_SIZE;
+  strm.avail_in = block->member_len - BLO_ZLIB_BLOCK_HEADER_SIZE - BLO_ZLIB_BLOCK_TRAILER_SIZE;
+  strm.next_out = buffer;
+  strm.avail_out = block->data_len;
+
+  const int err = inflate(&strm, Z_FINISH);
+  const bool success = (err == Z_STREAM_END) && (strm.total_out == block->data_len) &&
+                       (zlib_block_read_uint32(&trailer[0]) ==
+                        (uint)crc32(0, buffer, block->data_len)) &&
+                       (zlib_block_read_uint32(&trailer[4]) == block->data_len);
+  inflateEnd(&strm);
+
+  if (!success) {
+    data->error = true;
+  }
+}
+
+/**
+ * Inflate block compressed data, members are decompressed in parallel.
+ *
+ * \return The uncompressed data or NULL when \a mem isn't valid block compressed data.
+ */
+static char *zlib_blocks_inflate(const uchar *mem, const size_t mem_len, int64_t *r_buffersize)
+{
+  uint member_len, data_len;
+
+  /* Walk the chunk index stored in the member headers. */
+  int blocks_len = 0, blocks_alloc = 64;
+  ZlibBlockRead *blocks = MEM_mallocN(sizeof(*blocks) * blocks_alloc, __func__);
+  size_t member_offset = 0, data_offset = 0;
+  while (member_offset < mem_len) {
+    if (!zlib_block_header_parse(
+            mem + member_offset, mem_len - member_offset, &member_len, &data_len) ||
+        member_len > mem_len - member_offset) {
+      break;
+    }
+    if (blocks_len == blocks_alloc) {
+      blocks_alloc *= 2;
+      blocks = MEM_reallocN(blocks, sizeof(*blocks) * blocks_alloc);
+    }
+    ZlibBlockRead *block = &blocks[blocks_len++];
+    block->member_offset = member_offset;
+    block->member_len = member_len;
+    block->data_offset = data_offset;
+    block->data_len = data_len;
+
+    member_offset += member_len;
+    data_offset += data_len;
+  }
+
+  char *buffer = NULL;
+  if (blocks_len != 0 && member_offset == mem_len) {
+    buffer = MEM_mallocN(MAX2(data_offset, 1), __func__);
+
+    ZlibBlockReadData data = {
+        .mem = mem,
+        .buffer = (uchar *)buffer,
+        .blocks = blocks,
+        .error = false,
+    };
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, blocks_len, &data, zlib_block_inflate_cb, &settings);
+
+    if (data.error) {
+      MEM_freeN(buffer);
+      buffer = NULL;
+    }
+    else {
+      *r_buffersize = (int64_t)data_offset;
+    }
+  }
+
+  MEM_freeN(blocks);
+
+  return buffer;
+}
+
+/**
+ * Read and inflate a block compressed file.
+ *
+ * \return The uncompressed file contents, or NULL when the file isn't block compressed
+ * (the file position is restored in that case, so it can be read as a regular gzip file).
+ */
+static char *fd_read_zlib_blocks_from_file(int file, int64_t *r_buffersize)
+{
+  uchar header[BLO_ZLIB_BLOCK_HEADER_SIZE];
+  uint member_len, data_len;
+
+  const size_t mem_len = BLI_file_descriptor_size(file);
+  if (mem_len == (size_t)-1) {
+    return NULL;
+  }
+
+  const bool is_block_file = (read(file, header, sizeof(header)) == sizeof(header)) &&
+                             zlib_block_header_parse(
+                                 header, sizeof(header), &member_len, &data_len) &&
+                             (member_len <= mem_len);
+  lseek(file, 0, SEEK_SET);
+  if (!is_block_file) {
+    return NULL;
+  }
+  uchar *mem = MEM_mallocN(mem_len, __func__);
+  size_t mem_read = 0;
+  while (mem_read < mem_len) {
+    const int len = read(file, mem + mem_read, (uint)MIN2(mem_len - mem_read, INT_MAX));
+    if (len <= 0) {
+      break;
+    }
+    mem_read += len;
+  }
+
+  char *buffer = NULL;
+  if (mem_read == mem_len) {
+    buffer = zlib_blocks_inflate(mem, mem_len, r_buffersize);
+  }
+  MEM_freeN(mem);
+
+  if (buffer == NULL) {
+    /* Corrupt or truncated, let the regular gzip reader report the error. */
+    lseek(file, 0, SEEK_SET);
+  }
+
+  return buffer;
+}
+
 /* Memory reading. */
 
 static int fd_read_from_memory(FileData *filedata, void *buffer, uint size)
 {
   /* don't read more bytes then there are available in the buffer */
-  int readsize = (int)MIN2(size, (uint)(filedata->buffersize - filedata->file_offset));
+  int readsize = (int)MIN2((int64_t)size, filedata->buffersize - filedata->file_offset);
 
   memcpy(buffer, filedata->buffer + filedata->file_offset, readsize);
   filedata->file_offset += readsize;
@@ -1184,6 +1476,29 @@ static int fd_read_from_memory(FileData *filedata, void *buffer, uint size)
   return (readsize);
 }
 
+static off64_t fd_seek_from_memory(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_offset;
+  switch (whence) {
+    case SEEK_SET:
+      new_offset = offset;
+      break;
+    case SEEK_CUR:
+      new_offset = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_offset = filedata->buffersize + offset;
+      break;
+    default:
+      return -1;
+  }
+  if (new_offset < 0 || new_offset > filedata->buffersize) {
+    return -1;
+  }
+  filedata->file_offset = new_offset;
+  return new_offset;
+}
+
 /* MemFile reading. */
 
 static int fd_read_from_memfile(FileData *filedata, void *buffer, uint size)
@@ -1289,14 +1604,22 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   return fd;
 }
 
+/**
+ * \param use_zlib_blocks: Inflate block compressed files up-front. This reads the whole file,
+ * callers which only read the header of the file stream the gzip file instead.
+ */
 static FileData *blo_filedata_from_file_descriptor(const char *filepath,
                                                    ReportList *reports,
-                                                   int file)
+                                                   int file,
+                                                   const bool use_zlib_blocks)
 {
   FileDataReadFn *read_fn = NULL;
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  char *buffer = NULL;
+  int64_t buffersize = 0;
+  bool use_mmap = false;
 
   char header[7];
 
@@ -1316,8 +1639,34 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+#ifdef USE_BHEAD_MMAP
+    buffer = fd_mmap_file(file, &buffersize);
+    if (buffer != NULL) {
+      read_fn = fd_read_from_memory;
+      seek_fn = fd_seek_from_memory;
+      use_mmap = true;
+      /* Caller must close, the mapping stays valid. */
+      file = -1;
+    }
+    else
+#endif
+    {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+  }
+
+  /* Block compressed gzip file, decompressed in parallel up-front. */
+  if ((read_fn == NULL) && use_zlib_blocks &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    buffer = fd_read_zlib_blocks_from_file(file, &buffersize);
+    if (buffer != NULL) {
+      read_fn = fd_read_from_memory;
+      seek_fn = fd_seek_from_memory;
+      /* Caller must close. */
+      file = -1;
+    }
   }
 
   /* Gzip file. */
@@ -1351,6 +1700,11 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->buffer = buffer;
+  fd->buffersize = buffersize;
+  if (use_mmap) {
+    fd->flags |= FD_FLAGS_IS_MMAP;
+  }
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1358,7 +1712,9 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   return fd;
 }
 
-static FileData *blo_filedata_from_file_open(const char *filepath, ReportList *reports)
+static FileData *blo_filedata_from_file_open(const char *filepath,
+                                             ReportList *reports,
+                                             const bool use_zlib_blocks)
 {
   errno = 0;
   const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
@@ -1370,7 +1726,7 @@ static FileData *blo_filedata_from_file_open(const char *filepath, ReportList *r
                 errno ? strerror(errno) : TIP_("unknown error reading file"));
     return NULL;
   }
-  FileData *fd = blo_filedata_from_file_descriptor(filepath, reports, file);
+  FileData *fd = blo_filedata_from_file_descriptor(filepath, reports, file, use_zlib_blocks);
   if ((fd == NULL) || (fd->filedes == -1)) {
     close(file);
   }
@@ -1381,7 +1737,7 @@ static FileData *blo_filedata_from_file_open(const char *filepath, ReportList *r
 /* on each new library added, it now checks for the current FileData and expands relativeness */
 FileData *blo_filedata_from_file(const char *filepath, ReportList *reports)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, reports);
+  FileData *fd = blo_filedata_from_file_open(filepath, reports, true);
   if (fd != NULL) {
     /* needed for library_append and read_libraries */
     BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
@@ -1397,7 +1753,8 @@ FileData *blo_filedata_from_file(const char *filepath, ReportList *reports)
  */
 static FileData *blo_filedata_from_file_minimal(const char *filepath)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, NULL);
+  /* Only the header is read, don't inflate the whole file. */
+  FileData *fd = blo_filedata_from_file_open(filepath, NULL, false);
   if (fd != NULL) {
     decode_blender_header(fd);
     if (fd->flags & FD_FLAGS_FILE_OK) {
@@ -1408,6 +1765,18 @@ static FileData *blo_filedata_from_file_minimal(const char *filepath)
   return NULL;
 }
 
+/**
+ * zlib input sizes are 32 bit, give the buffer to the stream in chunks
+ * so files of 4 GB and more are read entirely.
+ */
+static void fd_read_gzip_from_memory_feed(FileData *filedata)
+{
+  if (filedata->strm.avail_in == 0) {
+    const int64_t offset = (int64_t)((const char *)filedata->strm.next_in - filedata->buffer);
+    filedata->strm.avail_in = (uInt)MIN2(filedata->buffersize - offset, (int64_t)UINT_MAX);
+  }
+}
+
 static int fd_read_gzip_from_memory(FileData *filedata, void *buffer, uint size)
 {
   int err;
@@ -1416,7 +1785,10 @@ static int fd_read_gzip_from_memory(FileData *filedata, void *buffer, uint size)
   filedata->strm.avail_out = size;
 
   // Inflate another chunk.
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  do {
+    fd_read_gzip_from_memory_feed(filedata);
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  } while (err == Z_OK && filedata->strm.avail_out != 0 && filedata->strm.avail_in == 0);
 
   if (err == Z_STREAM_END) {
     return 0;
@@ -1435,7 +1807,8 @@ static int fd_read_gzip_from_memory_init(FileData *fd)
 {
 
   fd->strm.next_in = (Bytef *)fd->buffer;
-  fd->strm.avail_in = fd->buffersize;
+  fd->strm.avail_in = 0;
+  fd_read_gzip_from_memory_feed(fd);
   fd->strm.total_out = 0;
   fd->strm.zalloc = Z_NULL;
   fd->strm.zfree = Z_NULL;
@@ -1461,10 +1834,21 @@ FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *rep
 
     fd->buffer = mem;
     fd->buffersize = memsize;
+    fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
 
     /* test if gzip */
     if (cp[0] == 0x1f && cp[1] == 0x8b) {
-      if (0 == fd_read_gzip_from_memory_init(fd)) {
+      int64_t buffersize;
+      char *buffer = zlib_blocks_inflate(mem, memsize, &buffersize);
+      if (buffer != NULL) {
+        /* Block compressed, the decompressed buffer is owned by the file data. */
+        fd->buffer = buffer;
+        fd->buffersize = buffersize;
+        fd->flags &= ~FD_FLAGS_NOT_MY_BUFFER;
+        fd->read = fd_read_from_memory;
+        fd->seek = fd_seek_from_memory;
+      }
+      else if (0 == fd_read_gzip_from_memory_init(fd)) {
         blo_filedata_free(fd);
         return NULL;
       }
@@ -1473,8 +1857,6 @@ FileData *blo_filedata_from_memory(const void *mem, int memsize, ReportList *rep
       fd->read = fd_read_from_memory;
     }
 
-    fd->flags |= FD_FLAGS_NOT_MY_BUFFER;
-
     return blo_decode_and_check(fd, reports);
   }
 }
@@ -1514,10 +1896,25 @@ void blo_filedata_free(FileData *fd)
     }
 
     if (fd->buffer && !(fd->flags & FD_FLAGS_NOT_MY_BUFFER)) {
-      MEM_freeN((void *)fd->buffer);
+#ifdef USE_BHEAD_MMAP
+      if (fd->flags & FD_FLAGS_IS_MMAP) {
+        munmap((void *)fd->buffer, (size_t)fd->buffersize);
+      }
+      else
+#endif
+      {
+        MEM_freeN((void *)fd->buffer);
+      }
       fd->buffer = NULL;
     }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+    /* Reconstructed data which was never read. */
+    LISTBASE_FOREACH (BHeadN *, new_bhead, &fd->bhead_list) {
+      MEM_SAFE_FREE(new_bhead->data_reconstructed);
+    }
+#endif
+
     /* Free all BHeadN data blocks */
 #ifndef NDEBUG
     BLI_freelistN(&fd->bhead_list);
@@ -2206,12 +2603,10 @@ void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd)
 /** \name DNA Struct Loading
  * \{ */
 
-static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
+static void switch_endian_structs(const struct SDNA *filesdna, const BHead *bhead, char *data)
 {
   int blocksize, nblocks;
-  char *data;
 
-  data = (char *)(bhead + 1);
   blocksize = filesdna->types_size[filesdna->structs[bhead->SDNAnr][0]];
 
   nblocks = bhead->nr;
@@ -2226,6 +2621,14 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  if (BHEADN_FROM_BHEAD(bh)->data_reconstructed) {
+    temp = BHEADN_FROM_BHEAD(bh)->data_reconstructed;
+    BHEADN_FROM_BHEAD(bh)->data_reconstructed = NULL;
+    return temp;
+  }
+#endif
+
   if (bh->len) {
 #ifdef USE_BHEAD_READ_ON_DEMAND
     BHead *bh_orig = bh;
@@ -2242,22 +2645,28 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
         }
       }
 #endif
-      switch_endian_structs(fd->filesdna, bh);
+      switch_endian_structs(fd->filesdna, bh, (char *)(bh + 1));
     }
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruction only reads the old data, no need to copy it first. */
+          data = blo_bhead_data_in_place(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              fd->flags &= ~FD_FLAGS_FILE_OK;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
         temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, data);
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2290,6 +2699,130 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+
+typedef struct ReconstructParallelData {
+  FileData *fd;
+  BHeadN **bheads;
+} ReconstructParallelData;
+
+typedef struct ReconstructParallelTLS {
+  /** Scratch buffer for endian switching, the file data itself is left untouched. */
+  char *buffer;
+  int buffer_len;
+} ReconstructParallelTLS;
+
+static bool reconstruct_parallel_test(FileData *fd, BHead *bh)
+{
+  if (bh->len == 0 || BHEADN_FROM_BHEAD(bh)->data_reconstructed != NULL) {
+    return false;
+  }
+  if (!(bh->code == DATA || bh->code == ID_LINK_PLACEHOLDER || BKE_idcode_is_valid(bh->code))) {
+    return false;
+  }
+  if (fd->compflags[bh->SDNAnr] != SDNA_CMP_NOT_EQUAL) {
+    return false;
+  }
+  /* Data that still needs to be read from the file is handled by #read_struct. */
+  return BHEADN_FROM_BHEAD(bh)->has_data || (blo_bhead_data_in_place(fd, bh) != NULL);
+}
+
+static void reconstruct_parallel_cb(void *__restrict userdata,
+                                    const int index,
+                                    const TaskParallelTLS *__restrict tls)
+{
+  ReconstructParallelData *data = userdata;
+  FileData *fd = data->fd;
+  BHeadN *new_bhead = data->bheads[index];
+  BHead *bh = &new_bhead->bhead;
+  const void *bh_data = new_bhead->has_data ? (bh + 1) : blo_bhead_data_in_place(fd, bh);
+
+  if (bh->SDNAnr && (fd->flags & FD_FLAGS_SWITCH_ENDIAN)) {
+    ReconstructParallelTLS *scratch = tls->userdata_chunk;
+    if (scratch->buffer_len < bh->len) {
+      MEM_SAFE_FREE(scratch->buffer);
+      scratch->buffer = MEM_mallocN(bh->len, __func__);
+      scratch->buffer_len = bh->len;
+    }
+    memcpy(scratch->buffer, bh_data, bh->len);
+    switch_endian_structs(fd->filesdna, bh, scratch->buffer);
+    bh_data = scratch->buffer;
+  }
+
+  new_bhead->data_reconstructed = DNA_struct_reconstruct(
+      fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, bh_data);
+}
+
+static void reconstruct_parallel_finalize(void *__restrict UNUSED(userdata),
+                                          void *__restrict userdata_chunk)
+{
+  ReconstructParallelTLS *scratch = userdata_chunk;
+  MEM_SAFE_FREE(scratch->buffer);
+}
+
+/**
+ * Reconstruct the structs of \a bheads in parallel, results are stored in the blocks,
+ * to be taken by #read_struct (or freed with the file data when unused).
+ */
+static void reconstruct_parallel(FileData *fd, BHeadN **bheads, const int bheads_len)
+{
+  ReconstructParallelData data = {
+      .fd = fd,
+      .bheads = bheads,
+  };
+  ReconstructParallelTLS scratch = {NULL};
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.scheduling_mode = TASK_SCHEDULING_DYNAMIC;
+  settings.userdata_chunk = &scratch;
+  settings.userdata_chunk_size = sizeof(scratch);
+  settings.func_finalize = reconstruct_parallel_finalize;
+  BLI_task_parallel_range(0, bheads_len, &data, reconstruct_parallel_cb, &settings);
+}
+
+/**
+ * Reconstruct the blocks of a single data-block (its ID and direct data) in parallel,
+ * right before #read_libblock reads them.
+ *
+ * Working one data-block at a time rather than on the whole file up-front keeps the extra
+ * memory bounded: results are taken by #read_struct immediately, so at most the blocks of the
+ * data-block being read are held in both their file and reconstructed forms.
+ */
+static void read_libblock_reconstruct_parallel(FileData *fd, BHead *bhead_id)
+{
+  BHeadN *bheads_static[64];
+  BHeadN **bheads = bheads_static;
+  int bheads_len = 0, bheads_alloc = ARRAY_SIZE(bheads_static);
+
+  for (BHead *bhead = bhead_id; bhead && (bhead == bhead_id || bhead->code == DATA);
+       bhead = blo_bhead_next(fd, bhead)) {
+    if (reconstruct_parallel_test(fd, bhead)) {
+      if (bheads_len == bheads_alloc) {
+        bheads_alloc *= 2;
+        if (bheads == bheads_static) {
+          bheads = MEM_mallocN(sizeof(*bheads) * bheads_alloc, __func__);
+          memcpy(bheads, bheads_static, sizeof(bheads_static));
+        }
+        else {
+          bheads = MEM_reallocN(bheads, sizeof(*bheads) * bheads_alloc);
+        }
+      }
+      bheads[bheads_len++] = BHEADN_FROM_BHEAD(bhead);
+    }
+  }
+
+  if (bheads_len > 1) {
+    reconstruct_parallel(fd, bheads, bheads_len);
+  }
+
+  if (bheads != bheads_static) {
+    MEM_freeN(bheads);
+  }
+}
+
+#endif /* USE_BHEAD_RECONSTRUCT_PARALLEL */
+
 typedef void (*link_list_cb)(FileData *fd, void *data);
 
 static void link_list_ex(FileData *fd, ListBase *lb, link_list_cb callback) /* only direct data */
@@ -5034,6 +5567,7 @@ static void direct_link_customdata(FileData *fd, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       layer->data = newdataadr(fd, layer->data);
@@ -9385,6 +9919,12 @@ static BHead *read_libblock(FileData *fd,
     }
   }
 
+#ifdef USE_BHEAD_RECONSTRUCT_PARALLEL
+  if (bhead->code != ID_LINK_PLACEHOLDER) {
+    read_libblock_reconstruct_parallel(fd, bhead);
+  }
+#endif
+
   /* read libblock */
   id = read_struct(fd, bhead, "lib block");
 
@@ -11940,7 +12480,7 @@ static int has_linked_ids_to_read(Main *mainvar)
 }
 
 static void read_library_linked_id(
-    ReportList *reports, FileData *fd, Main *mainvar, ID *id, ID **r_id)
+    ReportList *reports, FileData *fd, Main *mainvar, ID *id, const bool is_deferred, ID **r_id)
 {
   BHead *bhead = NULL;
   const bool is_valid = BKE_idcode_is_linkable(GS(id->name)) || ((id->tag & LIB_TAG_EXTERN) == 0);
@@ -11969,17 +12509,24 @@ static void read_library_linked_id(
     read_libblock(fd, mainvar, bhead, id->tag, false, r_id);
   }
   else {
-    blo_reportf_wrap(reports,
-                     RPT_WARNING,
-                     TIP_("LIB: %s: '%s' missing from '%s', parent '%s'"),
-                     BKE_idcode_to_name(GS(id->name)),
-                     id->name + 2,
-                     mainvar->curlib->filepath,
-                     library_parent_filepath(mainvar->curlib));
+    int tag = id->tag;
+    if (is_deferred) {
+      /* Not an error, the actual data-block will be read once it is needed. */
+      tag |= LIB_TAG_DEFERRED;
+    }
+    else {
+      blo_reportf_wrap(reports,
+                       RPT_WARNING,
+                       TIP_("LIB: %s: '%s' missing from '%s', parent '%s'"),
+                       BKE_idcode_to_name(GS(id->name)),
+                       id->name + 2,
+                       mainvar->curlib->filepath,
+                       library_parent_filepath(mainvar->curlib));
+    }
 
     /* Generate a placeholder for this ID (simplified version of read_libblock actually...). */
     if (r_id) {
-      *r_id = is_valid ? create_placeholder(mainvar, GS(id->name), id->name + 2, id->tag) : NULL;
+      *r_id = is_valid ? create_placeholder(mainvar, GS(id->name), id->name + 2, tag) : NULL;
     }
   }
 }
@@ -11987,7 +12534,8 @@ static void read_library_linked_id(
 static void read_library_linked_ids(FileData *basefd,
                                     FileData *fd,
                                     ListBase *mainlist,
-                                    Main *mainvar)
+                                    Main *mainvar,
+                                    const bool is_deferred)
 {
   GHash *loaded_ids = BLI_ghash_str_new(__func__);
 
@@ -12009,7 +12557,7 @@ static void read_library_linked_ids(FileData *basefd,
          * we go back to a single linked data when loading the file. */
         ID **realid = NULL;
         if (!BLI_ghash_ensure_p(loaded_ids, id->name, (void ***)&realid)) {
-          read_library_linked_id(basefd->reports, fd, mainvar, id, realid);
+          read_library_linked_id(basefd->reports, fd, mainvar, id, is_deferred, realid);
         }
 
         /* realid shall never be NULL - unless some source file/lib is broken
@@ -12138,6 +12686,7 @@ static FileData *read_library_file_data(FileData *basefd,
 static void read_libraries(FileData *basefd, ListBase *mainlist)
 {
   Main *mainl = mainlist->first;
+  const bool is_deferred = (basefd->skip_flags & BLO_READ_DEFER_LIBRARIES) != 0;
   bool do_it = true;
 
   /* Expander is now callback function. */
@@ -12164,8 +12713,20 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
                mainptr->curlib->name);
 #endif
 
-        /* Open file if it has not been done yet. */
-        FileData *fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        /* Packed libraries are always read, they cannot be reloaded from their file path. */
+        const bool is_lib_deferred = is_deferred && mainptr->curlib->packedfile == NULL;
+        FileData *fd = NULL;
+
+        if (is_lib_deferred) {
+          /* Library file is not opened at all, all its linked data-blocks become deferred
+           * placeholders. Set lib version to current main one, like for missing libraries. */
+          mainptr->versionfile = mainptr->curlib->versionfile = mainl->versionfile;
+          mainptr->subversionfile = mainptr->curlib->subversionfile = mainl->subversionfile;
+        }
+        else {
+          /* Open file if it has not been done yet. */
+          fd = read_library_file_data(basefd, mainlist, mainl, mainptr);
+        }
 
         if (fd) {
           do_it = true;
@@ -12173,7 +12734,7 @@ static void read_libraries(FileData *basefd, ListBase *mainlist)
 
         /* Read linked data-locks for each link placeholder, and replace
          * the placeholder with the real data-lock. */
-        read_library_linked_ids(basefd, fd, mainlist, mainptr);
+        read_library_linked_ids(basefd, fd, mainlist, mainptr, is_lib_deferred);
 
         /* Test if linked data-locks need to read further linked data-locks
          * and create link placeholders for them. */
@@ -46,6 +46,8 @@ enum eFileDataFlag {
   FD_FLAGS_NOT_MY_BUFFER = 1 << 4,
   /* XXX Unused in practice (checked once but never set). */
   FD_FLAGS_NOT_MY_LIBMAP = 1 << 5,
+  /** #FileData.buffer is a read-only mapping of the file. */
+  FD_FLAGS_IS_MMAP = 1 << 6,
 };
 
 /* Disallow since it's 32bit on ms-windows. */
@@ -65,7 +67,7 @@ typedef struct FileData {
   ListBase bhead_list;
   enum eFileDataFlag flags;
   bool is_eof;
-  int buffersize;
+  int64_t buffersize;
   int64_t file_offset;
 
   FileDataReadFn *read;
@@ -126,6 +128,34 @@ typedef struct FileData {
 
 #define SIZEOFBLENDERHEADER 12
 
+/**
+ * Block compressed files (written when #G_FILE_COMPRESS is set).
+ *
+ * The file is a sequence of independently deflated gzip members, so any gzip reader
+ * still decompresses it to a regular blend file. Each member header stores an extra
+ * field with the size of the whole member and the size of its uncompressed data,
+ * this acts as a chunk index, allowing members to be located without inflating them
+ * and to be decompressed in parallel.
+ *
+ * Member header layout (all values little endian):
+ * <pre>
+ * `1f 8b 08 04`   gzip magic, deflate, #FEXTRA flag.
+ * `MTIME`         `uint32`, always zero.
+ * `XFL OS`        `uchar[2]`.
+ * `XLEN`          `uint16`, #BLO_ZLIB_BLOCK_XLEN.
+ * `B L`           sub-field identifier.
+ * `SLEN`          `uint16`, #BLO_ZLIB_BLOCK_SLEN.
+ * `member_len`    `uint32`, size of the member in bytes (header and trailer included).
+ * `data_len`      `uint32`, size of the uncompressed data.
+ * </pre>
+ */
+#define BLO_ZLIB_BLOCK_SIZE (1 << 20)
+#define BLO_ZLIB_BLOCK_SLEN 8
+#define BLO_ZLIB_BLOCK_XLEN (4 + BLO_ZLIB_BLOCK_SLEN)
+#define BLO_ZLIB_BLOCK_HEADER_SIZE (12 + BLO_ZLIB_BLOCK_XLEN)
+/** CRC32 and ISIZE. */
+#define BLO_ZLIB_BLOCK_TRAILER_SIZE 8
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
@@ -145,6 +145,8 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "BKE_action.h"
 #include "BKE_blender_version.h"
@@ -215,7 +217,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZlibBlockWriter *zlib_handle;
   } _user_data;
 };
 
@@ -246,32 +248,194 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib
+ *
+ * Data is split into blocks of #BLO_ZLIB_BLOCK_SIZE which are deflated in parallel,
+ * each one written as its own gzip member, see #BLO_ZLIB_BLOCK_SIZE for details. */
+#define ZLIB_HANDLE(ww) (ww)->_user_data.zlib_handle
+
+typedef struct ZlibBlock {
+  uchar *data;
+  size_t data_len;
+  /** Gzip member, header and trailer included. */
+  uchar *member;
+  size_t member_len;
+  bool error;
+} ZlibBlock;
+
+typedef struct ZlibBlockWriter {
+  int file_handle;
+  /** Blocks compressed together, the last used one is being filled by #ww_write_zlib. */
+  ZlibBlock *blocks;
+  int blocks_num;
+  int blocks_used;
+  size_t member_len_max;
+  bool error;
+} ZlibBlockWriter;
 
-static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+static void zlib_block_write_uint16(uchar *dst, uint value)
+{
+  dst[0] = (uchar)(value & 0xff);
+  dst[1] = (uchar)((value >> 8) & 0xff);
+}
+
+static void zlib_block_write_uint32(uchar *dst, uint value)
 {
-  gzFile file;
+  zlib_block_write_uint16(dst, value & 0xffff);
+  zlib_block_write_uint16(dst + 2, value >> 16);
+}
 
-  file = BLI_gzopen(filepath, "wb1");
+static void zlib_block_compress_cb(void *__restrict userdata,
+                                   const int index,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ZlibBlockWriter *writer = userdata;
+  ZlibBlock *block = &writer->blocks[index];
+  z_stream strm = {NULL};
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
-    return true;
+  block->error = true;
+
+  /* Negative window bits for a raw deflate stream, the gzip framing is written here. */
+  if (deflateInit2(&strm, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    return;
   }
-  else {
+
+  strm.next_in = block->data;
+  strm.avail_in = (uInt)block->data_len;
+  strm.next_out = block->member + BLO_ZLIB_BLOCK_HEADER_SIZE;
+  strm.avail_out = (uInt)(writer->member_len_max - BLO_ZLIB_BLOCK_HEADER_SIZE -
+                          BLO_ZLIB_BLOCK_TRAILER_SIZE);
+
+  const int err = deflate(&strm, Z_FINISH);
+  const size_t deflate_len = strm.total_out;
+  deflateEnd(&strm);
+
+  if (err != Z_STREAM_END) {
+    return;
+  }
+
+  uchar *header = block->member;
+  block->member_len = BLO_ZLIB_BLOCK_HEADER_SIZE + deflate_len + BLO_ZLIB_BLOCK_TRAILER_SIZE;
+
+  header[0] = 0x1f;
+  header[1] = 0x8b;
+  header[2] = Z_DEFLATED;
+  header[3] = 0x04; /* FEXTRA */
+  zlib_block_write_uint32(&header[4], 0);
+  header[8] = 0x04; /* Fastest compression. */
+  header[9] = 0xff; /* Unknown OS. */
+  zlib_block_write_uint16(&header[10], BLO_ZLIB_BLOCK_XLEN);
+  header[12] = 'B';
+  header[13] = 'L';
+  zlib_block_write_uint16(&header[14], BLO_ZLIB_BLOCK_SLEN);
+  zlib_block_write_uint32(&header[16], (uint)block->member_len);
+  zlib_block_write_uint32(&header[20], (uint)block->data_len);
+
+  uchar *trailer = block->member + block->member_len - BLO_ZLIB_BLOCK_TRAILER_SIZE;
+  zlib_block_write_uint32(&trailer[0], (uint)crc32(0, block->data, (uInt)block->data_len));
+  zlib_block_write_uint32(&trailer[4], (uint)block->data_len);
+
+  block->error = false;
+}
+
+/**
+ * Compress all filled blocks in parallel, then write them to the file in order.
+ */
+static void zlib_block_writer_flush(ZlibBlockWriter *writer)
+{
+  const int blocks_num = (writer->blocks_used < writer->blocks_num &&
+                          writer->blocks[writer->blocks_used].data_len != 0) ?
+                             writer->blocks_used + 1 :
+                             writer->blocks_used;
+  if (blocks_num == 0 || writer->error) {
+    return;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, blocks_num, writer, zlib_block_compress_cb, &settings);
+
+  for (int i = 0; i < blocks_num; i++) {
+    ZlibBlock *block = &writer->blocks[i];
+    if (block->error ||
+        (size_t)write(writer->file_handle, block->member, block->member_len) != block->member_len) {
+      writer->error = true;
+      break;
+    }
+    block->data_len = 0;
+  }
+  writer->blocks_used = 0;
+}
+
+static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
+{
+  const int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+
+  if (file == -1) {
     return false;
   }
+
+  ZlibBlockWriter *writer = MEM_callocN(sizeof(*writer), __func__);
+  writer->file_handle = file;
+  /* Enough blocks to keep all threads busy, without holding on to too much memory. */
+  writer->blocks_num = MAX2(BLI_system_thread_count(), 1) * 2;
+  writer->blocks = MEM_callocN(sizeof(*writer->blocks) * writer->blocks_num, __func__);
+  writer->member_len_max = BLO_ZLIB_BLOCK_HEADER_SIZE + compressBound(BLO_ZLIB_BLOCK_SIZE) +
+                           BLO_ZLIB_BLOCK_TRAILER_SIZE;
+  for (int i = 0; i < writer->blocks_num; i++) {
+    writer->blocks[i].data = MEM_mallocN(BLO_ZLIB_BLOCK_SIZE, __func__);
+    writer->blocks[i].member = MEM_mallocN(writer->member_len_max, __func__);
+  }
+
+  ZLIB_HANDLE(ww) = writer;
+  return true;
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZlibBlockWriter *writer = ZLIB_HANDLE(ww);
+
+  zlib_block_writer_flush(writer);
+
+  bool success = !writer->error;
+  if (close(writer->file_handle) == -1) {
+    success = false;
+  }
+
+  for (int i = 0; i < writer->blocks_num; i++) {
+    MEM_freeN(writer->blocks[i].data);
+    MEM_freeN(writer->blocks[i].member);
+  }
+  MEM_freeN(writer->blocks);
+  MEM_freeN(writer);
+  ZLIB_HANDLE(ww) = NULL;
+
+  return success;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZlibBlockWriter *writer = ZLIB_HANDLE(ww);
+  size_t written = 0;
+
+  while (written < buf_len && !writer->error) {
+    ZlibBlock *block = &writer->blocks[writer->blocks_used];
+    const size_t len = MIN2(buf_len - written, BLO_ZLIB_BLOCK_SIZE - block->data_len);
+
+    memcpy(block->data + block->data_len, buf + written, len);
+    block->data_len += len;
+    written += len;
+
+    if (block->data_len == BLO_ZLIB_BLOCK_SIZE) {
+      writer->blocks_used++;
+      if (writer->blocks_used == writer->blocks_num) {
+        zlib_block_writer_flush(writer);
+      }
+    }
+  }
+
+  return writer->error ? 0 : written;
 }
-#undef FILE_HANDLE
+#undef ZLIB_HANDLE
 
 /* --- end compression types --- */
 
@@ -284,6 +448,7 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->open = ww_open_zlib;
       r_ww->close = ww_close_zlib;
       r_ww->write = ww_write_zlib;
+      /* Blocks are already buffered. */
       r_ww->use_buf = false;
       break;
     }
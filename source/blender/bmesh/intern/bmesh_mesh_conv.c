@@ -583,9 +583,10 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
 #if 0
   oldverts = MEM_dupallocN(me->mvert);
 #else
-    oldverts = me->mvert;
-    me->mvert = NULL;
     CustomData_update_typemap(&me->vdata);
+    /* The array can be shared with evaluated copies of the mesh, which keep using it. */
+    oldverts = CustomData_duplicate_referenced_layer(&me->vdata, CD_MVERT, me->totvert);
+    me->mvert = NULL;
     CustomData_set_layer(&me->vdata, CD_MVERT, NULL);
 #endif
   }
@@ -59,6 +59,18 @@ typedef enum CompositorPriority {
   COM_PRIORITY_LOW = 0,
 } CompositorPriority;
 
+/**
+ * \brief Possible execution models
+ * \see CompositorContext.executionModel
+ * \ingroup Execution
+ */
+typedef enum CompositorExecutionModel {
+  /** \brief Execute output operations per chunk, reading their inputs pixel by pixel */
+  COM_EXECUTION_MODEL_TILED = 0,
+  /** \brief Execute every operation for its whole area at once, keeping its result in a buffer */
+  COM_EXECUTION_MODEL_FULL_FRAME = 1,
+} CompositorExecutionModel;
+
 // configurable items
 
 // chunk size determination
@@ -103,6 +115,22 @@ typedef enum OrderOfChunks {
 
 #define COM_RULE_OF_THIRDS_DIVIDER 100.0f
 
+/**
+ * \brief Number of rows of an area calculated by a single task of the full frame execution model
+ */
+#define COM_FULL_FRAME_ROWS_PER_TASK 16
+
+/**
+ * \brief Maximum number of pixels calculated at once by NodeOperation.executeSpan
+ * \note spans of the inputs are kept on the stack, for every operation reading its inputs as spans
+ */
+#define COM_SPAN_WIDTH 32
+
+/**
+ * \brief Maximum number of inputs of operations calculating spans
+ */
+#define COM_SPAN_MAX_INPUTS 3
+
 #define COM_NUM_CHANNELS_VALUE 1
 #define COM_NUM_CHANNELS_VECTOR 3
 #define COM_NUM_CHANNELS_COLOR 4
@@ -25,6 +25,7 @@ CompositorContext::CompositorContext()
   this->m_scene = NULL;
   this->m_rd = NULL;
   this->m_quality = COM_QUALITY_HIGH;
+  this->m_executionModel = COM_EXECUTION_MODEL_TILED;
   this->m_hasActiveOpenCLDevices = false;
   this->m_fastCalculation = false;
   this->m_viewSettings = NULL;
@@ -46,6 +46,13 @@ class CompositorContext {
    */
   CompositorQuality m_quality;
 
+  /**
+   * \brief The execution model of the composite.
+   * This field is initialized in ExecutionSystem and must only be read from that point on.
+   * \see ExecutionSystem
+   */
+  CompositorExecutionModel m_executionModel;
+
   Scene *m_scene;
 
   /**
@@ -214,6 +221,22 @@ class CompositorContext {
     return this->m_quality;
   }
 
+  /**
+   * \brief set the execution model
+   */
+  void setExecutionModel(CompositorExecutionModel executionModel)
+  {
+    this->m_executionModel = executionModel;
+  }
+
+  /**
+   * \brief get the execution model
+   */
+  CompositorExecutionModel getExecutionModel() const
+  {
+    return this->m_executionModel;
+  }
+
   /**
    * \brief get the current frame-number of the scene in this context
    */
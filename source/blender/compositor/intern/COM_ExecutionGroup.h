@@ -329,6 +329,15 @@ class ExecutionGroup {
    */
   NodeOperation *getOutputOperation() const;
 
+  /**
+   * \brief get the area of the output operation that will be calculated
+   * \note this is the whole resolution of the group, unless a viewer or render border is set
+   */
+  const rcti *getViewerBorder() const
+  {
+    return &this->m_viewerBorder;
+  }
+
   /**
    * \brief compose multiple chunks into a single chunk
    * \return Memorybuffer *consolidated chunk
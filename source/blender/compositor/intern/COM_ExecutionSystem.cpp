@@ -30,6 +30,7 @@ extern "C" {
 #include "COM_NodeOperationBuilder.h"
 #include "COM_NodeOperation.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_WorkScheduler.h"
 #include "COM_ReadBufferOperation.h"
 #include "COM_Debug.h"
@@ -60,6 +61,7 @@ ExecutionSystem::ExecutionSystem(RenderData *rd,
     this->m_context.setQuality((CompositorQuality)editingtree->edit_quality);
   }
   this->m_context.setRendering(rendering);
+  this->m_context.setExecutionModel((CompositorExecutionModel)editingtree->execution_mode);
   this->m_context.setHasActiveOpenCLDevices(WorkScheduler::hasGPUDevices() &&
                                             (editingtree->flag & NTREE_COM_OPENCL));
 
@@ -172,6 +174,18 @@ void ExecutionSystem::execute()
       operation->initExecution();
     }
   }
+
+  if (this->m_context.getExecutionModel() == COM_EXECUTION_MODEL_FULL_FRAME) {
+    executeFullFrame();
+
+    editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
+    for (index = 0; index < this->m_operations.size(); index++) {
+      NodeOperation *operation = this->m_operations[index];
+      operation->deinitExecution();
+    }
+    return;
+  }
+
   for (index = 0; index < this->m_groups.size(); index++) {
     ExecutionGroup *executionGroup = this->m_groups[index];
     executionGroup->setChunksize(this->m_context.getChunksize());
@@ -200,6 +214,19 @@ void ExecutionSystem::execute()
   }
 }
 
+void ExecutionSystem::executeFullFrame()
+{
+  vector<ExecutionGroup *> outputGroups;
+  findOutputExecutionGroup(&outputGroups, COM_PRIORITY_HIGH);
+  if (!this->getContext().isFastCalculation()) {
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_MEDIUM);
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_LOW);
+  }
+
+  FullFrameExecutionModel executionModel(this->m_context, outputGroups);
+  executionModel.execute();
+}
+
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
   unsigned int index;
@@ -173,7 +173,8 @@ class ExecutionSystem {
   /**
    * \brief execute this system
    * - initialize the NodeOperation's and ExecutionGroup's
-   * - schedule the output ExecutionGroup's based on their priority
+   * - schedule the output ExecutionGroup's based on their priority, or execute the operations
+   *   of the output ExecutionGroup's one by one when using the full frame execution model
    * - deinitialize the ExecutionGroup's and NodeOperation's
    */
   void execute();
@@ -189,6 +190,12 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief execute the output operations with the full frame execution model
+   * \see FullFrameExecutionModel
+   */
+  void executeFullFrame();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -0,0 +1,755 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <typeinfo>
+
+#include "COM_FullFrameExecutionModel.h"
+
+#include "BKE_node.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_utildefines.h"
+
+#include "BLT_translation.h"
+
+#include "COM_CPUDevice.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
+
+#include "DNA_ID.h"
+#include "DNA_color_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_texture_types.h"
+
+#include "MEM_guardedalloc.h"
+
+typedef struct AreaTaskData {
+  NodeOperation *operation;
+  /** Buffer to write the result to, NULL for output operations. */
+  MemoryBuffer *output;
+  /** Calculate the area at once, otherwise it is calculated pixel by pixel. */
+  bool useArea;
+  MemoryBuffer **inputs;
+  const rcti *area;
+  const bNodeTree *bTree;
+  const vector<CPUDevice *> *devices;
+} AreaTaskData;
+
+static void execute_pixels(NodeOperation *operation, MemoryBuffer *output, rcti *rect)
+{
+  const int num_channels = output->get_num_channels();
+  void *data = operation->initializeTileData(rect);
+  for (int y = rect->ymin; y < rect->ymax; y++) {
+    float *elem = output->getElem(rect->xmin, y);
+    for (int x = rect->xmin; x < rect->xmax; x++) {
+      if (operation->isComplex()) {
+        operation->read(elem, x, y, data);
+      }
+      else {
+        operation->readSampled(elem, x, y, COM_PS_NEAREST);
+      }
+      elem += num_channels;
+    }
+  }
+  if (data) {
+    operation->deinitializeTileData(rect, data);
+  }
+}
+
+static void execute_area_task(void *__restrict userdata,
+                              const int index,
+                              const TaskParallelTLS *__restrict tls)
+{
+  AreaTaskData *data = (AreaTaskData *)userdata;
+  if (data->bTree->test_break && data->bTree->test_break(data->bTree->tbh)) {
+    return;
+  }
+
+  /* Single threaded operations calculate the whole area in a single task. */
+  const int rows = data->operation->isSingleThreaded() ? BLI_rcti_size_y(data->area) :
+                                                         COM_FULL_FRAME_ROWS_PER_TASK;
+  rcti rect;
+  rect.xmin = data->area->xmin;
+  rect.xmax = data->area->xmax;
+  rect.ymin = data->area->ymin + index * rows;
+  rect.ymax = min(rect.ymin + rows, data->area->ymax);
+
+  WorkScheduler::set_thread_device((*data->devices)[tls->thread_id]);
+  if (data->output == NULL) {
+    data->operation->executeRegion(&rect, 0);
+  }
+  else if (data->useArea) {
+    data->operation->updateMemoryBufferPartial(data->output, &rect, data->inputs);
+  }
+  else {
+    execute_pixels(data->operation, data->output, &rect);
+  }
+  WorkScheduler::set_thread_device(NULL);
+}
+
+FullFrameExecutionModel::FullFrameExecutionModel(const CompositorContext &context,
+                                                 const vector<ExecutionGroup *> &outputGroups)
+    : m_context(context), m_bTree(context.getbNodeTree()), m_outputGroups(outputGroups)
+{
+  /* Final renders composite every render result once, there is nothing to reuse. */
+  m_useCache = !context.isRendering();
+
+  const RenderData *rd = context.getRenderData();
+  ResultCacheHash hash;
+  hash.add(context.getFramenumber());
+  hash.add((int)context.getQuality());
+  hash.add((int)context.isFastCalculation());
+  hash.add(context.getViewName() ? context.getViewName() : "");
+  hash.add(rd->xsch);
+  hash.add(rd->ysch);
+  hash.add((int)rd->size);
+  hash.add(rd->mode & (R_BORDER | R_CROP));
+  hash.add(&rd->border, sizeof(rd->border));
+  m_contextKey = hash.getKey();
+
+  /* The calling thread takes part in the execution with thread id 0. */
+  const int num_threads = BLI_task_scheduler_num_threads(BLI_task_scheduler_get());
+  for (int thread_id = 0; thread_id <= num_threads; thread_id++) {
+    m_devices.push_back(new CPUDevice(thread_id));
+  }
+}
+
+FullFrameExecutionModel::~FullFrameExecutionModel()
+{
+  /* Buffers left when execution was cancelled. */
+  for (OperationBuffers::iterator iter = m_buffers.begin(); iter != m_buffers.end(); ++iter) {
+    OperationBuffer &operationBuffer = iter->second;
+    if (operationBuffer.buffer) {
+      iter->first->setOutputBuffer(NULL);
+      if (operationBuffer.owned) {
+        delete operationBuffer.buffer;
+      }
+      else if (operationBuffer.cached) {
+        ResultCache::release(operationBuffer.buffer);
+      }
+    }
+  }
+  m_buffers.clear();
+
+  while (!m_devices.empty()) {
+    delete m_devices.back();
+    m_devices.pop_back();
+  }
+}
+
+void FullFrameExecutionModel::getDependencies(NodeOperation *operation,
+                                              vector<NodeOperation *> *r_dependencies)
+{
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    if (input->isConnected()) {
+      r_dependencies->push_back(&input->getLink()->getOperation());
+    }
+  }
+  if (operation->isReadBufferOperation()) {
+    ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+    r_dependencies->push_back(readOperation->getMemoryProxy()->getWriteBufferOperation());
+  }
+}
+
+bool FullFrameExecutionModel::hashNode(const bNode *node, ResultCacheHash &hash)
+{
+  if (node->id) {
+    switch (GS(node->id->name)) {
+      case ID_SCE:
+        /* Render results are stored by scene name. Caches are cleared whenever a render result
+         * is replaced or freed (new render, render slot change, file load). */
+        hash.add(node->id->name);
+        break;
+      case ID_NT:
+        break;
+      default:
+        /* Images, movie clips, masks and textures can change without the node changing. */
+        return false;
+    }
+  }
+  if (node->type == CMP_NODE_DEFOCUS) {
+    /* Uses the settings of the scene camera. */
+    return false;
+  }
+
+  hash.add(node->idname);
+  hash.add(node->type);
+  /* UI only flags like selection or collapsing the node don't change the result. */
+  hash.add(node->flag & (NODE_MUTED | NODE_PREVIEW));
+  hash.add((int)node->custom1);
+  hash.add((int)node->custom2);
+  hash.add(&node->custom3, sizeof(node->custom3));
+  hash.add(&node->custom4, sizeof(node->custom4));
+  if (node->storage && !hashNodeStorage(node, hash)) {
+    return false;
+  }
+  LISTBASE_FOREACH (const bNodeSocket *, sock, &node->inputs) {
+    if (sock->default_value) {
+      hash.add(sock->default_value, MEM_allocN_len(sock->default_value));
+    }
+  }
+  /* Which operations a node adds depends on the outputs that are used. */
+  LISTBASE_FOREACH (const bNodeSocket *, sock, &node->outputs) {
+    hash.add(sock->flag & SOCK_IN_USE);
+  }
+  return true;
+}
+
+bool FullFrameExecutionModel::hashNodeStorage(const bNode *node, ResultCacheHash &hash)
+{
+  /* Only the content of the storage is hashed, pointers differ between copies of the node tree
+   * and can be reused by other data once freed. */
+  switch (node->type) {
+    case CMP_NODE_ALPHAOVER:
+    case CMP_NODE_BILATERALBLUR:
+    case CMP_NODE_BLUR:
+    case CMP_NODE_BOKEHIMAGE:
+    case CMP_NODE_MASK_BOX:
+    case CMP_NODE_CHANNEL_MATTE:
+    case CMP_NODE_CHROMA_MATTE:
+    case CMP_NODE_COLOR_MATTE:
+    case CMP_NODE_DIFF_MATTE:
+    case CMP_NODE_DIST_MATTE:
+    case CMP_NODE_LUMA_MATTE:
+    case CMP_NODE_COLOR_SPILL:
+    case CMP_NODE_COLORBALANCE:
+    case CMP_NODE_COLORCORRECTION:
+    case CMP_NODE_CROP:
+    case CMP_NODE_DENOISE:
+    case CMP_NODE_DILATEERODE:
+    case CMP_NODE_DBLUR:
+    case CMP_NODE_MASK_ELLIPSE:
+    case CMP_NODE_GLARE:
+    case CMP_NODE_KEYING:
+    case CMP_NODE_LENSDIST:
+    case CMP_NODE_SUNBEAMS:
+    case CMP_NODE_TONEMAP:
+    case CMP_NODE_TRANSLATE:
+    case CMP_NODE_VALTORGB:
+    case CMP_NODE_VECBLUR:
+      /* Plain settings without pointers. */
+      hash.add(node->storage, MEM_allocN_len(node->storage));
+      return true;
+    case CMP_NODE_TIME:
+    case CMP_NODE_CURVE_VEC:
+    case CMP_NODE_CURVE_RGB:
+    case CMP_NODE_HUECORRECT: {
+      const CurveMapping *cumap = (const CurveMapping *)node->storage;
+      hash.add(cumap->flag);
+      hash.add(&cumap->clipr, sizeof(cumap->clipr));
+      hash.add(cumap->black, sizeof(cumap->black));
+      hash.add(cumap->white, sizeof(cumap->white));
+      hash.add((int)cumap->tone);
+      for (int index = 0; index < CM_TOT; index++) {
+        const CurveMap *cuma = &cumap->cm[index];
+        hash.add((int)cuma->totpoint);
+        hash.add(cuma->ext_in, sizeof(cuma->ext_in));
+        hash.add(cuma->ext_out, sizeof(cuma->ext_out));
+        for (int point = 0; point < cuma->totpoint; point++) {
+          hash.add(&cuma->curve[point].x, sizeof(float[2]));
+          hash.add((int)cuma->curve[point].flag);
+        }
+      }
+      return true;
+    }
+    case CMP_NODE_CRYPTOMATTE: {
+      const NodeCryptomatte *data = (const NodeCryptomatte *)node->storage;
+      hash.add(data->add, sizeof(data->add));
+      hash.add(data->remove, sizeof(data->remove));
+      hash.add(data->matte_id ? data->matte_id : "");
+      hash.add(data->num_inputs);
+      return true;
+    }
+    case CMP_NODE_MAP_VALUE: {
+      const TexMapping *texmap = (const TexMapping *)node->storage;
+      hash.add(texmap->loc, sizeof(texmap->loc));
+      hash.add(texmap->size, sizeof(texmap->size));
+      hash.add(texmap->min, sizeof(texmap->min));
+      hash.add(texmap->max, sizeof(texmap->max));
+      hash.add(texmap->flag);
+      return true;
+    }
+    default:
+      /* Storage that is not known to be free of pointers or external data. */
+      return false;
+  }
+}
+
+bool FullFrameExecutionModel::isCacheable(NodeOperation *operation) const
+{
+  return m_useCache && !operation->isReadBufferOperation() &&
+         !operation->isWriteBufferOperation() && !operation->isSetOperation() &&
+         !operation->isOutputOperation(m_context.isRendering()) && operation->getWidth() > 0 &&
+         operation->getHeight() > 0;
+}
+
+ResultCacheKey FullFrameExecutionModel::getKey(NodeOperation *operation)
+{
+  OperationKeys::iterator found = m_keys.find(operation);
+  if (found != m_keys.end()) {
+    return found->second;
+  }
+
+  ResultCacheKey key;
+  if (operation->isReadBufferOperation()) {
+    key = getKey(((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation());
+  }
+  else if (operation->isWriteBufferOperation()) {
+    key = getKey(&operation->getInputSocket(0)->getLink()->getOperation());
+  }
+  else {
+    key = hashOperation(operation);
+  }
+  m_keys[operation] = key;
+  return key;
+}
+
+ResultCacheKey FullFrameExecutionModel::hashOperation(NodeOperation *operation)
+{
+  ResultCacheHash hash;
+  hash.add(m_contextKey);
+  hash.add(typeid(*operation).name());
+  hash.add((int)operation->getWidth());
+  hash.add((int)operation->getHeight());
+  hash.add((int)operation->getOutputSocket()->getDataType());
+  /* Only this area of the result is calculated. */
+  hash.add(&m_areas[operation], sizeof(rcti));
+
+  /* The settings of an operation come from the node it has been created for, operations added
+   * by the compositor itself only depend on their inputs. */
+  const bNode *node = operation->getbNode();
+  if (node) {
+    if (!hashNode(node, hash)) {
+      return COM_RESULT_CACHE_KEY_NONE;
+    }
+    hash.add((int)operation->getbNodeIndex());
+  }
+
+  if (operation->isSetOperation()) {
+    float value[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    operation->readSampled(value, 0, 0, COM_PS_NEAREST);
+    hash.add(value, sizeof(value));
+  }
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    ResultCacheKey inputKey = COM_RESULT_CACHE_KEY_NONE;
+    if (input->isConnected()) {
+      inputKey = getKey(&input->getLink()->getOperation());
+      if (inputKey == COM_RESULT_CACHE_KEY_NONE) {
+        return COM_RESULT_CACHE_KEY_NONE;
+      }
+    }
+    hash.add(inputKey);
+  }
+  return hash.getKey();
+}
+
+void FullFrameExecutionModel::addToCache(NodeOperation *operation)
+{
+  OperationBuffer &operationBuffer = m_buffers[operation];
+  const ResultCacheKey key = getKey(operation);
+  if (key == COM_RESULT_CACHE_KEY_NONE) {
+    return;
+  }
+
+  if (operationBuffer.owned) {
+    if (ResultCache::add(key, operationBuffer.buffer)) {
+      operationBuffer.owned = false;
+      operationBuffer.cached = true;
+    }
+  }
+  else {
+    /* The result is in the buffer of a MemoryProxy, which is freed after this execution. */
+    MemoryBuffer *buffer = new MemoryBuffer(operation->getOutputSocket()->getDataType(),
+                                            operationBuffer.buffer->getRect());
+    buffer->copyContentFrom(operationBuffer.buffer);
+    if (ResultCache::add(key, buffer)) {
+      ResultCache::release(buffer);
+    }
+    else {
+      delete buffer;
+    }
+  }
+}
+
+void FullFrameExecutionModel::determineAreaOrder(NodeOperation *operation,
+                                                 vector<NodeOperation *> *r_operations)
+{
+  if (m_areas.find(operation) != m_areas.end()) {
+    return;
+  }
+  rcti area;
+  BLI_rcti_init(&area, 0, 0, 0, 0);
+  m_areas[operation] = area;
+
+  vector<NodeOperation *> dependencies;
+  getDependencies(operation, &dependencies);
+  for (unsigned int index = 0; index < dependencies.size(); index++) {
+    determineAreaOrder(dependencies[index], r_operations);
+  }
+  r_operations->push_back(operation);
+}
+
+void FullFrameExecutionModel::determineAreas()
+{
+  /* The areas are part of the cache keys, they are determined for all operations first. */
+  vector<NodeOperation *> operations;
+  for (unsigned int index = 0; index < m_outputGroups.size(); index++) {
+    determineAreaOrder(m_outputGroups[index]->getOutputOperation(), &operations);
+  }
+  for (unsigned int index = 0; index < m_outputGroups.size(); index++) {
+    addArea(m_outputGroups[index]->getOutputOperation(), m_outputGroups[index]->getViewerBorder());
+  }
+
+  /* Readers come after the operations they read, their areas are complete once reached. */
+  for (int index = (int)operations.size() - 1; index >= 0; index--) {
+    NodeOperation *operation = operations[index];
+    rcti &area = m_areas[operation];
+
+    rcti resolution;
+    BLI_rcti_init(&resolution, 0, operation->getWidth(), 0, operation->getHeight());
+    if (operation->isSingleThreaded()) {
+      /* Calculated as a whole anyway. */
+      area = resolution;
+    }
+    else if (!BLI_rcti_isect(&area, &resolution, &area) || BLI_rcti_is_empty(&area)) {
+      /* Not read by any operation. */
+      continue;
+    }
+
+    if (operation->isReadBufferOperation()) {
+      addArea(((ReadBufferOperation *)operation)->getMemoryProxy()->getWriteBufferOperation(),
+              &area);
+    }
+    else if (operation->isWriteBufferOperation()) {
+      addArea(&operation->getInputSocket(0)->getLink()->getOperation(), &area);
+    }
+    else {
+      for (unsigned int inputIndex = 0; inputIndex < operation->getNumberOfInputSockets();
+           inputIndex++) {
+        NodeOperationInput *input = operation->getInputSocket(inputIndex);
+        if (input->isConnected()) {
+          rcti inputArea;
+          operation->getAreaOfInterest(inputIndex, &area, &inputArea);
+          addArea(&input->getLink()->getOperation(), &inputArea);
+        }
+      }
+    }
+  }
+}
+
+void FullFrameExecutionModel::addArea(NodeOperation *operation, const rcti *area)
+{
+  if (BLI_rcti_is_empty(area)) {
+    return;
+  }
+  rcti &operationArea = m_areas[operation];
+  if (BLI_rcti_is_empty(&operationArea)) {
+    operationArea = *area;
+  }
+  else {
+    BLI_rcti_union(&operationArea, area);
+  }
+}
+
+void FullFrameExecutionModel::determineOperations(NodeOperation *operation)
+{
+  if (m_buffers.find(operation) != m_buffers.end()) {
+    return;
+  }
+  OperationBuffer operationBuffer = {NULL, false, false, 0, NULL};
+
+  /* The result of a cached operation is used as is, the operations only needed for calculating
+   * it are left out. */
+  if (isCacheable(operation)) {
+    const ResultCacheKey key = getKey(operation);
+    if (key != COM_RESULT_CACHE_KEY_NONE) {
+      operationBuffer.buffer = ResultCache::acquire(key);
+      if (operationBuffer.buffer) {
+        operationBuffer.cached = true;
+        m_buffers[operation] = operationBuffer;
+        m_operations.push_back(operation);
+        return;
+      }
+    }
+  }
+  m_buffers[operation] = operationBuffer;
+
+  vector<NodeOperation *> dependencies;
+  getDependencies(operation, &dependencies);
+  for (unsigned int index = 0; index < dependencies.size(); index++) {
+    determineOperations(dependencies[index]);
+  }
+  m_operations.push_back(operation);
+}
+
+void FullFrameExecutionModel::determineReaders()
+{
+  for (unsigned int index = 0; index < m_operations.size(); index++) {
+    if (m_buffers[m_operations[index]].cached) {
+      continue;
+    }
+    vector<NodeOperation *> dependencies;
+    getDependencies(m_operations[index], &dependencies);
+    for (unsigned int dependency = 0; dependency < dependencies.size(); dependency++) {
+      OperationBuffer &operationBuffer = m_buffers[dependencies[dependency]];
+      operationBuffer.readers++;
+      operationBuffer.reader = m_operations[index];
+    }
+  }
+}
+
+bool FullFrameExecutionModel::isBraked() const
+{
+  return m_bTree->test_break && m_bTree->test_break(m_bTree->tbh);
+}
+
+void FullFrameExecutionModel::updateProgress(unsigned int operationsFinished)
+{
+  const unsigned int numOperations = m_operations.size();
+  m_bTree->progress(m_bTree->prh, (float)operationsFinished / numOperations);
+
+  char buf[128];
+  BLI_snprintf(buf,
+               sizeof(buf),
+               TIP_("Compositing | Operation %u-%u"),
+               operationsFinished,
+               numOperations);
+  m_bTree->stats_draw(m_bTree->sdh, buf);
+}
+
+void FullFrameExecutionModel::execute()
+{
+  determineAreas();
+  for (unsigned int index = 0; index < m_outputGroups.size(); index++) {
+    determineOperations(m_outputGroups[index]->getOutputOperation());
+  }
+  determineReaders();
+
+  for (unsigned int index = 0; index < m_operations.size(); index++) {
+    if (isBraked()) {
+      break;
+    }
+    executeOperation(m_operations[index]);
+    updateProgress(index + 1);
+  }
+}
+
+void FullFrameExecutionModel::executeOperation(NodeOperation *operation)
+{
+  const OperationBuffer &operationBuffer = m_buffers[operation];
+  if (operationBuffer.cached) {
+    /* Found in the cache, its inputs have not been executed. */
+    operation->setOutputBuffer(operationBuffer.buffer);
+    return;
+  }
+
+  if (operation->isReadBufferOperation()) {
+    /* Reads from the buffer of its WriteBufferOperation, which is released together with the
+     * read operation. */
+    return;
+  }
+
+  if (operation->isWriteBufferOperation()) {
+    executeWriteBufferOperation(operation);
+  }
+  else if (operation->isOutputOperation(m_context.isRendering())) {
+    for (unsigned int index = 0; index < m_outputGroups.size(); index++) {
+      if (m_outputGroups[index]->getOutputOperation() == operation) {
+        executeOutputOperation(operation, m_outputGroups[index]->getViewerBorder());
+      }
+    }
+  }
+  else if (operation->getWidth() > 0 && operation->getHeight() > 0) {
+    /* Constant operations are calculated for a single element. */
+    rcti rect, area;
+    if (operation->isSetOperation()) {
+      BLI_rcti_init(&rect, 0, 1, 0, 1);
+      area = rect;
+    }
+    else {
+      BLI_rcti_init(&rect, 0, operation->getWidth(), 0, operation->getHeight());
+      area = m_areas[operation];
+    }
+
+    MemoryBuffer *output = createOutputBuffer(operation, &rect);
+
+    const unsigned int numInputs = operation->getNumberOfInputSockets();
+    vector<MemoryBuffer *> inputs(numInputs);
+    bool useArea = operation->isFullFrameOperation();
+    for (unsigned int index = 0; index < numInputs; index++) {
+      inputs[index] = getInputBuffer(operation, index);
+      if (inputs[index] == NULL || !inputs[index]->coversArea(&area)) {
+        useArea = false;
+      }
+    }
+
+    executeArea(operation, output, &area, useArea, (numInputs) ? &inputs[0] : NULL);
+    operation->setOutputBuffer(output);
+
+    /* Results of cancelled executions are incomplete. */
+    if (isCacheable(operation) && !isBraked()) {
+      addToCache(operation);
+    }
+  }
+
+  vector<NodeOperation *> dependencies;
+  getDependencies(operation, &dependencies);
+  for (unsigned int index = 0; index < dependencies.size(); index++) {
+    releaseOperation(dependencies[index]);
+  }
+}
+
+void FullFrameExecutionModel::executeOutputOperation(NodeOperation *operation, const rcti *area)
+{
+  if (BLI_rcti_is_empty(area)) {
+    return;
+  }
+  executeArea(operation, NULL, area, false, NULL);
+}
+
+void FullFrameExecutionModel::executeWriteBufferOperation(NodeOperation *operation)
+{
+  WriteBufferOperation *writeOperation = (WriteBufferOperation *)operation;
+  MemoryBuffer *buffer = writeOperation->getMemoryProxy()->getBuffer();
+  NodeOperation *input = &operation->getInputSocket(0)->getLink()->getOperation();
+
+  /* The input operation has been calculated directly into the buffer of the proxy. */
+  if (input->getOutputBuffer() != buffer) {
+    rcti area;
+    if (writeOperation->isSingleValue()) {
+      BLI_rcti_init(&area, 0, 1, 0, 1);
+    }
+    else {
+      area = m_areas[operation];
+    }
+    if (!BLI_rcti_is_empty(&area)) {
+      /* WriteBufferOperation.executeRegion reads the pixels from the buffer of its input. */
+      executeArea(operation, NULL, &area, false, NULL);
+    }
+  }
+  if (writeOperation->isSingleValue()) {
+    buffer->setSingleElem();
+  }
+  buffer->setCreatedState();
+}
+
+MemoryBuffer *FullFrameExecutionModel::createOutputBuffer(NodeOperation *operation,
+                                                          const rcti *area)
+{
+  OperationBuffer &operationBuffer = m_buffers[operation];
+
+  /* An operation that is only read by a WriteBufferOperation writes directly to the buffer of
+   * its MemoryProxy, there is no need to copy the result. */
+  if (operationBuffer.readers == 1 && operationBuffer.reader->isWriteBufferOperation() &&
+      !operation->isSetOperation()) {
+    WriteBufferOperation *writeOperation = (WriteBufferOperation *)operationBuffer.reader;
+    MemoryBuffer *buffer = writeOperation->getMemoryProxy()->getBuffer();
+    if (buffer && buffer->getWidth() == BLI_rcti_size_x(area) &&
+        buffer->getHeight() == BLI_rcti_size_y(area)) {
+      operationBuffer.buffer = buffer;
+      operationBuffer.owned = false;
+      return buffer;
+    }
+  }
+
+  MemoryBuffer *buffer = new MemoryBuffer(operation->getOutputSocket()->getDataType(),
+                                          (rcti *)area);
+  if (operation->isSetOperation()) {
+    buffer->setSingleElem();
+  }
+  operationBuffer.buffer = buffer;
+  operationBuffer.owned = true;
+  return buffer;
+}
+
+MemoryBuffer *FullFrameExecutionModel::getInputBuffer(NodeOperation *operation,
+                                                      unsigned int inputSocketIndex)
+{
+  NodeOperationInput *input = operation->getInputSocket(inputSocketIndex);
+  if (!input->isConnected()) {
+    return NULL;
+  }
+  NodeOperation *inputOperation = &input->getLink()->getOperation();
+  if (inputOperation->isReadBufferOperation()) {
+    return ((ReadBufferOperation *)inputOperation)->getMemoryProxy()->getBuffer();
+  }
+  return inputOperation->getOutputBuffer();
+}
+
+void FullFrameExecutionModel::releaseOperation(NodeOperation *operation)
+{
+  OperationBuffer &operationBuffer = m_buffers[operation];
+  BLI_assert(operationBuffer.readers > 0);
+  operationBuffer.readers--;
+  if (operationBuffer.readers > 0) {
+    return;
+  }
+
+  if (operation->isReadBufferOperation()) {
+    ReadBufferOperation *readOperation = (ReadBufferOperation *)operation;
+    releaseOperation(readOperation->getMemoryProxy()->getWriteBufferOperation());
+  }
+  else if (operation->isWriteBufferOperation()) {
+    /* All read operations are done, the proxy buffer is not needed anymore. */
+    ((WriteBufferOperation *)operation)->getMemoryProxy()->free();
+  }
+  else if (operationBuffer.buffer) {
+    operation->setOutputBuffer(NULL);
+    if (operationBuffer.owned) {
+      delete operationBuffer.buffer;
+    }
+    else if (operationBuffer.cached) {
+      ResultCache::release(operationBuffer.buffer);
+    }
+    operationBuffer.buffer = NULL;
+  }
+}
+
+void FullFrameExecutionModel::executeArea(NodeOperation *operation,
+                                          MemoryBuffer *output,
+                                          const rcti *area,
+                                          bool useArea,
+                                          MemoryBuffer **inputs)
+{
+  AreaTaskData data;
+  data.operation = operation;
+  data.output = output;
+  data.useArea = useArea;
+  data.inputs = inputs;
+  data.area = area;
+  data.bTree = m_bTree;
+  data.devices = &m_devices;
+
+  const int height = BLI_rcti_size_y(area);
+  const int numTasks = operation->isSingleThreaded() ?
+                           1 :
+                           (height + COM_FULL_FRAME_ROWS_PER_TASK - 1) /
+                               COM_FULL_FRAME_ROWS_PER_TASK;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = numTasks > 1;
+  BLI_task_parallel_range(0, numTasks, &data, execute_area_task, &settings);
+}
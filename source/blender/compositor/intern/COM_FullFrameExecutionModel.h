@@ -0,0 +1,166 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_FULLFRAMEEXECUTIONMODEL_H__
+#define __COM_FULLFRAMEEXECUTIONMODEL_H__
+
+#include <map>
+#include <vector>
+
+#include "COM_CompositorContext.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+#include "COM_ResultCache.h"
+
+class CPUDevice;
+
+/**
+ * \brief Execution model calculating every operation for its whole area at once.
+ *
+ * Operations are executed one after another in the order of their dependencies. Every operation
+ * writes its result to a MemoryBuffer, which the operations reading it get as input. Operations
+ * that support it calculate their area with NodeOperation.updateMemoryBufferPartial, the others
+ * are calculated pixel by pixel, reading their inputs from the buffers instead of calculating
+ * them again. A buffer is freed as soon as the last operation reading it has been executed.
+ *
+ * Only the area of an operation that is read by other operations is calculated, starting from
+ * the area of the outputs, see NodeOperation.getAreaOfInterest. Buffers still cover the whole
+ * resolution of their operation, so pixels are read at their image coordinates.
+ *
+ * Areas are split in rows which are calculated by the threads of the task scheduler.
+ *
+ * When editing, results of operations are kept in the ResultCache. An operation whose result is
+ * found in the cache is not executed, neither are the operations only needed by it.
+ * \note OpenCL is not used by this execution model.
+ * \see CompositorContext.getExecutionModel
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ private:
+  /**
+   * \brief result of an operation and the number of operations that still need to read it
+   */
+  typedef struct OperationBuffer {
+    MemoryBuffer *buffer;
+    /** The buffer is owned by the execution model, not by a MemoryProxy. */
+    bool owned;
+    /** The buffer is owned by the ResultCache. */
+    bool cached;
+    int readers;
+    /** Last operation found reading the buffer, the only one when there is a single reader. */
+    NodeOperation *reader;
+  } OperationBuffer;
+
+  typedef std::map<NodeOperation *, OperationBuffer> OperationBuffers;
+  typedef std::map<NodeOperation *, ResultCacheKey> OperationKeys;
+  typedef std::map<NodeOperation *, rcti> OperationAreas;
+
+  const CompositorContext &m_context;
+  const bNodeTree *m_bTree;
+
+  /**
+   * \brief groups of the output operations to execute, in order of priority
+   */
+  vector<ExecutionGroup *> m_outputGroups;
+
+  /**
+   * \brief all operations needed by the output operations, inputs before their readers
+   */
+  vector<NodeOperation *> m_operations;
+
+  OperationBuffers m_buffers;
+
+  /**
+   * \brief area of every operation that is read, clamped to its resolution
+   */
+  OperationAreas m_areas;
+
+  /**
+   * \brief use and fill the ResultCache
+   */
+  bool m_useCache;
+
+  /**
+   * \brief hash of the context settings operations can depend on, part of every key
+   */
+  ResultCacheKey m_contextKey;
+
+  OperationKeys m_keys;
+
+  /**
+   * \brief devices bound to the threads of the task scheduler while executing operations
+   * \see WorkScheduler.set_thread_device
+   */
+  vector<CPUDevice *> m_devices;
+
+ public:
+  FullFrameExecutionModel(const CompositorContext &context,
+                          const vector<ExecutionGroup *> &outputGroups);
+  ~FullFrameExecutionModel();
+
+  /**
+   * \brief execute all operations needed by the output groups
+   */
+  void execute();
+
+  /**
+   * \brief add the settings of a node to the key of its operations
+   * \return false when the result of the node can't be cached
+   */
+  static bool hashNode(const bNode *node, ResultCacheHash &hash);
+
+ private:
+  static void getDependencies(NodeOperation *operation, vector<NodeOperation *> *r_dependencies);
+
+  static bool hashNodeStorage(const bNode *node, ResultCacheHash &hash);
+  bool isCacheable(NodeOperation *operation) const;
+  ResultCacheKey getKey(NodeOperation *operation);
+  ResultCacheKey hashOperation(NodeOperation *operation);
+  void addToCache(NodeOperation *operation);
+
+  void determineAreaOrder(NodeOperation *operation, vector<NodeOperation *> *r_operations);
+  void determineAreas();
+  void addArea(NodeOperation *operation, const rcti *area);
+
+  void determineOperations(NodeOperation *operation);
+  void determineReaders();
+
+  bool isBraked() const;
+  void updateProgress(unsigned int operationsFinished);
+
+  void executeOperation(NodeOperation *operation);
+  void executeOutputOperation(NodeOperation *operation, const rcti *area);
+  void executeWriteBufferOperation(NodeOperation *operation);
+
+  MemoryBuffer *createOutputBuffer(NodeOperation *operation, const rcti *area);
+  MemoryBuffer *getInputBuffer(NodeOperation *operation, unsigned int inputSocketIndex);
+  void releaseOperation(NodeOperation *operation);
+
+  void executeArea(NodeOperation *operation,
+                   MemoryBuffer *output,
+                   const rcti *area,
+                   bool useArea,
+                   MemoryBuffer **inputs);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
+
+#endif /* __COM_FULLFRAMEEXECUTIONMODEL_H__ */
@@ -23,7 +23,7 @@
 using std::max;
 using std::min;
 
-static unsigned int determine_num_channels(DataType datatype)
+unsigned int COM_num_channels_data_type(DataType datatype)
 {
   switch (datatype) {
     case COM_DT_VALUE:
@@ -57,10 +57,11 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, unsigned int chunkNumber, r
   this->m_height = BLI_rcti_size_y(&this->m_rect);
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = chunkNumber;
-  this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
+  this->m_num_channels = COM_num_channels_data_type(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_ALLOCATED;
+  this->m_singleElem = false;
   this->m_datatype = memoryProxy->getDataType();
 }
 
@@ -71,10 +72,11 @@ MemoryBuffer::MemoryBuffer(MemoryProxy *memoryProxy, rcti *rect)
   this->m_height = BLI_rcti_size_y(&this->m_rect);
   this->m_memoryProxy = memoryProxy;
   this->m_chunkNumber = -1;
-  this->m_num_channels = determine_num_channels(memoryProxy->getDataType());
+  this->m_num_channels = COM_num_channels_data_type(memoryProxy->getDataType());
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
+  this->m_singleElem = false;
   this->m_datatype = memoryProxy->getDataType();
 }
 MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
@@ -85,10 +87,11 @@ MemoryBuffer::MemoryBuffer(DataType dataType, rcti *rect)
   this->m_height = this->m_rect.ymax - this->m_rect.ymin;
   this->m_memoryProxy = NULL;
   this->m_chunkNumber = -1;
-  this->m_num_channels = determine_num_channels(dataType);
+  this->m_num_channels = COM_num_channels_data_type(dataType);
   this->m_buffer = (float *)MEM_mallocN_aligned(
       sizeof(float) * determineBufferSize() * this->m_num_channels, 16, "COM_MemoryBuffer");
   this->m_state = COM_MB_TEMPORARILY;
+  this->m_singleElem = false;
   this->m_datatype = dataType;
 }
 MemoryBuffer *MemoryBuffer::duplicate()
@@ -99,6 +102,19 @@ MemoryBuffer *MemoryBuffer::duplicate()
          this->determineBufferSize() * this->m_num_channels * sizeof(float));
   return result;
 }
+
+MemoryBuffer *MemoryBuffer::inflate(rcti *rect)
+{
+  BLI_assert(isSingleElem());
+  MemoryBuffer *result = new MemoryBuffer(this->m_datatype, rect);
+  const unsigned int size = result->determineBufferSize();
+  for (unsigned int index = 0; index < size; index++) {
+    memcpy(&result->m_buffer[index * this->m_num_channels],
+           this->m_buffer,
+           this->m_num_channels * sizeof(float));
+  }
+  return result;
+}
 void MemoryBuffer::clear()
 {
   memset(this->m_buffer, 0, this->determineBufferSize() * this->m_num_channels * sizeof(float));
@@ -52,6 +52,11 @@ typedef enum MemoryBufferExtend {
 
 class MemoryProxy;
 
+/**
+ * \brief number of channels of a pixel of the given data type
+ */
+unsigned int COM_num_channels_data_type(DataType datatype);
+
 /**
  * \brief a MemoryBuffer contains access to the data of a chunk
  */
@@ -97,6 +102,11 @@ class MemoryBuffer {
   int m_width;
   int m_height;
 
+  /**
+   * \brief the buffer holds a single element that is used for every pixel
+   */
+  bool m_singleElem;
+
  public:
   /**
    * \brief construct new MemoryBuffer for a chunk
@@ -140,6 +150,55 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief does this buffer hold a single element that is used for every pixel
+   * \note the full frame execution model stores results of constant operations this way
+   */
+  bool isSingleElem() const
+  {
+    return this->m_singleElem;
+  }
+
+  /**
+   * \brief use the first element of the buffer for every pixel
+   */
+  void setSingleElem()
+  {
+    this->m_singleElem = true;
+  }
+
+  /**
+   * \brief get the data of a pixel, x and y are in image space
+   * \note a single element buffer returns its element for every pixel
+   */
+  inline float *getElem(int x, int y)
+  {
+    if (isSingleElem()) {
+      return this->m_buffer;
+    }
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    const int offset = (this->m_width * (y - m_rect.ymin) + (x - m_rect.xmin)) *
+                       this->m_num_channels;
+    return &this->m_buffer[offset];
+  }
+
+  /**
+   * \brief number of floats between two neighboring pixels of a row
+   * \note zero for a single element buffer, so rows of every input can be iterated the same way
+   */
+  inline int getElemStride() const
+  {
+    return isSingleElem() ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief can every pixel of the area be read from this buffer
+   */
+  bool coversArea(const rcti *area) const
+  {
+    return isSingleElem() || BLI_rcti_inside_rcti(&this->m_rect, area);
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
@@ -349,6 +408,12 @@ class MemoryBuffer {
 
   MemoryBuffer *duplicate();
 
+  /**
+   * \brief create a buffer of the rect where every pixel is the single element of this buffer
+   * \note for operations that need the pixels of their inputs in memory
+   */
+  MemoryBuffer *inflate(rcti *rect);
+
   float getMaximumValue();
   float getMaximumValue(rcti *rect);
 
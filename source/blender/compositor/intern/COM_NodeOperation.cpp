@@ -24,6 +24,39 @@
 
 #include "COM_NodeOperation.h" /* own include */
 
+/*******************
+ **** SocketReader ****
+ *******************/
+
+void SocketReader::readOutputBuffer(float result[4], float x, float y, PixelSampler sampler)
+{
+  MemoryBuffer *buffer = this->m_outputBuffer;
+  if (buffer->isSingleElem()) {
+    /* constant operations store their value at (0,0) */
+    buffer->readNoCheck(result, 0, 0);
+  }
+  else if (sampler == COM_PS_NEAREST) {
+    buffer->read(result, x, y);
+  }
+  else {
+    buffer->readBilinear(result, x, y);
+  }
+}
+
+void SocketReader::readOutputBufferFiltered(
+    float result[4], float x, float y, float dx[2], float dy[2])
+{
+  MemoryBuffer *buffer = this->m_outputBuffer;
+  if (buffer->isSingleElem()) {
+    buffer->readNoCheck(result, 0, 0);
+  }
+  else {
+    const float uv[2] = {x, y};
+    const float deriv[2][2] = {{dx[0], dx[1]}, {dy[0], dy[1]}};
+    buffer->readEWA(result, uv, deriv);
+  }
+}
+
 /*******************
  **** NodeOperation ****
  *******************/
@@ -36,7 +69,12 @@ NodeOperation::NodeOperation()
   this->m_height = 0;
   this->m_isResolutionSet = false;
   this->m_openCL = false;
+  this->m_fullFrame = false;
+  this->m_span = false;
   this->m_btree = NULL;
+  this->m_bnode = NULL;
+  this->m_bnodeIndex = 0;
+  this->m_outputBuffer = NULL;
 }
 
 NodeOperation::~NodeOperation()
@@ -134,6 +172,89 @@ void NodeOperation::deinitExecution()
 {
   /* pass */
 }
+void NodeOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                              const rcti *area,
+                                              MemoryBuffer **inputs)
+{
+  if (!this->m_span) {
+    return;
+  }
+
+  const unsigned int numInputs = this->getNumberOfInputSockets();
+  BLI_assert(numInputs <= COM_SPAN_MAX_INPUTS);
+  float constants[COM_SPAN_MAX_INPUTS][COM_SPAN_WIDTH * COM_NUM_CHANNELS_COLOR];
+  const float *spans[COM_SPAN_MAX_INPUTS];
+
+  /* Constant inputs are repeated for a whole span once. */
+  for (unsigned int index = 0; index < numInputs; index++) {
+    if (inputs[index]->isSingleElem()) {
+      const int numChannels = inputs[index]->get_num_channels();
+      for (int x = 0; x < COM_SPAN_WIDTH; x++) {
+        memcpy(&constants[index][x * numChannels],
+               inputs[index]->getElem(0, 0),
+               sizeof(float) * numChannels);
+      }
+      spans[index] = constants[index];
+    }
+  }
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    for (int x = area->xmin; x < area->xmax; x += COM_SPAN_WIDTH) {
+      for (unsigned int index = 0; index < numInputs; index++) {
+        if (!inputs[index]->isSingleElem()) {
+          spans[index] = inputs[index]->getElem(x, y);
+        }
+      }
+      this->executeSpan(output->getElem(x, y), spans, min(area->xmax - x, COM_SPAN_WIDTH));
+    }
+  }
+}
+
+void NodeOperation::getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea)
+{
+  if (this->m_fullFrame) {
+    *r_inputArea = *outputArea;
+  }
+  else {
+    NodeOperation *inputOperation = this->getInputOperation(inputIndex);
+    BLI_rcti_init(r_inputArea, 0, inputOperation->getWidth(), 0, inputOperation->getHeight());
+  }
+}
+
+void NodeOperation::readSpan(float *output, int x, int y, int width)
+{
+  const int numChannels = COM_num_channels_data_type(this->getOutputSocket()->getDataType());
+
+  /* The full frame execution model calculates the output buffer before it is read. */
+  if (!this->m_span || this->m_outputBuffer) {
+    float color[4];
+    for (int index = 0; index < width; index++) {
+      this->readSampled(color, x + index, y, COM_PS_NEAREST);
+      memcpy(&output[index * numChannels], color, sizeof(float) * numChannels);
+    }
+    return;
+  }
+
+  const unsigned int numInputs = this->getNumberOfInputSockets();
+  BLI_assert(numInputs <= COM_SPAN_MAX_INPUTS);
+  float inputSpans[COM_SPAN_MAX_INPUTS][COM_SPAN_WIDTH * COM_NUM_CHANNELS_COLOR];
+  const float *spans[COM_SPAN_MAX_INPUTS];
+  for (unsigned int index = 0; index < numInputs; index++) {
+    spans[index] = inputSpans[index];
+  }
+
+  for (int start = 0; start < width; start += COM_SPAN_WIDTH) {
+    const int spanWidth = min(width - start, COM_SPAN_WIDTH);
+    for (unsigned int index = 0; index < numInputs; index++) {
+      NodeOperation *inputOperation = this->getInputOperation(index);
+      BLI_assert(inputOperation->getOutputSocket()->getDataType() ==
+                 this->getInputSocket(index)->getDataType());
+      inputOperation->readSpan(inputSpans[index], x + start, y, spanWidth);
+    }
+    this->executeSpan(&output[start * numChannels], spans, spanWidth);
+  }
+}
+
 SocketReader *NodeOperation::getInputSocketReader(unsigned int inputSocketIndex)
 {
   return this->getInputSocket(inputSocketIndex)->getReader();
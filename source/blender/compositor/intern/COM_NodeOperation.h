@@ -105,6 +105,18 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief can this operation calculate whole areas at once.
+   * \see updateMemoryBufferPartial
+   */
+  bool m_fullFrame;
+
+  /**
+   * \brief can this operation calculate spans of pixels at once.
+   * \see executeSpan
+   */
+  bool m_span;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -121,6 +133,18 @@ class NodeOperation : public SocketReader {
    */
   const bNodeTree *m_btree;
 
+  /**
+   * \brief editor node this operation has been created for, NULL for operations added by the
+   * compositor itself like conversions and buffers
+   * \see ResultCache
+   */
+  const bNode *m_bnode;
+
+  /**
+   * \brief index of this operation in the operations created for m_bnode
+   */
+  unsigned int m_bnodeIndex;
+
   /**
    * \brief set to truth when resolution for this operation is set
    */
@@ -190,6 +214,20 @@ class NodeOperation : public SocketReader {
   {
     this->m_btree = tree;
   }
+
+  void setbNode(const bNode *node, unsigned int index)
+  {
+    this->m_bnode = node;
+    this->m_bnodeIndex = index;
+  }
+  const bNode *getbNode() const
+  {
+    return this->m_bnode;
+  }
+  unsigned int getbNodeIndex() const
+  {
+    return this->m_bnodeIndex;
+  }
   virtual void initExecution();
 
   /**
@@ -248,6 +286,43 @@ class NodeOperation : public SocketReader {
   }
   virtual void deinitExecution();
 
+  /**
+   * \brief calculate an area of the output at once, used by the full frame execution model
+   * \note only called for operations set to be full frame operations
+   * \param output: buffer to write the result to, covering at least the area
+   * \param area: the area to calculate, in image space
+   * \param inputs: buffers with the results of the input operations, covering at least the
+   * area, or holding a single element when the input is constant
+   * \see MemoryBuffer.getElem
+   * \see FullFrameExecutionModel
+   */
+  virtual void updateMemoryBufferPartial(MemoryBuffer *output,
+                                         const rcti *area,
+                                         MemoryBuffer **inputs);
+
+  /**
+   * \brief get the area of an input that is read to calculate an area of the output
+   *
+   * The full frame execution model only calculates the area of an operation that is read by
+   * other operations. By default full frame operations read the same area of their inputs, other
+   * operations can read any pixel of them.
+   * \param inputIndex: index of a connected input socket
+   * \param outputArea: area of the output, in image space
+   * \param r_inputArea: area of the input, can exceed its resolution
+   * \see FullFrameExecutionModel
+   */
+  virtual void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
+  /**
+   * \brief read a span of pixels of a row, without sampling
+   *
+   * Operations implementing executeSpan calculate the span from spans of their inputs, other
+   * operations are read pixel by pixel.
+   * \param output: width pixels, with the number of channels of the output socket
+   * \see executeSpan
+   */
+  void readSpan(float *output, int x, int y, int width);
+
   bool isResolutionSet()
   {
     return this->m_isResolutionSet;
@@ -284,6 +359,24 @@ class NodeOperation : public SocketReader {
     return false;
   }
 
+  /**
+   * \brief can this operation calculate whole areas at once
+   * \see updateMemoryBufferPartial
+   */
+  bool isFullFrameOperation() const
+  {
+    return this->m_fullFrame;
+  }
+
+  /**
+   * \brief can this operation calculate spans of pixels at once
+   * \see executeSpan
+   */
+  bool isSpanOperation() const
+  {
+    return this->m_span;
+  }
+
   /**
    * \brief is this operation of type ReadBufferOperation
    * \return [true:false]
@@ -415,6 +508,37 @@ class NodeOperation : public SocketReader {
     this->m_complex = complex;
   }
 
+  /**
+   * \brief set whether this operation implements updateMemoryBufferPartial
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
+  /**
+   * \brief set whether this operation implements executeSpan
+   * Areas are calculated span by span as well, see updateMemoryBufferPartial.
+   */
+  void setSpanOperation(bool span)
+  {
+    this->m_span = span;
+    this->m_fullFrame = span;
+  }
+
+  /**
+   * \brief calculate a span of pixels of a row at once
+   *
+   * Replaces calling executePixelSampled for every pixel of the span, at pixel centers.
+   * \param output: width pixels, with the number of channels of the output socket
+   * \param inputs: width pixels of every input, with the number of channels of its socket
+   * \param width: number of pixels, at most COM_SPAN_WIDTH
+   * \note only called for operations marked with setSpanOperation
+   */
+  virtual void executeSpan(float * /*output*/, const float *const * /*inputs*/, int /*width*/)
+  {
+  }
+
   /**
    * \brief set if this NodeOperation can be scheduled on a OpenCLDevice
    */
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <list>
+#include <map>
+
+#include "COM_ResultCache.h"
+
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_userdef_types.h"
+
+typedef struct ResultCacheEntry {
+  ResultCacheKey key;
+  MemoryBuffer *buffer;
+  size_t size;
+  /** Number of executions using the buffer. */
+  int users;
+  /** Removed from the cache while in use, freed when released. */
+  bool removed;
+} ResultCacheEntry;
+
+typedef std::list<ResultCacheEntry *> ResultCacheEntries;
+
+/** \brief entries in the cache, most recently used first */
+static ResultCacheEntries g_entries;
+static std::map<ResultCacheKey, ResultCacheEntries::iterator> g_entries_by_key;
+/** \brief entries by buffer, including removed entries still in use */
+static std::map<MemoryBuffer *, ResultCacheEntry *> g_entries_by_buffer;
+static size_t g_size = 0;
+static ThreadMutex g_mutex = BLI_MUTEX_INITIALIZER;
+
+static size_t get_memory_limit()
+{
+  return ((size_t)U.compositor_cache_limit) * 1024 * 1024;
+}
+
+static size_t get_buffer_size(MemoryBuffer *buffer)
+{
+  return (size_t)buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels() *
+         sizeof(float);
+}
+
+static void free_entry(ResultCacheEntry *entry)
+{
+  g_entries_by_buffer.erase(entry->buffer);
+  delete entry->buffer;
+  delete entry;
+}
+
+static void remove_entry(ResultCacheEntries::iterator iter)
+{
+  ResultCacheEntry *entry = *iter;
+  g_entries_by_key.erase(entry->key);
+  g_entries.erase(iter);
+  g_size -= entry->size;
+
+  if (entry->users > 0) {
+    entry->removed = true;
+  }
+  else {
+    free_entry(entry);
+  }
+}
+
+/** Free least recently used entries until the cache fits in the memory limit. */
+static void limit_memory(size_t limit)
+{
+  ResultCacheEntries::iterator iter = g_entries.end();
+  while (g_size > limit && iter != g_entries.begin()) {
+    --iter;
+    if ((*iter)->users == 0) {
+      remove_entry(iter++);
+    }
+  }
+}
+
+MemoryBuffer *ResultCache::acquire(ResultCacheKey key)
+{
+  BLI_mutex_lock(&g_mutex);
+  MemoryBuffer *buffer = NULL;
+  std::map<ResultCacheKey, ResultCacheEntries::iterator>::iterator found = g_entries_by_key.find(
+      key);
+  if (found != g_entries_by_key.end()) {
+    ResultCacheEntry *entry = *found->second;
+    entry->users++;
+    /* Move to the front. */
+    g_entries.splice(g_entries.begin(), g_entries, found->second);
+    buffer = entry->buffer;
+  }
+  BLI_mutex_unlock(&g_mutex);
+  return buffer;
+}
+
+bool ResultCache::add(ResultCacheKey key, MemoryBuffer *buffer)
+{
+  BLI_assert(key != COM_RESULT_CACHE_KEY_NONE);
+  const size_t size = get_buffer_size(buffer);
+  const size_t limit = get_memory_limit();
+  if (size > limit) {
+    return false;
+  }
+
+  BLI_mutex_lock(&g_mutex);
+  std::map<ResultCacheKey, ResultCacheEntries::iterator>::iterator found = g_entries_by_key.find(
+      key);
+  if (found != g_entries_by_key.end()) {
+    remove_entry(found->second);
+  }
+  limit_memory(limit - size);
+
+  ResultCacheEntry *entry = new ResultCacheEntry();
+  entry->key = key;
+  entry->buffer = buffer;
+  entry->size = size;
+  entry->users = 1;
+  entry->removed = false;
+  g_entries.push_front(entry);
+  g_entries_by_key[key] = g_entries.begin();
+  g_entries_by_buffer[buffer] = entry;
+  g_size += size;
+  BLI_mutex_unlock(&g_mutex);
+  return true;
+}
+
+void ResultCache::release(MemoryBuffer *buffer)
+{
+  BLI_mutex_lock(&g_mutex);
+  std::map<MemoryBuffer *, ResultCacheEntry *>::iterator found = g_entries_by_buffer.find(buffer);
+  BLI_assert(found != g_entries_by_buffer.end());
+  ResultCacheEntry *entry = found->second;
+  BLI_assert(entry->users > 0);
+  entry->users--;
+  if (entry->users == 0) {
+    if (entry->removed) {
+      free_entry(entry);
+    }
+    else {
+      /* Entries in use could have made the cache exceed its limit. */
+      limit_memory(get_memory_limit());
+    }
+  }
+  BLI_mutex_unlock(&g_mutex);
+}
+
+void ResultCache::clear()
+{
+  BLI_mutex_lock(&g_mutex);
+  while (!g_entries.empty()) {
+    remove_entry(g_entries.begin());
+  }
+  BLI_mutex_unlock(&g_mutex);
+}
@@ -0,0 +1,117 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#ifndef __COM_RESULTCACHE_H__
+#define __COM_RESULTCACHE_H__
+
+#include <stdint.h>
+#include <string.h>
+
+#include "COM_MemoryBuffer.h"
+
+/**
+ * \brief key identifying the result of an operation
+ *
+ * The key of an operation is a hash of its type, its resolution, the settings of the node it has
+ * been created for and the keys of its inputs, so it changes whenever anything upstream changes.
+ * \see ResultCacheHash
+ */
+typedef uint64_t ResultCacheKey;
+
+/**
+ * \brief no key, used for operations whose result can't be cached
+ */
+#define COM_RESULT_CACHE_KEY_NONE 0
+
+/**
+ * \brief incremental 64 bit FNV-1a hash to build a ResultCacheKey with
+ */
+class ResultCacheHash {
+ private:
+  uint64_t m_hash;
+
+ public:
+  ResultCacheHash() : m_hash(14695981039346656037ULL)
+  {
+  }
+
+  void add(const void *data, size_t size)
+  {
+    const unsigned char *bytes = (const unsigned char *)data;
+    for (size_t index = 0; index < size; index++) {
+      m_hash = (m_hash ^ bytes[index]) * 1099511628211ULL;
+    }
+  }
+  void add(int value)
+  {
+    add(&value, sizeof(value));
+  }
+  void add(uint64_t value)
+  {
+    add(&value, sizeof(value));
+  }
+  void add(const char *str)
+  {
+    add(str, strlen(str) + 1);
+  }
+
+  ResultCacheKey getKey() const
+  {
+    return (m_hash == COM_RESULT_CACHE_KEY_NONE) ? 1 : m_hash;
+  }
+};
+
+/**
+ * \brief results of operations kept between executions of the compositor
+ *
+ * The cache lives as long as the compositor and owns the buffers added to it. A buffer is in use
+ * from the moment it has been added or acquired until it is released, buffers in use are never
+ * freed. When the buffers take more memory than the Compositor Cache Limit user preference the
+ * least recently used buffers that are not in use are freed.
+ *
+ * \note Results that depend on data outside of the node tree, like render results, are only
+ * valid until that data changes, the cache is cleared by COM_clearCaches in that case.
+ * \see FullFrameExecutionModel
+ * \ingroup Execution
+ */
+class ResultCache {
+ public:
+  /**
+   * \brief find the result of an operation and mark it as in use
+   * \return the result, or NULL when it is not in the cache
+   */
+  static MemoryBuffer *acquire(ResultCacheKey key);
+
+  /**
+   * \brief add the result of an operation and mark it as in use
+   * \return false when the buffer is not added, the caller keeps owning it
+   */
+  static bool add(ResultCacheKey key, MemoryBuffer *buffer);
+
+  /**
+   * \brief the buffer is not in use by the caller anymore
+   */
+  static void release(MemoryBuffer *buffer);
+
+  /**
+   * \brief remove all results, results in use are freed when released
+   */
+  static void clear();
+};
+
+#endif /* __COM_RESULTCACHE_H__ */
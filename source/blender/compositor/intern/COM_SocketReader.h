@@ -39,6 +39,9 @@ class MemoryBuffer;
  */
 class SocketReader {
  private:
+  void readOutputBuffer(float result[4], float x, float y, PixelSampler sampler);
+  void readOutputBufferFiltered(float result[4], float x, float y, float dx[2], float dy[2]);
+
  protected:
   /**
    * \brief Holds the width of the output of this operation.
@@ -50,6 +53,13 @@ class SocketReader {
    */
   unsigned int m_height;
 
+  /**
+   * \brief Result of this operation when it is calculated by the full frame execution model.
+   * While set, reads are served from this buffer instead of calculating the pixels again.
+   * \see FullFrameExecutionModel
+   */
+  MemoryBuffer *m_outputBuffer;
+
   /**
    * \brief calculate a single pixel
    * \note this method is called for non-complex
@@ -97,17 +107,43 @@ class SocketReader {
  public:
   inline void readSampled(float result[4], float x, float y, PixelSampler sampler)
   {
+    if (this->m_outputBuffer) {
+      readOutputBuffer(result, x, y, sampler);
+      return;
+    }
     executePixelSampled(result, x, y, sampler);
   }
   inline void read(float result[4], int x, int y, void *chunkData)
   {
+    if (this->m_outputBuffer) {
+      readOutputBuffer(result, x, y, COM_PS_NEAREST);
+      return;
+    }
     executePixel(result, x, y, chunkData);
   }
   inline void readFiltered(float result[4], float x, float y, float dx[2], float dy[2])
   {
+    if (this->m_outputBuffer) {
+      readOutputBufferFiltered(result, x, y, dx, dy);
+      return;
+    }
     executePixelFiltered(result, x, y, dx, dy);
   }
 
+  /**
+   * \brief set the buffer holding the calculated result of this operation
+   * \note only used by the full frame execution model, pass NULL to calculate pixels again
+   */
+  void setOutputBuffer(MemoryBuffer *buffer)
+  {
+    this->m_outputBuffer = buffer;
+  }
+
+  MemoryBuffer *getOutputBuffer() const
+  {
+    return this->m_outputBuffer;
+  }
+
   virtual void *initializeTileData(rcti * /*rect*/)
   {
     return 0;
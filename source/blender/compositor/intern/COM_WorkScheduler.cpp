@@ -371,3 +371,8 @@ int WorkScheduler::current_thread_id()
   CPUDevice *device = (CPUDevice *)BLI_thread_local_get(g_thread_device);
   return device->thread_id();
 }
+
+void WorkScheduler::set_thread_device(CPUDevice *device)
+{
+  BLI_thread_local_set(g_thread_device, device);
+}
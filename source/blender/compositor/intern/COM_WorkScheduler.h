@@ -27,6 +27,8 @@ extern "C" {
 #include "COM_defines.h"
 #include "COM_Device.h"
 
+class CPUDevice;
+
 /** \brief the workscheduler
  * \ingroup execution
  */
@@ -112,6 +114,14 @@ class WorkScheduler {
 
   static int current_thread_id();
 
+  /**
+   * \brief bind a device to the calling thread, for threads that are not started by the
+   * WorkScheduler but do execute operations (like the ones of the full frame execution model).
+   * Pass NULL to unbind the device again.
+   * \see current_thread_id
+   */
+  static void set_thread_device(CPUDevice *device);
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkScheduler")
 #endif
@@ -27,6 +27,7 @@ extern "C" {
 
 #include "COM_compositor.h"
 #include "COM_ExecutionSystem.h"
+#include "COM_ResultCache.h"
 #include "COM_WorkScheduler.h"
 #include "clew.h"
 #include "COM_MovieDistortionOperation.h"
@@ -110,10 +111,16 @@ void COM_execute(RenderData *rd,
   BLI_mutex_unlock(&s_compositorMutex);
 }
 
+void COM_clearCaches()
+{
+  ResultCache::clear();
+}
+
 void COM_deinitialize()
 {
   if (is_compositorMutex_init) {
     BLI_mutex_lock(&s_compositorMutex);
+    ResultCache::clear();
     WorkScheduler::deinitialize();
     is_compositorMutex_init = false;
     BLI_mutex_unlock(&s_compositorMutex);
@@ -44,6 +44,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation() : NodeOperation()
   this->m_inputValueOperation = NULL;
   this->m_inputColorOperation = NULL;
   this->setResolutionInputSocketIndex(1);
+  this->setSpanOperation(true);
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -79,6 +80,26 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ColorBalanceLGGOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  /* There are no vectorized versions of the color space conversions and the power function,
+   * calculating a span only saves reading the inputs pixel by pixel. */
+  const float *value = inputs[0];
+  const float *inputColor = inputs[1];
+  for (int x = 0; x < width; x++, output += 4, inputColor += 4) {
+    const float fac = min(1.0f, value[x]);
+    const float mfac = 1.0f - fac;
+    for (int channel = 0; channel < 3; channel++) {
+      output[channel] = mfac * inputColor[channel] +
+                        fac * colorbalance_lgg(inputColor[channel],
+                                               this->m_lift[channel],
+                                               this->m_gamma_inv[channel],
+                                               this->m_gain[channel]);
+    }
+    output[3] = inputColor[3];
+  }
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
   this->m_inputValueOperation = NULL;
@@ -87,6 +87,13 @@ class CompositorOperation : public NodeOperation {
     return this->m_active;
   }
   void executeRegion(rcti *rect, unsigned int tileNumber);
+  /**
+   * the inputs are read at the pixels that are written
+   */
+  void getAreaOfInterest(int /*inputIndex*/, const rcti *outputArea, rcti *r_inputArea)
+  {
+    *r_inputArea = *outputArea;
+  }
   void setScene(const struct Scene *scene)
   {
     m_scene = scene;
@@ -27,6 +27,7 @@ ConvertColorProfileOperation::ConvertColorProfileOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputOperation = NULL;
   this->m_predivided = false;
+  this->setSpanOperation(true);
 }
 
 void ConvertColorProfileOperation::initExecution()
@@ -45,6 +46,22 @@ void ConvertColorProfileOperation::executePixelSampled(float output[4],
       output, color, 4, this->m_toProfile, this->m_fromProfile, this->m_predivided, 1, 1, 0, 0);
 }
 
+void ConvertColorProfileOperation::executeSpan(float *output,
+                                               const float *const *inputs,
+                                               int width)
+{
+  IMB_buffer_float_from_float(output,
+                              inputs[0],
+                              4,
+                              this->m_toProfile,
+                              this->m_fromProfile,
+                              this->m_predivided,
+                              width,
+                              1,
+                              width,
+                              width);
+}
+
 void ConvertColorProfileOperation::deinitExecution()
 {
   this->m_inputOperation = NULL;
@@ -56,6 +56,7 @@ class ConvertColorProfileOperation : public NodeOperation {
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 
   /**
    * Initialize the execution
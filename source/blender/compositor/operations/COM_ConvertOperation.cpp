@@ -37,12 +37,38 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = NULL;
 }
 
+void ConvertBaseOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                                     const rcti *area,
+                                                     MemoryBuffer **inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  const int width = BLI_rcti_size_x(area);
+  for (int y = area->ymin; y < area->ymax; y++) {
+    convertRow(output->getElem(area->xmin, y),
+               input->getElem(area->xmin, y),
+               input->getElemStride(),
+               width);
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
+}
+
+void ConvertValueToColorOperation::convertRow(float *output,
+                                              const float *input,
+                                              int inputStride,
+                                              int width)
+{
+  for (int x = 0; x < width; x++, output += 4, input += inputStride) {
+    output[0] = output[1] = output[2] = input[0];
+    output[3] = 1.0f;
+  }
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -62,6 +88,17 @@ ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperat
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
+}
+
+void ConvertColorToValueOperation::convertRow(float *output,
+                                              const float *input,
+                                              int inputStride,
+                                              int width)
+{
+  for (int x = 0; x < width; x++, output++, input += inputStride) {
+    output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+  }
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -80,6 +117,17 @@ ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
+}
+
+void ConvertColorToBWOperation::convertRow(float *output,
+                                           const float *input,
+                                           int inputStride,
+                                           int width)
+{
+  for (int x = 0; x < width; x++, output++, input += inputStride) {
+    output[0] = IMB_colormanagement_get_luminance(input);
+  }
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -98,6 +146,17 @@ ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOper
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
+}
+
+void ConvertColorToVectorOperation::convertRow(float *output,
+                                               const float *input,
+                                               int inputStride,
+                                               int width)
+{
+  for (int x = 0; x < width; x++, output += 3, input += inputStride) {
+    copy_v3_v3(output, input);
+  }
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -116,6 +175,17 @@ ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOper
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
+}
+
+void ConvertValueToVectorOperation::convertRow(float *output,
+                                               const float *input,
+                                               int inputStride,
+                                               int width)
+{
+  for (int x = 0; x < width; x++, output += 3, input += inputStride) {
+    output[0] = output[1] = output[2] = input[0];
+  }
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -134,6 +204,18 @@ ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOper
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
+}
+
+void ConvertVectorToColorOperation::convertRow(float *output,
+                                               const float *input,
+                                               int inputStride,
+                                               int width)
+{
+  for (int x = 0; x < width; x++, output += 4, input += inputStride) {
+    copy_v3_v3(output, input);
+    output[3] = 1.0f;
+  }
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -151,6 +233,17 @@ ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOper
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
+}
+
+void ConvertVectorToValueOperation::convertRow(float *output,
+                                               const float *input,
+                                               int inputStride,
+                                               int width)
+{
+  for (int x = 0; x < width; x++, output++, input += inputStride) {
+    output[0] = (input[0] + input[1] + input[2]) / 3.0f;
+  }
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
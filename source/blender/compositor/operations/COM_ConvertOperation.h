@@ -25,14 +25,30 @@ class ConvertBaseOperation : public NodeOperation {
  protected:
   SocketReader *m_inputOperation;
 
+  /**
+   * \brief convert a row of pixels, subclasses implementing it are full frame operations
+   * \param inputStride: number of floats between two input pixels, zero for a constant input
+   */
+  virtual void convertRow(float * /*output*/,
+                          const float * /*input*/,
+                          int /*inputStride*/,
+                          int /*width*/)
+  {
+  }
+
  public:
   ConvertBaseOperation();
 
   void initExecution();
   void deinitExecution();
+
+  void updateMemoryBufferPartial(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
 };
 
 class ConvertValueToColorOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertValueToColorOperation();
 
@@ -40,6 +56,9 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
 };
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertColorToValueOperation();
 
@@ -47,6 +66,9 @@ class ConvertColorToValueOperation : public ConvertBaseOperation {
 };
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertColorToBWOperation();
 
@@ -54,6 +76,9 @@ class ConvertColorToBWOperation : public ConvertBaseOperation {
 };
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertColorToVectorOperation();
 
@@ -61,6 +86,9 @@ class ConvertColorToVectorOperation : public ConvertBaseOperation {
 };
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertValueToVectorOperation();
 
@@ -68,6 +96,9 @@ class ConvertValueToVectorOperation : public ConvertBaseOperation {
 };
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertVectorToColorOperation();
 
@@ -75,6 +106,9 @@ class ConvertVectorToColorOperation : public ConvertBaseOperation {
 };
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
+ protected:
+  void convertRow(float *output, const float *input, int inputStride, int width);
+
  public:
   ConvertVectorToValueOperation();
 
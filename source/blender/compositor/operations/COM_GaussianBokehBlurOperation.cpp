@@ -26,6 +26,7 @@ extern "C" {
 GaussianBokehBlurOperation::GaussianBokehBlurOperation() : BlurBaseOperation(COM_DT_COLOR)
 {
   this->m_gausstab = NULL;
+  this->setFullFrame(true);
 }
 
 void *GaussianBokehBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -112,6 +113,60 @@ void GaussianBokehBlurOperation::updateGauss()
 }
 
 void GaussianBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
+{
+  blurPixel(output, x, y, (MemoryBuffer *)data);
+}
+
+void GaussianBokehBlurOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                                           const rcti *area,
+                                                           MemoryBuffer **inputs)
+{
+  lockMutex();
+  if (!this->m_sizeavailable) {
+    updateGauss();
+  }
+  unlockMutex();
+
+  MemoryBuffer *inputBuffer = inputs[0];
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      if (inputBuffer->isSingleElem()) {
+        /* The filter is normalized, a constant stays the same. */
+        copy_v4_v4(elem, inputBuffer->getElem(x, y));
+      }
+      else {
+        blurPixel(elem, x, y, inputBuffer);
+      }
+      elem += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+}
+
+void GaussianBokehBlurOperation::getAreaOfInterest(int inputIndex,
+                                                   const rcti *outputArea,
+                                                   rcti *r_inputArea)
+{
+  if (inputIndex == 1) {
+    /* The size is read from the first pixel, see updateSize. */
+    BLI_rcti_init(r_inputArea, 0, 1, 0, 1);
+  }
+  else if (this->m_sizeavailable && this->m_gausstab != NULL) {
+    BLI_rcti_init(r_inputArea,
+                  outputArea->xmin - this->m_radx,
+                  outputArea->xmax + this->m_radx,
+                  outputArea->ymin - this->m_rady,
+                  outputArea->ymax + this->m_rady);
+  }
+  else {
+    BLI_rcti_init(r_inputArea, 0, this->getWidth(), 0, this->getHeight());
+  }
+}
+
+void GaussianBokehBlurOperation::blurPixel(float output[4],
+                                           int x,
+                                           int y,
+                                           MemoryBuffer *inputBuffer)
 {
   float tempColor[4];
   tempColor[0] = 0;
@@ -119,7 +174,6 @@ void GaussianBokehBlurOperation::executePixel(float output[4], int x, int y, voi
   tempColor[2] = 0;
   tempColor[3] = 0;
   float multiplier_accum = 0;
-  MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
   float *buffer = inputBuffer->getBuffer();
   int bufferwidth = inputBuffer->getWidth();
   int bufferstartx = inputBuffer->getRect()->xmin;
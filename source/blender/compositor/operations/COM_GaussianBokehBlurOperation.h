@@ -27,6 +27,7 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
   float *m_gausstab;
   int m_radx, m_rady;
   void updateGauss();
+  void blurPixel(float output[4], int x, int y, MemoryBuffer *inputBuffer);
 
  public:
   GaussianBokehBlurOperation();
@@ -37,6 +38,9 @@ class GaussianBokehBlurOperation : public BlurBaseOperation {
    */
   void executePixel(float output[4], int x, int y, void *data);
 
+  void updateMemoryBufferPartial(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
   /**
    * Deinitialize the execution
    */
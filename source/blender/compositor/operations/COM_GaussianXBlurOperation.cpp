@@ -32,6 +32,7 @@ GaussianXBlurOperation::GaussianXBlurOperation() : BlurBaseOperation(COM_DT_COLO
   this->m_gausstab_sse = NULL;
 #endif
   this->m_filtersize = 0;
+  this->setFullFrame(true);
 }
 
 void *GaussianXBlurOperation::initializeTileData(rcti * /*rect*/)
@@ -78,10 +79,60 @@ void GaussianXBlurOperation::updateGauss()
 }
 
 void GaussianXBlurOperation::executePixel(float output[4], int x, int y, void *data)
+{
+  blurPixel(output, x, y, (MemoryBuffer *)data);
+}
+
+void GaussianXBlurOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                                       const rcti *area,
+                                                       MemoryBuffer **inputs)
+{
+  lockMutex();
+  if (!this->m_sizeavailable) {
+    updateGauss();
+  }
+  unlockMutex();
+
+  MemoryBuffer *inputBuffer = inputs[0];
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      if (inputBuffer->isSingleElem()) {
+        /* The weights are normalized, a constant stays the same. */
+        copy_v4_v4(elem, inputBuffer->getElem(x, y));
+      }
+      else {
+        blurPixel(elem, x, y, inputBuffer);
+      }
+      elem += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+}
+
+void GaussianXBlurOperation::getAreaOfInterest(int inputIndex,
+                                               const rcti *outputArea,
+                                               rcti *r_inputArea)
+{
+  if (inputIndex == 1) {
+    /* The size is read from the first pixel, see updateSize. */
+    BLI_rcti_init(r_inputArea, 0, 1, 0, 1);
+  }
+  else if (this->m_sizeavailable && this->m_gausstab != NULL) {
+    BLI_rcti_init(r_inputArea,
+                  outputArea->xmin - this->m_filtersize - 1,
+                  outputArea->xmax + this->m_filtersize + 1,
+                  outputArea->ymin,
+                  outputArea->ymax);
+  }
+  else {
+    BLI_rcti_init(r_inputArea, 0, this->getWidth(), 0, this->getHeight());
+  }
+}
+
+void GaussianXBlurOperation::blurPixel(float output[4], int x, int y, MemoryBuffer *inputBuffer)
 {
   float ATTR_ALIGN(16) color_accum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
   float multiplier_accum = 0.0f;
-  MemoryBuffer *inputBuffer = (MemoryBuffer *)data;
   float *buffer = inputBuffer->getBuffer();
   int bufferwidth = inputBuffer->getWidth();
   int bufferstartx = inputBuffer->getRect()->xmin;
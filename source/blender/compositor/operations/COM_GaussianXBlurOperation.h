@@ -29,6 +29,7 @@ class GaussianXBlurOperation : public BlurBaseOperation {
 #endif
   int m_filtersize;
   void updateGauss();
+  void blurPixel(float output[4], int x, int y, MemoryBuffer *inputBuffer);
 
  public:
   GaussianXBlurOperation();
@@ -38,6 +39,9 @@ class GaussianXBlurOperation : public BlurBaseOperation {
    */
   void executePixel(float output[4], int x, int y, void *data);
 
+  void updateMemoryBufferPartial(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
   void executeOpenCL(OpenCLDevice *device,
                      MemoryBuffer *outputMemoryBuffer,
                      cl_mem clOutputBuffer,
@@ -24,6 +24,7 @@ GlareBaseOperation::GlareBaseOperation() : SingleThreadedOperation()
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_COLOR);
   this->m_settings = NULL;
+  this->setFullFrame(true);
 }
 void GlareBaseOperation::initExecution()
 {
@@ -51,6 +52,34 @@ MemoryBuffer *GlareBaseOperation::createMemoryBuffer(rcti *rect2)
   return result;
 }
 
+void GlareBaseOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                                   const rcti * /*area*/,
+                                                   MemoryBuffer **inputs)
+{
+  /* The glare is generated for the whole image at once, from every pixel of the input. */
+  MemoryBuffer *input = inputs[0];
+  MemoryBuffer *constant = NULL;
+  if (input->isSingleElem()) {
+    rcti rect;
+    BLI_rcti_init(&rect, 0, getWidth(), 0, getHeight());
+    constant = input->inflate(&rect);
+    input = constant;
+  }
+
+  this->generateGlare(output->getBuffer(), input, this->m_settings);
+
+  if (constant) {
+    delete constant;
+  }
+}
+
+void GlareBaseOperation::getAreaOfInterest(int /*inputIndex*/,
+                                           const rcti * /*outputArea*/,
+                                           rcti *r_inputArea)
+{
+  BLI_rcti_init(r_inputArea, 0, getWidth(), 0, getHeight());
+}
+
 bool GlareBaseOperation::determineDependingAreaOfInterest(rcti * /*input*/,
                                                           ReadBufferOperation *readOperation,
                                                           rcti *output)
@@ -67,6 +67,9 @@ class GlareBaseOperation : public SingleThreadedOperation {
                                         ReadBufferOperation *readOperation,
                                         rcti *output);
 
+  void updateMemoryBufferPartial(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
  protected:
   GlareBaseOperation();
 
@@ -17,6 +17,10 @@
  */
 
 #include "COM_MathBaseOperation.h"
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 extern "C" {
 #include "BLI_math.h"
 }
@@ -72,6 +76,15 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
+void MathBaseOperation::clampSpanIfNeeded(float *output, int width)
+{
+  if (this->m_useClamp) {
+    for (int x = 0; x < width; x++) {
+      CLAMP(output[x], 0.0f, 1.0f);
+    }
+  }
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
@@ -85,6 +98,25 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    _mm_storeu_ps(&output[x], _mm_add_ps(value1, value2));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = inputValue1[x] + inputValue2[x];
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -101,6 +133,25 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    _mm_storeu_ps(&output[x], _mm_sub_ps(value1, value2));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = inputValue1[x] - inputValue2[x];
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -117,6 +168,25 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    _mm_storeu_ps(&output[x], _mm_mul_ps(value1, value2));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = inputValue1[x] * inputValue2[x];
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -138,6 +208,28 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  const __m128 zero = _mm_setzero_ps();
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    /* We don't want to divide by zero. */
+    const __m128 valid = _mm_cmpneq_ps(value2, zero);
+    _mm_storeu_ps(&output[x], _mm_and_ps(valid, _mm_div_ps(value1, value2)));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = (inputValue2[x] == 0) ? 0.0f : inputValue1[x] / inputValue2[x];
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -357,6 +449,25 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    _mm_storeu_ps(&output[x], _mm_min_ps(value1, value2));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = min(inputValue1[x], inputValue2[x]);
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -373,6 +484,25 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    _mm_storeu_ps(&output[x], _mm_max_ps(value1, value2));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = max(inputValue1[x], inputValue2[x]);
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -456,6 +586,24 @@ void MathAbsoluteOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathAbsoluteOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  int x = 0;
+#ifdef __SSE2__
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    _mm_storeu_ps(&output[x], _mm_and_ps(value1, absMask));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = fabsf(inputValue1[x]);
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathRadiansOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -716,6 +864,27 @@ void MathMultiplyAddOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyAddOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue1 = inputs[0];
+  const float *inputValue2 = inputs[1];
+  const float *inputValue3 = inputs[2];
+  int x = 0;
+#ifdef __SSE2__
+  for (; x + 4 <= width; x += 4) {
+    const __m128 value1 = _mm_loadu_ps(&inputValue1[x]);
+    const __m128 value2 = _mm_loadu_ps(&inputValue2[x]);
+    const __m128 value3 = _mm_loadu_ps(&inputValue3[x]);
+    _mm_storeu_ps(&output[x], _mm_add_ps(_mm_mul_ps(value1, value2), value3));
+  }
+#endif
+  for (; x < width; x++) {
+    output[x] = inputValue1[x] * inputValue2[x] + inputValue3[x];
+  }
+
+  clampSpanIfNeeded(output, width);
+}
+
 void MathSmoothMinOperation::executePixelSampled(float output[4],
                                                  float x,
                                                  float y,
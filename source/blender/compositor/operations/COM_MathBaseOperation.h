@@ -42,6 +42,7 @@ class MathBaseOperation : public NodeOperation {
   MathBaseOperation();
 
   void clampIfNeeded(float color[4]);
+  void clampSpanIfNeeded(float *output, int width);
 
  public:
   /**
@@ -74,29 +75,37 @@ class MathAddOperation : public MathBaseOperation {
  public:
   MathAddOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
   MathSubtractOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
   MathMultiplyOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
   MathDivideOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -181,15 +190,19 @@ class MathMinimumOperation : public MathBaseOperation {
  public:
   MathMinimumOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
   MathMaximumOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
@@ -225,8 +238,10 @@ class MathAbsoluteOperation : public MathBaseOperation {
  public:
   MathAbsoluteOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MathRadiansOperation : public MathBaseOperation {
@@ -353,8 +368,10 @@ class MathMultiplyAddOperation : public MathBaseOperation {
  public:
   MathMultiplyAddOperation() : MathBaseOperation()
   {
+    this->setSpanOperation(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MathSmoothMinOperation : public MathBaseOperation {
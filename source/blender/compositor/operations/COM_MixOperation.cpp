@@ -18,6 +18,10 @@
 
 #include "COM_MixOperation.h"
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 extern "C" {
 #include "BLI_math.h"
 }
@@ -101,7 +105,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -126,11 +130,33 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(output, _mm_add_ps(color1, _mm_mul_ps(_mm_set1_ps(value), color2)));
+#else
+    output[0] = inputColor1[0] + value * inputColor2[0];
+    output[1] = inputColor1[1] + value * inputColor2[1];
+    output[2] = inputColor1[2] + value * inputColor2[2];
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -160,6 +186,31 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(output,
+                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - value), color1),
+                             _mm_mul_ps(_mm_set1_ps(value), color2)));
+#else
+    const float valuem = 1.0f - value;
+    output[0] = valuem * inputColor1[0] + value * inputColor2[0];
+    output[1] = valuem * inputColor1[1] + value * inputColor2[1];
+    output[2] = valuem * inputColor1[2] + value * inputColor2[2];
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -292,7 +343,7 @@ void MixColorOperation::executePixelSampled(float output[4],
 
 MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4],
@@ -321,11 +372,36 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(output,
+                  _mm_add_ps(_mm_mul_ps(_mm_min_ps(color1, color2), _mm_set1_ps(value)),
+                             _mm_mul_ps(color1, _mm_set1_ps(1.0f - value))));
+#else
+    const float valuem = 1.0f - value;
+    output[0] = min_ff(inputColor1[0], inputColor2[0]) * value + inputColor1[0] * valuem;
+    output[1] = min_ff(inputColor1[1], inputColor2[1]) * value + inputColor1[1] * valuem;
+    output[2] = min_ff(inputColor1[2], inputColor2[2]) * value + inputColor1[2] * valuem;
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -354,6 +430,35 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+#ifdef __SSE2__
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+#endif
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 difference = _mm_and_ps(_mm_sub_ps(color1, color2), absMask);
+    _mm_storeu_ps(output,
+                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.0f - value), color1),
+                             _mm_mul_ps(_mm_set1_ps(value), difference)));
+#else
+    const float valuem = 1.0f - value;
+    output[0] = valuem * inputColor1[0] + value * fabsf(inputColor1[0] - inputColor2[0]);
+    output[1] = valuem * inputColor1[1] + value * fabsf(inputColor1[1] - inputColor2[1]);
+    output[2] = valuem * inputColor1[2] + value * fabsf(inputColor1[2] - inputColor2[2]);
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
@@ -579,7 +684,7 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4],
@@ -626,6 +731,28 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(output, _mm_max_ps(_mm_mul_ps(_mm_set1_ps(value), color2), color1));
+#else
+    output[0] = max_ff(value * inputColor2[0], inputColor1[0]);
+    output[1] = max_ff(value * inputColor2[1], inputColor1[1]);
+    output[2] = max_ff(value * inputColor2[2], inputColor1[2]);
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
@@ -678,7 +805,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -707,6 +834,32 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(
+        output,
+        _mm_mul_ps(color1,
+                   _mm_add_ps(_mm_set1_ps(1.0f - value), _mm_mul_ps(_mm_set1_ps(value), color2))));
+#else
+    const float valuem = 1.0f - value;
+    output[0] = inputColor1[0] * (valuem + value * inputColor2[0]);
+    output[1] = inputColor1[1] * (valuem + value * inputColor2[1]);
+    output[2] = inputColor1[2] * (valuem + value * inputColor2[2]);
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -803,7 +956,7 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -833,6 +986,34 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+#ifdef __SSE2__
+  const __m128 one = _mm_set1_ps(1.0f);
+#endif
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    const __m128 screen = _mm_add_ps(_mm_set1_ps(1.0f - value),
+                                     _mm_mul_ps(_mm_set1_ps(value), _mm_sub_ps(one, color2)));
+    _mm_storeu_ps(output, _mm_sub_ps(one, _mm_mul_ps(screen, _mm_sub_ps(one, color1))));
+#else
+    const float valuem = 1.0f - value;
+    output[0] = 1.0f - (valuem + value * (1.0f - inputColor2[0])) * (1.0f - inputColor1[0]);
+    output[1] = 1.0f - (valuem + value * (1.0f - inputColor2[1])) * (1.0f - inputColor1[1]);
+    output[2] = 1.0f - (valuem + value * (1.0f - inputColor2[2])) * (1.0f - inputColor1[2]);
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -883,7 +1064,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setSpanOperation(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -911,6 +1092,28 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::executeSpan(float *output, const float *const *inputs, int width)
+{
+  const float *inputValue = inputs[0];
+  const float *inputColor1 = inputs[1];
+  const float *inputColor2 = inputs[2];
+  for (int x = 0; x < width; x++, output += 4, inputColor1 += 4, inputColor2 += 4) {
+    const float value = getSpanValue(inputValue[x], inputColor2);
+#ifdef __SSE2__
+    const __m128 color1 = _mm_loadu_ps(inputColor1);
+    const __m128 color2 = _mm_loadu_ps(inputColor2);
+    _mm_storeu_ps(output, _mm_sub_ps(color1, _mm_mul_ps(_mm_set1_ps(value), color2)));
+#else
+    output[0] = inputColor1[0] - value * inputColor2[0];
+    output[1] = inputColor1[1] - value * inputColor2[1];
+    output[2] = inputColor1[2] - value * inputColor2[2];
+#endif
+    output[3] = inputColor1[3];
+
+    clampIfNeeded(output);
+  }
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
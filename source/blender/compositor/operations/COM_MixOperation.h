@@ -46,6 +46,14 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * \brief mix factor of a pixel of a span
+   */
+  inline float getSpanValue(float value, const float inputColor2[4]) const
+  {
+    return (m_valueAlphaMultiply) ? value * inputColor2[3] : value;
+  }
+
  public:
   /**
    * Default constructor
@@ -87,12 +95,14 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -111,12 +121,14 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -147,6 +159,7 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -159,6 +172,7 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -177,6 +191,7 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -189,6 +204,7 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void executeSpan(float *output, const float *const *inputs, int width);
 };
 
 class MixValueOperation : public MixBaseOperation {
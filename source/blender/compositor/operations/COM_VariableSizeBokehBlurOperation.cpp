@@ -45,6 +45,8 @@ VariableSizeBokehBlurOperation::VariableSizeBokehBlurOperation() : NodeOperation
   this->m_do_size_scale = false;
 #ifdef COM_DEFOCUS_SEARCH
   this->m_inputSearchProgram = NULL;
+#else
+  this->setFullFrame(true);
 #endif
 }
 
@@ -71,7 +73,12 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
   data->color = (MemoryBuffer *)this->m_inputProgram->initializeTileData(rect);
   data->bokeh = (MemoryBuffer *)this->m_inputBokehProgram->initializeTileData(rect);
   data->size = (MemoryBuffer *)this->m_inputSizeProgram->initializeTileData(rect);
+  data->maxBlurScalar = determineMaxBlurScalar(data->size, rect);
+  return data;
+}
 
+int VariableSizeBokehBlurOperation::determineMaxBlurScalar(MemoryBuffer *sizeBuffer, rcti *rect)
+{
   rcti rect2;
   this->determineDependingAreaOfInterest(
       rect, (ReadBufferOperation *)this->m_inputSizeProgram, &rect2);
@@ -79,9 +86,9 @@ void *VariableSizeBokehBlurOperation::initializeTileData(rcti *rect)
   const float max_dim = max(m_width, m_height);
   const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
 
-  data->maxBlurScalar = (int)(data->size->getMaximumValue(&rect2) * scalar);
-  CLAMP(data->maxBlurScalar, 1.0f, this->m_maxBlur);
-  return data;
+  int maxBlurScalar = (int)(sizeBuffer->getMaximumValue(&rect2) * scalar);
+  CLAMP(maxBlurScalar, 1.0f, this->m_maxBlur);
+  return maxBlurScalar;
 }
 
 void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void *data)
@@ -92,7 +99,73 @@ void VariableSizeBokehBlurOperation::deinitializeTileData(rcti * /*rect*/, void
 
 void VariableSizeBokehBlurOperation::executePixel(float output[4], int x, int y, void *data)
 {
-  VariableSizeBokehBlurTileData *tileData = (VariableSizeBokehBlurTileData *)data;
+  blurPixel(output, x, y, (VariableSizeBokehBlurTileData *)data);
+}
+
+void VariableSizeBokehBlurOperation::updateMemoryBufferPartial(MemoryBuffer *output,
+                                                               const rcti *area,
+                                                               MemoryBuffer **inputs)
+{
+  /* The inputs are buffers of memory proxies covering the whole resolution, like the buffers of
+   * the tile data. The kernel reads their pixels directly, constants are spread over it. */
+  rcti resolution;
+  BLI_rcti_init(&resolution, 0, getWidth(), 0, getHeight());
+  MemoryBuffer *constants[2] = {NULL, NULL};
+  if (inputs[0]->isSingleElem()) {
+    constants[0] = inputs[0]->inflate(&resolution);
+  }
+  if (inputs[2]->isSingleElem()) {
+    constants[1] = inputs[2]->inflate(&resolution);
+  }
+
+  rcti rect = *area;
+  VariableSizeBokehBlurTileData tileData;
+  tileData.color = constants[0] ? constants[0] : inputs[0];
+  tileData.bokeh = inputs[1];
+  tileData.size = constants[1] ? constants[1] : inputs[2];
+  tileData.maxBlurScalar = determineMaxBlurScalar(tileData.size, &rect);
+
+  for (int y = area->ymin; y < area->ymax; y++) {
+    float *elem = output->getElem(area->xmin, y);
+    for (int x = area->xmin; x < area->xmax; x++) {
+      blurPixel(elem, x, y, &tileData);
+      elem += COM_NUM_CHANNELS_COLOR;
+    }
+  }
+
+  for (int index = 0; index < 2; index++) {
+    if (constants[index]) {
+      delete constants[index];
+    }
+  }
+}
+
+void VariableSizeBokehBlurOperation::getAreaOfInterest(int inputIndex,
+                                                       const rcti *outputArea,
+                                                       rcti *r_inputArea)
+{
+  if (inputIndex == 1) {
+    BLI_rcti_init(r_inputArea, 0, COM_BLUR_BOKEH_PIXELS, 0, COM_BLUR_BOKEH_PIXELS);
+    return;
+  }
+
+  const float max_dim = max(m_width, m_height);
+  const float scalar = this->m_do_size_scale ? (max_dim / 100.0f) : 1.0f;
+  /* Pixels up to the maximum blur are blurred with, the largest size is searched a bit further,
+   * see determineMaxBlurScalar. */
+  const int pad = max(max(this->m_maxBlur, 1), (int)(this->m_maxBlur * scalar)) + 2;
+  BLI_rcti_init(r_inputArea,
+                outputArea->xmin - pad,
+                outputArea->xmax + pad,
+                outputArea->ymin - pad,
+                outputArea->ymax + pad);
+}
+
+void VariableSizeBokehBlurOperation::blurPixel(float output[4],
+                                               int x,
+                                               int y,
+                                               const VariableSizeBokehBlurTileData *tileData)
+{
   MemoryBuffer *inputProgramBuffer = tileData->color;
   MemoryBuffer *inputBokehBuffer = tileData->bokeh;
   MemoryBuffer *inputSizeBuffer = tileData->size;
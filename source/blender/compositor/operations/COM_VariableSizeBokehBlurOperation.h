@@ -23,6 +23,8 @@
 
 //#define COM_DEFOCUS_SEARCH
 
+struct VariableSizeBokehBlurTileData;
+
 class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepHelper {
  private:
   int m_maxBlur;
@@ -35,6 +37,9 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
   SocketReader *m_inputSearchProgram;
 #endif
 
+  int determineMaxBlurScalar(MemoryBuffer *sizeBuffer, rcti *rect);
+  void blurPixel(float output[4], int x, int y, const VariableSizeBokehBlurTileData *tileData);
+
  public:
   VariableSizeBokehBlurOperation();
 
@@ -43,6 +48,9 @@ class VariableSizeBokehBlurOperation : public NodeOperation, public QualityStepH
    */
   void executePixel(float output[4], int x, int y, void *data);
 
+  void updateMemoryBufferPartial(MemoryBuffer *output, const rcti *area, MemoryBuffer **inputs);
+  void getAreaOfInterest(int inputIndex, const rcti *outputArea, rcti *r_inputArea);
+
   /**
    * Initialize the execution
    */
@@ -51,6 +51,13 @@ class ViewerOperation : public NodeOperation {
   void initExecution();
   void deinitExecution();
   void executeRegion(rcti *rect, unsigned int tileNumber);
+  /**
+   * the inputs are read at the pixels that are written
+   */
+  void getAreaOfInterest(int /*inputIndex*/, const rcti *outputArea, rcti *r_inputArea)
+  {
+    *r_inputArea = *outputArea;
+  }
   bool isOutputOperation(bool /*rendering*/) const
   {
     if (G.background) {
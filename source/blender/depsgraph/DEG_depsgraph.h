@@ -129,7 +129,11 @@ void DEG_graph_id_tag_update(struct Main *bmain,
 void DEG_graph_id_type_tag(struct Depsgraph *depsgraph, short id_type);
 void DEG_id_type_tag(struct Main *bmain, short id_type);
 
-void DEG_ids_clear_recalc(struct Main *bmain, Depsgraph *depsgraph);
+/* Clear recalc flags of all IDs. With backup the flags are kept aside, so a render engine which
+ * reuses the depsgraph across frames can still see which IDs were updated. */
+void DEG_ids_clear_recalc(struct Main *bmain, Depsgraph *depsgraph, const bool backup);
+/* Bring back recalc flags which were cleared with backup. */
+void DEG_ids_restore_recalc(struct Main *bmain, Depsgraph *depsgraph);
 
 /* Check if something was changed in the database and inform
  * editors about this.
@@ -53,6 +53,14 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* Number of full and incremental relations builds of the graph, and the time spent on them in
+ * seconds. */
+void DEG_stats_relations_build(const struct Depsgraph *graph,
+                               int *r_num_full_builds,
+                               double *r_full_builds_time,
+                               int *r_num_incremental_builds,
+                               double *r_incremental_builds_time);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
@@ -63,6 +71,17 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* ************************************************ */
+/* Evaluation Profiler */
+
+/* Start recording a timeline of all operations evaluated by any dependency graph, across frames.
+ * When filepath is not NULL the timeline is written there by DEG_debug_profile_end(). */
+void DEG_debug_profile_begin(const char *filepath);
+bool DEG_debug_profile_is_active(void);
+/* Write recorded timeline in the Chrome trace event JSON format. */
+bool DEG_debug_profile_write(const char *filepath);
+void DEG_debug_profile_end(void);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
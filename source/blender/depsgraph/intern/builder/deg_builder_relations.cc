@@ -103,6 +103,7 @@ extern "C" {
 
 #include "intern/builder/deg_builder.h"
 #include "intern/builder/deg_builder_pchanmap.h"
+#include "intern/builder/deg_builder_relations_cache.h"
 #include "intern/debug/deg_debug.h"
 #include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_physics.h"
@@ -241,7 +242,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      is_incremental_build_(false),
+      rna_node_query_(graph, this)
 {
 }
 
@@ -315,7 +319,8 @@ void DepsgraphRelationBuilder::add_modifier_to_transform_relation(const DepsNode
   add_depends_on_transform_relation(id, geometry_key, description);
 }
 
-void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
+void DepsgraphRelationBuilder::add_customdata_mask(ID *requester_id,
+                                                   Object *object,
                                                    const DEGCustomDataMeshMasks &customdata_masks)
 {
   if (customdata_masks != DEGCustomDataMeshMasks() && object != nullptr &&
@@ -327,11 +332,12 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
     }
     else {
       id_node->customdata_masks |= customdata_masks;
+      graph_->relations_cache->add_eval_request(requester_id, &object->id, 0, customdata_masks);
     }
   }
 }
 
-void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
+void DepsgraphRelationBuilder::add_special_eval_flag(ID *requester_id, ID *id, uint32_t flag)
 {
   DEG::IDNode *id_node = graph_->find_id_node(id);
   if (id_node == nullptr) {
@@ -339,6 +345,7 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
   }
   else {
     id_node->eval_flags |= flag;
+    graph_->relations_cache->add_eval_request(requester_id, id, flag, DEGCustomDataMeshMasks());
   }
 }
 
@@ -348,6 +355,9 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
   else {
@@ -369,6 +379,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
+    if (is_incremental_build_) {
+      flags |= RELATION_CHECK_BEFORE_ADD;
+    }
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
   else {
@@ -476,6 +489,18 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(const set<ID *> &rebuild_ids)
+{
+  is_incremental_build_ = true;
+  /* Builders stop traversal on IDs which are already built, so only the IDs from the set are
+   * visited while building the view layer. */
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (rebuild_ids.find(id_node->id_orig) == rebuild_ids.end()) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -775,7 +800,7 @@ void DepsgraphRelationBuilder::build_object_data(Object *object)
       if (object->type == OB_FONT) {
         Curve *curve = (Curve *)object->data;
         if (curve->textoncurve) {
-          add_special_eval_flag(&curve->textoncurve->id, DAG_EVAL_NEED_CURVE_PATH);
+          add_special_eval_flag(&object->id, &curve->textoncurve->id, DAG_EVAL_NEED_CURVE_PATH);
         }
       }
       break;
@@ -888,7 +913,8 @@ void DepsgraphRelationBuilder::build_object_parent(Object *object)
        * TODO(sergey): This optimization got lost at 2.8, so either verify
        * we can get rid of this mask here, or bring the optimization
        * back. */
-      add_customdata_mask(object->parent,
+      add_customdata_mask(&object->id,
+                          object->parent,
                           DEGCustomDataMeshMasks::MaskVert(CD_MASK_ORIGINDEX) |
                               DEGCustomDataMeshMasks::MaskEdge(CD_MASK_ORIGINDEX) |
                               DEGCustomDataMeshMasks::MaskFace(CD_MASK_ORIGINDEX) |
@@ -953,7 +979,7 @@ void DepsgraphRelationBuilder::build_object_parent(Object *object)
 
   /* Dupliverts uses original vertex index. */
   if (parent->transflag & OB_DUPLIVERTS) {
-    add_customdata_mask(parent, DEGCustomDataMeshMasks::MaskVert(CD_MASK_ORIGINDEX));
+    add_customdata_mask(&object->id, parent, DEGCustomDataMeshMasks::MaskVert(CD_MASK_ORIGINDEX));
   }
 }
 
@@ -1123,7 +1149,7 @@ void DepsgraphRelationBuilder::build_constraints(ID *id,
           ComponentKey target_geometry_key(&ct->tar->id, NodeType::GEOMETRY);
           add_relation(target_transform_key, constraint_op_key, cti->name);
           add_relation(target_geometry_key, constraint_op_key, cti->name);
-          add_customdata_mask(ct->tar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
+          add_customdata_mask(id, ct->tar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
         }
         else if (con->type == CONSTRAINT_TYPE_SHRINKWRAP) {
           bShrinkwrapConstraint *scon = (bShrinkwrapConstraint *)con->data;
@@ -1136,12 +1162,13 @@ void DepsgraphRelationBuilder::build_constraints(ID *id,
           if (ct->tar->type == OB_MESH && scon->shrinkType != MOD_SHRINKWRAP_NEAREST_VERTEX) {
             bool track = (scon->flag & CON_SHRINKWRAP_TRACK_NORMAL) != 0;
             if (track || BKE_shrinkwrap_needs_normals(scon->shrinkType, scon->shrinkMode)) {
-              add_customdata_mask(ct->tar,
+              add_customdata_mask(id,
+                                  ct->tar,
                                   DEGCustomDataMeshMasks::MaskVert(CD_MASK_NORMAL) |
                                       DEGCustomDataMeshMasks::MaskLoop(CD_MASK_CUSTOMLOOPNORMAL));
             }
             if (scon->shrinkType == MOD_SHRINKWRAP_TARGET_PROJECT) {
-              add_special_eval_flag(&ct->tar->id, DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY);
+              add_special_eval_flag(id, &ct->tar->id, DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY);
             }
           }
 
@@ -160,6 +160,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
+  /* Only build relations of the given IDs, relations of all other IDs are restored from the
+   * relations cache of the graph. Relations which already exist are not added again. */
+  void begin_build_incremental(const set<ID *> &rebuild_ids);
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -190,8 +193,13 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
    * of this object. */
   void add_modifier_to_transform_relation(const DepsNodeHandle *handle, const char *description);
 
-  void add_customdata_mask(Object *object, const DEGCustomDataMeshMasks &customdata_masks);
-  void add_special_eval_flag(ID *object, uint32_t flag);
+  /* Request evaluation flags and CustomData layers of the given ID for the builder of the
+   * requester ID. The request is stored in the relations cache, so it is kept by incremental
+   * builds which skip the builder of the requester. */
+  void add_customdata_mask(ID *requester_id,
+                           Object *object,
+                           const DEGCustomDataMeshMasks &customdata_masks);
+  void add_special_eval_flag(ID *requester_id, ID *id, uint32_t flag);
 
   virtual void build_id(ID *id);
 
@@ -358,6 +366,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   /* State which demotes currently built entities. */
   Scene *scene_;
 
+  /* Relations of some IDs are restored from the relations cache. */
+  bool is_incremental_build_;
+
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
 };
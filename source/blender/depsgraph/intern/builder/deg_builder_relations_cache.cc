@@ -0,0 +1,220 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_relations_cache.h"
+
+#include "BLI_ghash.h"
+#include "BLI_utildefines.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_time.h"
+
+namespace DEG {
+
+RelationsCache::RelationsCache() : num_relations_(0)
+{
+}
+
+RelationsCache::~RelationsCache()
+{
+}
+
+void RelationsCache::clear()
+{
+  operations_.clear();
+  num_relations_ = 0;
+  eval_requests_.clear();
+}
+
+bool RelationsCache::is_empty() const
+{
+  return num_relations_ == 0;
+}
+
+void RelationsCache::identifier_from_operation(const OperationNode *op_node,
+                                               OperationIdentifier *r_identifier)
+{
+  const ComponentNode *comp_node = op_node->owner;
+  r_identifier->id_orig = comp_node->owner->id_orig;
+  r_identifier->component_type = comp_node->type;
+  r_identifier->component_name = comp_node->name;
+  r_identifier->opcode = op_node->opcode;
+  r_identifier->name = op_node->name;
+  r_identifier->name_tag = op_node->name_tag;
+}
+
+OperationNode *RelationsCache::find_operation(const Depsgraph *graph,
+                                              const OperationIdentifier &identifier)
+{
+  const IDNode *id_node = graph->find_id_node(identifier.id_orig);
+  if (id_node == nullptr) {
+    return nullptr;
+  }
+  const ComponentNode *comp_node = id_node->find_component(identifier.component_type,
+                                                           identifier.component_name.c_str());
+  if (comp_node == nullptr) {
+    return nullptr;
+  }
+  return comp_node->find_operation(
+      identifier.opcode, identifier.name.c_str(), identifier.name_tag);
+}
+
+void RelationsCache::store(const Depsgraph *graph)
+{
+  operations_.clear();
+  num_relations_ = 0;
+  for (const IDNode *id_node : graph->id_nodes) {
+    GHASH_FOREACH_BEGIN (const ComponentNode *, comp_node, id_node->components) {
+      /* Operations are only moved to the vector when build is finalized. */
+      BLI_assert(comp_node->operations_map != nullptr);
+      GHASH_FOREACH_BEGIN (const OperationNode *, op_node, comp_node->operations_map) {
+        if (op_node->inlinks.size() == 0) {
+          continue;
+        }
+        operations_.push_back(CachedOperation());
+        CachedOperation &cached_operation = operations_.back();
+        identifier_from_operation(op_node, &cached_operation.operation);
+        cached_operation.inlinks.reserve(op_node->inlinks.size());
+        for (const Relation *rel : op_node->inlinks) {
+          CachedRelation cached_relation;
+          if (rel->from->type == NodeType::TIMESOURCE) {
+            cached_relation.from_time_source = true;
+          }
+          else if (rel->from->type == NodeType::OPERATION) {
+            cached_relation.from_time_source = false;
+            identifier_from_operation(static_cast<const OperationNode *>(rel->from),
+                                      &cached_relation.from);
+          }
+          else {
+            BLI_assert(!"Relations builder is only expected to connect operations");
+            continue;
+          }
+          cached_relation.name = rel->name;
+          cached_relation.flag = rel->flag;
+          cached_operation.inlinks.push_back(cached_relation);
+          num_relations_++;
+        }
+      }
+      GHASH_FOREACH_END();
+    }
+    GHASH_FOREACH_END();
+  }
+}
+
+void RelationsCache::add_eval_request(ID *requester_id,
+                                      ID *target_id,
+                                      uint32_t eval_flags,
+                                      const DEGCustomDataMeshMasks &customdata_masks)
+{
+  CachedEvalRequest request;
+  request.requester_id = requester_id;
+  request.target_id = target_id;
+  request.eval_flags = eval_flags;
+  request.customdata_masks = customdata_masks;
+  eval_requests_.push_back(request);
+}
+
+void RelationsCache::expand_ids(set<ID *> *ids) const
+{
+  set<ID *> connected_ids;
+  for (const CachedOperation &cached_operation : operations_) {
+    ID *id_to = cached_operation.operation.id_orig;
+    const bool is_to_in_set = (ids->find(id_to) != ids->end());
+    for (const CachedRelation &cached_relation : cached_operation.inlinks) {
+      if (cached_relation.from_time_source) {
+        continue;
+      }
+      ID *id_from = cached_relation.from.id_orig;
+      if (id_from == id_to) {
+        continue;
+      }
+      if (is_to_in_set) {
+        connected_ids.insert(id_from);
+      }
+      else if (ids->find(id_from) != ids->end()) {
+        connected_ids.insert(id_to);
+      }
+    }
+  }
+  ids->insert(connected_ids.begin(), connected_ids.end());
+}
+
+int RelationsCache::restore(Depsgraph *graph, const set<ID *> &rebuild_ids)
+{
+  int num_restored_relations = 0;
+  for (const CachedOperation &cached_operation : operations_) {
+    OperationNode *op_to = find_operation(graph, cached_operation.operation);
+    if (op_to == nullptr) {
+      continue;
+    }
+    const bool is_to_rebuilt = (rebuild_ids.find(cached_operation.operation.id_orig) !=
+                                rebuild_ids.end());
+    for (const CachedRelation &cached_relation : cached_operation.inlinks) {
+      Node *node_from;
+      if (cached_relation.from_time_source) {
+        /* Time relations are created by the builder of the ID which uses them. */
+        if (is_to_rebuilt) {
+          continue;
+        }
+        node_from = graph->find_time_source();
+      }
+      else {
+        if (is_to_rebuilt &&
+            rebuild_ids.find(cached_relation.from.id_orig) != rebuild_ids.end()) {
+          continue;
+        }
+        node_from = find_operation(graph, cached_relation.from);
+      }
+      if (node_from == nullptr) {
+        continue;
+      }
+      graph->add_new_relation(node_from, op_to, cached_relation.name, cached_relation.flag);
+      num_restored_relations++;
+    }
+  }
+  /* Targets of requests are not necessarily connected to the requester by a relation which
+   * makes them rebuilt together, so requests are applied per requester. */
+  vector<CachedEvalRequest> kept_eval_requests;
+  for (const CachedEvalRequest &request : eval_requests_) {
+    if (rebuild_ids.find(request.requester_id) != rebuild_ids.end()) {
+      continue;
+    }
+    if (graph->find_id_node(request.requester_id) == nullptr) {
+      continue;
+    }
+    IDNode *target_node = graph->find_id_node(request.target_id);
+    if (target_node == nullptr) {
+      continue;
+    }
+    target_node->eval_flags |= request.eval_flags;
+    target_node->customdata_masks |= request.customdata_masks;
+    kept_eval_requests.push_back(request);
+  }
+  eval_requests_.swap(kept_eval_requests);
+  return num_restored_relations;
+}
+
+}  // namespace DEG
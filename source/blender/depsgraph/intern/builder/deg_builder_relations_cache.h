@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "intern/depsgraph_type.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_operation.h"
+
+struct ID;
+
+namespace DEG {
+
+struct Depsgraph;
+
+/* Relations created by the relations builder, stored in a way which survives re-creation of the
+ * graph nodes.
+ *
+ * Used by the incremental relations update: relations between IDs which were not tagged for
+ * relations update are re-created from this cache instead of going through the relations
+ * builder again. */
+class RelationsCache {
+ public:
+  RelationsCache();
+  ~RelationsCache();
+
+  void clear();
+  bool is_empty() const;
+
+  /* Store all relations which currently exist in the graph.
+   * Evaluation requests are not affected, they are added by the relations builder as it goes.
+   *
+   * NOTE: Is to be called before copy-on-write relations are added, those are always created for
+   * the whole graph. */
+  void store(const Depsgraph *graph);
+
+  /* Store special evaluation flags and CustomData masks which the builder of the requester ID
+   * requested for the target ID. */
+  void add_eval_request(ID *requester_id,
+                        ID *target_id,
+                        uint32_t eval_flags,
+                        const DEGCustomDataMeshMasks &customdata_masks);
+
+  /* Add IDs which are connected to the given ones by a cached relation.
+   * These IDs might have relations to the tagged ones created by their builder, so they are to be
+   * built again as well. */
+  void expand_ids(set<ID *> *ids) const;
+
+  /* Re-create cached relations in the graph, skipping relations between IDs of the given set.
+   * Relations builder is expected to create those for the IDs from the set.
+   *
+   * Evaluation requests made by builders of IDs which are not in the set are applied again,
+   * whether the target ID is in the set or not, since builders of those IDs are not invoked.
+   * Requests of IDs from the set are dropped, their builders make them again.
+   *
+   * Returns number of restored relations. */
+  int restore(Depsgraph *graph, const set<ID *> &rebuild_ids);
+
+ protected:
+  /* Identifies operation node across graph rebuilds. */
+  struct OperationIdentifier {
+    ID *id_orig;
+    NodeType component_type;
+    string component_name;
+    OperationCode opcode;
+    string name;
+    int name_tag;
+  };
+
+  struct CachedRelation {
+    /* When true the relation is coming from the time source, and from is ignored. */
+    bool from_time_source;
+    OperationIdentifier from;
+    const char *name;
+    int flag;
+  };
+
+  struct CachedOperation {
+    OperationIdentifier operation;
+    vector<CachedRelation> inlinks;
+  };
+
+  static void identifier_from_operation(const OperationNode *op_node,
+                                        OperationIdentifier *r_identifier);
+  static OperationNode *find_operation(const Depsgraph *graph,
+                                       const OperationIdentifier &identifier);
+
+  struct CachedEvalRequest {
+    ID *requester_id;
+    ID *target_id;
+    uint32_t eval_flags;
+    DEGCustomDataMeshMasks customdata_masks;
+  };
+
+  vector<CachedOperation> operations_;
+  int num_relations_;
+  vector<CachedEvalRequest> eval_requests_;
+};
+
+}  // namespace DEG
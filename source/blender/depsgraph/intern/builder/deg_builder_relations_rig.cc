@@ -110,7 +110,8 @@ void DepsgraphRelationBuilder::build_ik_pose(Object *object,
        * separately. */
       ComponentKey target_key(&data->tar->id, NodeType::GEOMETRY);
       add_relation(target_key, target_dependent_key, con->name);
-      add_customdata_mask(data->tar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
+      add_customdata_mask(
+          &object->id, data->tar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
     }
     if (data->tar == object && data->subtarget[0]) {
       /* Prevent target's constraints from linking to anything from same
@@ -139,7 +140,8 @@ void DepsgraphRelationBuilder::build_ik_pose(Object *object,
        * separately. */
       ComponentKey target_key(&data->poletar->id, NodeType::GEOMETRY);
       add_relation(target_key, target_dependent_key, con->name);
-      add_customdata_mask(data->poletar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
+      add_customdata_mask(
+          &object->id, data->poletar, DEGCustomDataMeshMasks::MaskVert(CD_MASK_MDEFORMVERT));
     }
   }
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -223,7 +225,7 @@ void DepsgraphRelationBuilder::build_splineik_pose(Object *object,
     add_relation(target_geometry_key, solver_key, "Curve.Path -> Spline IK");
     ComponentKey target_transform_key(&data->tar->id, NodeType::TRANSFORM);
     add_relation(target_transform_key, solver_key, "Curve.Transform -> Spline IK");
-    add_special_eval_flag(&data->tar->id, DAG_EVAL_NEED_CURVE_PATH);
+    add_special_eval_flag(&object->id, &data->tar->id, DAG_EVAL_NEED_CURVE_PATH);
   }
   pchan->flag |= POSE_DONE;
   OperationKey final_transforms_key(
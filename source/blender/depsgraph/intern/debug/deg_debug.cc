@@ -35,7 +35,13 @@
 namespace DEG {
 
 DepsgraphDebug::DepsgraphDebug()
-    : flags(G.debug), is_ever_evaluated(false), graph_evaluation_start_time_(0)
+    : flags(G.debug),
+      is_ever_evaluated(false),
+      num_full_builds(0),
+      full_builds_time(0.0),
+      num_incremental_builds(0),
+      incremental_builds_time(0.0),
+      graph_evaluation_start_time_(0)
 {
 }
 
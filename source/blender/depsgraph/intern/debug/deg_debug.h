@@ -52,6 +52,13 @@ class DepsgraphDebug {
    * This is NOT an indication that depsgraph is at its evaluated state. */
   bool is_ever_evaluated;
 
+  /* Number of relations builds and accumulated time spent on them, in seconds.
+   * Allows to measure time saved by the incremental relations update. */
+  int num_full_builds;
+  double full_builds_time;
+  int num_incremental_builds;
+  double incremental_builds_time;
+
  protected:
   /* Maximum number of counters used to calculate frame rate of depsgraph update. */
   static const constexpr int MAX_FPS_COUNTERS = 64;
@@ -0,0 +1,294 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Timeline is exported in the Chrome trace event format, which can be inspected with
+ * chrome://tracing or Perfetto.
+ */
+
+#include "intern/debug/deg_debug_profile.h"
+
+#include <cstdio>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "PIL_time.h"
+
+extern "C" {
+#include "DNA_ID.h"
+} /* extern "C" */
+
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/depsgraph.h"
+#include "intern/debug/deg_debug.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace DEG {
+
+namespace {
+
+struct ProfileEvent {
+  double start_time;
+  double end_time;
+  float frame;
+  char id_name[MAX_ID_NAME];
+  /* Component and operation type names are static strings. */
+  const char *component_type;
+  const char *operation;
+  string component_name;
+  string operation_name;
+  string graph_name;
+};
+
+/* Events of one thread, the lock is only contended when several graphs are evaluated at the same
+ * time (viewport and render for example), since each of them has its own thread 0. */
+struct ProfileThread {
+  vector<ProfileEvent> events;
+  SpinLock lock;
+};
+
+/* Scheduler threads have an index in [0, BLENDER_MAX_THREADS], graph evaluations are stored in
+ * an extra timeline after them. */
+#define PROFILE_NUM_THREADS (BLENDER_MAX_THREADS + 2)
+#define PROFILE_EVALUATION_THREAD (BLENDER_MAX_THREADS + 1)
+
+struct Profile {
+  bool is_active;
+  double start_time;
+  string filepath;
+  ProfileThread *threads;
+};
+
+Profile profile = {false, 0.0, "", NULL};
+
+void profile_push_event(const int thread_index, ProfileEvent &event)
+{
+  BLI_assert(thread_index >= 0 && thread_index < PROFILE_NUM_THREADS);
+  ProfileThread &thread = profile.threads[thread_index];
+  BLI_spin_lock(&thread.lock);
+  thread.events.push_back(event);
+  BLI_spin_unlock(&thread.lock);
+}
+
+/* Write string as a JSON string literal. */
+void profile_write_json_string(FILE *file, const char *str)
+{
+  fputc('"', file);
+  for (const char *c = str; *c != '\0'; c++) {
+    switch (*c) {
+      case '"':
+        fputs("\\\"", file);
+        break;
+      case '\\':
+        fputs("\\\\", file);
+        break;
+      default:
+        if ((unsigned char)*c < 0x20) {
+          fprintf(file, "\\u%04x", (unsigned char)*c);
+        }
+        else {
+          fputc(*c, file);
+        }
+        break;
+    }
+  }
+  fputc('"', file);
+}
+
+void profile_write_event(FILE *file, const int thread_index, const ProfileEvent &event)
+{
+  /* Timestamps are in microseconds. */
+  fprintf(file,
+          ",\n{\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"name\":",
+          thread_index,
+          (event.start_time - profile.start_time) * 1e6,
+          (event.end_time - event.start_time) * 1e6);
+  if (event.operation == NULL) {
+    fprintf(file, "\"Evaluate frame %g\",\"cat\":\"Depsgraph\"", event.frame);
+  }
+  else {
+    string name = string(event.id_name + 2) + " " + event.operation;
+    if (!event.operation_name.empty()) {
+      name += " " + event.operation_name;
+    }
+    profile_write_json_string(file, name.c_str());
+    fputs(",\"cat\":", file);
+    profile_write_json_string(file, event.component_type);
+  }
+  fputs(",\"args\":{\"depsgraph\":", file);
+  profile_write_json_string(file, event.graph_name.c_str());
+  fprintf(file, ",\"frame\":%g", event.frame);
+  if (event.operation != NULL) {
+    fputs(",\"id\":", file);
+    profile_write_json_string(file, event.id_name);
+    fputs(",\"component\":", file);
+    profile_write_json_string(file, event.component_name.c_str());
+    fputs(",\"operation\":", file);
+    profile_write_json_string(file, event.operation);
+  }
+  fputs("}}", file);
+}
+
+void profile_write_thread_name(FILE *file, const int thread_index, const char *name)
+{
+  fprintf(file,
+          ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+          "\"args\":{\"name\":\"%s\"}}",
+          thread_index,
+          name);
+  /* Keep graph evaluations on top, followed by threads in order. */
+  fprintf(file,
+          ",\n{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_sort_index\","
+          "\"args\":{\"sort_index\":%d}}",
+          thread_index,
+          (thread_index == PROFILE_EVALUATION_THREAD) ? -1 : thread_index);
+}
+
+}  // namespace
+
+bool deg_debug_profile_is_active()
+{
+  return profile.is_active;
+}
+
+void deg_debug_profile_record_operation(const Depsgraph *graph,
+                                        const OperationNode *operation_node,
+                                        const int thread_id,
+                                        const double start_time,
+                                        const double end_time)
+{
+  const ComponentNode *comp_node = operation_node->owner;
+  const IDNode *id_node = comp_node->owner;
+  ProfileEvent event;
+  event.start_time = start_time;
+  event.end_time = end_time;
+  event.frame = graph->ctime;
+  BLI_strncpy(event.id_name, id_node->id_orig->name, sizeof(event.id_name));
+  event.component_type = nodeTypeAsString(comp_node->type);
+  event.operation = operationCodeAsString(operation_node->opcode);
+  event.component_name = comp_node->name;
+  event.operation_name = operation_node->name;
+  event.graph_name = graph->debug.name;
+  profile_push_event(thread_id, event);
+}
+
+void deg_debug_profile_record_evaluation(const Depsgraph *graph,
+                                         const double start_time,
+                                         const double end_time)
+{
+  ProfileEvent event;
+  event.start_time = start_time;
+  event.end_time = end_time;
+  event.frame = graph->ctime;
+  event.id_name[0] = '\0';
+  event.component_type = NULL;
+  event.operation = NULL;
+  event.graph_name = graph->debug.name;
+  profile_push_event(PROFILE_EVALUATION_THREAD, event);
+}
+
+}  // namespace DEG
+
+void DEG_debug_profile_begin(const char *filepath)
+{
+  DEG_debug_profile_end();
+
+  DEG::profile.threads = new DEG::ProfileThread[PROFILE_NUM_THREADS];
+  for (int i = 0; i < PROFILE_NUM_THREADS; i++) {
+    BLI_spin_init(&DEG::profile.threads[i].lock);
+  }
+  DEG::profile.filepath = (filepath != NULL) ? filepath : "";
+  DEG::profile.start_time = PIL_check_seconds_timer();
+  DEG::profile.is_active = true;
+}
+
+bool DEG_debug_profile_is_active(void)
+{
+  return DEG::profile.is_active;
+}
+
+bool DEG_debug_profile_write(const char *filepath)
+{
+  if (!DEG::profile.is_active) {
+    return false;
+  }
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == NULL) {
+    DEG_ERROR_PRINTF("Error writing depsgraph profile '%s'\n", filepath);
+    return false;
+  }
+
+  fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+  fputs("{\"ph\":\"M\",\"pid\":1,\"name\":\"process_name\",\"args\":{\"name\":\"Depsgraph\"}}",
+        file);
+  for (int thread_index = 0; thread_index < PROFILE_NUM_THREADS; thread_index++) {
+    DEG::ProfileThread &thread = DEG::profile.threads[thread_index];
+    BLI_spin_lock(&thread.lock);
+    if (!thread.events.empty()) {
+      char name[64];
+      if (thread_index == PROFILE_EVALUATION_THREAD) {
+        STRNCPY(name, "Graph evaluations");
+      }
+      else if (thread_index == 0) {
+        STRNCPY(name, "Calling thread");
+      }
+      else {
+        BLI_snprintf(name, sizeof(name), "Worker thread %d", thread_index);
+      }
+      DEG::profile_write_thread_name(file, thread_index, name);
+    }
+    for (const DEG::ProfileEvent &event : thread.events) {
+      DEG::profile_write_event(file, thread_index, event);
+    }
+    BLI_spin_unlock(&thread.lock);
+  }
+  fputs("\n]}\n", file);
+  fclose(file);
+  return true;
+}
+
+void DEG_debug_profile_end(void)
+{
+  if (!DEG::profile.is_active) {
+    return;
+  }
+  if (!DEG::profile.filepath.empty()) {
+    if (DEG_debug_profile_write(DEG::profile.filepath.c_str())) {
+      printf("Depsgraph profile written to '%s'\n", DEG::profile.filepath.c_str());
+    }
+  }
+  DEG::profile.is_active = false;
+  for (int i = 0; i < PROFILE_NUM_THREADS; i++) {
+    BLI_spin_end(&DEG::profile.threads[i].lock);
+  }
+  delete[] DEG::profile.threads;
+  DEG::profile.threads = NULL;
+  DEG::profile.filepath.clear();
+}
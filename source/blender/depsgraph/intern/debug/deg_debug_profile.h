@@ -0,0 +1,47 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Evaluation profiler, records a timeline of all operations evaluated by all dependency graphs.
+ */
+
+#pragma once
+
+namespace DEG {
+
+struct Depsgraph;
+struct OperationNode;
+
+bool deg_debug_profile_is_active();
+
+/* Record evaluation of a single operation, done by the given task scheduler thread. */
+void deg_debug_profile_record_operation(const Depsgraph *graph,
+                                        const OperationNode *operation_node,
+                                        const int thread_id,
+                                        const double start_time,
+                                        const double end_time);
+
+/* Record a whole evaluation of the graph. */
+void deg_debug_profile_record_evaluation(const Depsgraph *graph,
+                                         const double start_time,
+                                         const double end_time);
+
+}  // namespace DEG
@@ -44,6 +44,8 @@ extern "C" {
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_debug.h"
 
+#include "intern/builder/deg_builder_relations_cache.h"
+
 #include "intern/depsgraph_update.h"
 #include "intern/depsgraph_physics.h"
 #include "intern/depsgraph_relation.h"
@@ -69,6 +71,7 @@ template<typename T> static void remove_from_vector(vector<T> *vector, const T &
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_update_all_relations(true),
       need_update_time(false),
       bmain(bmain),
       scene(scene),
@@ -84,8 +87,10 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
   id_hash = BLI_ghash_ptr_new("Depsgraph id hash");
   entry_tags = BLI_gset_ptr_new("Depsgraph entry_tags");
   memset(id_type_updated, 0, sizeof(id_type_updated));
+  memset(id_type_updated_backup, 0, sizeof(id_type_updated_backup));
   memset(id_type_exist, 0, sizeof(id_type_exist));
   memset(physics_relations, 0, sizeof(physics_relations));
+  relations_cache = OBJECT_GUARDED_NEW(RelationsCache);
 }
 
 Depsgraph::~Depsgraph()
@@ -93,6 +98,7 @@ Depsgraph::~Depsgraph()
   clear_id_nodes();
   BLI_ghash_free(id_hash, nullptr, nullptr);
   BLI_gset_free(entry_tags, nullptr);
+  OBJECT_GUARDED_DELETE(relations_cache, RelationsCache);
   if (time_source != nullptr) {
     OBJECT_GUARDED_DELETE(time_source, TimeSourceNode);
   }
@@ -55,6 +55,7 @@ struct IDNode;
 struct Node;
 struct OperationNode;
 struct Relation;
+class RelationsCache;
 struct TimeSourceNode;
 
 /* Dependency Graph object */
@@ -110,8 +111,21 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Relations of all IDs are to be updated. When it is false only relations of the IDs from
+   * id_relations_tagged are to be updated, which allows to use incremental relations update. */
+  bool need_update_all_relations;
+
+  /* IDs which were tagged for relations update since the relations were last built. */
+  set<ID *> id_relations_tagged;
+
+  /* Relations created by the builder during the last build.
+   * Only filled in when incremental relations update is enabled. */
+  RelationsCache *relations_cache;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
+  /* Updated ID types which were cleared with backup. */
+  char id_type_updated_backup[MAX_LIBARRAY];
 
   /* Indicates type of IDs present in the depsgraph. */
   char id_type_exist[MAX_LIBARRAY];
@@ -50,6 +50,7 @@ extern "C" {
 #include "builder/deg_builder_cycle.h"
 #include "builder/deg_builder_nodes.h"
 #include "builder/deg_builder_relations.h"
+#include "builder/deg_builder_relations_cache.h"
 #include "builder/deg_builder_transitive.h"
 
 #include "intern/debug/deg_debug.h"
@@ -172,7 +173,8 @@ void DEG_add_modifier_to_transform_relation(struct DepsNodeHandle *node_handle,
 void DEG_add_special_eval_flag(struct DepsNodeHandle *node_handle, ID *id, uint32_t flag)
 {
   DEG::DepsNodeHandle *deg_node_handle = get_node_handle(node_handle);
-  deg_node_handle->builder->add_special_eval_flag(id, flag);
+  deg_node_handle->builder->add_special_eval_flag(
+      deg_node_handle->node->owner->owner->id_orig, id, flag);
 }
 
 void DEG_add_customdata_mask(struct DepsNodeHandle *node_handle,
@@ -180,7 +182,9 @@ void DEG_add_customdata_mask(struct DepsNodeHandle *node_handle,
                              const CustomData_MeshMasks *masks)
 {
   DEG::DepsNodeHandle *deg_node_handle = get_node_handle(node_handle);
-  deg_node_handle->builder->add_customdata_mask(object, DEG::DEGCustomDataMeshMasks(masks));
+  deg_node_handle->builder->add_customdata_mask(deg_node_handle->node->owner->owner->id_orig,
+                                                object,
+                                                DEG::DEGCustomDataMeshMasks(masks));
 }
 
 struct ID *DEG_get_id_from_handle(struct DepsNodeHandle *node_handle)
@@ -223,6 +227,30 @@ static void graph_build_finalize_common(DEG::Depsgraph *deg_graph, Main *bmain)
 #endif
   /* Relations are up to date. */
   deg_graph->need_update = false;
+  deg_graph->need_update_all_relations = false;
+  deg_graph->id_relations_tagged.clear();
+}
+
+/* Collect IDs relations of which are to be built again by the incremental relations update.
+ * Returns false when relations of the whole graph are to be built. */
+static bool graph_build_incremental_ids(DEG::Depsgraph *deg_graph, DEG::set<ID *> *r_rebuild_ids)
+{
+  if ((G.f & G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS) == 0) {
+    return false;
+  }
+  if (deg_graph->need_update_all_relations || deg_graph->relations_cache->is_empty()) {
+    return false;
+  }
+  for (ID *id : deg_graph->id_relations_tagged) {
+    /* Object level edits (modifiers, constraints) are the common case. Other data-blocks, like
+     * collections, might change bases of the view layer, which is only handled by full build. */
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    r_rebuild_ids->insert(id);
+  }
+  deg_graph->relations_cache->expand_ids(r_rebuild_ids);
+  return true;
 }
 
 /* Build depsgraph for the given scene layer, and dump results in given graph container. */
@@ -231,31 +259,79 @@ void DEG_graph_build_from_view_layer(Depsgraph *graph,
                                      Scene *scene,
                                      ViewLayer *view_layer)
 {
-  double start_time = 0.0;
-  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    start_time = PIL_check_seconds_timer();
-  }
+  const double start_time = PIL_check_seconds_timer();
   DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
   /* Perform sanity checks. */
   BLI_assert(BLI_findindex(&scene->view_layers, view_layer) != -1);
   BLI_assert(deg_graph->scene == scene);
   BLI_assert(deg_graph->view_layer == view_layer);
+  const bool use_relations_cache = (G.f & G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS) != 0;
+  DEG::set<ID *> rebuild_ids;
+  const bool is_incremental = graph_build_incremental_ids(deg_graph, &rebuild_ids);
+  DEG::set<ID *> previous_ids;
+  if (is_incremental) {
+    for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+      previous_ids.insert(id_node->id_orig);
+    }
+  }
   DEG::DepsgraphBuilderCache builder_cache;
   /* Generate all the nodes in the graph first */
   DEG::DepsgraphNodeBuilder node_builder(bmain, deg_graph, &builder_cache);
   node_builder.begin_build();
   node_builder.build_view_layer(scene, view_layer, DEG::DEG_ID_LINKED_DIRECTLY);
   node_builder.end_build();
+  const double nodes_time = PIL_check_seconds_timer();
   /* Hook up relationships between operations - to determine evaluation order. */
   DEG::DepsgraphRelationBuilder relation_builder(bmain, deg_graph, &builder_cache);
   relation_builder.begin_build();
+  int num_restored_relations = 0;
+  if (is_incremental) {
+    /* IDs which were not in the graph have no cached relations. */
+    for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+      if (previous_ids.find(id_node->id_orig) == previous_ids.end()) {
+        rebuild_ids.insert(id_node->id_orig);
+      }
+    }
+    relation_builder.begin_build_incremental(rebuild_ids);
+    num_restored_relations = deg_graph->relations_cache->restore(deg_graph, rebuild_ids);
+  }
+  else {
+    /* Evaluation requests are stored by the relations builder as it goes. */
+    deg_graph->relations_cache->clear();
+  }
   relation_builder.build_view_layer(scene, view_layer, DEG::DEG_ID_LINKED_DIRECTLY);
+  if (use_relations_cache) {
+    deg_graph->relations_cache->store(deg_graph);
+  }
+  else {
+    deg_graph->relations_cache->clear();
+  }
   relation_builder.build_copy_on_write_relations();
+  const double relations_time = PIL_check_seconds_timer();
   /* Finalize building. */
   graph_build_finalize_common(deg_graph, bmain);
   /* Finish statistics. */
+  const double end_time = PIL_check_seconds_timer();
+  if (is_incremental) {
+    deg_graph->debug.num_incremental_builds++;
+    deg_graph->debug.incremental_builds_time += end_time - start_time;
+  }
+  else {
+    deg_graph->debug.num_full_builds++;
+    deg_graph->debug.full_builds_time += end_time - start_time;
+  }
   if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
-    printf("Depsgraph built in %f seconds.\n", PIL_check_seconds_timer() - start_time);
+    printf("Depsgraph built in %f seconds.\n", end_time - start_time);
+    printf("  Nodes: %f, relations: %f, finalize: %f seconds.\n",
+           nodes_time - start_time,
+           relations_time - nodes_time,
+           end_time - relations_time);
+    if (is_incremental) {
+      printf("  Incremental: %d of %d IDs rebuilt, %d relations restored.\n",
+             (int)rebuild_ids.size(),
+             (int)deg_graph->id_nodes.size(),
+             num_restored_relations);
+    }
   }
 }
 
@@ -272,6 +348,8 @@ void DEG_graph_build_for_render_pipeline(Depsgraph *graph,
   /* Perform sanity checks. */
   BLI_assert(deg_graph->scene == scene);
   deg_graph->is_render_pipeline_depsgraph = true;
+  /* Incremental relations update is only supported for the view layer graphs. */
+  deg_graph->relations_cache->clear();
   DEG::DepsgraphBuilderCache builder_cache;
   /* Generate all the nodes in the graph first */
   DEG::DepsgraphNodeBuilder node_builder(bmain, deg_graph, &builder_cache);
@@ -303,6 +381,8 @@ void DEG_graph_build_for_compositor_preview(
   /* Perform sanity checks. */
   BLI_assert(deg_graph->scene == scene);
   deg_graph->is_render_pipeline_depsgraph = true;
+  /* Incremental relations update is only supported for the view layer graphs. */
+  deg_graph->relations_cache->clear();
   DEG::DepsgraphBuilderCache builder_cache;
   /* Generate all the nodes in the graph first */
   DEG::DepsgraphNodeBuilder node_builder(bmain, deg_graph, &builder_cache);
@@ -440,6 +520,8 @@ void DEG_graph_build_from_ids(Depsgraph *graph,
   BLI_assert(BLI_findindex(&scene->view_layers, view_layer) != -1);
   BLI_assert(deg_graph->scene == scene);
   BLI_assert(deg_graph->view_layer == view_layer);
+  /* Incremental relations update is only supported for the view layer graphs. */
+  deg_graph->relations_cache->clear();
   DEG::DepsgraphBuilderCache builder_cache;
   /* Generate all the nodes in the graph first */
   DEG::DepsgraphFromIDsNodeBuilder node_builder(bmain, deg_graph, &builder_cache, ids, num_ids);
@@ -466,11 +548,8 @@ void DEG_graph_build_from_ids(Depsgraph *graph,
   }
 }
 
-/* Tag graph relations for update. */
-void DEG_graph_tag_relations_update(Depsgraph *graph)
+static void graph_tag_relations_update(DEG::Depsgraph *deg_graph)
 {
-  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
-  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
   deg_graph->need_update = true;
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
@@ -484,6 +563,24 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+/* Tag graph relations for update. */
+void DEG_graph_tag_relations_update(Depsgraph *graph)
+{
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+  deg_graph->need_update_all_relations = true;
+  graph_tag_relations_update(deg_graph);
+}
+
+/* Tag relations of the given ID for update. */
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(graph);
+  deg_graph->id_relations_tagged.insert(id);
+  graph_tag_relations_update(deg_graph);
+}
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(Depsgraph *graph, Main *bmain, Scene *scene, ViewLayer *view_layer)
 {
@@ -503,3 +600,12 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of the given ID for update in all dependency graphs. */
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (DEG::Depsgraph *depsgraph : DEG::get_all_registered_graphs(bmain)) {
+    DEG_graph_id_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
@@ -247,6 +247,20 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+void DEG_stats_relations_build(const Depsgraph *graph,
+                               int *r_num_full_builds,
+                               double *r_full_builds_time,
+                               int *r_num_incremental_builds,
+                               double *r_incremental_builds_time)
+{
+  const DEG::Depsgraph *deg_graph = reinterpret_cast<const DEG::Depsgraph *>(graph);
+  const DEG::DepsgraphDebug &debug = deg_graph->debug;
+  *r_num_full_builds = debug.num_full_builds;
+  *r_full_builds_time = debug.full_builds_time;
+  *r_num_incremental_builds = debug.num_incremental_builds;
+  *r_incremental_builds_time = debug.incremental_builds_time;
+}
+
 static DEG::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
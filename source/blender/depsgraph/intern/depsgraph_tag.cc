@@ -166,9 +166,11 @@ void depsgraph_tag_to_component_opcode(const ID *id,
   }
   switch (tag) {
     case ID_RECALC_TRANSFORM:
+    case ID_RECALC_TRANSFORM_INPLACE:
       *component_type = NodeType::TRANSFORM;
       break;
     case ID_RECALC_GEOMETRY:
+    case ID_RECALC_MODIFIER_INPLACE:
       depsgraph_geometry_tag_to_component(id, component_type);
       break;
     case ID_RECALC_ANIMATION:
@@ -237,6 +239,7 @@ void depsgraph_tag_to_component_opcode(const ID *id,
       break;
     case ID_RECALC_ALL:
     case ID_RECALC_PSYS_ALL:
+    case ID_RECALC_INPLACE_ALL:
       BLI_assert(!"Should not happen");
       break;
   }
@@ -302,6 +305,22 @@ void depsgraph_tag_component(Depsgraph *graph,
   }
 }
 
+/* Get recalc flags to be stored in the copy-on-write ID when it is tagged with the given flag.
+ *
+ * In-place update is only possible while every tag since the last evaluation was an in-place
+ * one: any other tag clears them, and they are not set on top of other pending tags. */
+int id_tag_update_inplace_flags(ID *id_cow, int flag)
+{
+  if ((flag & ID_RECALC_INPLACE_ALL) == 0) {
+    id_cow->recalc &= ~ID_RECALC_INPLACE_ALL;
+    return flag;
+  }
+  if (id_cow->recalc != 0 && (id_cow->recalc & ID_RECALC_INPLACE_ALL) == 0) {
+    return flag & ~ID_RECALC_INPLACE_ALL;
+  }
+  return flag;
+}
+
 /* This is a tag compatibility with legacy code.
  *
  * Mainly, old code was tagging object with ID_RECALC_GEOMETRY tag to inform
@@ -463,7 +482,7 @@ const char *update_source_as_string(eUpdateSource source)
 int deg_recalc_flags_for_legacy_zero()
 {
   return ID_RECALC_ALL & ~(ID_RECALC_PSYS_ALL | ID_RECALC_ANIMATION | ID_RECALC_SOURCE |
-                           ID_RECALC_TIME | ID_RECALC_EDITORS);
+                           ID_RECALC_TIME | ID_RECALC_EDITORS | ID_RECALC_INPLACE_ALL);
 }
 
 int deg_recalc_flags_effective(Depsgraph *graph, int flags)
@@ -645,7 +664,7 @@ void graph_id_tag_update(
   /* Store original flag in the ID.
    * Allows to have more granularity than a node-factory based flags. */
   if (id_node != nullptr) {
-    id_node->id_cow->recalc |= flag;
+    id_node->id_cow->recalc |= id_tag_update_inplace_flags(id_node->id_cow, flag);
   }
   /* When ID is tagged for update based on an user edits store the recalc flags in the original ID.
    * This way IDs in the undo steps will have this flag preserved, making it possible to restore
@@ -655,7 +674,9 @@ void graph_id_tag_update(
    * usually newly created dependency graph skips animation update to avoid loss of unkeyed
    * changes). */
   if (update_source == DEG_UPDATE_SOURCE_USER_EDIT) {
-    id->recalc |= deg_recalc_flags_effective(graph, flag);
+    /* In-place flags are only valid together with all other tags of the copy-on-write ID since
+     * its last evaluation, they are not kept for the rebuilt dependency graph. */
+    id->recalc |= deg_recalc_flags_effective(graph, flag) & ~ID_RECALC_INPLACE_ALL;
   }
   int current_flag = flag;
   while (current_flag != 0) {
@@ -695,6 +716,8 @@ const char *DEG_update_tag_as_string(IDRecalcFlag flag)
       return "PSYS_PHYS";
     case ID_RECALC_PSYS_ALL:
       return "PSYS_ALL";
+    case ID_RECALC_INPLACE_ALL:
+      return "INPLACE_ALL";
     case ID_RECALC_COPY_ON_WRITE:
       return "COPY_ON_WRITE";
     case ID_RECALC_SHADING:
@@ -727,6 +750,10 @@ const char *DEG_update_tag_as_string(IDRecalcFlag flag)
       return "TIME";
     case ID_RECALC_SOURCE:
       return "SOURCE";
+    case ID_RECALC_TRANSFORM_INPLACE:
+      return "TRANSFORM_INPLACE";
+    case ID_RECALC_MODIFIER_INPLACE:
+      return "MODIFIER_INPLACE";
     case ID_RECALC_ALL:
       return "ALL";
   }
@@ -822,7 +849,18 @@ static void deg_graph_clear_id_recalc_flags(ID *id)
   }
 }
 
-void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
+static int deg_graph_id_recalc_flags(ID *id)
+{
+  int recalc = id->recalc & ID_RECALC_ALL;
+  bNodeTree *ntree = ntreeFromID(id);
+  /* Embedded node trees are reported as an update of their owner. */
+  if (ntree) {
+    recalc |= ntree->id.recalc & ID_RECALC_ALL;
+  }
+  return recalc;
+}
+
+void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph, const bool backup)
 {
   DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
   /* TODO(sergey): Re-implement POST_UPDATE_HANDLER_WORKAROUND using entry_tags
@@ -832,6 +870,9 @@ void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
   }
   /* Go over all ID nodes nodes, clearing tags. */
   for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+    if (backup) {
+      id_node->id_cow_recalc_backup |= deg_graph_id_recalc_flags(id_node->id_cow);
+    }
     /* TODO: we clear original ID recalc flags here, but this may not work
      * correctly when there are multiple depsgraph with others still using
      * the recalc flag. */
@@ -841,5 +882,23 @@ void DEG_ids_clear_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
       deg_graph_clear_id_recalc_flags(id_node->id_orig);
     }
   }
+  if (backup) {
+    for (int i = 0; i < MAX_LIBARRAY; i++) {
+      deg_graph->id_type_updated_backup[i] |= deg_graph->id_type_updated[i];
+    }
+  }
   memset(deg_graph->id_type_updated, 0, sizeof(deg_graph->id_type_updated));
 }
+
+void DEG_ids_restore_recalc(Main *UNUSED(bmain), Depsgraph *depsgraph)
+{
+  DEG::Depsgraph *deg_graph = reinterpret_cast<DEG::Depsgraph *>(depsgraph);
+  for (DEG::IDNode *id_node : deg_graph->id_nodes) {
+    id_node->id_cow->recalc |= id_node->id_cow_recalc_backup;
+    id_node->id_cow_recalc_backup = 0;
+  }
+  for (int i = 0; i < MAX_LIBARRAY; i++) {
+    deg_graph->id_type_updated[i] |= deg_graph->id_type_updated_backup[i];
+  }
+  memset(deg_graph->id_type_updated_backup, 0, sizeof(deg_graph->id_type_updated_backup));
+}
@@ -32,6 +32,7 @@
 #include "BLI_task.h"
 #include "BLI_ghash.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
 
 #include "BKE_global.h"
 
@@ -43,6 +44,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/debug/deg_debug_profile.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/eval/deg_eval_flush.h"
 #include "intern/eval/deg_eval_stats.h"
@@ -69,12 +71,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int thread_id, TaskPool *pool)
-{
-  BLI_task_pool_push_from_thread(
-      pool, deg_task_run_func, node, false, TASK_PRIORITY_HIGH, thread_id);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -95,21 +91,66 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  bool do_profile;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready to be evaluated, ordered by their critical path. Only used with
+   * priority scheduling, tasks then pick the most critical operation instead of a fixed one. */
+  bool use_priority_scheduling;
+  Heap *ready_queue;
+  SpinLock ready_queue_lock;
 };
 
-void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
+void ready_queue_push(DepsgraphEvalState *state, OperationNode *node)
+{
+  /* Heap is a min-heap, negate so the longest critical path comes first. */
+  BLI_spin_lock(&state->ready_queue_lock);
+  BLI_heap_insert(state->ready_queue, (float)-node->critical_path_time, node);
+  BLI_spin_unlock(&state->ready_queue_lock);
+}
+
+OperationNode *ready_queue_pop(DepsgraphEvalState *state)
+{
+  BLI_spin_lock(&state->ready_queue_lock);
+  BLI_assert(!BLI_heap_is_empty(state->ready_queue));
+  OperationNode *node = (OperationNode *)BLI_heap_pop_min(state->ready_queue);
+  BLI_spin_unlock(&state->ready_queue_lock);
+  return node;
+}
+
+void schedule_node_to_pool(OperationNode *node, const int thread_id, TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_userdata(pool);
+  if (state->use_priority_scheduling) {
+    /* Every pushed task evaluates one ready operation, but which one is only decided when the
+     * task starts running. */
+    ready_queue_push(state, node);
+    node = NULL;
+  }
+  BLI_task_pool_push_from_thread(
+      pool, deg_task_run_func, node, false, TASK_PRIORITY_HIGH, thread_id);
+}
+
+void evaluate_node(const DepsgraphEvalState *state,
+                   OperationNode *operation_node,
+                   const int thread_id)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
+  if (state->do_stats || state->do_profile) {
     const double start_time = PIL_check_seconds_timer();
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    const double end_time = PIL_check_seconds_timer();
+    if (state->do_stats) {
+      operation_node->stats.current_time += end_time - start_time;
+    }
+    if (state->do_profile) {
+      deg_debug_profile_record_operation(
+          state->graph, operation_node, thread_id, start_time, end_time);
+    }
   }
   else {
     operation_node->evaluate(depsgraph);
@@ -123,7 +164,10 @@ void deg_task_run_func(TaskPool *pool, void *taskdata, int thread_id)
 
   /* Evaluate node. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  if (operation_node == NULL) {
+    operation_node = ready_queue_pop(state);
+  }
+  evaluate_node(state, operation_node, thread_id);
 
   /* Schedule children. */
   BLI_task_pool_delayed_push_begin(pool, thread_id);
@@ -329,7 +373,7 @@ void evaluate_graph_single_threaded(DepsgraphEvalState *state)
     OperationNode *operation_node;
     BLI_gsqueue_pop(evaluation_queue, &operation_node);
 
-    evaluate_node(state, operation_node);
+    evaluate_node(state, operation_node, 0);
     schedule_children(state, operation_node, 0, schedule_node_to_queue, evaluation_queue);
   }
 
@@ -368,13 +412,25 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 
   graph->debug.begin_graph_evaluation();
 
+  const double start_time = PIL_check_seconds_timer();
   graph->is_evaluating = true;
   depsgraph_ensure_view_layer(graph);
   /* Set up evaluation state. */
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_profile = deg_debug_profile_is_active();
   state.need_single_thread_pass = false;
+  /* Priority scheduling relies on timing of previous evaluations. */
+  state.use_priority_scheduling = (G.f & G_FLAG_DEPSGRAPH_PRIORITY_SCHEDULING) != 0;
+  if (state.use_priority_scheduling) {
+    state.do_stats = true;
+    state.ready_queue = BLI_heap_new();
+    BLI_spin_init(&state.ready_queue_lock);
+  }
+  else {
+    state.ready_queue = NULL;
+  }
   /* Set up task scheduler and pull for threaded evaluation. */
   TaskScheduler *task_scheduler;
   bool need_free_scheduler;
@@ -414,6 +470,11 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  if (state.use_priority_scheduling) {
+    deg_eval_stats_update_critical_path(graph);
+    BLI_spin_end(&state.ready_queue_lock);
+    BLI_heap_free(state.ready_queue, NULL);
+  }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   if (need_free_scheduler) {
@@ -421,6 +482,10 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
   graph->is_evaluating = false;
 
+  if (state.do_profile) {
+    deg_debug_profile_record_evaluation(graph, start_time, PIL_check_seconds_timer());
+  }
+
   graph->debug.end_graph_evaluation();
 }
 
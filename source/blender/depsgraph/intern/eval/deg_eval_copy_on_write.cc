@@ -28,6 +28,10 @@
  * TODO(sergey): Re-evaluate that after new ID handling is in place. */
 #define NESTED_ID_NASTY_WORKAROUND
 
+/* Update copy-on-write data-blocks in place when only part of the original changed, instead of
+ * freeing and copying the whole data-block again. */
+#define USE_GRANULAR_UPDATE
+
 /* Silence warnings from copying deprecated fields. */
 #define DNA_DEPRECATED_ALLOW
 
@@ -37,6 +41,8 @@
 
 #include "BLI_utildefines.h"
 #include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_vector.h"
 #include "BLI_threads.h"
 #include "BLI_string.h"
 
@@ -277,7 +283,7 @@ struct ValidateData {
 
 /* Similar to generic BKE_id_copy() but does not require main and assumes pointer
  * is already allocated. */
-bool id_copy_inplace_no_main(const ID *id, ID *newid)
+bool id_copy_inplace_no_main(const ID *id, ID *newid, const int extra_copy_flags = 0)
 {
   const ID *id_for_copy = id;
 
@@ -286,8 +292,8 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   id_for_copy = nested_id_hack_get_discarded_pointers(&id_hack_storage, id);
 #endif
 
-  bool result = BKE_id_copy_ex(
-      nullptr, (ID *)id_for_copy, &newid, (LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE));
+  const int flag = LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE | extra_copy_flags;
+  bool result = BKE_id_copy_ex(nullptr, (ID *)id_for_copy, &newid, flag);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
@@ -867,6 +873,7 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
    * - We don't want heap-allocations here.
    * - We don't want bmain's content to be freed when main is freed. */
   bool done = false;
+  int extra_copy_flags = 0;
   /* First we handle special cases which are not covered by BKE_id_copy() yet.
    * or cases where we want to do something smarter than simple datablock
    * copy. */
@@ -882,15 +889,17 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       break;
     }
     case ID_ME: {
-      /* TODO(sergey): Ideally we want to handle meshes in a special
-       * manner here to avoid initial copy of all the geometry arrays. */
+      /* Geometry arrays are shared with the original instead of being copied, so are not
+       * copied again when the mesh is updated either. The original gets its own copy of the
+       * layers it modifies, see CustomData_duplicate_referenced_layer(). */
+      extra_copy_flags |= LIB_ID_COPY_CD_SHARE;
       break;
     }
     default:
       break;
   }
   if (!done) {
-    done = id_copy_inplace_no_main(id_orig, id_cow);
+    done = id_copy_inplace_no_main(id_orig, id_cow, extra_copy_flags);
   }
   if (!done) {
     BLI_assert(!"No idea how to perform CoW on datablock");
@@ -930,6 +939,139 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   return deg_expand_copy_on_write_datablock(depsgraph, id_node, node_builder, create_placeholders);
 }
 
+#ifdef USE_GRANULAR_UPDATE
+
+namespace {
+
+/* Transform channels are the most common change of objects, they are synced without copying
+ * modifiers, pose and the rest of the object again. */
+void object_update_transform_inplace(const Object *object_orig, Object *object_cow)
+{
+  copy_v3_v3(object_cow->loc, object_orig->loc);
+  copy_v3_v3(object_cow->dloc, object_orig->dloc);
+  copy_v3_v3(object_cow->scale, object_orig->scale);
+  copy_v3_v3(object_cow->dscale, object_orig->dscale);
+  copy_v3_v3(object_cow->rot, object_orig->rot);
+  copy_v3_v3(object_cow->drot, object_orig->drot);
+  copy_qt_qt(object_cow->quat, object_orig->quat);
+  copy_qt_qt(object_cow->dquat, object_orig->dquat);
+  copy_v3_v3(object_cow->rotAxis, object_orig->rotAxis);
+  copy_v3_v3(object_cow->drotAxis, object_orig->drotAxis);
+  object_cow->rotAngle = object_orig->rotAngle;
+  object_cow->drotAngle = object_orig->drotAngle;
+  object_cow->rotmode = object_orig->rotmode;
+  copy_m4_m4(object_cow->parentinv, object_orig->parentinv);
+  copy_m4_m4(object_cow->constinv, object_orig->constinv);
+}
+
+/* Settings of modifiers which are copied with modifier_copyData_generic() are all stored in the
+ * modifier itself, so they can be copied over the ones of the copy-on-write modifier. Other
+ * modifiers own allocated data (bindings, caches), which needs the full copy of the object. */
+bool modifier_update_inplace_is_supported(const ModifierData *md_orig, const ModifierData *md_cow)
+{
+  if (md_orig->type != md_cow->type || !STREQ(md_orig->name, md_cow->name)) {
+    return false;
+  }
+  const ModifierTypeInfo *mti = modifierType_getInfo((ModifierType)md_orig->type);
+  return mti->copyData == modifier_copyData_generic && mti->freeData == nullptr;
+}
+
+void modifier_remap_id_callback(void *user_data, Object * /*object*/, ID **id_p, int /*cb_flag*/)
+{
+  if (*id_p == nullptr || !deg_copy_on_write_is_needed(*id_p)) {
+    return;
+  }
+  const Depsgraph *depsgraph = (const Depsgraph *)user_data;
+  *id_p = depsgraph->get_cow_id(*id_p);
+}
+
+/* Sync modifier settings without copying the rest of the object, the runtime data of the
+ * modifiers is kept. Only possible when the modifier stack itself did not change. */
+bool object_update_modifiers_inplace(const Depsgraph *depsgraph,
+                                     const Object *object_orig,
+                                     Object *object_cow)
+{
+  if (BLI_listbase_count(&object_orig->modifiers) != BLI_listbase_count(&object_cow->modifiers)) {
+    return false;
+  }
+  const ModifierData *md_orig = (const ModifierData *)object_orig->modifiers.first;
+  const ModifierData *md_cow = (const ModifierData *)object_cow->modifiers.first;
+  for (; md_orig != nullptr; md_orig = md_orig->next, md_cow = md_cow->next) {
+    if (!modifier_update_inplace_is_supported(md_orig, md_cow)) {
+      return false;
+    }
+  }
+
+  md_orig = (const ModifierData *)object_orig->modifiers.first;
+  LISTBASE_FOREACH (ModifierData *, md, &object_cow->modifiers) {
+    const ModifierTypeInfo *mti = modifierType_getInfo((ModifierType)md->type);
+    md->mode = md_orig->mode;
+    md->flag = md_orig->flag;
+    const size_t data_size = sizeof(ModifierData);
+    memcpy((char *)md + data_size,
+           (const char *)md_orig + data_size,
+           (size_t)mti->structSize - data_size);
+    if (mti->foreachIDLink) {
+      mti->foreachIDLink(md, object_cow, modifier_remap_id_callback, (void *)depsgraph);
+    }
+    else if (mti->foreachObjectLink) {
+      mti->foreachObjectLink(
+          md, object_cow, (ObjectWalkFunc)modifier_remap_id_callback, (void *)depsgraph);
+    }
+    md_orig = md_orig->next;
+  }
+  return true;
+}
+
+/* ID_RECALC_TRANSFORM and ID_RECALC_GEOMETRY alone are also used for edits of other settings
+ * (track axis, constraints, parent vertices, modifier stack), only the explicit in-place tags
+ * tell that nothing else in the object changed. */
+bool object_update_inplace(const Depsgraph *depsgraph, const IDNode *id_node)
+{
+  /* The copy-on-write component is always part of the update, its own recalc flag is set by the
+   * flush as well. */
+  const int recalc = id_node->id_cow->recalc & ~ID_RECALC_COPY_ON_WRITE;
+  int recalc_inplace = ID_RECALC_POINT_CACHE;
+  if (recalc & ID_RECALC_TRANSFORM_INPLACE) {
+    recalc_inplace |= ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE;
+  }
+  if (recalc & ID_RECALC_MODIFIER_INPLACE) {
+    /* Geometry changes are flushed to the batch cache, which is tagged as shading. */
+    recalc_inplace |= ID_RECALC_GEOMETRY | ID_RECALC_SHADING | ID_RECALC_MODIFIER_INPLACE;
+  }
+  if ((recalc & ID_RECALC_INPLACE_ALL) == 0 || (recalc & ~recalc_inplace) != 0) {
+    return false;
+  }
+  const Object *object_orig = (const Object *)id_node->id_orig;
+  Object *object_cow = (Object *)id_node->id_cow;
+  if ((recalc & ID_RECALC_MODIFIER_INPLACE) &&
+      !object_update_modifiers_inplace(depsgraph, object_orig, object_cow)) {
+    return false;
+  }
+  if (recalc & ID_RECALC_TRANSFORM_INPLACE) {
+    object_update_transform_inplace(object_orig, object_cow);
+  }
+  return true;
+}
+
+bool update_copy_on_write_datablock_inplace(const Depsgraph *depsgraph, const IDNode *id_node)
+{
+  if (!check_datablock_expanded(id_node->id_cow)) {
+    return false;
+  }
+  switch (GS(id_node->id_orig->name)) {
+    case ID_OB:
+      return object_update_inplace(depsgraph, id_node);
+    default:
+      break;
+  }
+  return false;
+}
+
+}  // namespace
+
+#endif /* USE_GRANULAR_UPDATE */
+
 ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode *id_node)
 {
   const ID *id_orig = id_node->id_orig;
@@ -938,6 +1080,11 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   if (!deg_copy_on_write_is_needed(id_orig)) {
     return id_cow;
   }
+#ifdef USE_GRANULAR_UPDATE
+  if (update_copy_on_write_datablock_inplace(depsgraph, id_node)) {
+    return id_cow;
+  }
+#endif
   RuntimeBackup backup(depsgraph);
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
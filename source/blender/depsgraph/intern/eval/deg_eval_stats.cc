@@ -27,6 +27,7 @@
 #include "BLI_ghash.h"
 
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -53,6 +54,46 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
     IDNode *id_node = comp_node->owner;
     id_node->stats.current_time += op_node->stats.current_time;
     comp_node->stats.current_time += op_node->stats.current_time;
+    /* Only operations which were actually evaluated have meaningful timing. */
+    if (op_node->scheduled) {
+      op_node->stats.update_average();
+    }
+  }
+}
+
+void deg_eval_stats_update_critical_path(Depsgraph *graph)
+{
+  /* Traverse operations from the leaves of the graph towards its roots, so the critical path of
+   * all children is known when reaching an operation. Cyclic relations are ignored, operations
+   * which are only reachable through cycles keep their own time as an estimate. */
+  vector<OperationNode *> queue;
+  queue.reserve(graph->operations.size());
+  for (OperationNode *op_node : graph->operations) {
+    op_node->critical_path_time = op_node->stats.average_time;
+    op_node->custom_flags = 0;
+    for (Relation *rel : op_node->outlinks) {
+      if (rel->to->type == NodeType::OPERATION && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++op_node->custom_flags;
+      }
+    }
+    if (op_node->custom_flags == 0) {
+      queue.push_back(op_node);
+    }
+  }
+  while (!queue.empty()) {
+    OperationNode *op_node = queue.back();
+    queue.pop_back();
+    for (Relation *rel : op_node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *from = (OperationNode *)rel->from;
+      from->critical_path_time = max(from->critical_path_time,
+                                     from->stats.average_time + op_node->critical_path_time);
+      if (--from->custom_flags == 0) {
+        queue.push_back(from);
+      }
+    }
   }
 }
 
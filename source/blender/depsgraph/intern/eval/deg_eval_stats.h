@@ -30,4 +30,7 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Update critical path estimate of all operations from their averaged evaluation time. */
+void deg_eval_stats_update_critical_path(Depsgraph *graph);
+
 }  // namespace DEG
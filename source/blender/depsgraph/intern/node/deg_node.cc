@@ -270,6 +270,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -277,6 +278,18 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::update_average()
+{
+  /* Exponential moving average, follows changes of the scene quick enough while smoothing out
+   * noise of individual timings. */
+  if (average_time == 0.0) {
+    average_time = current_time;
+  }
+  else {
+    average_time = average_time * 0.75 + current_time * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
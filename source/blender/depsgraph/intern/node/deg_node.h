@@ -154,8 +154,12 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Fold time of the current graph evaluation into the running average. */
+    void update_average();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Running average of time spent on this node over the evaluations it was part of. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
@@ -252,6 +252,10 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time needed to evaluate the longest chain of operations starting with this one,
+   * based on previous evaluations. Used to evaluate critical operations first. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -127,6 +127,26 @@ static void object_force_modifier_bind_simple_options(Depsgraph *depsgraph,
   md_eval->mode = mode;
 }
 
+/* Physics modifiers define collision and effector relations of other objects, which are only
+ * handled when all relations are tagged for update. */
+static void object_modifier_relations_tag_update(Main *bmain, Object *ob, int type)
+{
+  if (ELEM(type,
+           eModifierType_Softbody,
+           eModifierType_ParticleSystem,
+           eModifierType_Cloth,
+           eModifierType_Collision,
+           eModifierType_Fluidsim,
+           eModifierType_Surface,
+           eModifierType_DynamicPaint,
+           eModifierType_Fluid)) {
+    DEG_relations_tag_update(bmain);
+  }
+  else {
+    DEG_id_tag_relations_update(bmain, &ob->id);
+  }
+}
+
 /** Add a modifier to given object, including relevant extra processing needed by some physics
  * types (particles, simulations...).
  *
@@ -215,7 +235,7 @@ ModifierData *ED_object_modifier_add(
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob, type);
 
   return new_md;
 }
@@ -375,6 +395,7 @@ static bool object_modifier_remove(Main *bmain,
 
 bool ED_object_modifier_remove(ReportList *reports, Main *bmain, Object *ob, ModifierData *md)
 {
+  const int type = md->type;
   bool sort_depsgraph = false;
   bool ok;
 
@@ -386,7 +407,7 @@ bool ED_object_modifier_remove(ReportList *reports, Main *bmain, Object *ob, Mod
   }
 
   DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
-  DEG_relations_tag_update(bmain);
+  object_modifier_relations_tag_update(bmain, ob, type);
 
   return 1;
 }
@@ -338,7 +338,7 @@ static int object_clear_transform_generic_exec(bContext *C,
     ED_autokeyframe_object(C, scene, ob, ks);
 
     /* tag for updates */
-    DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
+    DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
   }
   CTX_DATA_END;
 
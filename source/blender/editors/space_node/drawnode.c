@@ -802,6 +802,8 @@ static void node_shader_buts_tex_image_ex(uiLayout *layout, bContext *C, Pointer
 {
   PointerRNA iuserptr = RNA_pointer_get(ptr, "image_user");
   uiTemplateImage(layout, C, ptr, "image", &iuserptr, 0, 0);
+
+  uiItemR(layout, ptr, "compression", 0, IFACE_("Compression"), ICON_NONE);
 }
 
 static void node_shader_buts_tex_environment(uiLayout *layout, bContext *C, PointerRNA *ptr)
@@ -834,6 +836,7 @@ static void node_shader_buts_tex_environment_ex(uiLayout *layout, bContext *C, P
 
   uiItemR(layout, ptr, "interpolation", 0, IFACE_("Interpolation"), ICON_NONE);
   uiItemR(layout, ptr, "projection", 0, IFACE_("Projection"), ICON_NONE);
+  uiItemR(layout, ptr, "compression", 0, IFACE_("Compression"), ICON_NONE);
 }
 
 static void node_shader_buts_tex_sky(uiLayout *layout, bContext *UNUSED(C), PointerRNA *ptr)
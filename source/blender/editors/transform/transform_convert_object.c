@@ -242,7 +242,7 @@ void trans_obchild_in_obmode_update_all(TransInfo *t)
 
     mul_m4_m4m4(ob->parentinv, dmat, xf->parentinv_orig);
 
-    DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
+    DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
   }
 }
 
@@ -1158,7 +1158,7 @@ static void recalcData_objects(TransInfo *t)
         /* sets recalc flags fully, instead of flushing existing ones
          * otherwise proxies don't function correctly
          */
-        DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM);
+        DEG_id_tag_update(&ob->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
 
         if (t->flag & T_TEXTURE) {
           DEG_id_tag_update(&ob->id, ID_RECALC_GEOMETRY);
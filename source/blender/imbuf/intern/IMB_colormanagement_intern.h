@@ -27,6 +27,7 @@
 #include "DNA_listBase.h"
 #include "BLI_sys_types.h"
 
+struct ColormanageLUT;
 struct ImBuf;
 struct OCIO_ConstProcessorRcPtr;
 
@@ -123,4 +124,22 @@ void colorspace_set_default_role(char *colorspace, int size, int role);
 void colormanage_imbuf_set_default_spaces(struct ImBuf *ibuf);
 void colormanage_imbuf_make_linear(struct ImBuf *ibuf, const char *from_colorspace);
 
+/* ** Baked display transforms ** */
+
+#define COLORMANAGE_LUT_KEY_LEN (MAX_COLORSPACE_NAME * 4 + 64)
+
+struct ColormanageLUT *colormanage_lut_acquire(const char *key,
+                                               struct OCIO_ConstProcessorRcPtr *processor,
+                                               size_t num_pixels);
+bool colormanage_lut_use_predivide(const struct ColormanageLUT *lut);
+void colormanage_lut_release(struct ColormanageLUT *lut);
+void colormanage_lut_apply(const struct ColormanageLUT *lut,
+                           struct OCIO_ConstProcessorRcPtr *processor,
+                           float *buffer,
+                           int width,
+                           int height,
+                           int channels,
+                           bool predivide);
+void colormanage_lut_cache_free(void);
+
 #endif /* __IMB_COLORMANAGEMENT_INTERN_H__ */
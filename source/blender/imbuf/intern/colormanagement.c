@@ -99,6 +99,8 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
+  /* Baked processor, used instead of it when set. */
+  struct ColormanageLUT *lut;
   CurveMapping *curve_mapping;
   bool is_data_result;
 } ColormanageProcessor;
@@ -742,6 +744,8 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  colormanage_lut_cache_free();
+
   colormanage_free_config();
 }
 
@@ -1727,12 +1731,38 @@ static bool is_ibuf_rect_in_display_space(ImBuf *ibuf,
   return false;
 }
 
+static void display_processor_use_lut(ColormanageProcessor *cm_processor,
+                                      const ColorManagedViewSettings *view_settings,
+                                      const ColorManagedDisplaySettings *display_settings,
+                                      size_t num_pixels)
+{
+  char key[COLORMANAGE_LUT_KEY_LEN];
+
+  if (cm_processor->processor == NULL || cm_processor->is_data_result) {
+    return;
+  }
+
+  BLI_snprintf(key,
+               sizeof(key),
+               "%s|%s|%s|%f|%f|%s",
+               view_settings->look,
+               view_settings->view_transform,
+               display_settings->display_device,
+               view_settings->exposure,
+               view_settings->gamma,
+               global_role_scene_linear);
+
+  cm_processor->lut = colormanage_lut_acquire(
+      key, (struct OCIO_ConstProcessorRcPtr *)cm_processor->processor, num_pixels);
+}
+
 static void colormanage_display_buffer_process_ex(
     ImBuf *ibuf,
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    bool use_lut)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1748,6 +1778,12 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+    /* Byte display buffers for drawing don't need the precision of the exact transform. */
+    if (use_lut && display_buffer == NULL) {
+      display_processor_use_lut(
+          cm_processor, view_settings, display_settings, ((size_t)ibuf->x) * ibuf->y);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1768,7 +1804,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /*********************** Threaded processor transform routines *************************/
@@ -2429,8 +2465,12 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3826,7 +3866,17 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->lut && channels >= 3 &&
+      !(predivide && channels == 4 && !colormanage_lut_use_predivide(cm_processor->lut))) {
+    colormanage_lut_apply(cm_processor->lut,
+                          (struct OCIO_ConstProcessorRcPtr *)cm_processor->processor,
+                          buffer,
+                          width,
+                          height,
+                          channels,
+                          predivide);
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3875,6 +3925,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->lut) {
+    colormanage_lut_release(cm_processor->lut);
+  }
 
   MEM_freeN(cm_processor);
 }
@@ -0,0 +1,582 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup imbuf
+ *
+ * Display transforms baked into a shaper and a 3D LUT.
+ *
+ * Applying an OCIO processor pixel by pixel is the most expensive part of creating display
+ * buffers of float images. For display buffers the transform is baked once into a LUT, which is
+ * applied with trilinear interpolation instead.
+ *
+ * The shaper maps scene linear values to LUT coordinates using the bits of their float
+ * representation, which is a piecewise linear approximation of log2 that is cheap to evaluate
+ * with SIMD instructions. Every octave is covered by the same number of cells, so values are
+ * interpolated linearly within cells. The shaper covers the range from 0 up to the value at
+ * which the transform reaches display white, values outside of this range are clamped.
+ *
+ * Baked LUTs are compared against the exact processor, transforms which can't be represented
+ * by a LUT (because they change alpha or are not smooth enough) are remembered as such and keep
+ * using the processor.
+ *
+ * Values above display white are clamped by the LUT, which matches display buffers as long as
+ * the result is clamped anyway. For transforms going beyond display white, like the Standard
+ * view, this doesn't hold for predivided pixels where alpha is multiplied again afterwards. Only
+ * those pixels of which the unpremultiplied color is outside of the shaper range use the exact
+ * processor, all others (including opaque pixels) still use the LUT.
+ */
+
+#include "IMB_colormanagement_intern.h"
+
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "ocio_capi.h"
+
+/* Maximum number of grid points along every axis of the LUT. */
+#define LUT_MAX_SIZE 64
+/* Number of transforms kept in the cache. */
+#define LUT_CACHE_SIZE 4
+/* Values below 2^LUT_SHAPER_OFFSET_EXP are mapped linearly to the first LUT cell. */
+#define LUT_SHAPER_OFFSET_EXP -10
+/* Range of the shaper is searched in powers of 2 between these exponents. */
+#define LUT_SHAPER_MIN_EXP -4
+#define LUT_SHAPER_MAX_EXP 12
+/* Difference between the bits of floats an octave apart. */
+#define LUT_OCTAVE_BITS (1 << 23)
+/* Maximum difference with the exact transform, one step of 8 bit display buffers. */
+#define LUT_TOLERANCE (1.0f / 255.0f)
+
+typedef struct ColormanageLUT {
+  struct ColormanageLUT *next, *prev;
+
+  char key[COLORMANAGE_LUT_KEY_LEN];
+
+  /* RGBA grid of size^3 entries, red changing fastest.
+   * NULL when the transform can't be baked. */
+  float *table;
+  int size;
+
+  /* Shaper: coordinate = (float_as_int(max(x, 0) + offset) - offset_bits) * scale. */
+  float shaper_offset;
+  int shaper_offset_bits;
+  float shaper_scale;
+
+  /* Largest value covered by the shaper. */
+  float shaper_max;
+
+  /* Output within the shaper range is accurate above display white too, so the LUT can be used
+   * for predivided pixels within that range. */
+  bool use_predivide;
+  /* Output stays within the display range outside of the shaper range as well, so the LUT can be
+   * used for all predivided pixels. */
+  bool use_predivide_beyond_range;
+
+  /* Number of processors using the LUT. */
+  int users;
+  /* Removed from the cache while in use, freed when released. */
+  bool is_removed;
+} ColormanageLUT;
+
+static ListBase lut_cache = {NULL, NULL};
+static ThreadMutex lut_lock = BLI_MUTEX_INITIALIZER;
+
+/*********************** Shaper *************************/
+
+BLI_INLINE int lut_float_as_int(float f)
+{
+  union {
+    int i;
+    float f;
+  } u;
+  u.f = f;
+  return u.i;
+}
+
+BLI_INLINE float lut_int_as_float(int i)
+{
+  union {
+    int i;
+    float f;
+  } u;
+  u.i = i;
+  return u.f;
+}
+
+static float lut_shaper_inverse(const ColormanageLUT *lut, int index)
+{
+  const int bits = lut->shaper_offset_bits + (int)((double)index / lut->shaper_scale + 0.5);
+  return lut_int_as_float(bits) - lut->shaper_offset;
+}
+
+/* Shaper covering the values up to 2^range_exp, minus the offset. */
+static void lut_shaper_init(ColormanageLUT *lut, int range_exp)
+{
+  const int num_octaves = range_exp - LUT_SHAPER_OFFSET_EXP;
+  const int cells_per_octave = (LUT_MAX_SIZE - 1) / num_octaves;
+
+  lut->size = num_octaves * cells_per_octave + 1;
+  lut->shaper_offset = ldexpf(1.0f, LUT_SHAPER_OFFSET_EXP);
+  lut->shaper_offset_bits = lut_float_as_int(lut->shaper_offset);
+  lut->shaper_scale = (float)cells_per_octave / (float)LUT_OCTAVE_BITS;
+  lut->shaper_max = lut_shaper_inverse(lut, lut->size - 1);
+}
+
+/*********************** Apply *************************/
+
+#ifdef __SSE2__
+
+MALWAYS_INLINE __m128 lut_lerp_sse(const __m128 a, const __m128 b, const __m128 t)
+{
+  return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+static void lut_apply_pixel(const ColormanageLUT *lut, float *pixel, int channels, bool predivide)
+{
+  const float alpha = (channels == 4) ? pixel[3] : 1.0f;
+  __m128 color = _mm_set_ps(0.0f, pixel[2], pixel[1], pixel[0]);
+
+  predivide = predivide && alpha != 1.0f && alpha != 0.0f;
+  if (predivide) {
+    color = _mm_mul_ps(color, _mm_set1_ps(1.0f / alpha));
+  }
+
+  /* Shaper, NaN are mapped to 0 as well. */
+  const __m128 x = _mm_add_ps(_mm_max_ps(color, _mm_setzero_ps()),
+                              _mm_set1_ps(lut->shaper_offset));
+  const __m128i bits = _mm_sub_epi32(_mm_castps_si128(x),
+                                     _mm_set1_epi32(lut->shaper_offset_bits));
+  const __m128 coord = _mm_min_ps(_mm_mul_ps(_mm_cvtepi32_ps(bits),
+                                             _mm_set1_ps(lut->shaper_scale)),
+                                  _mm_set1_ps((float)(lut->size - 1)));
+  const __m128i cell = _mm_cvttps_epi32(_mm_min_ps(coord, _mm_set1_ps((float)(lut->size - 2))));
+  const __m128 t = _mm_sub_ps(coord, _mm_cvtepi32_ps(cell));
+
+  int index[4];
+  _mm_storeu_si128((__m128i *)index, cell);
+
+  const int stride_g = 4 * lut->size;
+  const int stride_b = 4 * lut->size * lut->size;
+  const float *entry = lut->table + 4 * index[0] + stride_g * index[1] + stride_b * index[2];
+
+  const __m128 tr = _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m128 tg = _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1));
+  const __m128 tb = _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 2));
+
+  const __m128 c00 = lut_lerp_sse(_mm_load_ps(entry), _mm_load_ps(entry + 4), tr);
+  const __m128 c10 = lut_lerp_sse(
+      _mm_load_ps(entry + stride_g), _mm_load_ps(entry + stride_g + 4), tr);
+  const __m128 c01 = lut_lerp_sse(
+      _mm_load_ps(entry + stride_b), _mm_load_ps(entry + stride_b + 4), tr);
+  const __m128 c11 = lut_lerp_sse(_mm_load_ps(entry + stride_b + stride_g),
+                                  _mm_load_ps(entry + stride_b + stride_g + 4),
+                                  tr);
+
+  color = lut_lerp_sse(lut_lerp_sse(c00, c10, tg), lut_lerp_sse(c01, c11, tg), tb);
+
+  if (predivide) {
+    color = _mm_mul_ps(color, _mm_set1_ps(alpha));
+  }
+
+  float result[4];
+  _mm_storeu_ps(result, color);
+  copy_v3_v3(pixel, result);
+}
+
+#else /* __SSE2__ */
+
+static void lut_apply_pixel(const ColormanageLUT *lut, float *pixel, int channels, bool predivide)
+{
+  const float alpha = (channels == 4) ? pixel[3] : 1.0f;
+  float color[3], coord[3], t[3];
+  int index[3];
+
+  copy_v3_v3(color, pixel);
+
+  predivide = predivide && alpha != 1.0f && alpha != 0.0f;
+  if (predivide) {
+    mul_v3_fl(color, 1.0f / alpha);
+  }
+
+  for (int i = 0; i < 3; i++) {
+    /* Shaper, NaN are mapped to 0 as well. */
+    const float x = ((color[i] > 0.0f) ? color[i] : 0.0f) + lut->shaper_offset;
+    const int bits = lut_float_as_int(x) - lut->shaper_offset_bits;
+    coord[i] = min_ff((float)bits * lut->shaper_scale, (float)(lut->size - 1));
+    index[i] = (int)min_ff(coord[i], (float)(lut->size - 2));
+    t[i] = coord[i] - (float)index[i];
+  }
+
+  const int stride_g = 4 * lut->size;
+  const int stride_b = 4 * lut->size * lut->size;
+  const float *entry = lut->table + 4 * index[0] + stride_g * index[1] + stride_b * index[2];
+
+  for (int i = 0; i < 3; i++) {
+    const float c00 = interpf(entry[i + 4], entry[i], t[0]);
+    const float c10 = interpf(entry[i + stride_g + 4], entry[i + stride_g], t[0]);
+    const float c01 = interpf(entry[i + stride_b + 4], entry[i + stride_b], t[0]);
+    const float c11 = interpf(
+        entry[i + stride_b + stride_g + 4], entry[i + stride_b + stride_g], t[0]);
+
+    pixel[i] = interpf(interpf(c11, c01, t[1]), interpf(c10, c00, t[1]), t[2]);
+  }
+
+  if (predivide) {
+    mul_v3_fl(pixel, alpha);
+  }
+}
+
+#endif /* __SSE2__ */
+
+/* Predivided pixel of which the color is clamped by the shaper, while the transform goes beyond
+ * display white there. */
+BLI_INLINE bool lut_pixel_beyond_range(const ColormanageLUT *lut, const float pixel[4])
+{
+  const float alpha = pixel[3];
+  if (alpha == 1.0f || alpha == 0.0f) {
+    return false;
+  }
+  return max_fff(pixel[0], pixel[1], pixel[2]) > lut->shaper_max * alpha;
+}
+
+/**
+ * \param processor: The transform the LUT was baked from, applied to the predivided pixels the
+ * LUT can't represent.
+ */
+void colormanage_lut_apply(const ColormanageLUT *lut,
+                           struct OCIO_ConstProcessorRcPtr *processor,
+                           float *buffer,
+                           int width,
+                           int height,
+                           int channels,
+                           bool predivide)
+{
+  const size_t i_last = ((size_t)width) * height;
+  size_t i;
+  float *fp;
+
+  BLI_assert(lut->table != NULL);
+  BLI_assert(ELEM(channels, 3, 4));
+  BLI_assert(!predivide || channels != 4 || lut->use_predivide);
+
+  if (predivide && channels == 4 && !lut->use_predivide_beyond_range) {
+    for (i = 0, fp = buffer; i != i_last; i++, fp += channels) {
+      if (lut_pixel_beyond_range(lut, fp)) {
+        OCIO_processorApplyRGBA_predivide((OCIO_ConstProcessorRcPtr *)processor, fp);
+      }
+      else {
+        lut_apply_pixel(lut, fp, channels, true);
+      }
+    }
+    return;
+  }
+
+  for (i = 0, fp = buffer; i != i_last; i++, fp += channels) {
+    lut_apply_pixel(lut, fp, channels, predivide);
+  }
+}
+
+/*********************** Bake *************************/
+
+typedef struct LUTBakeData {
+  ColormanageLUT *lut;
+  OCIO_ConstProcessorRcPtr *processor;
+} LUTBakeData;
+
+static void lut_processor_apply(OCIO_ConstProcessorRcPtr *processor,
+                                float *buffer,
+                                int width,
+                                int height)
+{
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(buffer,
+                                                              width,
+                                                              height,
+                                                              4,
+                                                              sizeof(float),
+                                                              4 * sizeof(float),
+                                                              4 * sizeof(float) * width);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+static void lut_bake_slice(void *__restrict userdata,
+                           const int b,
+                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LUTBakeData *data = (LUTBakeData *)userdata;
+  ColormanageLUT *lut = data->lut;
+  float *slice = lut->table + ((size_t)4) * lut->size * lut->size * b;
+  float *fp = slice;
+
+  for (int g = 0; g < lut->size; g++) {
+    for (int r = 0; r < lut->size; r++, fp += 4) {
+      fp[0] = lut_shaper_inverse(lut, r);
+      fp[1] = lut_shaper_inverse(lut, g);
+      fp[2] = lut_shaper_inverse(lut, b);
+      fp[3] = 1.0f;
+    }
+  }
+
+  lut_processor_apply(data->processor, slice, lut->size, lut->size);
+}
+
+/* Exponent of the smallest power of 2 at which grays reach display white, so the LUT doesn't
+ * waste its resolution on values which are all clamped to white. */
+static int lut_shaper_range_exp(OCIO_ConstProcessorRcPtr *processor)
+{
+  float ramp[LUT_SHAPER_MAX_EXP - LUT_SHAPER_MIN_EXP + 1][4];
+  const int ramp_len = ARRAY_SIZE(ramp);
+
+  for (int i = 0; i < ramp_len; i++) {
+    const float value = ldexpf(1.0f, LUT_SHAPER_MIN_EXP + i);
+    copy_v4_fl4(ramp[i], value, value, value, 1.0f);
+  }
+
+  lut_processor_apply(processor, &ramp[0][0], ramp_len, 1);
+
+  for (int i = 0; i < ramp_len; i++) {
+    if (min_fff(ramp[i][0], ramp[i][1], ramp[i][2]) >= 1.0f - 1e-5f) {
+      return LUT_SHAPER_MIN_EXP + i;
+    }
+  }
+  return LUT_SHAPER_MAX_EXP;
+}
+
+/* Compare the LUT against the exact transform in the centers of all LUT cells, where
+ * interpolation is the least accurate, and for values outside of the range of the shaper. */
+static bool lut_validate(ColormanageLUT *lut, OCIO_ConstProcessorRcPtr *processor)
+{
+  const int num_cells = lut->size - 1;
+  /* Cell centers, followed by a negative value, then values beyond the shaper range. */
+  const int num_values = num_cells + 3;
+  const int num_values_in_range = num_cells + 1;
+  const size_t num_samples = ((size_t)num_values) * num_values * num_values;
+  float *values = MEM_mallocN(sizeof(float) * num_values, __func__);
+  float *exact = MEM_mallocN(sizeof(float) * 4 * num_samples, __func__);
+  float *baked = MEM_mallocN(sizeof(float) * 4 * num_samples, __func__);
+  bool is_valid = true;
+
+  lut->use_predivide = true;
+  lut->use_predivide_beyond_range = true;
+
+  for (int i = 0; i < num_cells; i++) {
+    values[i] = 0.5f * (lut_shaper_inverse(lut, i) + lut_shaper_inverse(lut, i + 1));
+  }
+  values[num_cells] = -0.1f;
+  values[num_cells + 1] = 2.0f * lut->shaper_max;
+  values[num_cells + 2] = 64.0f * lut->shaper_max;
+
+  float *fp = exact;
+  for (int b = 0; b < num_values; b++) {
+    for (int g = 0; g < num_values; g++) {
+      for (int r = 0; r < num_values; r++, fp += 4) {
+        copy_v4_fl4(fp, values[r], values[g], values[b], 0.5f);
+      }
+    }
+  }
+  memcpy(baked, exact, sizeof(float) * 4 * num_samples);
+
+  lut_processor_apply(processor, exact, (int)num_samples, 1);
+  colormanage_lut_apply(
+      lut, (struct OCIO_ConstProcessorRcPtr *)processor, baked, (int)num_samples, 1, 4, false);
+
+  for (size_t i = 0; i < num_samples && is_valid; i++) {
+    const float *exact_pixel = exact + 4 * i;
+    const float *baked_pixel = baked + 4 * i;
+    const int r = (int)(i % num_values);
+    const int g = (int)((i / num_values) % num_values);
+    const int b = (int)(i / ((size_t)num_values * num_values));
+    const bool in_range = MAX3(r, g, b) < num_values_in_range;
+
+    if (exact_pixel[3] != 0.5f) {
+      is_valid = false;
+    }
+
+    for (int j = 0; j < 3; j++) {
+      /* Values above display white become visible when alpha is multiplied again after the
+       * transform, they have to match within the shaper range and are clamped by the LUT
+       * outside of it. */
+      if (in_range) {
+        if (!(fabsf(max_ff(exact_pixel[j], 0.0f) - max_ff(baked_pixel[j], 0.0f)) <=
+              LUT_TOLERANCE)) {
+          lut->use_predivide = false;
+        }
+      }
+      else if (exact_pixel[j] > 1.0f + LUT_TOLERANCE) {
+        lut->use_predivide_beyond_range = false;
+      }
+
+      /* Display buffers are clamped, NaN fail the comparison. */
+      const float difference = fabsf(clamp_f(exact_pixel[j], 0.0f, 1.0f) -
+                                     clamp_f(baked_pixel[j], 0.0f, 1.0f));
+      if (!(difference <= LUT_TOLERANCE)) {
+        is_valid = false;
+      }
+    }
+  }
+
+  MEM_freeN(values);
+  MEM_freeN(exact);
+  MEM_freeN(baked);
+
+  return is_valid;
+}
+
+static void lut_bake(ColormanageLUT *lut, OCIO_ConstProcessorRcPtr *processor)
+{
+  LUTBakeData data;
+  TaskParallelSettings settings;
+
+  lut_shaper_init(lut, lut_shaper_range_exp(processor));
+
+  lut->table = MEM_mallocN_aligned(
+      sizeof(float) * 4 * lut->size * lut->size * lut->size, 16, "colormanagement LUT");
+
+  data.lut = lut;
+  data.processor = processor;
+
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, lut->size, &data, lut_bake_slice, &settings);
+
+  if (!lut_validate(lut, processor)) {
+    MEM_freeN(lut->table);
+    lut->table = NULL;
+  }
+}
+
+/*********************** Cache *************************/
+
+static void lut_free(ColormanageLUT *lut)
+{
+  if (lut->table) {
+    MEM_freeN(lut->table);
+  }
+  MEM_freeN(lut);
+}
+
+static void lut_cache_remove(ColormanageLUT *lut)
+{
+  BLI_remlink(&lut_cache, lut);
+
+  if (lut->users > 0) {
+    lut->is_removed = true;
+  }
+  else {
+    lut_free(lut);
+  }
+}
+
+/* Free least recently used LUTs which are not in use. */
+static void lut_cache_limit(void)
+{
+  ColormanageLUT *lut = lut_cache.last;
+
+  while (lut && BLI_listbase_count_at_most(&lut_cache, LUT_CACHE_SIZE + 1) > LUT_CACHE_SIZE) {
+    ColormanageLUT *prev = lut->prev;
+    if (lut->users == 0) {
+      lut_cache_remove(lut);
+    }
+    lut = prev;
+  }
+}
+
+ColormanageLUT *colormanage_lut_acquire(const char *key,
+                                        struct OCIO_ConstProcessorRcPtr *processor,
+                                        size_t num_pixels)
+{
+  ColormanageLUT *lut;
+
+  BLI_mutex_lock(&lut_lock);
+
+  lut = BLI_findstring(&lut_cache, key, offsetof(ColormanageLUT, key));
+
+  if (lut) {
+    /* Move to the front. */
+    BLI_remlink(&lut_cache, lut);
+    BLI_addhead(&lut_cache, lut);
+  }
+  else if (num_pixels >= LUT_MAX_SIZE * LUT_MAX_SIZE * LUT_MAX_SIZE) {
+    /* Only bake for buffers which take longer to transform than baking. */
+    lut = MEM_callocN(sizeof(ColormanageLUT), "colormanagement LUT cache entry");
+    BLI_strncpy(lut->key, key, sizeof(lut->key));
+
+    lut_bake(lut, (OCIO_ConstProcessorRcPtr *)processor);
+
+    BLI_addhead(&lut_cache, lut);
+    lut_cache_limit();
+  }
+
+  if (lut && lut->table == NULL) {
+    /* Transform can't be baked. */
+    lut = NULL;
+  }
+
+  if (lut) {
+    lut->users++;
+  }
+
+  BLI_mutex_unlock(&lut_lock);
+
+  return lut;
+}
+
+bool colormanage_lut_use_predivide(const ColormanageLUT *lut)
+{
+  return lut->use_predivide;
+}
+
+void colormanage_lut_release(ColormanageLUT *lut)
+{
+  BLI_mutex_lock(&lut_lock);
+
+  BLI_assert(lut->users > 0);
+  lut->users--;
+
+  if (lut->users == 0) {
+    if (lut->is_removed) {
+      lut_free(lut);
+    }
+    else {
+      /* LUTs in use could have made the cache exceed its size. */
+      lut_cache_limit();
+    }
+  }
+
+  BLI_mutex_unlock(&lut_lock);
+}
+
+void colormanage_lut_cache_free(void)
+{
+  BLI_mutex_lock(&lut_lock);
+
+  while (lut_cache.first) {
+    lut_cache_remove(lut_cache.first);
+  }
+
+  BLI_mutex_unlock(&lut_lock);
+}
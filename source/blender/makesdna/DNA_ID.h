@@ -525,6 +525,9 @@ enum {
   /* RESET_NEVER tag data-block as a place-holder
    * (because the real one could not be linked from its library e.g.). */
   LIB_TAG_MISSING = 1 << 6,
+  /* RESET_NEVER tag data-block as a place-holder whose reading from its library has been
+   * deferred until it is actually needed (always set together with #LIB_TAG_MISSING). */
+  LIB_TAG_DEFERRED = 1 << 19,
 
   /* RESET_NEVER tag data-block as being up-to-date regarding its reference. */
   LIB_TAG_OVERRIDE_LIBRARY_REFOK = 1 << 9,
@@ -643,6 +646,19 @@ typedef enum IDRecalcFlag {
    * input file or for color space changes. */
   ID_RECALC_SOURCE = (1 << 23),
 
+  /* Only transform channels of the object did change (location, rotation, scale, parent inverse),
+   * nothing else in the object was modified by the same edit.
+   * Allows the copy-on-write update to sync the transform instead of copying the whole object.
+   * Only use it from places which are known to modify nothing but the transform, such as the
+   * transform system. Is to be tagged together with ID_RECALC_TRANSFORM. */
+  ID_RECALC_TRANSFORM_INPLACE = (1 << 24),
+
+  /* Only settings stored in the modifiers of the object did change, the modifier stack itself
+   * and the rest of the object are the same.
+   * Allows the copy-on-write update to sync the modifier settings instead of copying the whole
+   * object. Is to be tagged together with ID_RECALC_GEOMETRY. */
+  ID_RECALC_MODIFIER_INPLACE = (1 << 25),
+
   /***************************************************************************
    * Pseudonyms, to have more semantic meaning in the actual code without
    * using too much low-level and implementation specific tags. */
@@ -660,6 +676,8 @@ typedef enum IDRecalcFlag {
   /* Identifies that something in particle system did change. */
   ID_RECALC_PSYS_ALL = (ID_RECALC_PSYS_REDO | ID_RECALC_PSYS_RESET | ID_RECALC_PSYS_CHILD |
                         ID_RECALC_PSYS_PHYS),
+  /* Identifies that only parts of the ID which can be updated in place did change. */
+  ID_RECALC_INPLACE_ALL = (ID_RECALC_TRANSFORM_INPLACE | ID_RECALC_MODIFIER_INPLACE),
 
 } IDRecalcFlag;
 
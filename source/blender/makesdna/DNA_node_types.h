@@ -394,6 +394,10 @@ typedef struct bNodeLink {
 #define NTREE_QUALITY_MEDIUM 1
 #define NTREE_QUALITY_LOW 2
 
+/* tree->execution_mode */
+#define NTREE_EXECUTION_MODE_TILED 0
+#define NTREE_EXECUTION_MODE_FULL_FRAME 1
+
 /* tree->chunksize */
 #define NTREE_CHUNKSIZE_32 32
 #define NTREE_CHUNKSIZE_64 64
@@ -439,7 +443,9 @@ typedef struct bNodeTree {
   short is_updating;
   /** Generic temporary flag for recursion check (DFS/BFS). */
   short done;
-  char _pad2[4];
+  /** Execution model of the compositor engine. */
+  short execution_mode;
+  char _pad2[2];
 
   /** Specific node type this tree is used for. */
   int nodetype DNA_DEPRECATED;
@@ -842,7 +848,7 @@ typedef struct NodeTexImage {
   float projection_blend;
   int interpolation;
   int extension;
-  char _pad[4];
+  int compression;
 } NodeTexImage;
 
 typedef struct NodeTexChecker {
@@ -861,7 +867,7 @@ typedef struct NodeTexEnvironment {
   int color_space DNA_DEPRECATED;
   int projection;
   int interpolation;
-  char _pad[4];
+  int compression;
 } NodeTexEnvironment;
 
 typedef struct NodeTexGradient {
@@ -1163,6 +1169,11 @@ enum {
 #define SHD_INTERP_CUBIC 2
 #define SHD_INTERP_SMART 3
 
+/* image texture compression */
+#define SHD_IMAGE_COMPRESSION_AUTO 0
+#define SHD_IMAGE_COMPRESSION_NONE 1
+#define SHD_IMAGE_COMPRESSION_COMPRESSED 2
+
 /* tangent */
 #define SHD_TANGENT_RADIAL 0
 #define SHD_TANGENT_UVMAP 1
@@ -727,7 +727,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Memory limit of the compositor result cache (in megabytes). */
+  int compositor_cache_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
@@ -853,6 +854,14 @@ typedef struct UserDef {
   char filebrowser_display_type; /* eUserpref_TempSpaceDisplayType */
   char _pad5[4];
 
+  /** Directory of the sequencer disk cache, 1024 = FILE_MAX. */
+  char sequencer_disk_cache_dir[1024];
+  /** Size limit of the sequencer disk cache (in gigabytes). */
+  int sequencer_disk_cache_size_limit;
+  /** #eUserpref_SeqDiskCacheCompression. */
+  short sequencer_disk_cache_compression;
+  char _pad14[2];
+
   struct WalkNavigation walk_navigation;
 
   /** The UI for the user preferences. */
@@ -1277,6 +1286,13 @@ typedef enum eUserpref_TempSpaceDisplayType {
   USER_TEMP_SPACE_DISPLAY_WINDOW,
 } eUserpref_TempSpaceDisplayType;
 
+/** #UserDef.sequencer_disk_cache_compression */
+typedef enum eUserpref_SeqDiskCacheCompression {
+  USER_SEQ_DISK_CACHE_COMPRESSION_NONE = 0,
+  USER_SEQ_DISK_CACHE_COMPRESSION_LOW = 1,
+  USER_SEQ_DISK_CACHE_COMPRESSION_HIGH = 2,
+} eUserpref_SeqDiskCacheCompression;
+
 typedef enum eUserpref_EmulateMMBMod {
   USER_EMU_MMB_MOD_ALT = 0,
   USER_EMU_MMB_MOD_OSKEY = 1,
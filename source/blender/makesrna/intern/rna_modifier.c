@@ -759,14 +759,16 @@ static char *rna_Modifier_path(PointerRNA *ptr)
 
 static void rna_Modifier_update(Main *UNUSED(bmain), Scene *UNUSED(scene), PointerRNA *ptr)
 {
-  DEG_id_tag_update(ptr->owner_id, ID_RECALC_GEOMETRY);
+  /* Only the settings of the modifier changed, the evaluated object can sync them in place. */
+  DEG_id_tag_update(ptr->owner_id, ID_RECALC_GEOMETRY | ID_RECALC_MODIFIER_INPLACE);
   WM_main_add_notifier(NC_OBJECT | ND_MODIFIER, ptr->owner_id);
 }
 
-static void rna_Modifier_dependency_update(Main *bmain, Scene *scene, PointerRNA *ptr)
+static void rna_Modifier_dependency_update(Main *bmain, Scene *UNUSED(scene), PointerRNA *ptr)
 {
-  rna_Modifier_update(bmain, scene, ptr);
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_update(ptr->owner_id, ID_RECALC_GEOMETRY);
+  WM_main_add_notifier(NC_OBJECT | ND_MODIFIER, ptr->owner_id);
+  DEG_id_tag_relations_update(bmain, ptr->owner_id);
 }
 
 /* Vertex Groups */
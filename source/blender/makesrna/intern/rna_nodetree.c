@@ -91,6 +91,21 @@ static const EnumPropertyItem node_quality_items[] = {
     {0, NULL, 0, NULL, NULL},
 };
 
+static const EnumPropertyItem node_execution_mode_items[] = {
+    {NTREE_EXECUTION_MODE_TILED,
+     "TILED",
+     0,
+     "Tiled",
+     "Calculate the result in tiles, pulling every pixel through the node tree"},
+    {NTREE_EXECUTION_MODE_FULL_FRAME,
+     "FULL_FRAME",
+     0,
+     "Full Frame",
+     "Calculate the result of every node for the whole image at once, freeing intermediate "
+     "buffers as soon as they are no longer needed"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 static const EnumPropertyItem node_chunksize_items[] = {
     {NTREE_CHUNKSIZE_32, "32", 0, "32x32", "Chunksize of 32x32"},
     {NTREE_CHUNKSIZE_64, "64", 0, "64x64", "Chunksize of 64x64"},
@@ -4210,6 +4225,22 @@ static const EnumPropertyItem sh_tex_prop_interpolation_items[] = {
     {0, NULL, 0, NULL, NULL},
 };
 
+static const EnumPropertyItem sh_tex_prop_compression_items[] = {
+    {SHD_IMAGE_COMPRESSION_AUTO,
+     "AUTO",
+     0,
+     "Auto",
+     "Compress the image when the scene exceeds the texture memory budget, "
+     "8 bit Non-Color images are never block compressed"},
+    {SHD_IMAGE_COMPRESSION_NONE, "NONE", 0, "None", "Store the image at full precision"},
+    {SHD_IMAGE_COMPRESSION_COMPRESSED,
+     "COMPRESSED",
+     0,
+     "Compressed",
+     "Store float images as half float, and 8 bit color images block compressed (CPU only)"},
+    {0, NULL, 0, NULL, NULL},
+};
+
 static void def_sh_tex_environment(StructRNA *srna)
 {
   static const EnumPropertyItem prop_projection_items[] = {
@@ -4249,6 +4280,11 @@ static void def_sh_tex_environment(StructRNA *srna)
   RNA_def_property_ui_text(prop, "Interpolation", "Texture interpolation");
   RNA_def_property_update(prop, 0, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "compression", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_items(prop, sh_tex_prop_compression_items);
+  RNA_def_property_ui_text(prop, "Compression", "How the image is stored in memory for rendering");
+  RNA_def_property_update(prop, 0, "rna_Node_update");
+
   prop = RNA_def_property(srna, "image_user", PROP_POINTER, PROP_NONE);
   RNA_def_property_flag(prop, PROP_NEVER_NULL);
   RNA_def_property_pointer_sdna(prop, NULL, "iuser");
@@ -4340,6 +4376,11 @@ static void def_sh_tex_image(StructRNA *srna)
       prop, "Extension", "How the image is extrapolated past its original bounds");
   RNA_def_property_update(prop, 0, "rna_Node_update");
 
+  prop = RNA_def_property(srna, "compression", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_items(prop, sh_tex_prop_compression_items);
+  RNA_def_property_ui_text(prop, "Compression", "How the image is stored in memory for rendering");
+  RNA_def_property_update(prop, 0, "rna_Node_update");
+
   prop = RNA_def_property(srna, "image_user", PROP_POINTER, PROP_NONE);
   RNA_def_property_flag(prop, PROP_NEVER_NULL);
   RNA_def_property_pointer_sdna(prop, NULL, "iuser");
@@ -9331,6 +9372,12 @@ static void rna_def_composite_nodetree(BlenderRNA *brna)
   RNA_def_property_enum_items(prop, node_quality_items);
   RNA_def_property_ui_text(prop, "Edit Quality", "Quality when editing");
 
+  prop = RNA_def_property(srna, "execution_mode", PROP_ENUM, PROP_NONE);
+  RNA_def_property_enum_sdna(prop, NULL, "execution_mode");
+  RNA_def_property_enum_items(prop, node_execution_mode_items);
+  RNA_def_property_ui_text(prop, "Execution Mode", "Set how compositing is executed");
+  RNA_def_property_update(prop, NC_NODE | NA_EDITED, "rna_NodeTree_update");
+
   prop = RNA_def_property(srna, "chunk_size", PROP_ENUM, PROP_NONE);
   RNA_def_property_enum_sdna(prop, NULL, "chunksize");
   RNA_def_property_enum_items(prop, node_chunksize_items);
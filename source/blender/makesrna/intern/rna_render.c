@@ -785,6 +785,15 @@ static void rna_def_render_engine(BlenderRNA *brna)
   prop = RNA_def_property(srna, "is_preview", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "flag", RE_ENGINE_PREVIEW);
 
+  prop = RNA_def_property(srna, "is_depsgraph_reused", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", RE_ENGINE_DEPSGRAPH_REUSED);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop,
+      "Depsgraph Reused",
+      "The depsgraph of the previous render is used again with persistent data, data synced "
+      "from it is still valid");
+
   prop = RNA_def_property(srna, "camera_override", PROP_POINTER, PROP_NONE);
   RNA_def_property_pointer_funcs(prop, "rna_RenderEngine_camera_override_get", NULL, NULL, NULL);
   RNA_def_property_struct_type(prop, "Object");
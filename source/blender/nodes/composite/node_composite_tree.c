@@ -322,6 +322,19 @@ void ntreeCompositTagRender(Scene *curscene)
       }
     }
   }
+
+  /* Results calculated from the previous render result are not valid anymore. */
+  ntreeCompositClearCaches();
+}
+
+/* Free results cached by the compositor between executions.
+ * Render Layers results are cached by scene, so this is to be called whenever a render result
+ * is replaced or freed. */
+void ntreeCompositClearCaches(void)
+{
+#ifdef WITH_COMPOSITOR
+  COM_clearCaches();
+#endif
 }
 
 /* XXX after render animation system gets a refresh, this call allows composite to end clean */
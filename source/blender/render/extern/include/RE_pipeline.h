@@ -187,6 +187,10 @@ void RE_FreeAllRender(void);
  * Invoked when loading new file.
  */
 void RE_FreeAllPersistentData(void);
+/* Free depsgraphs kept by render engines for persistent data.
+ * Invoked on undo, which replaces the data they were built from.
+ */
+void RE_FreeAllPersistentDepsgraphs(void);
 /* only call on file load */
 void RE_FreeAllRenderResults(void);
 /* for external render engines that can keep persistent data */
@@ -162,11 +162,29 @@ void RE_engine_free(RenderEngine *engine)
     BLI_threaded_malloc_end();
   }
 
+  if (engine->depsgraph) {
+    /* Depsgraph kept around for persistent data. */
+    DEG_graph_free(engine->depsgraph);
+  }
+
   BLI_mutex_end(&engine->update_render_passes_mutex);
 
   MEM_freeN(engine);
 }
 
+/* The depsgraph kept for persistent data references evaluated data of the Main it was built
+ * for, free it when that Main is replaced. */
+void RE_engine_free_persistent_depsgraph(RenderEngine *engine)
+{
+  if (engine->depsgraph == NULL || (engine->flag & RE_ENGINE_RENDERING)) {
+    /* Still in use by the render. */
+    return;
+  }
+  DEG_graph_free(engine->depsgraph);
+  engine->depsgraph = NULL;
+  engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
+}
+
 /* Render Results */
 
 static RenderPart *get_part_from_result(Render *re, RenderResult *result)
@@ -504,31 +522,59 @@ RenderData *RE_engine_get_render_data(Render *re)
 }
 
 /* Depsgraph */
+static void engine_depsgraph_free(RenderEngine *engine)
+{
+  DEG_graph_free(engine->depsgraph);
+
+  engine->depsgraph = NULL;
+}
+
 static void engine_depsgraph_init(RenderEngine *engine, ViewLayer *view_layer)
 {
   Main *bmain = engine->re->main;
   Scene *scene = engine->re->scene;
+  bool reuse_depsgraph = false;
+
+  /* Reuse the depsgraph of the previous render for persistent data, so evaluated datablocks keep
+   * their addresses and the engine only needs to update what changed since then. Depsgraphs are
+   * freed on file load and undo (see #RE_FreeAllPersistentDepsgraphs), checking Main as well is
+   * only an extra safety. */
+  if (engine->depsgraph) {
+    if (DEG_get_bmain(engine->depsgraph) == bmain &&
+        DEG_get_input_scene(engine->depsgraph) == scene &&
+        DEG_get_input_view_layer(engine->depsgraph) == view_layer) {
+      reuse_depsgraph = true;
+    }
+    else {
+      engine_depsgraph_free(engine);
+    }
+  }
 
-  engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(engine->depsgraph, "RENDER");
+  if (reuse_depsgraph) {
+    /* Lets the engine know it can keep data it synced from this depsgraph. */
+    engine->flag |= RE_ENGINE_DEPSGRAPH_REUSED;
+  }
+  else {
+    engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
+    engine->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    DEG_debug_name_set(engine->depsgraph, "RENDER");
+  }
 
   if (engine->re->r.scemode & R_BUTS_PREVIEW) {
     Depsgraph *depsgraph = engine->depsgraph;
     DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
     DEG_evaluate_on_framechange(bmain, depsgraph, CFRA);
     DEG_ids_check_recalc(bmain, depsgraph, scene, view_layer, true);
-    DEG_ids_clear_recalc(bmain, depsgraph);
+    DEG_ids_clear_recalc(bmain, depsgraph, false);
   }
   else {
     BKE_scene_graph_update_for_newframe(engine->depsgraph, bmain);
   }
-}
-
-static void engine_depsgraph_free(RenderEngine *engine)
-{
-  DEG_graph_free(engine->depsgraph);
 
-  engine->depsgraph = NULL;
+  if (reuse_depsgraph) {
+    /* Report everything which changed since the previous render as updated. */
+    DEG_ids_restore_recalc(bmain, engine->depsgraph);
+  }
 }
 
 void RE_engine_frame_set(RenderEngine *engine, int frame, float subframe)
@@ -610,7 +656,12 @@ bool RE_bake_engine(Render *re,
   engine->tile_y = re->r.tiley;
 
   if (type->bake) {
+    if (engine->depsgraph) {
+      /* Baking uses the depsgraph it was given, not the one kept for persistent data. */
+      engine_depsgraph_free(engine);
+    }
     engine->depsgraph = depsgraph;
+    engine->flag &= ~RE_ENGINE_DEPSGRAPH_REUSED;
 
     /* update is only called so we create the engine.session */
     if (type->update) {
@@ -771,6 +822,11 @@ int RE_engine_render(Render *re, int do_all)
         type->update(engine, re->main, engine->depsgraph);
       }
 
+      if (persistent_data) {
+        /* Updates were handled by the engine, don't report them again for the next frame. */
+        DEG_ids_clear_recalc(re->main, engine->depsgraph, false);
+      }
+
       if (re->draw_lock) {
         re->draw_lock(re->dlh, 0);
       }
@@ -787,7 +843,9 @@ int RE_engine_render(Render *re, int do_all)
         DRW_render_gpencil(engine, engine->depsgraph);
       }
 
-      engine_depsgraph_free(engine);
+      if (!persistent_data) {
+        engine_depsgraph_free(engine);
+      }
 
       if (RE_engine_test_break(engine)) {
         break;
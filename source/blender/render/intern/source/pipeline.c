@@ -389,6 +389,7 @@ void RE_ClearResult(Render *re)
   if (re) {
     render_result_free(re->result);
     re->result = NULL;
+    ntreeCompositClearCaches();
   }
 }
 
@@ -397,6 +398,8 @@ void RE_SwapResult(Render *re, RenderResult **rr)
   /* for keeping render buffers */
   if (re) {
     SWAP(RenderResult *, re->result, *rr);
+    /* Render slot changed, compositor results of the previous render result are not valid. */
+    ntreeCompositClearCaches();
   }
 }
 
@@ -697,6 +700,16 @@ void RE_FreeAllPersistentData(void)
   }
 }
 
+void RE_FreeAllPersistentDepsgraphs(void)
+{
+  Render *re;
+  for (re = RenderGlobal.renderlist.first; re != NULL; re = re->next) {
+    if (re->engine != NULL) {
+      RE_engine_free_persistent_depsgraph(re->engine);
+    }
+  }
+}
+
 /* on file load, free all re */
 void RE_FreeAllRenderResults(void)
 {
@@ -709,6 +722,8 @@ void RE_FreeAllRenderResults(void)
     re->result = NULL;
     re->pushedresult = NULL;
   }
+  /* New files can have scenes of the same name, which would match cached compositor results. */
+  ntreeCompositClearCaches();
 }
 
 void RE_FreePersistentData(void)
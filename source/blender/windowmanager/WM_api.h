@@ -181,6 +181,7 @@ struct ID *WM_file_append_datablock(struct bContext *C,
                                     const short id_code,
                                     const char *id_name);
 void WM_lib_reload(struct Library *lib, struct bContext *C, struct ReportList *reports);
+bool WM_lib_deferred_load_tagged(struct Main *bmain, struct ReportList *reports);
 
 /* mouse cursors */
 void WM_cursor_set(struct wmWindow *win, int curs);
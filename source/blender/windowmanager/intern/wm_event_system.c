@@ -50,6 +50,7 @@
 #include "BKE_customdata.h"
 #include "BKE_idprop.h"
 #include "BKE_global.h"
+#include "BKE_library.h"
 #include "BKE_main.h"
 #include "BKE_report.h"
 #include "BKE_scene.h"
@@ -317,16 +318,54 @@ static void wm_notifier_clear(wmNotifier *note)
   memset(((char *)note) + sizeof(Link), 0, sizeof(*note) - sizeof(Link));
 }
 
-void wm_event_do_depsgraph(bContext *C, bool is_after_open_file)
+/* Reading deferred data-blocks and updating the dependency graphs again, per update. */
+#define DEFERRED_LOAD_MAX_PASSES 8
+
+static void wm_event_deferred_id_tag_cb(ID *id, void *user_data)
+{
+  if (id->tag & LIB_TAG_DEFERRED) {
+    id->tag |= LIB_TAG_DOIT;
+    *(bool *)user_data = true;
+  }
+}
+
+/**
+ * Read linked data-blocks whose loading was deferred (see #G_FLAG_LIB_DEFERRED_LOAD),
+ * as soon as one of the dependency graphs needs them.
+ *
+ * This is the only trigger: the interface accessing a deferred data-block (outliner, properties
+ * of an object from a hidden collection, Python) still sees a missing place-holder, until it is
+ * evaluated or #WM_OT_lib_deferred_load reads everything left.
+ *
+ * \return true when data-blocks were read, dependency graphs then need another update.
+ */
+static bool wm_event_do_depsgraph_deferred_load(bContext *C)
 {
   wmWindowManager *wm = CTX_wm_manager(C);
-  /* The whole idea of locked interface is to prevent viewport and whatever
-   * thread to modify the same data. Because of this, we can not perform
-   * dependency graph update.
-   */
-  if (wm->is_interface_locked) {
-    return;
+  Main *bmain = CTX_data_main(C);
+  bool has_deferred = false;
+
+  BKE_main_id_tag_all(bmain, LIB_TAG_DOIT, false);
+
+  for (wmWindow *win = wm->windows.first; win; win = win->next) {
+    Scene *scene = WM_window_get_active_scene(win);
+    ViewLayer *view_layer = WM_window_get_active_view_layer(win);
+    Depsgraph *depsgraph = BKE_scene_get_depsgraph(bmain, scene, view_layer, false);
+    if (depsgraph != NULL) {
+      DEG_foreach_ID(depsgraph, wm_event_deferred_id_tag_cb, &has_deferred);
+    }
+  }
+
+  if (!has_deferred) {
+    return false;
   }
+
+  return WM_lib_deferred_load_tagged(bmain, &wm->reports);
+}
+
+static void wm_event_do_depsgraph_update(bContext *C, bool is_after_open_file)
+{
+  wmWindowManager *wm = CTX_wm_manager(C);
   /* Combine datamasks so 1 win doesn't disable UV's in another [#26448]. */
   CustomData_MeshMasks win_combine_v3d_datamask = {0};
   for (wmWindow *win = wm->windows.first; win; win = win->next) {
@@ -360,6 +399,32 @@ void wm_event_do_depsgraph(bContext *C, bool is_after_open_file)
   }
 }
 
+void wm_event_do_depsgraph(bContext *C, bool is_after_open_file)
+{
+  wmWindowManager *wm = CTX_wm_manager(C);
+  /* The whole idea of locked interface is to prevent viewport and whatever
+   * thread to modify the same data. Because of this, we can not perform
+   * dependency graph update.
+   */
+  if (wm->is_interface_locked) {
+    return;
+  }
+
+  wm_event_do_depsgraph_update(C, is_after_open_file);
+
+  /* Newly read data-blocks may need more deferred ones, until the whole graph is loaded.
+   * Bound the number of passes so a single update cannot stall the interface for too long,
+   * whatever is still deferred then gets read by the next updates. */
+  if (G.f & G_FLAG_LIB_DEFERRED_LOAD) {
+    for (int pass = 0; pass < DEFERRED_LOAD_MAX_PASSES; pass++) {
+      if (!wm_event_do_depsgraph_deferred_load(C)) {
+        break;
+      }
+      wm_event_do_depsgraph_update(C, false);
+    }
+  }
+}
+
 /**
  * Was part of #wm_event_do_notifiers,
  * split out so it can be called once before entering the #WM_main loop.
@@ -625,19 +625,26 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
     /* also exit screens and editors */
     wm_window_match_init(C, &wmbase);
 
+    /* Loading preferences when the user intended to load a regular file is a security risk,
+     * because the excluded path list is also loaded.
+     * Further it's just confusing if a user loads a file and various preferences change. */
+    eBLOReadSkip skip_flags = BLO_READ_SKIP_USERDEF;
+
+    /* Linked data-blocks are loaded on demand by the window-manager depsgraph update,
+     * which does not run in background mode. */
+    if ((G.f & G_FLAG_LIB_DEFERRED_LOAD) && !G.background) {
+      skip_flags |= BLO_READ_DEFER_LIBRARIES;
+    }
+
     /* confusing this global... */
     G.relbase_valid = 1;
-    success = BKE_blendfile_read(
-        C,
-        filepath,
-        /* Loading preferences when the user intended to load a regular file is a security risk,
-         * because the excluded path list is also loaded.
-         * Further it's just confusing if a user loads a file and various preferences change. */
-        &(const struct BlendFileReadParams){
-            .is_startup = false,
-            .skip_flags = BLO_READ_SKIP_USERDEF,
-        },
-        reports);
+    success = BKE_blendfile_read(C,
+                                 filepath,
+                                 &(const struct BlendFileReadParams){
+                                     .is_startup = false,
+                                     .skip_flags = skip_flags,
+                                 },
+                                 reports);
 
     /* BKE_file_read sets new Main into context. */
     Main *bmain = CTX_data_main(C);
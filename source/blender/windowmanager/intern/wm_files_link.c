@@ -687,11 +687,29 @@ static int wm_lib_relocate_invoke(bContext *C, wmOperator *op, const wmEvent *UN
   return OPERATOR_CANCELLED;
 }
 
+/* Deferred data-blocks are identified by library filepath and ID name rather than by pointer:
+ * reloading a library frees place-holders and unused libraries, whose memory may then be reused
+ * by newly read data-blocks. */
+#define DEFERRED_ID_KEY_MAXNCPY (FILE_MAX + MAX_ID_NAME)
+
+static void lib_deferred_id_key(const ID *id, char r_key[DEFERRED_ID_KEY_MAXNCPY])
+{
+  BLI_snprintf(r_key, DEFERRED_ID_KEY_MAXNCPY, "%s|%s", id->lib->filepath, id->name);
+}
+
+static bool lib_deferred_id_requested(GSet *deferred_ids, const ID *id)
+{
+  char key[DEFERRED_ID_KEY_MAXNCPY];
+  lib_deferred_id_key(id, key);
+  return BLI_gset_haskey(deferred_ids, key);
+}
+
 static void lib_relocate_do(Main *bmain,
                             Library *library,
                             WMLinkAppendData *lapp_data,
                             ReportList *reports,
-                            const bool do_reload)
+                            const bool do_reload,
+                            GSet *deferred_ids)
 {
   ListBase *lbarray[MAX_LIBARRAY];
   int lba_idx;
@@ -713,6 +731,10 @@ static void lib_relocate_do(Main *bmain,
 
     for (; id; id = id->next) {
       if (id->lib == library) {
+        if (deferred_ids != NULL && !lib_deferred_id_requested(deferred_ids, id)) {
+          /* Only replace the deferred place-holders that have been requested. */
+          continue;
+        }
         WMLinkAppendDataItem *item;
 
         /* We remove it from current Main, and add it to items to link... */
@@ -921,13 +943,97 @@ void WM_lib_reload(Library *lib, bContext *C, ReportList *reports)
 
   wm_link_append_data_library_add(lapp_data, lib->filepath);
 
-  lib_relocate_do(CTX_data_main(C), lib, lapp_data, reports, true);
+  lib_relocate_do(CTX_data_main(C), lib, lapp_data, reports, true, NULL);
 
   wm_link_append_data_free(lapp_data);
 
   WM_event_add_notifier(C, NC_WINDOW, NULL);
 }
 
+/**
+ * Read from their libraries all linked data-blocks tagged with both #LIB_TAG_DEFERRED and
+ * #LIB_TAG_DOIT, replacing their deferred place-holders (see #BLO_READ_DEFER_LIBRARIES).
+ *
+ * Data-blocks that cannot be found remain regular missing place-holders.
+ *
+ * \return true if any deferred data-block has been processed.
+ */
+bool WM_lib_deferred_load_tagged(Main *bmain, ReportList *reports)
+{
+  /* Gather everything up-front: reloading a library re-tags all libraries and clears
+   * #LIB_TAG_DOIT from objects and collections, so tags cannot be used across reloads.
+   * Libraries are kept by filepath and looked up again before each reload, since reloading
+   * one library may free others. */
+  GSet *deferred_ids = BLI_gset_str_new(__func__);
+  GSet *libraries_done = BLI_gset_str_new(__func__);
+  LinkNode *libraries = NULL;
+
+  ListBase *lbarray[MAX_LIBARRAY];
+  int lba_idx = set_listbasepointers(bmain, lbarray);
+  while (lba_idx--) {
+    for (ID *id = lbarray[lba_idx]->first; id; id = id->next) {
+      if ((id->tag & (LIB_TAG_DEFERRED | LIB_TAG_DOIT)) == (LIB_TAG_DEFERRED | LIB_TAG_DOIT)) {
+        BLI_assert(id->lib != NULL);
+        char key[DEFERRED_ID_KEY_MAXNCPY];
+        lib_deferred_id_key(id, key);
+        BLI_gset_add(deferred_ids, BLI_strdup(key));
+        if (BLI_gset_add(libraries_done, id->lib->filepath)) {
+          BLI_linklist_prepend(&libraries, BLI_strdup(id->lib->filepath));
+        }
+      }
+    }
+  }
+  BLI_gset_clear(libraries_done, NULL);
+
+  for (LinkNode *libnode = libraries; libnode; libnode = libnode->next) {
+    char *filepath = libnode->link;
+    Library *lib = BLI_findstring(&bmain->libraries, filepath, offsetof(Library, filepath));
+
+    /* Unused libraries get freed by the reload of other ones. */
+    if (lib == NULL) {
+      continue;
+    }
+    BLI_gset_add(libraries_done, filepath);
+
+    if (!BLI_exists(lib->filepath)) {
+      BKE_reportf(reports, RPT_WARNING, "Cannot find lib '%s'", lib->filepath);
+      continue;
+    }
+
+    WMLinkAppendData *lapp_data = wm_link_append_data_new(BLO_LIBLINK_USE_PLACEHOLDERS |
+                                                          BLO_LIBLINK_FORCE_INDIRECT);
+    wm_link_append_data_library_add(lapp_data, lib->filepath);
+
+    lib_relocate_do(bmain, lib, lapp_data, reports, true, deferred_ids);
+
+    wm_link_append_data_free(lapp_data);
+  }
+
+  const bool changed = BLI_gset_len(libraries_done) != 0;
+
+  /* Anything requested from a processed library and still deferred could not be read (missing
+   * library, or old data-block kept alive), make it a regular missing place-holder so it is not
+   * requested again. */
+  lba_idx = set_listbasepointers(bmain, lbarray);
+  while (lba_idx--) {
+    for (ID *id = lbarray[lba_idx]->first; id; id = id->next) {
+      if ((id->tag & LIB_TAG_DEFERRED) && BLI_gset_haskey(libraries_done, id->lib->filepath) &&
+          lib_deferred_id_requested(deferred_ids, id)) {
+        id->tag &= ~(LIB_TAG_DEFERRED | LIB_TAG_DOIT);
+      }
+    }
+  }
+
+  /* Keys of `libraries_done` are owned by `libraries`. */
+  BLI_gset_free(libraries_done, NULL);
+  BLI_linklist_freeN(libraries);
+  BLI_gset_free(deferred_ids, MEM_freeN);
+
+  return changed;
+}
+
+#undef DEFERRED_ID_KEY_MAXNCPY
+
 static int wm_lib_relocate_exec_do(bContext *C, wmOperator *op, bool do_reload)
 {
   Library *lib;
@@ -1035,7 +1141,7 @@ static int wm_lib_relocate_exec_do(bContext *C, wmOperator *op, bool do_reload)
       lapp_data->flag |= BLO_LIBLINK_USE_PLACEHOLDERS | BLO_LIBLINK_FORCE_INDIRECT;
     }
 
-    lib_relocate_do(bmain, lib, lapp_data, op->reports, do_reload);
+    lib_relocate_do(bmain, lib, lapp_data, op->reports, do_reload, NULL);
 
     wm_link_append_data_free(lapp_data);
 
@@ -1111,4 +1217,38 @@ void WM_OT_lib_reload(wmOperatorType *ot)
                                  FILE_SORT_ALPHA);
 }
 
+static int wm_lib_deferred_load_exec(bContext *C, wmOperator *op)
+{
+  Main *bmain = CTX_data_main(C);
+
+  ListBase *lbarray[MAX_LIBARRAY];
+  int lba_idx = set_listbasepointers(bmain, lbarray);
+  while (lba_idx--) {
+    for (ID *id = lbarray[lba_idx]->first; id; id = id->next) {
+      if (id->tag & LIB_TAG_DEFERRED) {
+        id->tag |= LIB_TAG_DOIT;
+      }
+    }
+  }
+
+  if (!WM_lib_deferred_load_tagged(bmain, op->reports)) {
+    return OPERATOR_CANCELLED;
+  }
+
+  WM_event_add_notifier(C, NC_WINDOW, NULL);
+
+  return OPERATOR_FINISHED;
+}
+
+void WM_OT_lib_deferred_load(wmOperatorType *ot)
+{
+  ot->name = "Load Deferred Library Data";
+  ot->idname = "WM_OT_lib_deferred_load";
+  ot->description = "Read all linked data-blocks whose loading has been deferred";
+
+  ot->exec = wm_lib_deferred_load_exec;
+
+  ot->flag |= OPTYPE_UNDO;
+}
+
 /** \} */
@@ -3633,6 +3633,7 @@ void wm_operatortypes_register(void)
   WM_operatortype_append(WM_OT_append);
   WM_operatortype_append(WM_OT_lib_relocate);
   WM_operatortype_append(WM_OT_lib_reload);
+  WM_operatortype_append(WM_OT_lib_deferred_load);
   WM_operatortype_append(WM_OT_recover_last_session);
   WM_operatortype_append(WM_OT_recover_auto_save);
   WM_operatortype_append(WM_OT_save_as_mainfile);
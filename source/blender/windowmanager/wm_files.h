@@ -69,5 +69,6 @@ void WM_OT_append(struct wmOperatorType *ot);
 
 void WM_OT_lib_relocate(struct wmOperatorType *ot);
 void WM_OT_lib_reload(struct wmOperatorType *ot);
+void WM_OT_lib_deferred_load(struct wmOperatorType *ot);
 
 #endif /* __WM_FILES_H__ */
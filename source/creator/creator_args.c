@@ -527,6 +527,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--render-output");
   BLI_argsPrintArgDoc(ba, "--engine");
   BLI_argsPrintArgDoc(ba, "--threads");
+  BLI_argsPrintArgDoc(ba, "--threads-numa");
 
   printf("\n");
   printf("Format Options:\n");
@@ -598,6 +599,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-pretty");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-profile");
   BLI_argsPrintArgDoc(ba, "--debug-gpu");
   BLI_argsPrintArgDoc(ba, "--debug-gpumem");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-shaders");
@@ -617,6 +619,9 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--factory-startup");
   BLI_argsPrintArgDoc(ba, "--enable-library-override");
   BLI_argsPrintArgDoc(ba, "--enable-event-simulate");
+  BLI_argsPrintArgDoc(ba, "--defer-libraries");
+  BLI_argsPrintArgDoc(ba, "--depsgraph-priority-scheduling");
+  BLI_argsPrintArgDoc(ba, "--depsgraph-incremental-relations");
   printf("\n");
   BLI_argsPrintArgDoc(ba, "--env-system-datafiles");
   BLI_argsPrintArgDoc(ba, "--env-system-scripts");
@@ -979,6 +984,27 @@ static int arg_handle_debug_mode_generic_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_mode_depsgraph_profile_doc[] =
+    "<filepath>\n"
+    "\tRecord a timeline of all dependency graph operations evaluated by all threads, written\n"
+    "\tto <filepath> on exit in the Chrome trace event format (chrome://tracing, Perfetto).";
+static int arg_handle_debug_mode_depsgraph_profile(int argc,
+                                                   const char **argv,
+                                                   void *UNUSED(data))
+{
+  if (argc > 1) {
+    char filepath[FILE_MAX];
+    STRNCPY(filepath, argv[1]);
+    BLI_path_cwd(filepath, sizeof(filepath));
+    DEG_debug_profile_begin(filepath);
+    return 1;
+  }
+  else {
+    printf("\nError: you must specify a filepath after '--debug-depsgraph-profile'.\n");
+    return 0;
+  }
+}
+
 static const char arg_handle_debug_mode_io_doc[] =
     "\n\t"
     "Enable debug messages for I/O (collada, ...).";
@@ -1130,6 +1156,42 @@ static int arg_handle_enable_event_simulate(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_defer_libraries_doc[] =
+    "\n\t"
+    "Defer reading linked library data until it is needed by the scene evaluation.\n"
+    "\tIgnored in background mode.";
+static int arg_handle_defer_libraries(int UNUSED(argc),
+                                      const char **UNUSED(argv),
+                                      void *UNUSED(data))
+{
+  G.f |= G_FLAG_LIB_DEFERRED_LOAD;
+  return 0;
+}
+
+static const char arg_handle_depsgraph_priority_scheduling_doc[] =
+    "\n\t"
+    "Evaluate dependency graph operations with the longest chain of dependent operations first,\n"
+    "\tusing timings of previous evaluations.";
+static int arg_handle_depsgraph_priority_scheduling(int UNUSED(argc),
+                                                    const char **UNUSED(argv),
+                                                    void *UNUSED(data))
+{
+  G.f |= G_FLAG_DEPSGRAPH_PRIORITY_SCHEDULING;
+  return 0;
+}
+
+static const char arg_handle_depsgraph_incremental_relations_doc[] =
+    "\n\t"
+    "When relations of some objects are tagged for update, only rebuild relations of those\n"
+    "\tobjects and re-use relations of other data-blocks from the previous build.";
+static int arg_handle_depsgraph_incremental_relations(int UNUSED(argc),
+                                                      const char **UNUSED(argv),
+                                                      void *UNUSED(data))
+{
+  G.f |= G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS;
+  return 0;
+}
+
 static const char arg_handle_env_system_set_doc_datafiles[] =
     "\n\t"
     "Set the " STRINGIFY_ARG(BLENDER_SYSTEM_DATAFILES) " environment variable.";
@@ -1478,6 +1540,18 @@ static int arg_handle_threads_set(int argc, const char **argv, void *UNUSED(data
   }
 }
 
+static const char arg_handle_threads_numa_set_doc[] =
+    "\n"
+    "\tPin task scheduler threads to the NUMA nodes of the system, keeping work and memory\n"
+    "\taccesses local to each node where possible.";
+static int arg_handle_threads_numa_set(int UNUSED(argc),
+                                       const char **UNUSED(argv),
+                                       void *UNUSED(data))
+{
+  BLI_system_numa_scheduler_set(true);
+  return 0;
+}
+
 static const char arg_handle_verbosity_set_doc[] =
     "<verbose>\n"
     "\tSet logging verbosity level for debug messages which supports it.";
@@ -2166,6 +2240,12 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-depsgraph-pretty",
               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_pretty),
               (void *)G_DEBUG_DEPSGRAPH_PRETTY);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--debug-depsgraph-profile",
+              CB(arg_handle_debug_mode_depsgraph_profile),
+              NULL);
   BLI_argsAdd(ba,
               1,
               NULL,
@@ -2192,6 +2272,19 @@ void main_args_setup(bContext *C, bArgs *ba)
   BLI_argsAdd(
       ba, 1, NULL, "--disable-library-override", CB(arg_handle_disable_override_library), NULL);
   BLI_argsAdd(ba, 1, NULL, "--enable-event-simulate", CB(arg_handle_enable_event_simulate), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--defer-libraries", CB(arg_handle_defer_libraries), NULL);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--depsgraph-priority-scheduling",
+              CB(arg_handle_depsgraph_priority_scheduling),
+              NULL);
+  BLI_argsAdd(ba,
+              1,
+              NULL,
+              "--depsgraph-incremental-relations",
+              CB(arg_handle_depsgraph_incremental_relations),
+              NULL);
 
   /* TODO, add user env vars? */
   BLI_argsAdd(
@@ -2237,6 +2330,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_argsAdd(ba, 4, "-F", "--render-format", CB(arg_handle_image_type_set), C);
   BLI_argsAdd(ba, 1, "-t", "--threads", CB(arg_handle_threads_set), NULL);
+  BLI_argsAdd(ba, 1, NULL, "--threads-numa", CB(arg_handle_threads_numa_set), NULL);
   BLI_argsAdd(ba, 4, "-x", "--use-extension", CB(arg_handle_extension_set), C);
 
 #  undef CB
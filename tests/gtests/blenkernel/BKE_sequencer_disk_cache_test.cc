@@ -0,0 +1,191 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_fileops.h"
+#include "BLI_fileops_types.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_scene_types.h"
+#include "DNA_sequence_types.h"
+#include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_appdir.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_sequencer.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#define IMAGE_SIZE 64
+/* Uncompressed size of an image, cache files are slightly larger with their header. */
+#define IMAGE_NUM_BYTES (IMAGE_SIZE * IMAGE_SIZE * 4)
+
+class SequencerDiskCacheTest : public testing::Test {
+ protected:
+  Main *m_bmain;
+  Scene *m_scene;
+  Sequence *m_seq;
+  SeqRenderData m_context;
+  UserDef m_previous_userdef;
+  char m_dir[FILE_MAX];
+
+  virtual void SetUp()
+  {
+    BLI_threadapi_init();
+    BKE_tempdir_init(NULL);
+
+    m_previous_userdef = U;
+    BLI_join_dirfile(m_dir, sizeof(m_dir), BKE_tempdir_session(), "sequencer_disk_cache");
+    BLI_strncpy(U.sequencer_disk_cache_dir, m_dir, sizeof(U.sequencer_disk_cache_dir));
+    U.sequencer_disk_cache_size_limit = 1;
+    U.sequencer_disk_cache_compression = USER_SEQ_DISK_CACHE_COMPRESSION_NONE;
+    U.memcachelimit = 64;
+
+    m_bmain = BKE_main_new();
+    G_MAIN = m_bmain;
+
+    m_scene = (Scene *)MEM_callocN(sizeof(Scene), __func__);
+    Editing *ed = BKE_sequencer_editing_ensure(m_scene);
+    ed->cache_flag |= SEQ_CACHE_STORE_RAW | SEQ_CACHE_DISK_CACHE_ENABLE;
+
+    m_seq = BKE_sequence_alloc(&ed->seqbase, 1, 1, SEQ_TYPE_COLOR);
+    m_seq->len = 100;
+    m_seq->effectdata = MEM_callocN(sizeof(SolidColorVars), __func__);
+    BKE_sequence_calc_disp(m_scene, m_seq);
+
+    BKE_sequencer_new_render_data(m_bmain,
+                                  NULL,
+                                  m_scene,
+                                  IMAGE_SIZE,
+                                  IMAGE_SIZE,
+                                  SEQ_PROXY_RENDER_SIZE_FULL,
+                                  false,
+                                  &m_context);
+  }
+
+  virtual void TearDown()
+  {
+    BKE_sequencer_cache_disk_free();
+    BKE_sequencer_cache_disk_size_limit_set(0);
+    BKE_sequencer_editing_free(m_scene, false);
+    MEM_freeN(m_scene);
+
+    G_MAIN = NULL;
+    BKE_main_free(m_bmain);
+
+    U = m_previous_userdef;
+    BKE_tempdir_session_purge();
+    BLI_threadapi_exit();
+  }
+
+  /* Store an image in the memory cache, and write it to the disk cache. */
+  void put(int cfra)
+  {
+    ImBuf *ibuf = IMB_allocImBuf(IMAGE_SIZE, IMAGE_SIZE, 32, IB_rect);
+    for (int i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++) {
+      ibuf->rect[i] = (unsigned int)(i * cfra);
+    }
+    BKE_sequencer_cache_put(&m_context, m_seq, cfra, SEQ_CACHE_STORE_RAW, ibuf, 1.0f);
+    IMB_freeImBuf(ibuf);
+  }
+
+  /* Finish writing, and only keep the images on disk, like after reloading the file. */
+  void reload()
+  {
+    BKE_sequencer_cache_disk_free();
+    BKE_sequencer_cache_cleanup(m_scene);
+  }
+
+  /* Check if the image of a frame is in the cache, and has the expected content. */
+  bool contains(int cfra)
+  {
+    ImBuf *ibuf = BKE_sequencer_cache_get(&m_context, m_seq, cfra, SEQ_CACHE_STORE_RAW);
+    if (ibuf == NULL) {
+      return false;
+    }
+    EXPECT_EQ(IMAGE_SIZE, ibuf->x);
+    EXPECT_EQ(IMAGE_SIZE, ibuf->y);
+    EXPECT_TRUE(ibuf->rect != NULL);
+    if (ibuf->rect) {
+      for (int i = 0; i < IMAGE_SIZE * IMAGE_SIZE; i++) {
+        if (ibuf->rect[i] != (unsigned int)(i * cfra)) {
+          ADD_FAILURE() << "Pixel " << i << " differs";
+          break;
+        }
+      }
+    }
+    IMB_freeImBuf(ibuf);
+    return true;
+  }
+
+  int num_files()
+  {
+    struct direntry *filelist;
+    const unsigned int totfile = BLI_filelist_dir_contents(m_dir, &filelist);
+    int num = 0;
+    for (unsigned int i = 0; i < totfile; i++) {
+      if (!S_ISDIR(filelist[i].type)) {
+        num++;
+      }
+    }
+    BLI_filelist_free(filelist, totfile);
+    return num;
+  }
+};
+
+TEST_F(SequencerDiskCacheTest, RoundTrip)
+{
+  put(1);
+  reload();
+  EXPECT_EQ(1, num_files());
+
+  EXPECT_TRUE(contains(1));
+  EXPECT_FALSE(contains(2));
+}
+
+TEST_F(SequencerDiskCacheTest, KeyStability)
+{
+  put(1);
+  reload();
+
+  /* Selection doesn't change the image. */
+  m_seq->flag ^= SELECT;
+  EXPECT_TRUE(contains(1));
+  EXPECT_TRUE(contains(1));
+
+  /* Settings do, once the cache is invalidated like after any change. */
+  ((SolidColorVars *)m_seq->effectdata)->col[0] = 1.0f;
+  BKE_sequencer_cache_cleanup(m_scene);
+  EXPECT_FALSE(contains(1));
+
+  ((SolidColorVars *)m_seq->effectdata)->col[0] = 0.0f;
+  BKE_sequencer_cache_cleanup(m_scene);
+  EXPECT_TRUE(contains(1));
+}
+
+TEST_F(SequencerDiskCacheTest, Eviction)
+{
+  /* Room for two images. */
+  BKE_sequencer_cache_disk_size_limit_set(IMAGE_NUM_BYTES * 5 / 2);
+
+  put(1);
+  put(2);
+  put(3);
+  reload();
+  EXPECT_EQ(2, num_files());
+
+  /* The least recently used image is removed. */
+  EXPECT_FALSE(contains(1));
+  EXPECT_TRUE(contains(2));
+  EXPECT_TRUE(contains(3));
+}
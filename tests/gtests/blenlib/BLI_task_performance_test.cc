@@ -15,10 +15,13 @@ extern "C" {
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 
 #include "PIL_time.h"
 }
 
+#include "BLI_task_pool_test_utils.h"
+
 #define NUM_RUN_AVERAGED 100
 
 static uint gen_pseudo_random_number(uint num)
@@ -296,3 +299,201 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Task pool scheduling of many small tasks. *** */
+
+#define NUM_POOL_RUN_AVERAGED 10
+
+/* Depth of the spawned tasks tree. */
+#define SPAWN_DEPTH 8
+
+static void task_pool_small_work(const int index)
+{
+  const uint limit = gen_pseudo_random_number((uint)index) / 16;
+  for (uint i = (uint)index; i < limit;) {
+    i += gen_pseudo_random_number(i) / 16 + 1;
+  }
+}
+
+static void task_pool_flat_func(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+  TaskPoolTestData *data = (TaskPoolTestData *)BLI_task_pool_userdata(pool);
+  task_pool_small_work(POINTER_AS_INT(taskdata));
+  atomic_add_and_fetch_uint32(&data->num_done, 1);
+}
+
+typedef enum eTaskPoolTestMode {
+  /* Many small tasks pushed from the main thread. */
+  TASK_POOL_TEST_FLAT,
+  /* Small tasks pushed by other tasks, from their worker thread. */
+  TASK_POOL_TEST_SPAWN,
+  /* Tasks waiting on their own nested pool of spawned tasks. */
+  TASK_POOL_TEST_NESTED,
+} eTaskPoolTestMode;
+
+#define NUM_FLAT_TASKS 100000
+#define NUM_NESTED_TASKS 256
+
+/* Average time to run all tasks of the given mode, the number of tasks is returned in
+ * \a r_num_tasks. */
+static double task_pool_test_run(TaskScheduler *scheduler,
+                                 const eTaskPoolTestMode mode,
+                                 const bool use_global_queue,
+                                 uint32_t *r_num_tasks)
+{
+  double averaged_timing = 0.0;
+  for (int i = 0; i < NUM_POOL_RUN_AVERAGED; i++) {
+    TaskPoolTestData data = {
+        scheduler, 0, SPAWN_DEPTH / 2, task_pool_small_work, use_global_queue};
+    uint32_t num_expected = 0;
+
+    const double init_time = PIL_check_seconds_timer();
+    TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+    switch (mode) {
+      case TASK_POOL_TEST_FLAT:
+        for (int j = 0; j < NUM_FLAT_TASKS; j++) {
+          BLI_task_pool_push(
+              pool, task_pool_flat_func, POINTER_FROM_INT(j), false, TASK_PRIORITY_HIGH);
+        }
+        num_expected = NUM_FLAT_TASKS;
+        break;
+      case TASK_POOL_TEST_SPAWN:
+        BLI_task_pool_push(
+            pool, task_pool_spawn_func, POINTER_FROM_INT(SPAWN_DEPTH), false, TASK_PRIORITY_HIGH);
+        num_expected = spawn_tree_num_tasks(SPAWN_DEPTH);
+        break;
+      case TASK_POOL_TEST_NESTED:
+        for (int j = 0; j < NUM_NESTED_TASKS; j++) {
+          BLI_task_pool_push(pool, task_pool_nested_func, NULL, false, TASK_PRIORITY_HIGH);
+        }
+        num_expected = NUM_NESTED_TASKS * spawn_tree_num_tasks(SPAWN_DEPTH / 2);
+        break;
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+    averaged_timing += PIL_check_seconds_timer() - init_time;
+
+    EXPECT_EQ(data.num_done, num_expected);
+    *r_num_tasks = num_expected;
+  }
+  return averaged_timing / NUM_POOL_RUN_AVERAGED;
+}
+
+/* Compare the work-stealing deques against pushing everything to the global queue, which is
+ * how the scheduler worked before the deques. Tasks pushed from the main thread always go to
+ * the global queue, so there should be no difference for those. */
+static void task_pool_test_do(const char *id, const eTaskPoolTestMode mode)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  const int num_threads_max = BLI_system_thread_count();
+  for (int num_threads = 1;; num_threads = MIN2(num_threads * 2, num_threads_max)) {
+    TaskScheduler *scheduler = BLI_task_scheduler_create(num_threads);
+    uint32_t num_tasks;
+
+    const double global_queue_timing = task_pool_test_run(scheduler, mode, true, &num_tasks);
+    const double deque_timing = task_pool_test_run(scheduler, mode, false, &num_tasks);
+
+    printf("\t%d threads: %u tasks done in %fs with deques, %fs with global queue only "
+           "(%.2fx) on average over %d runs\n",
+           num_threads,
+           num_tasks,
+           deque_timing,
+           global_queue_timing,
+           global_queue_timing / deque_timing,
+           NUM_POOL_RUN_AVERAGED);
+
+    BLI_task_scheduler_free(scheduler);
+
+    if (num_threads == num_threads_max) {
+      break;
+    }
+  }
+
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, PoolManySmallTasks)
+{
+  task_pool_test_do("Task pool - Many small tasks pushed from main thread", TASK_POOL_TEST_FLAT);
+}
+
+TEST(task, PoolManySmallTasksSpawned)
+{
+  task_pool_test_do("Task pool - Many small tasks spawned from worker threads",
+                    TASK_POOL_TEST_SPAWN);
+}
+
+TEST(task, PoolNested)
+{
+  task_pool_test_do("Task pool - Nested pools of spawned tasks", TASK_POOL_TEST_NESTED);
+}
+
+/* *** NUMA-aware scheduling of parallel ranges. *** */
+
+#define NUMA_NUM_ITEMS (1 << 24)
+#define NUMA_NUM_PASSES 10
+
+static void task_numa_init_func(void *__restrict userdata,
+                                const int index,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  float *data = (float *)userdata;
+  data[index] = (float)index;
+}
+
+static void task_numa_stream_func(void *__restrict userdata,
+                                  const int index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  float *data = (float *)userdata;
+  data[index] = data[index] * 0.5f + 1.0f;
+}
+
+static void task_numa_test_do(const bool use_numa)
+{
+  BLI_system_numa_scheduler_set(use_numa);
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4096;
+
+  /* Memory is first touched from the worker threads, so with a NUMA-aware scheduler its pages are
+   * spread over the nodes the same way following passes will access them. */
+  float *data = (float *)MEM_mallocN(sizeof(*data) * NUMA_NUM_ITEMS, __func__);
+  BLI_task_parallel_range(0, NUMA_NUM_ITEMS, data, task_numa_init_func, &settings);
+
+  const double init_time = PIL_check_seconds_timer();
+  for (int i = 0; i < NUMA_NUM_PASSES; i++) {
+    BLI_task_parallel_range(0, NUMA_NUM_ITEMS, data, task_numa_stream_func, &settings);
+  }
+  const double timing = PIL_check_seconds_timer() - init_time;
+
+  printf("\t%s scheduler (%d nodes): %d passes over %d items done in %fs\n",
+         use_numa ? "NUMA-aware" : "Default",
+         use_numa ? BLI_thread_numa_num_nodes() : 1,
+         NUMA_NUM_PASSES,
+         NUMA_NUM_ITEMS,
+         timing);
+
+  EXPECT_FLOAT_EQ(data[0], 2.0f - 2.0f / (1 << NUMA_NUM_PASSES));
+  EXPECT_FLOAT_EQ(data[NUMA_NUM_ITEMS - 1],
+                  (float)(NUMA_NUM_ITEMS - 1) / (1 << NUMA_NUM_PASSES) + data[0]);
+
+  MEM_freeN(data);
+  BLI_threadapi_exit();
+  BLI_system_numa_scheduler_set(false);
+}
+
+TEST(task, RangeIterNUMA)
+{
+  printf("\n========== STARTING Parallel range - NUMA-aware scheduling ==========\n");
+  task_numa_test_do(false);
+  task_numa_test_do(true);
+  printf("========== ENDED Parallel range - NUMA-aware scheduling ==========\n\n");
+}
@@ -0,0 +1,86 @@
+/* Apache License, Version 2.0 */
+
+#ifndef __BLENDER_TESTING_BLI_TASK_POOL_TEST_UTILS_H__
+#define __BLENDER_TESTING_BLI_TASK_POOL_TEST_UTILS_H__
+
+/* Task pool callbacks shared by the functional and performance tests of the task scheduler.
+ * Users include "atomic_ops.h", "BLI_utildefines.h" and "BLI_task.h" first. */
+
+/* Number of children pushed by each spawning task. */
+#define SPAWN_FANOUT 4
+
+typedef struct TaskPoolTestData {
+  TaskScheduler *scheduler;
+  uint32_t num_done;
+  /* Depth of the spawned tasks tree run by each #task_pool_nested_func. */
+  int nested_depth;
+  /* Optional work done by each spawned task, given its depth. */
+  void (*work_func)(const int depth);
+  /* Push spawned tasks to the global queue instead of the deque of their thread, like the
+   * scheduler did before it had work-stealing deques. */
+  bool use_global_queue;
+} TaskPoolTestData;
+
+/* Thread to push spawned tasks from, -1 pushes them to the global queue. */
+inline int task_pool_test_push_thread(const TaskPoolTestData *data, const int threadid)
+{
+  return data->use_global_queue ? -1 : threadid;
+}
+
+/* Similar to the way depsgraph evaluation schedules the children of a node once it's done. */
+inline void task_pool_spawn_func(TaskPool *__restrict pool, void *taskdata, int threadid)
+{
+  TaskPoolTestData *data = (TaskPoolTestData *)BLI_task_pool_userdata(pool);
+  const int depth = POINTER_AS_INT(taskdata);
+
+  if (data->work_func) {
+    data->work_func(depth);
+  }
+
+  if (depth > 0) {
+    const int push_threadid = task_pool_test_push_thread(data, threadid);
+    BLI_task_pool_delayed_push_begin(pool, push_threadid);
+    for (int i = 0; i < SPAWN_FANOUT; i++) {
+      BLI_task_pool_push_from_thread(pool,
+                                     task_pool_spawn_func,
+                                     POINTER_FROM_INT(depth - 1),
+                                     false,
+                                     TASK_PRIORITY_HIGH,
+                                     push_threadid);
+    }
+    BLI_task_pool_delayed_push_end(pool, push_threadid);
+  }
+  atomic_add_and_fetch_uint32(&data->num_done, 1);
+}
+
+/* Each task runs its own pool of spawned tasks, and waits for it. */
+inline void task_pool_nested_func(TaskPool *__restrict pool, void *UNUSED(taskdata), int threadid)
+{
+  TaskPoolTestData *data = (TaskPoolTestData *)BLI_task_pool_userdata(pool);
+  TaskPoolTestData nested_data = *data;
+  nested_data.num_done = 0;
+
+  TaskPool *nested_pool = BLI_task_pool_create(data->scheduler, &nested_data);
+  BLI_task_pool_push_from_thread(nested_pool,
+                                 task_pool_spawn_func,
+                                 POINTER_FROM_INT(data->nested_depth),
+                                 false,
+                                 TASK_PRIORITY_HIGH,
+                                 task_pool_test_push_thread(data, threadid));
+  BLI_task_pool_work_and_wait(nested_pool);
+  BLI_task_pool_free(nested_pool);
+
+  atomic_add_and_fetch_uint32(&data->num_done, nested_data.num_done);
+}
+
+/* Number of tasks run by #task_pool_spawn_func for a tree of given depth. */
+inline uint32_t spawn_tree_num_tasks(const int depth)
+{
+  uint32_t num_tasks = 0;
+  for (uint32_t i = 0, num_level = 1; i <= (uint32_t)depth; i++, num_level *= SPAWN_FANOUT) {
+    num_tasks += num_level;
+  }
+  return num_tasks;
+}
+
+#endif /* __BLENDER_TESTING_BLI_TASK_POOL_TEST_UTILS_H__ */
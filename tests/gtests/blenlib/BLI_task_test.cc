@@ -15,6 +15,8 @@ extern "C" {
 #include "BLI_task.h"
 };
 
+#include "BLI_task_pool_test_utils.h"
+
 #define NUM_ITEMS 10000
 
 /* *** Parallel iterations over range of integer values. *** */
@@ -253,3 +255,148 @@ TEST(task, ListBaseIter)
   MEM_freeN(items_buffer);
   BLI_threadapi_exit();
 }
+
+/* *** Task pool with tasks spawned from worker threads. *** */
+
+#define SPAWN_DEPTH 6
+
+TEST(task, PoolSpawnFromThread)
+{
+  BLI_threadapi_init();
+
+  /* Always use several threads, so tasks get stolen between them. */
+  TaskScheduler *scheduler = BLI_task_scheduler_create(8);
+
+  for (int i = 0; i < 10; i++) {
+    TaskPoolTestData data = {scheduler, 0, SPAWN_DEPTH / 2, NULL, false};
+    TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+    BLI_task_pool_push(
+        pool, task_pool_spawn_func, POINTER_FROM_INT(SPAWN_DEPTH), false, TASK_PRIORITY_HIGH);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+
+    EXPECT_EQ(data.num_done, spawn_tree_num_tasks(SPAWN_DEPTH));
+  }
+
+  BLI_task_scheduler_free(scheduler);
+  BLI_threadapi_exit();
+}
+
+TEST(task, PoolNested)
+{
+  const int num_tasks = 64;
+
+  BLI_threadapi_init();
+
+  TaskScheduler *scheduler = BLI_task_scheduler_create(8);
+
+  for (int i = 0; i < 10; i++) {
+    TaskPoolTestData data = {scheduler, 0, SPAWN_DEPTH / 2, NULL, false};
+    TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+    for (int j = 0; j < num_tasks; j++) {
+      BLI_task_pool_push(pool, task_pool_nested_func, NULL, false, TASK_PRIORITY_HIGH);
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+
+    EXPECT_EQ(data.num_done, num_tasks * spawn_tree_num_tasks(SPAWN_DEPTH / 2));
+  }
+
+  BLI_task_scheduler_free(scheduler);
+  BLI_threadapi_exit();
+}
+
+/* *** Nested pools mixing their tasks with the ones of the outer pool. *** */
+
+typedef struct TaskPoolMixedData {
+  TaskScheduler *scheduler;
+  TaskPool *outer_pool;
+  uint32_t num_outer_done;
+  uint32_t num_nested_done;
+} TaskPoolMixedData;
+
+static void task_pool_mixed_outer_leaf_func(TaskPool *__restrict pool,
+                                            void *UNUSED(taskdata),
+                                            int UNUSED(threadid))
+{
+  TaskPoolMixedData *data = (TaskPoolMixedData *)BLI_task_pool_userdata(pool);
+  atomic_add_and_fetch_uint32(&data->num_outer_done, 1);
+}
+
+static void task_pool_mixed_nested_leaf_func(TaskPool *__restrict pool,
+                                             void *UNUSED(taskdata),
+                                             int UNUSED(threadid))
+{
+  TaskPoolMixedData *data = (TaskPoolMixedData *)BLI_task_pool_userdata(pool);
+  atomic_add_and_fetch_uint32(&data->num_nested_done, 1);
+}
+
+/* Pushes a task of its own pool, then one of the outer pool on top of it. */
+static void task_pool_mixed_nested_func(TaskPool *__restrict pool,
+                                        void *UNUSED(taskdata),
+                                        int threadid)
+{
+  TaskPoolMixedData *data = (TaskPoolMixedData *)BLI_task_pool_userdata(pool);
+  BLI_task_pool_push_from_thread(
+      pool, task_pool_mixed_nested_leaf_func, NULL, false, TASK_PRIORITY_HIGH, threadid);
+  BLI_task_pool_push_from_thread(data->outer_pool,
+                                 task_pool_mixed_outer_leaf_func,
+                                 NULL,
+                                 false,
+                                 TASK_PRIORITY_HIGH,
+                                 threadid);
+  atomic_add_and_fetch_uint32(&data->num_nested_done, 1);
+}
+
+/* Pushes a task of the outer pool, then waits for a nested pool which pushes tasks of both
+ * pools from the same thread. The tasks of the nested pool must not end up out of reach of the
+ * waiting threads, between tasks of the outer pool. */
+static void task_pool_mixed_outer_func(TaskPool *__restrict pool,
+                                       void *UNUSED(taskdata),
+                                       int threadid)
+{
+  TaskPoolMixedData *data = (TaskPoolMixedData *)BLI_task_pool_userdata(pool);
+  BLI_task_pool_push_from_thread(
+      pool, task_pool_mixed_outer_leaf_func, NULL, false, TASK_PRIORITY_HIGH, threadid);
+
+  TaskPoolMixedData nested_data = *data;
+  nested_data.num_nested_done = 0;
+  TaskPool *nested_pool = BLI_task_pool_create(data->scheduler, &nested_data);
+  for (int i = 0; i < SPAWN_FANOUT; i++) {
+    BLI_task_pool_push_from_thread(
+        nested_pool, task_pool_mixed_nested_func, NULL, false, TASK_PRIORITY_HIGH, threadid);
+  }
+  BLI_task_pool_work_and_wait(nested_pool);
+  BLI_task_pool_free(nested_pool);
+
+  atomic_add_and_fetch_uint32(&data->num_nested_done, nested_data.num_nested_done);
+  atomic_add_and_fetch_uint32(&data->num_outer_done, 1);
+}
+
+TEST(task, PoolNestedMixed)
+{
+  const int num_tasks = 64;
+
+  BLI_threadapi_init();
+
+  /* Few threads, so all of them end up waiting for nested pools at the same time. */
+  TaskScheduler *scheduler = BLI_task_scheduler_create(2);
+
+  for (int i = 0; i < 100; i++) {
+    TaskPoolMixedData data = {scheduler, NULL, 0, 0};
+    TaskPool *pool = BLI_task_pool_create(scheduler, &data);
+    data.outer_pool = pool;
+    for (int j = 0; j < num_tasks; j++) {
+      BLI_task_pool_push(pool, task_pool_mixed_outer_func, NULL, false, TASK_PRIORITY_HIGH);
+    }
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+
+    /* Each outer task pushes one outer leaf, and one more from each of its nested tasks. */
+    EXPECT_EQ(data.num_outer_done, (uint32_t)(num_tasks * (2 + SPAWN_FANOUT)));
+    EXPECT_EQ(data.num_nested_done, (uint32_t)(num_tasks * 2 * SPAWN_FANOUT));
+  }
+
+  BLI_task_scheduler_free(scheduler);
+  BLI_threadapi_exit();
+}
@@ -0,0 +1,189 @@
+/* Apache License, Version 2.0 */
+
+#include "blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "COM_compositor.h"
+
+extern "C" {
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_global.h"
+#include "BKE_image.h"
+#include "BKE_main.h"
+#include "BKE_node.h"
+#include "BKE_scene.h"
+
+#include "DNA_image_types.h"
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+}
+
+#define IMAGE_WIDTH 64
+#define IMAGE_HEIGHT 48
+/* Both models use the same kernels, only the summation order of some filters differs. */
+#define TOLERANCE 1e-4f
+
+static int test_break(void * /*handle*/)
+{
+  return 0;
+}
+
+static void progress(void * /*handle*/, float /*progress*/)
+{
+}
+
+static void stats_draw(void * /*handle*/, const char * /*str*/)
+{
+}
+
+/* Uses the base test for the initialization of Blender, the node tree is created from scratch:
+ * a box mask is blurred, glared and defocused by its own value, and shown in a viewer. */
+class ExecutionModelTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  bNodeTree *ntree = nullptr;
+  bNode *viewer = nullptr;
+
+  virtual void SetUp()
+  {
+    /* Viewers are not executed in background mode. */
+    G.background = false;
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    scene->r.xsch = IMAGE_WIDTH;
+    scene->r.ysch = IMAGE_HEIGHT;
+    scene->r.size = 100;
+
+    ntree = ntreeAddTree(bmain, "Compositing", "CompositorNodeTree");
+    ntree->test_break = test_break;
+    ntree->progress = progress;
+    ntree->stats_draw = stats_draw;
+
+    bNode *mask = nodeAddStaticNode(NULL, ntree, CMP_NODE_MASK_BOX);
+    NodeBoxMask *mask_data = (NodeBoxMask *)mask->storage;
+    mask_data->width = 0.3f;
+    mask_data->height = 0.4f;
+
+    bNode *blur = nodeAddStaticNode(NULL, ntree, CMP_NODE_BLUR);
+    NodeBlurData *blur_data = (NodeBlurData *)blur->storage;
+    blur_data->sizex = 4;
+    blur_data->sizey = 3;
+
+    bNode *glare = nodeAddStaticNode(NULL, ntree, CMP_NODE_GLARE);
+    ((NodeGlare *)glare->storage)->threshold = 0.5f;
+
+    bNode *defocus = nodeAddStaticNode(NULL, ntree, CMP_NODE_DEFOCUS);
+    NodeDefocus *defocus_data = (NodeDefocus *)defocus->storage;
+    defocus_data->scale = 4.0f;
+    defocus_data->maxblur = 8.0f;
+
+    viewer = nodeAddStaticNode(NULL, ntree, CMP_NODE_VIEWER);
+
+    link(mask, "Mask", blur, "Image");
+    link(blur, "Image", glare, "Image");
+    link(glare, "Image", defocus, "Image");
+    link(mask, "Mask", defocus, "Z");
+    link(defocus, "Image", viewer, "Image");
+    ntreeUpdateTree(bmain, ntree);
+    viewer->flag |= NODE_DO_OUTPUT | NODE_DO_OUTPUT_RECALC;
+  }
+
+  virtual void TearDown()
+  {
+    COM_deinitialize();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    G.background = true;
+
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  void link(bNode *fromnode, const char *fromsock, bNode *tonode, const char *tosock)
+  {
+    nodeAddLink(ntree,
+                fromnode,
+                nodeFindSocket(fromnode, SOCK_OUT, fromsock),
+                tonode,
+                nodeFindSocket(tonode, SOCK_IN, tosock));
+  }
+
+  /* Execute the tree in the given mode, and return a copy of the pixels of the viewer. Pixels
+   * outside of the viewer border stay black. */
+  float *execute(short execution_mode)
+  {
+    Image *image = (Image *)viewer->id;
+    ImageUser *iuser = (ImageUser *)viewer->storage;
+    void *lock;
+    ImBuf *ibuf = BKE_image_acquire_ibuf(image, iuser, &lock);
+    if (ibuf && ibuf->rect_float) {
+      memset(ibuf->rect_float, 0, sizeof(float) * 4 * ibuf->x * ibuf->y);
+    }
+    BKE_image_release_ibuf(image, ibuf, lock);
+
+    ntree->execution_mode = execution_mode;
+    COM_execute(&scene->r,
+                scene,
+                ntree,
+                false,
+                &scene->view_settings,
+                &scene->display_settings,
+                "");
+
+    float *pixels = NULL;
+    ibuf = BKE_image_acquire_ibuf(image, iuser, &lock);
+    EXPECT_TRUE(ibuf != NULL && ibuf->rect_float != NULL);
+    if (ibuf && ibuf->rect_float) {
+      EXPECT_EQ(IMAGE_WIDTH, ibuf->x);
+      EXPECT_EQ(IMAGE_HEIGHT, ibuf->y);
+      pixels = (float *)MEM_dupallocN(ibuf->rect_float);
+    }
+    BKE_image_release_ibuf(image, ibuf, lock);
+    return pixels;
+  }
+
+  /* Compare the viewer results of both execution models. */
+  void expect_same_results()
+  {
+    float *tiled = execute(NTREE_EXECUTION_MODE_TILED);
+    float *full_frame = execute(NTREE_EXECUTION_MODE_FULL_FRAME);
+    ASSERT_TRUE(tiled != NULL && full_frame != NULL);
+
+    float max_difference = 0.0f;
+    float max_value = 0.0f;
+    for (int i = 0; i < IMAGE_WIDTH * IMAGE_HEIGHT * 4; i++) {
+      max_difference = max_ff(max_difference, fabsf(tiled[i] - full_frame[i]));
+      max_value = max_ff(max_value, tiled[i]);
+    }
+    EXPECT_LE(max_difference, TOLERANCE);
+    /* Not trivially the same. */
+    EXPECT_GT(max_value, 0.0f);
+
+    MEM_freeN(tiled);
+    MEM_freeN(full_frame);
+  }
+};
+
+TEST_F(ExecutionModelTest, FullImage)
+{
+  expect_same_results();
+}
+
+TEST_F(ExecutionModelTest, ViewerBorder)
+{
+  /* Only the area of interest of the border is calculated in full frame mode, the blurs still
+   * read the pixels around it. */
+  ntree->flag |= NTREE_VIEWER_BORDER;
+  ntree->viewer_border.xmin = 0.4f;
+  ntree->viewer_border.xmax = 0.8f;
+  ntree->viewer_border.ymin = 0.3f;
+  ntree->viewer_border.ymax = 0.6f;
+  expect_same_results();
+}
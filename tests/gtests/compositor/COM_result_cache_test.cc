@@ -0,0 +1,190 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "COM_FullFrameExecutionModel.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_ResultCache.h"
+
+extern "C" {
+#include "BLI_rect.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_node.h"
+
+#include "DNA_node_types.h"
+#include "DNA_userdef_types.h"
+}
+
+/* Color buffers of a quarter MB, four of them fit in a cache limit of 1 MB. */
+#define BUFFER_SIZE 128
+#define CACHE_LIMIT_MB 1
+
+class ResultCacheTest : public testing::Test {
+ protected:
+  int m_previous_limit;
+
+  virtual void SetUp()
+  {
+    m_previous_limit = U.compositor_cache_limit;
+    U.compositor_cache_limit = CACHE_LIMIT_MB;
+  }
+
+  virtual void TearDown()
+  {
+    ResultCache::clear();
+    U.compositor_cache_limit = m_previous_limit;
+  }
+
+  static MemoryBuffer *create_buffer(int size = BUFFER_SIZE)
+  {
+    rcti rect;
+    BLI_rcti_init(&rect, 0, size, 0, size);
+    return new MemoryBuffer(COM_DT_COLOR, &rect);
+  }
+
+  /* Add a buffer which is not in use anymore. */
+  static MemoryBuffer *add_released(ResultCacheKey key)
+  {
+    MemoryBuffer *buffer = create_buffer();
+    EXPECT_TRUE(ResultCache::add(key, buffer));
+    ResultCache::release(buffer);
+    return buffer;
+  }
+
+  /* Check if the key is in the cache, without keeping it in use. */
+  static bool contains(ResultCacheKey key)
+  {
+    MemoryBuffer *buffer = ResultCache::acquire(key);
+    if (buffer == NULL) {
+      return false;
+    }
+    ResultCache::release(buffer);
+    return true;
+  }
+};
+
+TEST_F(ResultCacheTest, AddAcquire)
+{
+  MemoryBuffer *buffer = add_released(1);
+
+  MemoryBuffer *acquired = ResultCache::acquire(1);
+  EXPECT_EQ(buffer, acquired);
+  ResultCache::release(acquired);
+  EXPECT_EQ(NULL, ResultCache::acquire(2));
+}
+
+TEST_F(ResultCacheTest, AddReplacesKey)
+{
+  add_released(1);
+  MemoryBuffer *buffer = add_released(1);
+
+  MemoryBuffer *acquired = ResultCache::acquire(1);
+  EXPECT_EQ(buffer, acquired);
+  ResultCache::release(acquired);
+}
+
+TEST_F(ResultCacheTest, EvictLeastRecentlyUsed)
+{
+  for (ResultCacheKey key = 1; key <= 4; key++) {
+    add_released(key);
+  }
+  /* Key 2 becomes the least recently used. */
+  EXPECT_TRUE(contains(1));
+
+  add_released(5);
+  EXPECT_FALSE(contains(2));
+  EXPECT_TRUE(contains(1));
+  EXPECT_TRUE(contains(3));
+  EXPECT_TRUE(contains(4));
+  EXPECT_TRUE(contains(5));
+}
+
+TEST_F(ResultCacheTest, KeepInUse)
+{
+  MemoryBuffer *buffers[4];
+  for (int i = 0; i < 4; i++) {
+    buffers[i] = create_buffer();
+    EXPECT_TRUE(ResultCache::add(i + 1, buffers[i]));
+  }
+  /* Nothing in use can be freed to make room, the cache exceeds its limit until the new buffer
+   * is released, it's the only one that can be freed then. */
+  MemoryBuffer *buffer = create_buffer();
+  EXPECT_TRUE(ResultCache::add(5, buffer));
+  EXPECT_TRUE(contains(5));
+  ResultCache::release(buffer);
+  EXPECT_FALSE(contains(5));
+
+  for (int i = 0; i < 4; i++) {
+    ResultCache::release(buffers[i]);
+  }
+  for (ResultCacheKey key = 1; key <= 4; key++) {
+    EXPECT_TRUE(contains(key));
+  }
+}
+
+TEST_F(ResultCacheTest, SizeLimit)
+{
+  /* Larger than the whole cache, the caller keeps owning it. */
+  MemoryBuffer *buffer = create_buffer(BUFFER_SIZE * 4);
+  EXPECT_FALSE(ResultCache::add(1, buffer));
+  EXPECT_EQ(NULL, ResultCache::acquire(1));
+  delete buffer;
+
+  U.compositor_cache_limit = 0;
+  buffer = create_buffer();
+  EXPECT_FALSE(ResultCache::add(1, buffer));
+  delete buffer;
+}
+
+TEST_F(ResultCacheTest, ClearInUse)
+{
+  MemoryBuffer *buffer = create_buffer();
+  EXPECT_TRUE(ResultCache::add(1, buffer));
+  ResultCache::clear();
+  EXPECT_EQ(NULL, ResultCache::acquire(1));
+  /* Freed on release. */
+  ResultCache::release(buffer);
+}
+
+TEST(ResultCacheHash, Key)
+{
+  ResultCacheHash hash_a, hash_b;
+  EXPECT_EQ(hash_a.getKey(), hash_b.getKey());
+  EXPECT_NE((ResultCacheKey)COM_RESULT_CACHE_KEY_NONE, hash_a.getKey());
+
+  hash_a.add(1);
+  hash_b.add(2);
+  EXPECT_NE(hash_a.getKey(), hash_b.getKey());
+
+  ResultCacheHash hash_c;
+  hash_c.add(1);
+  EXPECT_EQ(hash_a.getKey(), hash_c.getKey());
+}
+
+static ResultCacheKey node_key(const bNode *node)
+{
+  ResultCacheHash hash;
+  EXPECT_TRUE(FullFrameExecutionModel::hashNode(node, hash));
+  return hash.getKey();
+}
+
+TEST(ResultCacheHash, Node)
+{
+  bNode node = {NULL};
+  BLI_strncpy(node.idname, "CompositorNodeBlur", sizeof(node.idname));
+  node.type = CMP_NODE_BLUR;
+  const ResultCacheKey key = node_key(&node);
+
+  /* UI only flags keep the key. */
+  node.flag |= NODE_SELECT | NODE_HIDDEN;
+  EXPECT_EQ(key, node_key(&node));
+
+  /* Settings change it. */
+  node.flag |= NODE_MUTED;
+  const ResultCacheKey muted_key = node_key(&node);
+  EXPECT_NE(key, muted_key);
+  node.custom1 = 1;
+  EXPECT_NE(muted_key, node_key(&node));
+}
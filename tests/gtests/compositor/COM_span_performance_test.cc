@@ -0,0 +1,175 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MixOperation.h"
+#include "COM_NodeOperation.h"
+
+extern "C" {
+#include "BLI_math_base.h"
+#include "BLI_rect.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+}
+
+#define IMAGE_WIDTH 1920
+#define IMAGE_HEIGHT 1080
+#define NUM_RUN_AVERAGED 10
+
+/* Operation reading its result from a buffer, like operations that have been executed by the
+ * full frame execution model. */
+class BufferSourceOperation : public NodeOperation {
+ public:
+  BufferSourceOperation(MemoryBuffer *buffer)
+  {
+    this->addOutputSocket(buffer->get_num_channels() == 1 ? COM_DT_VALUE : COM_DT_COLOR);
+    this->setOutputBuffer(buffer);
+  }
+};
+
+static MemoryBuffer *create_buffer(DataType datatype, unsigned int seed)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, IMAGE_WIDTH, 0, IMAGE_HEIGHT);
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, &rect);
+
+  float *elem = buffer->getBuffer();
+  const int num_elem = IMAGE_WIDTH * IMAGE_HEIGHT * buffer->get_num_channels();
+  for (int i = 0; i < num_elem; i++) {
+    /* Values in the [0..2) range with some zeros, to cover the clamping and division cases. */
+    seed = seed * 1103515245 + 12345;
+    elem[i] = (i % 97 == 0) ? 0.0f : (float)((seed >> 8) & 0xffff) / 32768.0f;
+  }
+  return buffer;
+}
+
+static void span_performance_test_do(const char *id, NodeOperation *operation)
+{
+  const unsigned int num_inputs = operation->getNumberOfInputSockets();
+  MemoryBuffer *inputs[COM_SPAN_MAX_INPUTS];
+  BufferSourceOperation *sources[COM_SPAN_MAX_INPUTS];
+  for (unsigned int i = 0; i < num_inputs; i++) {
+    inputs[i] = create_buffer(operation->getInputSocket(i)->getDataType(), i + 1);
+    sources[i] = new BufferSourceOperation(inputs[i]);
+    operation->getInputSocket(i)->setLink(sources[i]->getOutputSocket());
+  }
+  operation->initExecution();
+
+  rcti rect;
+  BLI_rcti_init(&rect, 0, IMAGE_WIDTH, 0, IMAGE_HEIGHT);
+  const DataType datatype = operation->getOutputSocket()->getDataType();
+  const int num_channels = COM_num_channels_data_type(datatype);
+  MemoryBuffer *pixel_output = new MemoryBuffer(datatype, &rect);
+  MemoryBuffer *span_output = new MemoryBuffer(datatype, &rect);
+
+  double pixel_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    float color[4];
+    for (int y = 0; y < IMAGE_HEIGHT; y++) {
+      for (int x = 0; x < IMAGE_WIDTH; x++) {
+        operation->readSampled(color, x, y, COM_PS_NEAREST);
+        memcpy(pixel_output->getElem(x, y), color, sizeof(float) * num_channels);
+      }
+    }
+    pixel_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  double span_timing = 0.0;
+  for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+    const double init_time = PIL_check_seconds_timer();
+    operation->updateMemoryBufferPartial(span_output, &rect, inputs);
+    span_timing += PIL_check_seconds_timer() - init_time;
+  }
+
+  printf("\t%s: per pixel %fs, spans %fs on average over %d runs (%.2fx)\n",
+         id,
+         pixel_timing / NUM_RUN_AVERAGED,
+         span_timing / NUM_RUN_AVERAGED,
+         NUM_RUN_AVERAGED,
+         pixel_timing / span_timing);
+
+  const float *pixel_elem = pixel_output->getBuffer();
+  const float *span_elem = span_output->getBuffer();
+  float max_difference = 0.0f;
+  for (int i = 0; i < IMAGE_WIDTH * IMAGE_HEIGHT * num_channels; i++) {
+    max_difference = max_ff(max_difference, fabsf(pixel_elem[i] - span_elem[i]));
+  }
+  EXPECT_NEAR(max_difference, 0.0f, 1e-5f);
+
+  /* Spans read from the input operations, as the tiled execution model does. */
+  float row[IMAGE_WIDTH * COM_NUM_CHANNELS_COLOR];
+  operation->readSpan(row, 0, IMAGE_HEIGHT / 2, IMAGE_WIDTH);
+  EXPECT_EQ(memcmp(row,
+                   span_output->getElem(0, IMAGE_HEIGHT / 2),
+                   sizeof(float) * IMAGE_WIDTH * num_channels),
+            0);
+
+  operation->deinitExecution();
+  delete pixel_output;
+  delete span_output;
+  for (unsigned int i = 0; i < num_inputs; i++) {
+    delete sources[i];
+    delete inputs[i];
+  }
+  delete operation;
+}
+
+TEST(compositor_span, MixBlend)
+{
+  span_performance_test_do("Mix Blend", new MixBlendOperation());
+}
+
+TEST(compositor_span, MixAdd)
+{
+  MixAddOperation *operation = new MixAddOperation();
+  operation->setUseClamp(true);
+  span_performance_test_do("Mix Add clamped", operation);
+}
+
+TEST(compositor_span, MixMultiply)
+{
+  MixMultiplyOperation *operation = new MixMultiplyOperation();
+  operation->setUseValueAlphaMultiply(true);
+  span_performance_test_do("Mix Multiply alpha", operation);
+}
+
+TEST(compositor_span, MixScreen)
+{
+  span_performance_test_do("Mix Screen", new MixScreenOperation());
+}
+
+TEST(compositor_span, MathAdd)
+{
+  span_performance_test_do("Math Add", new MathAddOperation());
+}
+
+TEST(compositor_span, MathMultiply)
+{
+  MathMultiplyOperation *operation = new MathMultiplyOperation();
+  operation->setUseClamp(true);
+  span_performance_test_do("Math Multiply clamped", operation);
+}
+
+TEST(compositor_span, MathDivide)
+{
+  span_performance_test_do("Math Divide", new MathDivideOperation());
+}
+
+TEST(compositor_span, ColorBalanceLGG)
+{
+  const float lift[3] = {0.9f, 1.0f, 1.1f};
+  const float gain[3] = {1.2f, 1.0f, 0.8f};
+  const float gamma_inv[3] = {1.0f / 1.1f, 1.0f, 1.0f / 0.9f};
+  ColorBalanceLGGOperation *operation = new ColorBalanceLGGOperation();
+  operation->setLift(lift);
+  operation->setGain(gain);
+  operation->setGammaInv(gamma_inv);
+  span_performance_test_do("Color Balance LGG", operation);
+}
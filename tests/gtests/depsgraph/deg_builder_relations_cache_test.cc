@@ -0,0 +1,174 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+
+#include "BKE_collection.h"
+#include "BKE_constraint.h"
+#include "BKE_global.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+}
+
+/* Uses the base test for the initialization of Blender, the scene is created from scratch.
+ *
+ * The requester object has a shrinkwrap constraint which requests normals and the shrinkwrap
+ * boundary of the target mesh object. The other object is parented to the target, so tagging it
+ * rebuilds relations of the target but not of the requester. */
+class RelationsCacheTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+  Object *target = nullptr;
+  Object *requester = nullptr;
+  Object *child = nullptr;
+  int previous_flag = 0;
+
+  virtual void SetUp()
+  {
+    previous_flag = G.f;
+    G.f |= G_FLAG_DEPSGRAPH_INCREMENTAL_RELATIONS;
+
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    target = BKE_object_add_only_object(bmain, OB_MESH, "Target");
+    target->data = mesh;
+    id_us_plus(&mesh->id);
+    BKE_collection_object_add(bmain, scene->master_collection, target);
+
+    requester = BKE_object_add_only_object(bmain, OB_EMPTY, "Requester");
+    bConstraint *con = BKE_constraint_add_for_object(
+        requester, "Shrinkwrap", CONSTRAINT_TYPE_SHRINKWRAP);
+    bShrinkwrapConstraint *data = static_cast<bShrinkwrapConstraint *>(con->data);
+    data->target = target;
+    data->shrinkType = MOD_SHRINKWRAP_TARGET_PROJECT;
+    data->flag |= CON_SHRINKWRAP_TRACK_NORMAL;
+    BKE_collection_object_add(bmain, scene->master_collection, requester);
+
+    child = BKE_object_add_only_object(bmain, OB_EMPTY, "Child");
+    child->parent = target;
+    child->partype = PAROBJECT;
+    BKE_collection_object_add(bmain, scene->master_collection, child);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+  }
+
+  virtual void TearDown()
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+    G.f = previous_flag;
+
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  int num_incremental_builds()
+  {
+    int num_full_builds, num_incremental_builds;
+    double full_builds_time, incremental_builds_time;
+    DEG_stats_relations_build(depsgraph,
+                              &num_full_builds,
+                              &full_builds_time,
+                              &num_incremental_builds,
+                              &incremental_builds_time);
+    return num_incremental_builds;
+  }
+
+  /* Compare the graph with a graph built from scratch. */
+  void expect_same_as_full_build()
+  {
+    Depsgraph *full_depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(full_depsgraph, bmain, scene, view_layer);
+
+    size_t outer, operations, relations;
+    size_t full_outer, full_operations, full_relations;
+    DEG_stats_simple(depsgraph, &outer, &operations, &relations);
+    DEG_stats_simple(full_depsgraph, &full_outer, &full_operations, &full_relations);
+    EXPECT_EQ(full_outer, outer);
+    EXPECT_EQ(full_operations, operations);
+    EXPECT_EQ(full_relations, relations);
+
+    for (Object *object : {target, requester, child}) {
+      EXPECT_EQ(DEG_get_eval_flags_for_id(full_depsgraph, &object->id),
+                DEG_get_eval_flags_for_id(depsgraph, &object->id));
+      CustomData_MeshMasks masks, full_masks;
+      DEG_get_customdata_mask_for_object(depsgraph, object, &masks);
+      DEG_get_customdata_mask_for_object(full_depsgraph, object, &full_masks);
+      EXPECT_EQ(full_masks.vmask, masks.vmask);
+      EXPECT_EQ(full_masks.emask, masks.emask);
+      EXPECT_EQ(full_masks.fmask, masks.fmask);
+      EXPECT_EQ(full_masks.pmask, masks.pmask);
+      EXPECT_EQ(full_masks.lmask, masks.lmask);
+    }
+
+    DEG_graph_free(full_depsgraph);
+  }
+};
+
+TEST_F(RelationsCacheTest, KeepRequestsOfRequesterNotRebuilt)
+{
+  child->partype = PARVERT1;
+  DEG_graph_id_tag_relations_update(depsgraph, &child->id);
+  DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+  EXPECT_EQ(1, num_incremental_builds());
+
+  CustomData_MeshMasks masks;
+  DEG_get_customdata_mask_for_object(depsgraph, target, &masks);
+  EXPECT_TRUE(masks.vmask & CD_MASK_NORMAL);
+  EXPECT_TRUE(masks.vmask & CD_MASK_ORIGINDEX);
+  EXPECT_TRUE(DEG_get_eval_flags_for_id(depsgraph, &target->id) &
+              DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY);
+  expect_same_as_full_build();
+}
+
+TEST_F(RelationsCacheTest, DropRequestsOfRebuiltRequester)
+{
+  BKE_constraints_free(&requester->constraints);
+  DEG_graph_id_tag_relations_update(depsgraph, &requester->id);
+  DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+  EXPECT_EQ(1, num_incremental_builds());
+
+  CustomData_MeshMasks masks;
+  DEG_get_customdata_mask_for_object(depsgraph, target, &masks);
+  EXPECT_FALSE(masks.vmask & CD_MASK_NORMAL);
+  EXPECT_FALSE(DEG_get_eval_flags_for_id(depsgraph, &target->id) &
+               DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY);
+  expect_same_as_full_build();
+}
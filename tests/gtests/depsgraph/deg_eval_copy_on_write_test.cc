@@ -0,0 +1,278 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "blendfile_loading_base_test.h"
+
+extern "C" {
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_collection.h"
+#include "BKE_constraint.h"
+#include "BKE_customdata.h"
+#include "BKE_library.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+}
+
+/* Uses the base test for the initialization of Blender, the scene is created from scratch. */
+class CopyOnWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  Object *object = nullptr;
+  Mesh *mesh = nullptr;
+
+  virtual void SetUp()
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+
+    /* Two loose edges. */
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = 4;
+    mesh->totedge = 2;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_CALLOC, nullptr, mesh->totedge);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int i = 0; i < mesh->totvert; i++) {
+      mesh->mvert[i].co[0] = (float)i;
+    }
+    for (int i = 0; i < mesh->totedge; i++) {
+      mesh->medge[i].v1 = i * 2;
+      mesh->medge[i].v2 = i * 2 + 1;
+    }
+
+    object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    object->data = mesh;
+    id_us_plus(&mesh->id);
+    BLI_addtail(&object->modifiers, modifier_new(eModifierType_Mirror));
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+
+    ViewLayer *view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  virtual void TearDown()
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    bmain = nullptr;
+
+    BlendfileLoadingBaseTest::TearDown();
+  }
+};
+
+TEST_F(CopyOnWriteTest, ObjectTransformInPlace)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+  ModifierData *md_eval = static_cast<ModifierData *>(object_eval->modifiers.first);
+  ASSERT_NE(nullptr, md_eval);
+  /* Only a full copy of the object would restore the name from the original. */
+  BLI_strncpy(md_eval->name, "Evaluated", sizeof(md_eval->name));
+
+  object->loc[0] = 2.0f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(object_eval, DEG_get_evaluated_object(depsgraph, object));
+  EXPECT_EQ(md_eval, object_eval->modifiers.first);
+  EXPECT_STREQ("Evaluated", md_eval->name);
+  EXPECT_FLOAT_EQ(2.0f, object_eval->loc[0]);
+  EXPECT_FLOAT_EQ(2.0f, object_eval->obmat[3][0]);
+}
+
+TEST_F(CopyOnWriteTest, ObjectFullCopy)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+  ModifierData *md_eval = static_cast<ModifierData *>(object_eval->modifiers.first);
+  BLI_strncpy(md_eval->name, "Evaluated", sizeof(md_eval->name));
+
+  /* Other changes than transform still go through a full copy. */
+  object->loc[0] = 2.0f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM | ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  md_eval = static_cast<ModifierData *>(object_eval->modifiers.first);
+  EXPECT_STREQ(static_cast<ModifierData *>(object->modifiers.first)->name, md_eval->name);
+  EXPECT_FLOAT_EQ(2.0f, object_eval->obmat[3][0]);
+}
+
+TEST_F(CopyOnWriteTest, ObjectTrackAxisFullCopy)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+
+  /* Settings which only tag the transform are not transform channels, they need the full copy. */
+  object->trackflag = OB_NEGZ;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(OB_NEGZ, object_eval->trackflag);
+}
+
+TEST_F(CopyOnWriteTest, ObjectConstraintFullCopy)
+{
+  bConstraint *con = BKE_constraint_add_for_object(object, "Limit", CONSTRAINT_TYPE_LOCLIMIT);
+  DEG_relations_tag_update(bmain);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+  bConstraint *con_eval = static_cast<bConstraint *>(object_eval->constraints.first);
+  ASSERT_NE(nullptr, con_eval);
+  EXPECT_FLOAT_EQ(1.0f, con_eval->enforce);
+
+  con->enforce = 0.5f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  con_eval = static_cast<bConstraint *>(object_eval->constraints.first);
+  EXPECT_FLOAT_EQ(0.5f, con_eval->enforce);
+}
+
+TEST_F(CopyOnWriteTest, ObjectTransformInPlaceMixedEdit)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+
+  /* Another edit tagged in the same update cancels the in-place update, in any order. */
+  object->trackflag = OB_NEGZ;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  object->loc[0] = 2.0f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(OB_NEGZ, object_eval->trackflag);
+  EXPECT_FLOAT_EQ(2.0f, object_eval->loc[0]);
+
+  object->loc[0] = 3.0f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM | ID_RECALC_TRANSFORM_INPLACE);
+  object->trackflag = OB_POSY;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_TRANSFORM);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(OB_POSY, object_eval->trackflag);
+  EXPECT_FLOAT_EQ(3.0f, object_eval->loc[0]);
+}
+
+TEST_F(CopyOnWriteTest, ModifierSettingsInPlace)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+  MirrorModifierData *mmd_eval = static_cast<MirrorModifierData *>(object_eval->modifiers.first);
+  /* Only a full copy of the object would restore the track axis from the original. */
+  object_eval->trackflag = OB_NEGZ;
+
+  MirrorModifierData *mmd = static_cast<MirrorModifierData *>(object->modifiers.first);
+  mmd->tolerance = 0.5f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_GEOMETRY | ID_RECALC_MODIFIER_INPLACE);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(mmd_eval, object_eval->modifiers.first);
+  EXPECT_EQ(&mmd->modifier, mmd_eval->modifier.orig_modifier_data);
+  EXPECT_FLOAT_EQ(0.5f, mmd_eval->tolerance);
+  EXPECT_EQ(OB_NEGZ, object_eval->trackflag);
+}
+
+TEST_F(CopyOnWriteTest, ModifierSettingsInPlaceMixedEdit)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+
+  /* Another edit tagged in the same update cancels the in-place update. */
+  object->trackflag = OB_NEGZ;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_GEOMETRY);
+  MirrorModifierData *mmd = static_cast<MirrorModifierData *>(object->modifiers.first);
+  mmd->tolerance = 0.5f;
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_GEOMETRY | ID_RECALC_MODIFIER_INPLACE);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(OB_NEGZ, object_eval->trackflag);
+  EXPECT_FLOAT_EQ(0.5f, static_cast<MirrorModifierData *>(object_eval->modifiers.first)->tolerance);
+}
+
+TEST_F(CopyOnWriteTest, ModifierStackFullCopy)
+{
+  Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+
+  /* Modifiers added or removed are not synced in place. */
+  BLI_addtail(&object->modifiers, modifier_new(eModifierType_Array));
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_GEOMETRY | ID_RECALC_MODIFIER_INPLACE);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(2, BLI_listbase_count(&object_eval->modifiers));
+}
+
+TEST_F(CopyOnWriteTest, MeshLayersShared)
+{
+  Mesh *mesh_eval = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+  ASSERT_NE(mesh, mesh_eval);
+  /* The evaluated mesh doesn't get its own copy of the geometry. */
+  EXPECT_EQ(mesh->mvert, mesh_eval->mvert);
+  EXPECT_EQ(mesh->medge, mesh_eval->medge);
+  MEdge *medge = mesh->medge;
+
+  /* Writers get their own copy of the layer they modify, the evaluated mesh keeps the previous
+   * state until it is updated. */
+  MVert *mvert_prev = mesh->mvert;
+  mesh->mvert = static_cast<MVert *>(
+      CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert));
+  EXPECT_NE(mvert_prev, mesh->mvert);
+  mesh->mvert[0].co[0] = 10.0f;
+  EXPECT_EQ(mvert_prev, mesh_eval->mvert);
+  EXPECT_FLOAT_EQ(0.0f, mesh_eval->mvert[0].co[0]);
+
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(&mesh_eval->id, DEG_get_evaluated_id(depsgraph, &mesh->id));
+  EXPECT_EQ(mesh->mvert, mesh_eval->mvert);
+  EXPECT_FLOAT_EQ(10.0f, mesh_eval->mvert[0].co[0]);
+  /* Untouched layers are still shared. */
+  EXPECT_EQ(medge, mesh->medge);
+  EXPECT_EQ(medge, mesh_eval->medge);
+}
+
+TEST_F(CopyOnWriteTest, MeshLayersOutliveOriginal)
+{
+  Mesh *mesh_eval = reinterpret_cast<Mesh *>(DEG_get_evaluated_id(depsgraph, &mesh->id));
+
+  /* Like leaving edit mode, the original geometry is freed and created again before the
+   * evaluated mesh is updated. */
+  CustomData_free(&mesh->vdata, mesh->totvert);
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  EXPECT_NE(mesh->mvert, mesh_eval->mvert);
+  EXPECT_FLOAT_EQ(3.0f, mesh_eval->mvert[3].co[0]);
+
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  EXPECT_EQ(mesh->mvert, mesh_eval->mvert);
+  EXPECT_FLOAT_EQ(0.0f, mesh_eval->mvert[3].co[0]);
+}
@@ -0,0 +1,140 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_math_base.h"
+#include "BLI_utildefines.h"
+
+#include "IMB_colormanagement_intern.h"
+}
+
+/* The handle typedefs of the OCIO C-API conflict with the struct forward declarations of the
+ * color management in C++, keep them in their own namespace. */
+namespace ocio {
+extern "C" {
+#include "ocio_capi.h"
+}
+}  // namespace ocio
+
+using namespace ocio;
+
+/* Enough pixels for the LUT to be baked. */
+#define BUFFER_WIDTH 64
+#define BUFFER_HEIGHT (64 * 64)
+/* One step of 8 bit display buffers, with some margin for float precision. */
+#define DISPLAY_TOLERANCE (1.0f / 255.0f + 1e-5f)
+
+/* Uses the fallback configuration, where linear to sRGB goes beyond display white like the
+ * Standard view. */
+class ColormanageLUTTest : public testing::Test {
+ protected:
+  OCIO_ConstConfigRcPtr *m_config;
+  ocio::OCIO_ConstProcessorRcPtr *m_processor;
+  ColormanageLUT *m_lut;
+
+  virtual void SetUp()
+  {
+    OCIO_init();
+    m_config = OCIO_configCreateFallback();
+    m_processor = OCIO_configGetProcessorWithNames(m_config, "Linear", "sRGB");
+    m_lut = colormanage_lut_acquire("Linear|sRGB|test",
+                                    (::OCIO_ConstProcessorRcPtr *)m_processor,
+                                    BUFFER_WIDTH * BUFFER_HEIGHT);
+  }
+
+  virtual void TearDown()
+  {
+    if (m_lut) {
+      colormanage_lut_release(m_lut);
+    }
+    colormanage_lut_cache_free();
+    OCIO_processorRelease(m_processor);
+    OCIO_configRelease(m_config);
+    OCIO_exit();
+  }
+
+  /* Colors from below 0 to far above display white, with the given alpha. */
+  static float *create_buffer(float alpha)
+  {
+    const int num_pixels = BUFFER_WIDTH * BUFFER_HEIGHT;
+    float *buffer = (float *)MEM_mallocN(sizeof(float) * 4 * num_pixels, __func__);
+    unsigned int seed = 1;
+    for (int i = 0; i < num_pixels; i++) {
+      for (int j = 0; j < 3; j++) {
+        seed = seed * 1103515245 + 12345;
+        const float value = (float)((seed >> 8) & 0xffff) / 65536.0f;
+        buffer[4 * i + j] = (value * value * 4.0f - 0.1f) * alpha;
+      }
+      buffer[4 * i + 3] = alpha;
+    }
+    return buffer;
+  }
+
+  /* Compare applying the LUT and the exact processor, like display buffers after clamping. */
+  void expect_same_as_processor(float alpha, bool predivide)
+  {
+    const int num_pixels = BUFFER_WIDTH * BUFFER_HEIGHT;
+    float *baked = create_buffer(alpha);
+    float *exact = create_buffer(alpha);
+
+    colormanage_lut_apply(m_lut,
+                          (::OCIO_ConstProcessorRcPtr *)m_processor,
+                          baked,
+                          BUFFER_WIDTH,
+                          BUFFER_HEIGHT,
+                          4,
+                          predivide);
+
+    OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(exact,
+                                                                BUFFER_WIDTH,
+                                                                BUFFER_HEIGHT,
+                                                                4,
+                                                                sizeof(float),
+                                                                4 * sizeof(float),
+                                                                4 * sizeof(float) * BUFFER_WIDTH);
+    if (predivide) {
+      OCIO_processorApply_predivide(m_processor, img);
+    }
+    else {
+      OCIO_processorApply(m_processor, img);
+    }
+    OCIO_PackedImageDescRelease(img);
+
+    float max_difference = 0.0f;
+    for (int i = 0; i < num_pixels * 4; i++) {
+      const float difference = fabsf(clamp_f(exact[i], 0.0f, 1.0f) -
+                                     clamp_f(baked[i], 0.0f, 1.0f));
+      max_difference = max_ff(max_difference, difference);
+    }
+    EXPECT_LE(max_difference, DISPLAY_TOLERANCE);
+
+    MEM_freeN(baked);
+    MEM_freeN(exact);
+  }
+};
+
+TEST_F(ColormanageLUTTest, Opaque)
+{
+  ASSERT_TRUE(m_lut != NULL);
+  expect_same_as_processor(1.0f, false);
+  expect_same_as_processor(1.0f, true);
+}
+
+TEST_F(ColormanageLUTTest, Predivide)
+{
+  ASSERT_TRUE(m_lut != NULL);
+  /* The transform is accurate within the shaper range, predivided pixels there use the LUT. */
+  EXPECT_TRUE(colormanage_lut_use_predivide(m_lut));
+  expect_same_as_processor(0.5f, true);
+  expect_same_as_processor(0.1f, true);
+  expect_same_as_processor(0.0f, true);
+}
+
+TEST_F(ColormanageLUTTest, Straight)
+{
+  ASSERT_TRUE(m_lut != NULL);
+  expect_same_as_processor(0.5f, false);
+}